@@ -0,0 +1,47 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+
+#ifndef DTMFOSCILLATOR_H_
+#define DTMFOSCILLATOR_H_
+
+#include <stdint.h>
+
+//Samples generated between two exact evaluations of the oscillators
+#define DTMF_OSCILLATOR_RESEED_SAMPLES 1024
+
+/*
+ * DtmfOscillator synthesizes the dual tone of a DTMF key as mono S16,
+ * (sin1 / 2 + sin2 / 2) * 16384 like the former tone table. Both sines follow
+ * s[n+1] = 2cos(w)s[n] - s[n-1] and restart from sin() every
+ * DTMF_OSCILLATOR_RESEED_SAMPLES, so rounding errors cannot build up over
+ * long tones. Whole frequencies repeat every second, the position wraps there.
+ */
+class DtmfOscillator
+{
+public:
+    DtmfOscillator(int lowFrequency, int highFrequency, int sampleRate);
+    void generate(int16_t *buffer, int samples);
+    int getSampleRate() const { return mSampleRate; }
+
+private:
+    int mSampleRate;
+    //Position in the one second period shared by both tones
+    int mPosition;
+    double mOmega[2];
+};
+
+#endif /* DTMFOSCILLATOR_H_ */
@@ -0,0 +1,64 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef IMAADPCM_H_
+#define IMAADPCM_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+//Extension of the compressed system sounds
+#define IMA_ADPCM_FILE_EXTENSION ".adpcm"
+#define IMA_ADPCM_MAGIC "IMAA"
+#define IMA_ADPCM_VERSION 1
+#define IMA_ADPCM_HEADER_SIZE 20
+//Frames of a block, the first one is stored as is in the block header
+#define IMA_ADPCM_BLOCK_FRAMES 1025
+#define IMA_ADPCM_MAX_CHANNELS 8
+
+/*
+ * IMA-ADPCM container for the system sounds, 4 bits per S16LE sample.
+ * The file header (little endian) is followed by independent blocks, so
+ * a file can be decoded while it is streamed:
+ *   "IMAA" | version u16 | channels u16 | rate u32 | frames u32 | blockFrames u16 | reserved u16
+ * Each block starts with a predictor s16, a step index u8 and a reserved
+ * byte per channel, followed by the nibbles of the other frames, frame by
+ * frame and channel by channel, low nibble first.
+ */
+typedef struct imaAdpcmHeader
+{
+    uint16_t channels;
+    uint32_t rate;
+    uint32_t frames;
+    uint16_t blockFrames;
+}IMA_ADPCM_HEADER_T;
+
+class ImaAdpcm
+{
+public:
+    static bool readHeader(const uint8_t *data, size_t size, IMA_ADPCM_HEADER_T &header);
+    //Bytes of the block holding frames frames
+    static size_t getBlockSize(const IMA_ADPCM_HEADER_T &header, size_t frames);
+    //Decodes one block to interleaved S16LE
+    static void decodeBlock(const IMA_ADPCM_HEADER_T &header, const uint8_t *block, size_t frames, int16_t *output);
+    //Decodes a whole file to interleaved S16LE, returns false if it is not a valid ADPCM file
+    static bool decode(const uint8_t *data, size_t size, std::vector<uint8_t> &output);
+    //Encodes interleaved S16LE to a whole file
+    static void encode(const int16_t *pcm, size_t frames, uint16_t channels, uint32_t rate, std::vector<uint8_t> &output);
+};
+
+#endif /* IMAADPCM_H_ */
@@ -0,0 +1,73 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef PCMCONVERTER_H_
+#define PCMCONVERTER_H_
+
+#include <pulse/pulseaudio.h>
+#include <stdint.h>
+#include <vector>
+
+/*
+ * PcmConverter converts interleaved PCM to the sample spec of the sink, so
+ * pulse does not have to resample the stream in its mixing thread.
+ * Supported formats are S16LE, S24LE, S32LE and FLOAT32LE, channels are
+ * duplicated or averaged and the rate is converted by linear interpolation.
+ * Input can be fed in chunks of any size, the converter keeps its state.
+ */
+class PcmConverter
+{
+public:
+    PcmConverter();
+
+    //Returns false if one of the specs is not supported, the converter is then a passthrough
+    bool setup(const pa_sample_spec &from, const pa_sample_spec &to);
+    void reset();
+    bool isPassthrough() const { return mPassthrough; }
+    const pa_sample_spec& getOutputSpec() const { return mPassthrough ? mFrom : mTo; }
+
+    //Appends the converted data to output
+    void convert(const void *input, size_t bytes, std::vector<uint8_t> &output);
+    //Upper bound of the output size for bytes of input
+    size_t getMaxOutputSize(size_t bytes) const;
+
+    static bool isSupportedFormat(pa_sample_format_t format);
+
+private:
+    void convertFrames(const uint8_t *input, size_t frames, std::vector<uint8_t> &output);
+    void decode(const uint8_t *input, size_t frames);
+    void remapChannels(size_t frames);
+    size_t resample(size_t frames);
+    void encode(const float *samples, size_t count, uint8_t *output);
+
+    pa_sample_spec mFrom;
+    pa_sample_spec mTo;
+    bool mPassthrough;
+    size_t mInputFrameSize;
+    size_t mOutputFrameSize;
+    //Position of the next output frame relative to mLastFrame, in 1/mTo.rate input frames.
+    //Output frames are mFrom.rate apart, so the position stays exact.
+    uint64_t mPosition;
+    bool mHasLastFrame;
+    std::vector<float> mLastFrame;
+    //Input bytes of an incomplete frame, kept for the next call
+    std::vector<uint8_t> mPartialFrame;
+    std::vector<float> mDecoded;
+    std::vector<float> mRemapped;
+    std::vector<float> mResampled;
+};
+
+#endif /* PCMCONVERTER_H_ */
@@ -0,0 +1,41 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef PCMMIXER_H_
+#define PCMMIXER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+//Gains are Q15 fixed point, unity is the one value which does not fit an int16
+#define PCM_MIXER_GAIN_UNITY 32768
+
+/*
+ * Kernels summing S16 PCM, used to mix several playbacks into one stream.
+ * Sums saturate instead of wrapping around.
+ */
+class PcmMixer
+{
+public:
+    //Adds input scaled by gain to output, gain is 0 to PCM_MIXER_GAIN_UNITY
+    static void mix(int16_t *output, const int16_t *input, size_t samples, uint32_t gain);
+    //Converts a volume of 0 to 100 to a gain
+    static uint32_t volumeToGain(int volume);
+    //Converts a linear amplitude of 0 to 1 to a gain
+    static uint32_t linearToGain(double linear);
+};
+
+#endif /* PCMMIXER_H_ */
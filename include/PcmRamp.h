@@ -0,0 +1,73 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef PCMRAMP_H_
+#define PCMRAMP_H_
+
+#include <pulse/pulseaudio.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "PcmMixer.h"
+
+//Frames whose gain is computed at once, the samples of a block are then scaled with SIMD
+#define PCM_RAMP_BLOCK_SAMPLES 1024
+//Points of the quarter sine the equal power curve is interpolated from
+#define PCM_RAMP_CURVE_POINTS 256
+
+enum PCM_RAMP_CURVE_E
+{
+    ePcmRampLinear,
+    //sin rising, cos falling, for fades which keep the power of a crossfade constant
+    ePcmRampEqualPower
+};
+
+//Gain ramp from one Q15 gain to another, kept across buffers
+typedef struct pcmRamp
+{
+    uint32_t from;
+    uint32_t to;
+    uint32_t frames;
+    //Frames already ramped, frames past the end get the target gain
+    uint32_t position;
+    PCM_RAMP_CURVE_E curve;
+}PCM_RAMP_T;
+
+/*
+ * Kernels applying a gain ramp to interleaved PCM in place, to avoid clicks
+ * when a stream starts, stops or pauses. The gain of each frame is computed
+ * in fixed point without divisions, the samples are scaled with SSE2 or
+ * NEON for S16 and FLOAT32, S24 and S32 use the scalar path.
+ */
+class PcmRamp
+{
+public:
+    static void start(PCM_RAMP_T &ramp, uint32_t from, uint32_t to, uint32_t frames, PCM_RAMP_CURVE_E curve);
+    //Starts a new ramp from the gain the ramp has reached
+    static void retarget(PCM_RAMP_T &ramp, uint32_t to, uint32_t frames);
+    static bool isActive(const PCM_RAMP_T &ramp) { return ramp.position < ramp.frames; }
+    static uint32_t getGain(const PCM_RAMP_T &ramp);
+    //Scales frames of buffer and moves the ramp forward
+    static void apply(PCM_RAMP_T &ramp, void *buffer, size_t frames, pa_sample_format_t format, uint8_t channels);
+    static bool isSupportedFormat(pa_sample_format_t format);
+    static PCM_RAMP_CURVE_E getCurve(const char *name);
+
+private:
+    static uint64_t getPhaseStep(const PCM_RAMP_T &ramp);
+    static uint32_t getGainAt(const PCM_RAMP_T &ramp, uint32_t position, uint64_t phaseStep);
+    static void scale(void *buffer, const int16_t *gains, size_t samples, pa_sample_format_t format);
+};
+
+#endif /* PCMRAMP_H_ */
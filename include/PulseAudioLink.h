@@ -18,7 +18,9 @@
 #define PULSEAUDIOLINK_H_
 
 #include <pulse/pulseaudio.h>
-#include <pulse/simple.h>
+#include <deque>
+#include <map>
+#include <memory>
 #include <set>
 #include <string>
 #include "log.h"
@@ -26,13 +28,52 @@
 #include <math.h>
 #include <unistd.h>
 #include <audiodTracer.h>
-#include <thread>
 #include "mixerInterface.h"
+#include "PulsePlaybackEngine.h"
+#include "DtmfOscillator.h"
 
 #include "utils.h"
 #define AUDIO_EFFECT_FADE_OUT  1
 #define AUDIO_EFFECT_FADE_IN   (1<<1)
 
+//Upload of a sample which takes longer than this is retried
+#define PRELOAD_TIMEOUT_MS 5000
+//Manifest of system sounds uploaded as soon as Pulse is connected
+#define SOUND_WARMUP_CONFIG "/etc/palm/audiod/audiod_sound_warmup_config.json"
+#define SOUND_WARMUP_DEFAULT_BUDGET_KB 512
+#define SOUND_WARMUP_DEFAULT_PARALLEL_UPLOADS 4
+//Byte budget of the samples uploaded to Pulse, 0 keeps every sample loaded
+#define SAMPLE_CACHE_DEFAULT_BUDGET_KB 0
+//Low latency mode of the feedback sounds, configured by the "lowLatency" section of the manifest
+#define LOW_LATENCY_DEFAULT_STREAMS_PER_SINK 2
+//Streams are added on demand when every armed stream is busy, up to this count
+#define LOW_LATENCY_MAX_STREAMS_PER_SINK 6
+#define LOW_LATENCY_DEFAULT_BUDGET_KB 256
+
+enum SOUND_READINESS_E
+{
+    eSoundNotLoaded,
+    eSoundLoading,
+    eSoundReady,
+    eSoundFailed
+};
+
+//Ways a system sound is started, the latency of each is probed separately
+enum PLAY_LATENCY_MODE_E
+{
+    ePlayLatencySample,
+    ePlayLatencyStream,
+    ePlayLatencyModeCount
+};
+
+typedef struct playLatencyProbe
+{
+    unsigned int count;
+    gint64 totalUs;
+    gint64 minUs;
+    gint64 maxUs;
+}PLAY_LATENCY_PROBE_T;
+
 #define AUDIO_STATUS_NORMAL  1
 #define AUDIO_STATUS_STOPPING  2
 #define AUDIO_STATUS_STOPPED  3
@@ -129,28 +170,6 @@ protected:
     int mAudioEffect;
 };
 
-class PlaybackThread
-{
-    public:
-        PlaybackThread(MixerInterface* mixerCallBack, std::string playbackId);
-        bool play(const char * samplename, const char * sink, const char * format, int rate, int channels);
-        bool pause();
-        bool resume();
-        bool stop();
-        std::string getPlaybackStatus();
-        void playbackStatusChanged(std::string playbackID, std::string state);
-    private:
-        bool mDataAvailable;
-        pa_simple *mStream;
-        bool playThread();
-        uint8_t* mPlayData;
-        FILE *fptr;
-        std::thread playbackThread;
-        std::string playbackState;
-        MixerInterface *mCallback;
-        std::string mPlaybackId;
-};
-
 /*
  * PulseAudioLink handles a connection with Pulse using Pulse official APIs
  * The only purpose of this class is to allow playing a system sound file
@@ -174,38 +193,136 @@ public:
     bool    play(const char * filename, const char * sink, const char * format, \
         int rate, int channels);
     std::string    playSound(const char * filename, const char * sink, const char * format, \
-        int rate, int channels);
+        int rate, int channels, int volume);
     std::string    play(const char *snd,  EVirtualAudioSink sink, const char *format, \
-        int rate, int channels);
+        int rate, int channels, int volume);
+    int queueSound(std::string playbackId, const char *filename, const char *format, int rate, int channels);
     bool controlPlayback(std::string playbackId, std::string requestType);
-    std::string getPlaybackStatus(std::string playbackId);
+    std::string getPlaybackStatus(std::string playbackId, PLAYBACK_TIMING_T *timing = nullptr);
 
     /// on-demand sounds need to be pre-loaded in Pulse for a faster initial playback
-    void    preload(const char * filename, const char * format, int rate, int channels, const char * path);
+    /// Returns true if the sample is already loaded, otherwise the upload completes asynchronously
+    bool    preload(const char * filename, const char * format, int rate, int channels, const char * path);
+    void    preloadCompleted(const std::string &samplename, unsigned int requestId, bool isSuccess, size_t bytes);
+
+    /// upload the sounds listed in the warm-up manifest, called once Pulse is connected
+    void    warmUpSounds();
+    SOUND_READINESS_E getSoundReadiness(const std::string &samplename) const;
+    /// sample cache usage and hit/miss/eviction counters
+    pbnjson::JValue getSampleCacheStats() const;
+    /// request to first sample latency of the sample and low latency modes
+    pbnjson::JValue getPlayLatencyStats() const;
+    //Fade configured for the sink, defaultMs if there is none
+    int getGainRampMs(const char *sink, int defaultMs);
 
     /// These should really be private, but they're needed for global callbacks...
     void    pulseAudioStateChanged(pa_context_state_t state);
+    void    recordPlayLatency(PLAY_LATENCY_MODE_E mode, gint64 latencyUs);
 
     void registerCallback(MixerInterface *mixerCallBack);
 
 protected:
     bool     connectToPulse();
+    void    querySinkSpec();
     void    killPulseConnection();
     bool    iteratePulse(int block);
+    bool    playSample(const char * samplename, const char * sink, gint64 requestTime = 0);
+    bool    playWhenLoaded(const char * samplename, const char * sink, bool loaded, gint64 requestTime = 0);
+    void    completePreload(const std::string &samplename, bool isSuccess);
+    void    startWarmUpUploads();
+    void    configureSampleCache(const pbnjson::JValue &cacheConfig);
+    void    touchSample(const std::string &samplename);
+    void    evictSamples(const std::string &keepSample);
+    void    configureLowLatency(const pbnjson::JValue &lowLatencyConfig);
+    void    configureGainRamp(const pbnjson::JValue &rampConfig);
+    void    stageFeedbackSounds();
+    void    armFeedbackStreams();
+    void    releaseFeedbackStreams();
+    bool    playLowLatency(const char * samplename, const char * sink, gint64 requestTime);
 
     static void* pathread_func(void*);
+    static void server_info_callback(pa_context *c, const pa_server_info *info, void *userdata);
     static void stream_drain_complete(pa_stream*stream, int success, void *userdata) ;
     static void data_stream_write_callback(pa_stream *s, size_t length, void *userdata);
     static void PlayAudioDataProviderDeferCB(pa_mainloop_api *a,
                                              pa_defer_event *e,
                                              void *userdata);
+    static void ArmFeedbackStreamsDeferCB(pa_mainloop_api *a, pa_defer_event *e, void *userdata);
+    static void PlayFeedbackDeferCB(pa_mainloop_api *a, pa_defer_event *e, void *userdata);
+    static void feedback_stream_state_cb(pa_stream *s, void *userdata);
+    static void feedback_stream_uncork_cb(pa_stream *s, int success, void *userdata);
+    static void feedback_stream_drain_cb(pa_stream *s, int success, void *userdata);
 
 private:
     pa_context *            mContext;
     pa_mainloop *            mMainLoop;
     bool                    mPulseAudioReady;
-    std::set<std::string>    mLoadedSounds;
-    std::map<std::string, PlaybackThread *> mMapAudioList;
+    //Spec of the server, samples are converted to it before being uploaded
+    pa_sample_spec          mSinkSpec;
+    //Samples uploaded to Pulse, failed uploads are kept with no size so they are not retried
+    typedef struct sampleCacheEntry
+    {
+        size_t bytes;
+        unsigned int hits;
+        guint64 lastUse;
+        bool pinned;
+    }SAMPLE_CACHE_ENTRY_T;
+    std::map<std::string, SAMPLE_CACHE_ENTRY_T> mLoadedSounds;
+    std::set<std::string> mPinnedSounds;
+    size_t mSampleCacheBudget;
+    size_t mSampleCacheBytes;
+    unsigned int mSampleCacheHits;
+    unsigned int mSampleCacheMisses;
+    unsigned int mSampleCacheEvictions;
+    //Samples being uploaded, with the sinks waiting to play them
+    typedef struct preloadRequest
+    {
+        unsigned int requestId;
+        guint64 startTime;
+        std::vector<const char*> pendingSinks;
+    }PRELOAD_REQUEST_T;
+    std::map<std::string, PRELOAD_REQUEST_T> mPendingPreloads;
+    unsigned int mPreloadRequestId;
+    std::map<std::string, SOUND_READINESS_E> mSoundReadiness;
+    std::deque<std::string> mWarmUpQueue;
+    std::set<std::string> mWarmUpUploads;
+    int mWarmUpParallelUploads;
+    guint64 mWarmUpStartTime;
+    //Feedback sounds staged in the sink spec, played through corked streams kept connected per sink
+    bool mLowLatencyEnabled;
+    int mFeedbackStreamsPerSink;
+    //Latency requested for the streams, 0 keeps the server default
+    pa_usec_t mFeedbackTargetLatency;
+    size_t mFeedbackBudget;
+    std::vector<std::string> mFeedbackSinks;
+    std::vector<std::string> mFeedbackSoundNames;
+    pa_sample_spec mFeedbackSpec;
+    std::map<std::string, std::shared_ptr<const std::vector<uint8_t>>> mFeedbackSounds;
+    bool mFeedbackStreamsArmed;
+    enum FEEDBACK_STREAM_STATE_E
+    {
+        eFeedbackArming,
+        eFeedbackIdle,
+        eFeedbackPlaying
+    };
+    typedef struct feedbackStream
+    {
+        pa_stream *stream;
+        std::string sink;
+        FEEDBACK_STREAM_STATE_E state;
+        PulseAudioLink *link;
+        //Sound to start once the stream is ready, for a stream added on demand
+        std::shared_ptr<const std::vector<uint8_t>> pending;
+        gint64 requestTime;
+    }FEEDBACK_STREAM_T;
+    static FEEDBACK_STREAM_T* connectFeedbackStream(PulseAudioLink *link, pa_context *context, const pa_sample_spec &spec,
+                                                    pa_usec_t targetLatency, const std::string &sink);
+    static void startFeedbackStream(FEEDBACK_STREAM_T *entry, const std::shared_ptr<const std::vector<uint8_t>> &pcm,
+                                    gint64 requestTime);
+    //Only touched on the pulse thread
+    std::vector<FEEDBACK_STREAM_T*> mFeedbackStreams;
+    PLAY_LATENCY_PROBE_T mPlayLatency[ePlayLatencyModeCount];
+    PulsePlaybackEngine mPlaybackEngine;
     MixerInterface *mCallback;
     pthread_t mThread;
 };
@@ -226,17 +343,27 @@ enum Dtmf {
     Dtmf_ArrayCount
 };
 
+#define DTMF_SAMPLE_RATE 44100
+#define DTMF_FADE_MS 20
+
+/*
+ * PulseDtmfGenerator synthesizes a dual tone straight into the pa_stream
+ * write buffer, with a fade in and a fade out of 20 ms by default
+ */
 class PulseDtmfGenerator : public PulseAudioDataProvider {
 public:
-    PulseDtmfGenerator(Dtmf tone, int milliseconds=0);
+    PulseDtmfGenerator(Dtmf tone, int milliseconds=0, int sampleRate=DTMF_SAMPLE_RATE, int fadeMs=DTMF_FADE_MS);
     Dtmf getTone(){ return (Dtmf)mDtmf; };
     virtual bool stream_write_callback(pa_stream *s, size_t length);
 protected:
     virtual ~PulseDtmfGenerator();
+    void generateTone(gint16 *buffer, int samples);
+    void applyFades(gint16 *buffer, int samples, bool isStopping);
     int mDtmf;
-    int mWritePos;
     int mAccumulatedSamples;
     int mPlaySamples;
+    int mFadeSamples;
+    DtmfOscillator mOscillator;
 };
 
 #endif /* PULSEAUDIOLINK_H_ */
@@ -23,12 +23,19 @@
 #include <sys/socket.h>
 #include <sys/un.h>
 #include <cerrno>
+#include <deque>
 #include "messageUtils.h"
 #include "log.h"
 #include "main.h"
 #include <audiodTracer.h>
 #include <pulse/module-palm-policy-tables.h>
 #include "mixerInterface.h"
+#include "PulseReplyTracker.h"
+
+//Number of preallocated frames queued towards pulseaudio
+#define PULSE_SEND_RING_SIZE 64
+//Number of frames from pulseaudio read in one recv
+#define PULSE_RECV_BUFFER_FRAMES 16
 
 //Implementation of PulseMixer using Pulse as backend
 class PulseAudioMixer
@@ -44,6 +51,10 @@ public:
     //Will ignore volume of high latency sinks not playing and mute them.
     bool programTrackVolume(EVirtualAudioSink sink, int sinkIndex, int volume, LSHandle *lshandle, LSMessage *message, void *ctx, PulseCallBackFunc cb, bool ramp = false);
     bool programVolume(EVirtualSource source, int volume, LSHandle *lshandle, LSMessage *message, void *ctx, PulseCallBackFunc cb, bool ramp = false);
+    //Programs several sink inputs together, cb is called once when all of them are answered.
+    //Each sink input is its own paVolumeSet and pulse applies it on its own, the batch is not atomic:
+    //cb gets false if any of them failed while the others keep their new volume.
+    bool programVolumes(const std::vector<utils::SINK_VOLUME_ENTRY_T> &entries, LSHandle *lshandle, LSMessage *message, void *ctx, PulseCallBackFunc cb);
     bool setSoundOutputOnRange(EVirtualAudioSink startSink,\
         EVirtualAudioSink endSink, const char* deviceName);
     bool setSoundInputOnRange(EVirtualSource startSource,\
@@ -64,11 +75,14 @@ public:
     /// Play a system sound using Pulse's API
     bool playSystemSound(const char *snd, EVirtualAudioSink sink);
     std::string playSound(const char *snd, EVirtualAudioSink sink, \
-        const char *format, int rate, int channels);
+        const char *format, int rate, int channels, int volume);
+    int queueSound(std::string playbackId, const char *snd, const char *format, int rate, int channels);
     bool controlPlayback(std::string playbackId, std::string requestType);
-    std::string getPlaybackStatus(std::string playbackId);
+    std::string getPlaybackStatus(std::string playbackId, PLAYBACK_TIMING_T *timing = nullptr);
     /// Pre-load system sound in Pulse, if necessary
     void preloadSystemSound(const char * snd);
+    pbnjson::JValue getSampleCacheStats();
+    pbnjson::JValue getPlayLatencyStats();
     bool muteSink(const int& sink, const int& mutestatus, LSHandle *lshandle, LSMessage *message, void *ctx, PulseCallBackFunc cb);  //TODO : remove
     bool setMute(const char* deviceName, const int& mutestatus, LSHandle *lshandle, LSMessage *message, void *ctx, PulseCallBackFunc cb);
     //mute virtual source
@@ -93,6 +107,8 @@ public:
     bool _connectSocket();
     void _pulseStatus(GIOChannel * ch, GIOCondition condition, gpointer user_data);
     void _timer();
+    bool _expirePendingRequests();
+    bool _pulseWritable(GIOChannel * ch, GIOCondition condition);
 
     GIOChannel* mChannel;
     void openCloseSink(EVirtualAudioSink sink, bool openNotClose, int sinkIndex, std::string trackId);
@@ -159,14 +175,59 @@ private:
         LSMessage *message;
         void *ctx;
         PulseCallBackFunc cb;
+        uint32_t replyID;
+        guint64 deadline;
+    };
+
+    //Shared completion of a programVolumes batch
+    struct volumeBatchInfo
+    {
+        pulseCallBackInfo pci;
+        int count;
+        int remaining;
+        bool status;
     };
 
-    //Map to store pulseaudio callback information along with operation id
-    std::map<int, pulseCallBackInfo> mPulseCallBackInfo;
+    bool queueTrackVolume(EVirtualAudioSink sink, int sinkIndex, int volume, bool ramp, const pulseCallBackInfo &pci);
+    static bool _volumeBatchReply(LSHandle *sh, LSMessage *reply, void *ctx, bool status);
+
+    //Pending requests keyed by sequence number, several requests can wait for the same reply id
+    std::map<uint32_t, pulseCallBackInfo> mPulseCallBackInfo;
+    //Matches the replies to the sequence numbers
+    PulseReplyTracker mReplyTracker;
+    guint mPendingTimerID;
+
+    //To register/complete the callback of a request sent to pulseaudio
+    uint32_t addPendingRequest(uint32_t replyID, const pulseCallBackInfo &pci);
+    void completePendingRequest(uint32_t replyID, bool status);
+    void failAllPendingRequests();
+
+    //Outgoing frames waiting for the socket, flushed together on G_IO_OUT
+    char mSendRing[PULSE_SEND_RING_SIZE][SIZE_MESG_TO_PULSE];
+    int mSendHead;
+    int mSendCount;
+    size_t mSendOffset;
+    guint mSendSourceID;
+
+    char* reserveSendFrame();
+    void commitSendFrame();
+    bool flushSendQueue();
+    void resetSendQueue();
+
+    //Reusable receive buffer, may hold a partial frame between wakeups
+    char mRecvBuffer[PULSE_RECV_BUFFER_FRAMES * SIZE_MESG_TO_AUDIOD];
+    size_t mRecvLength;
+    unsigned int mRecvFrameCount;
+    unsigned int mShortReadCount;
+    unsigned int mMalformedFrameCount;
+
+    void receiveFromPulse(GIOChannel *ch, bool &peerClosed);
+    bool isValidPulseFrame(const char *buffer);
+    void dispatchPulseMessage(const char *buffer);
 
     // Function to send message to pulseaudio
     bool sendHeaderToPA(char *data, paudiodMsgHdr audioMsgHdr);
-    template<typename T>bool sendDataToPulse (uint32_t msgType, uint32_t msgID, T subObj);
+    template<typename T>bool sendDataToPulse (uint32_t msgType, uint32_t msgID, T subObj, const pulseCallBackInfo *pci = nullptr);
 };
 
 #endif //PULSEAUDIOMIXER_H_
@@ -0,0 +1,278 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef PULSEPLAYBACKENGINE_H_
+#define PULSEPLAYBACKENGINE_H_
+
+#include <pulse/pulseaudio.h>
+#include <deque>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+#include "log.h"
+#include "utils.h"
+#include "mixerInterface.h"
+#include "PcmConverter.h"
+#include "PcmMixer.h"
+#include "PcmRamp.h"
+#include "ImaAdpcm.h"
+
+//Number of playbacks which can be active at the same time
+#define PLAYBACK_STREAM_POOL_SIZE 16
+//Number of finished playbacks whose last state can still be queried
+#define PLAYBACK_FINISHED_HISTORY_SIZE 32
+//Bytes of the file read at once when the stream is converted
+#define PLAYBACK_CONVERT_CHUNK_SIZE 4096
+//Latency requested for the stream of a sink, pause and stop are heard within it
+#define PLAYBACK_MIX_LATENCY_MS 50
+//Frames mixed at once
+#define PLAYBACK_MIX_CHUNK_FRAMES 1024
+//Spec mixed at when the server spec is unknown
+#define PLAYBACK_MIX_DEFAULT_RATE 48000
+#define PLAYBACK_MIX_DEFAULT_CHANNELS 2
+//Fade applied when a playback starts, stops, pauses or resumes, unless configured for its sink
+#define PLAYBACK_RAMP_DEFAULT_MS 10
+//Files which can wait in the queue of a playback, each one holds an open file
+#define PLAYBACK_QUEUE_MAX_ITEMS 16
+
+//Progress of an active playback, frames are counted at the rate of its stream
+typedef struct playbackTiming
+{
+    //Frames handed to pulse
+    uint64_t framesWritten;
+    //Frames heard so far, framesWritten minus the data still queued in pulse
+    uint64_t positionFrames;
+    //Latency of the stream as reported by its timing info
+    pa_usec_t latency;
+    uint32_t rate;
+    //Queued file being played
+    int item;
+}PLAYBACK_TIMING_T;
+
+//Reads PCM data from a memory mapped file, falls back to stdio for files
+//which cannot be mapped (pipes, empty or special files).
+//IMA-ADPCM files are decoded block by block while they are read.
+class PcmFileSource
+{
+public:
+    PcmFileSource();
+    ~PcmFileSource();
+
+    bool open(const char *fileName);
+    void close();
+    //Copies up to bytes of data to buffer, returns 0 at end of file
+    size_t read(void *buffer, size_t bytes);
+    bool isMapped() const { return nullptr != mData; }
+    //Spec stored in a compressed file, returns false for raw PCM
+    bool getSampleSpec(pa_sample_spec &spec) const;
+    //Asks the kernel to read the mapped file ahead of playback
+    void prefetch();
+
+private:
+    PcmFileSource(const PcmFileSource &) = delete;
+    PcmFileSource& operator=(const PcmFileSource &) = delete;
+
+    size_t readRaw(void *buffer, size_t bytes);
+    bool decodeNextBlock();
+
+    const uint8_t *mData;
+    size_t mLength;
+    size_t mOffset;
+    FILE *mFile;
+    bool mCompressed;
+    IMA_ADPCM_HEADER_T mHeader;
+    uint32_t mDecodedFrames;
+    std::vector<uint8_t> mBlock;
+    //Decoded block, or the bytes read to detect the format of a raw file
+    std::vector<uint8_t> mPending;
+    size_t mPendingOffset;
+};
+
+/*
+ * PulsePlaybackEngine plays files on asynchronous pulse streams.
+ * All streams share one context driven by a pa_threaded_mainloop, the
+ * public API only queues work and never waits for pulseaudio.
+ * The playbacks of a sink are converted to S16 at the server rate and
+ * summed into one stream, so pulse sees one sink input per sink however
+ * many playbacks are active. The stream is corked while every playback
+ * of the sink is paused and closed once the last one is gone.
+ * Playbacks fade in when they start or resume and fade out before they
+ * stop or pause, the fade length and curve can be set per sink.
+ * Files queued on a playback are opened when they are queued and played
+ * back to back on the same stream, the next one is prefetched while the
+ * current one plays.
+ */
+class PulsePlaybackEngine
+{
+public:
+    PulsePlaybackEngine();
+    ~PulsePlaybackEngine();
+
+    void registerCallback(MixerInterface *mixerCallBack);
+
+    std::string play(const char *fileName, const char *sink, const char *format, int rate, int channels, int volume);
+    //Queues a file after the ones of an active playback, returns its item index or -1
+    int enqueue(const std::string &playbackId, const char *fileName, const char *format, int rate, int channels);
+    bool pause(const std::string &playbackId);
+    bool resume(const std::string &playbackId);
+    bool stop(const std::string &playbackId);
+    //timing is filled for active playbacks only, it is left untouched otherwise
+    std::string getPlaybackStatus(const std::string &playbackId, PLAYBACK_TIMING_T *timing = nullptr);
+    //An empty sink sets the fade of the sinks which are not configured
+    void setGainRamp(const std::string &sink, int milliseconds, PCM_RAMP_CURVE_E curve);
+    //Returns false if no fade is configured for the sink itself
+    bool getGainRamp(const std::string &sink, int &milliseconds);
+    //Underflows pulse reported on the mixer streams before they were closed, since the engine was created
+    uint32_t getUnderrunCount();
+
+private:
+    PulsePlaybackEngine(const PulsePlaybackEngine &) = delete;
+    PulsePlaybackEngine& operator=(const PulsePlaybackEngine &) = delete;
+
+    enum PLAYBACK_STATE_E
+    {
+        eStateConnecting,
+        eStatePlaying,
+        eStatePaused,
+        eStateDraining,
+        eStateStopped,
+        eStateError
+    };
+
+    struct playbackMixer;
+    typedef struct playbackMixer PLAYBACK_MIXER_T;
+
+    //File queued after the current one of a playback
+    typedef struct playbackItem
+    {
+        int index;
+        pa_sample_spec spec;
+        PcmFileSource *source;
+    }PLAYBACK_ITEM_T;
+
+    typedef struct playbackStream
+    {
+        PulsePlaybackEngine *engine;
+        std::string playbackId;
+        std::string sink;
+        pa_sample_spec spec;
+        //Mixer of the sink, the playback is summed into its stream
+        PLAYBACK_MIXER_T *mixer;
+        //Item being played, the file and spec above are the ones of this item
+        int item;
+        int itemCount;
+        std::deque<PLAYBACK_ITEM_T> queue;
+        PcmFileSource *source;
+        //Converts the file to the mixer spec, data not yet mixed stays in converted
+        PcmConverter converter;
+        std::vector<uint8_t> converted;
+        size_t convertedOffset;
+        uint32_t gain;
+        //Fade of the playback, the gain above is reached at its end
+        PCM_RAMP_T ramp;
+        //Paused or stopped, still mixed until the fade out ends
+        bool fadingOut;
+        uint64_t framesWritten;
+        //Frame of the mixer stream which follows the last data of the playback
+        uint64_t writeEnd;
+        bool endOfFile;
+        PLAYBACK_STATE_E state;
+    }PLAYBACK_STREAM_T;
+
+    struct playbackMixer
+    {
+        PulsePlaybackEngine *engine;
+        std::string sink;
+        pa_sample_spec spec;
+        pa_stream *stream;
+        uint64_t framesWritten;
+        std::vector<PLAYBACK_STREAM_T*> playbacks;
+        //Data read from one playback before it is summed into the write buffer
+        std::vector<uint8_t> buffer;
+    };
+
+    typedef struct playbackRampConfig
+    {
+        int milliseconds;
+        PCM_RAMP_CURVE_E curve;
+    }PLAYBACK_RAMP_CONFIG_T;
+
+    typedef struct playbackStatusNotify
+    {
+        MixerInterface *callback;
+        std::string playbackId;
+        std::string state;
+        int item;
+    }PLAYBACK_STATUS_NOTIFY_T;
+
+    //Everything below is guarded by the threaded mainloop lock
+    pa_threaded_mainloop *mMainLoop;
+    pa_context *mContext;
+    bool mContextFailed;
+    //Spec of the server, streams are converted to it before being written
+    pa_sample_spec mSinkSpec;
+    bool mSinkSpecKnown;
+    MixerInterface *mCallback;
+    std::map<std::string, PLAYBACK_STREAM_T*> mStreams;
+    std::map<std::string, PLAYBACK_MIXER_T*> mMixers;
+    //Mixers left without playbacks, waiting for pulse to terminate their stream
+    std::set<PLAYBACK_MIXER_T*> mClosingMixers;
+    std::deque<std::pair<std::string, PLAYBACK_STATE_E>> mFinishedPlaybacks;
+    PLAYBACK_RAMP_CONFIG_T mDefaultRamp;
+    std::map<std::string, PLAYBACK_RAMP_CONFIG_T> mSinkRamps;
+    uint32_t mUnderruns;
+
+    bool connectContext();
+    pa_sample_spec getMixSpec() const;
+    PLAYBACK_MIXER_T* getMixer(const std::string &sink);
+    bool startMixer(PLAYBACK_MIXER_T *mixer);
+    void startWaitingMixers();
+    bool setupPlayback(PLAYBACK_STREAM_T *playback);
+    void updateMixer(PLAYBACK_MIXER_T *mixer, bool drain);
+    void failMixer(PLAYBACK_MIXER_T *mixer);
+    void closeMixer(PLAYBACK_MIXER_T *mixer, bool drain);
+    void releaseMixer(PLAYBACK_MIXER_T *mixer);
+    void writeMixer(PLAYBACK_MIXER_T *mixer, size_t length);
+    void endFadeOut(PLAYBACK_STREAM_T *playback, std::vector<PLAYBACK_STREAM_T*> &ended);
+    size_t readPlayback(PLAYBACK_STREAM_T *playback, void *buffer, size_t bytes);
+    size_t readSource(PLAYBACK_STREAM_T *playback, void *buffer, size_t bytes);
+    bool startNextItem(PLAYBACK_STREAM_T *playback);
+    void dropQueue(PLAYBACK_STREAM_T *playback);
+    PcmFileSource* openSource(const char *fileName, const char *format, int rate, int channels, pa_sample_spec &spec);
+    size_t readConverted(PLAYBACK_STREAM_T *playback, void *buffer, size_t bytes);
+    void setState(PLAYBACK_STREAM_T *playback, PLAYBACK_STATE_E state);
+    void notifyStatus(const std::string &playbackId, const char *state, int item);
+    void finishStream(PLAYBACK_STREAM_T *playback, PLAYBACK_STATE_E state);
+    PLAYBACK_STREAM_T* findStream(const std::string &playbackId);
+    void getTiming(PLAYBACK_STREAM_T *playback, PLAYBACK_TIMING_T &timing);
+    const PLAYBACK_RAMP_CONFIG_T& getRampConfig(const std::string &sink) const;
+    uint32_t getRampFrames(PLAYBACK_STREAM_T *playback) const;
+    bool canFade(PLAYBACK_STREAM_T *playback) const;
+    static bool isMixed(const PLAYBACK_STREAM_T *playback);
+    static const char* getStateName(PLAYBACK_STATE_E state);
+
+    static void contextStateCallback(pa_context *context, void *userdata);
+    static void serverInfoCallback(pa_context *context, const pa_server_info *info, void *userdata);
+    static void mixerStateCallback(pa_stream *stream, void *userdata);
+    static void mixerWriteCallback(pa_stream *stream, size_t length, void *userdata);
+    static void mixerUnderflowCallback(pa_stream *stream, void *userdata);
+    static void mixerDrainCallback(pa_stream *stream, int success, void *userdata);
+    static void mixerCorkCallback(pa_stream *stream, int success, void *userdata);
+    static gboolean _notifyPlaybackStatus(gpointer data);
+};
+
+#endif /* PULSEPLAYBACKENGINE_H_ */
@@ -0,0 +1,67 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef PULSEREPLYTRACKER_H_
+#define PULSEREPLYTRACKER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+#include <deque>
+#include <map>
+#include <vector>
+
+/*
+ * Matches the replies of pulseaudio to the requests sent to it. Pulse only
+ * echoes the reply id of a request and answers in the order it received
+ * them, so the oldest request waiting for a reply id is the one answered.
+ * A request failed by its deadline still owes a reply: the late reply is
+ * absorbed without completing a newer request of the same reply id.
+ */
+class PulseReplyTracker
+{
+public:
+    PulseReplyTracker();
+    //Returns the sequence number of the new request
+    uint32_t add(uint32_t replyID, uint64_t deadline);
+    //Returns the sequence answered by a reply of replyID, 0 if it answers an expired request or nothing
+    uint32_t complete(uint32_t replyID);
+    //Removes and returns the requests whose deadline passed, oldest first
+    std::vector<uint32_t> expire(uint64_t now);
+    //Forgets every request, their replies will never come
+    std::vector<uint32_t> clear();
+    bool empty() const { return mRequests.empty(); }
+    size_t size() const { return mRequests.size(); }
+    uint32_t getLateReplies() const { return mLateReplies; }
+
+private:
+    typedef struct pendingReply
+    {
+        uint32_t replyID;
+        uint64_t deadline;
+    }PENDING_REPLY_T;
+
+    void remove(uint32_t sequence);
+
+    std::map<uint32_t, PENDING_REPLY_T> mRequests;
+    //Sequences waiting for each reply id, in the order the requests were sent
+    std::map<uint32_t, std::deque<uint32_t>> mPendingReplies;
+    //Replies still owed by expired requests, per reply id
+    std::map<uint32_t, uint32_t> mExpiredReplies;
+    uint32_t mSequence;
+    uint32_t mLateReplies;
+};
+
+#endif /* PULSEREPLYTRACKER_H_ */
@@ -0,0 +1,171 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef VOLUMECURVE_H_
+#define VOLUMECURVE_H_
+
+#include <pulse/pulseaudio.h>
+#include <pbnjson.hpp>
+#include <stddef.h>
+#include <map>
+#include <string>
+
+//Volume steps 0 to 100 of the luna APIs
+#define VOLUME_CURVE_STEPS 101
+#define VOLUME_CURVE_MAX_STEP (VOLUME_CURVE_STEPS - 1)
+//Attenuation at and below which a step is muted
+#define VOLUME_CURVE_MUTE_DB -100.0
+//Range of the log curve when the config gives none
+#define VOLUME_CURVE_LOG_MIN_DB -60.0
+#define VOLUME_CURVE_MAX_POINTS 16
+
+enum VOLUME_CURVE_TYPE_E
+{
+    //Step in percent of PA_VOLUME_NORM, what Pulse got before curves existed
+    eVolumeCurveLinear,
+    //Same dB for every step between minDb and maxDb
+    eVolumeCurveLog,
+    //dB interpolated between points of the config
+    eVolumeCurvePiecewise
+};
+
+typedef struct volumeCurvePoint
+{
+    int step;
+    double dB;
+}VOLUME_CURVE_POINT_T;
+
+typedef struct volumeCurveTable
+{
+    pa_volume_t volume[VOLUME_CURVE_STEPS];
+}VOLUME_CURVE_TABLE_T;
+
+/*
+ * Lookup tables mapping the 0-100 volume steps to pa_volume_t. The built in
+ * curves are generated at compile time, the ones of the config use the same
+ * constexpr code when they are loaded, so a volume only costs a lookup.
+ * Curves are kept by stream type, names without a curve use the linear one.
+ * Step 0 is always muted. The volumes sent to the policy module stay percents
+ * since the module maps them itself, curves only shape the gains audiod
+ * applies to the playbacks it mixes.
+ */
+class VolumeCurve
+{
+public:
+    static constexpr pa_volume_t fromDb(double dB)
+    {
+        if (dB <= VOLUME_CURVE_MUTE_DB)
+            return PA_VOLUME_MUTED;
+        //pa_volume_t is cubic, so it is 10^(dB/60) of PA_VOLUME_NORM
+        return (pa_volume_t)(PA_VOLUME_NORM * exponential(dB / 60.0 * 2.302585092994046) + 0.5);
+    }
+
+    static constexpr VOLUME_CURVE_TABLE_T makeLinear()
+    {
+        VOLUME_CURVE_TABLE_T table = {};
+        for (int step = 0; step < VOLUME_CURVE_STEPS; step++)
+            table.volume[step] = (pa_volume_t)(((uint64_t)PA_VOLUME_NORM * step + VOLUME_CURVE_MAX_STEP / 2) / VOLUME_CURVE_MAX_STEP);
+        return table;
+    }
+
+    static constexpr VOLUME_CURVE_TABLE_T makeLog(double minDb, double maxDb)
+    {
+        VOLUME_CURVE_TABLE_T table = {};
+        for (int step = 1; step < VOLUME_CURVE_STEPS; step++)
+            table.volume[step] = fromDb(minDb + (maxDb - minDb) * (step - 1) / (VOLUME_CURVE_MAX_STEP - 1));
+        return table;
+    }
+
+    //points are sorted by step, steps outside of them get the dB of the nearest point
+    static constexpr VOLUME_CURVE_TABLE_T makePiecewise(const VOLUME_CURVE_POINT_T *points, size_t count)
+    {
+        VOLUME_CURVE_TABLE_T table = {};
+        size_t next = 0;
+        for (int step = 1; step < VOLUME_CURVE_STEPS; step++)
+        {
+            while (next < count && points[next].step < step)
+                next++;
+            double dB = 0.0;
+            if (0 == next)
+                dB = points[0].dB;
+            else if (next == count)
+                dB = points[count - 1].dB;
+            else
+            {
+                const VOLUME_CURVE_POINT_T &low = points[next - 1];
+                const VOLUME_CURVE_POINT_T &high = points[next];
+                dB = low.dB + (high.dB - low.dB) * (step - low.step) / (high.step - low.step);
+            }
+            table.volume[step] = fromDb(dB);
+        }
+        return table;
+    }
+
+    static constexpr bool isMonotonic(const VOLUME_CURVE_TABLE_T &table)
+    {
+        for (int step = 1; step < VOLUME_CURVE_STEPS; step++)
+        {
+            if (table.volume[step] < table.volume[step - 1])
+                return false;
+        }
+        return true;
+    }
+
+    //First step giving the same volume as the one below it, 0 if every step changes the volume
+    static constexpr int findCollapsedStep(const VOLUME_CURVE_TABLE_T &table)
+    {
+        for (int step = 1; step < VOLUME_CURVE_STEPS; step++)
+        {
+            if (table.volume[step] == table.volume[step - 1])
+                return step;
+        }
+        return 0;
+    }
+
+    //Replaces the curve of name with the volumeCurve object of a config,
+    //curves where a step does not change the volume are rejected
+    static bool setCurve(const std::string &name, const pbnjson::JValue &curve);
+    static bool hasCurve(const std::string &name);
+    static pa_volume_t getVolume(const std::string &name, int step);
+
+private:
+    //e^x, halved until the series converges fast and squared back
+    static constexpr double exponential(double x)
+    {
+        int halvings = 0;
+        while (x > 0.5 || x < -0.5)
+        {
+            x /= 2.0;
+            halvings++;
+        }
+        double term = 1.0;
+        double sum = 1.0;
+        for (int i = 1; i < 16; i++)
+        {
+            term *= x / i;
+            sum += term;
+        }
+        for (; halvings > 0; halvings--)
+            sum *= sum;
+        return sum;
+    }
+
+    static const VOLUME_CURVE_TABLE_T& getTable(const std::string &name);
+
+    static std::map<std::string, VOLUME_CURVE_TABLE_T> mCurves;
+};
+
+#endif /* VOLUMECURVE_H_ */
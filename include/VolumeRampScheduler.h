@@ -0,0 +1,95 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef VOLUMERAMPSCHEDULER_H_
+#define VOLUMERAMPSCHEDULER_H_
+
+#include <glib.h>
+#include <map>
+#include <vector>
+#include "utils.h"
+
+//Period of the tick advancing all ramps
+#define VOLUME_RAMP_TICK_MS 20
+#define VOLUME_RAMP_DEFAULT_MS 200
+
+class PulseAudioMixer;
+
+//Volume of one sink input, ramping or not
+typedef struct volumeRamp
+{
+    EVirtualAudioSink sink;
+    //Volume last sent to pulse
+    int volume;
+    int from;
+    int to;
+    bool active;
+    gint64 start;
+    gint64 duration;
+    guint steps;
+}VOLUME_RAMP_T;
+
+/*
+ * Ramps the volumes of sink inputs on audiod side with a single timer, so
+ * sinks ducked together move together. Every tick advances all active ramps
+ * from the same clock and programs their new volumes as one step. A step is
+ * one paVolumeSet per sink input queued together, pulse applies each of them
+ * on its own. A volume programmed without a ramp cancels the ramp of its sink
+ * input, a new ramp starts from where the current one is. A ramp only advances
+ * once its step is queued, so a step which could not be queued is sent again
+ * by the next tick. Each ramp logs when it ends, with its scheduled and
+ * achieved duration.
+ */
+class VolumeRampScheduler
+{
+public:
+    VolumeRampScheduler(PulseAudioMixer *mixer);
+    ~VolumeRampScheduler();
+    void setVolume(EVirtualAudioSink sink, int sinkIndex, int volume);
+    //Returns false if the volume of the sink input is not known yet, it cannot ramp then
+    bool startRamp(EVirtualAudioSink sink, int sinkIndex, int volume, guint durationMs = VOLUME_RAMP_DEFAULT_MS);
+    //Ramps every known sink input of sink, returns the number of ramps started
+    int startSinkRamp(EVirtualAudioSink sink, int volume, guint durationMs = VOLUME_RAMP_DEFAULT_MS);
+    //Stops the ramp at the volume it reached
+    void cancelRamp(int sinkIndex);
+    void removeSinkInput(int sinkIndex);
+    void clear();
+    //Adds the volumes which changed since the last step sent
+    void collectStep(std::vector<utils::SINK_VOLUME_ENTRY_T> &entries);
+    //Advances the ramps of a collected step once it is queued, a step
+    //which could not be queued is collected again by the next tick
+    void commitStep(const std::vector<utils::SINK_VOLUME_ENTRY_T> &entries);
+
+private:
+    VolumeRampScheduler(const VolumeRampScheduler&) = delete;
+    VolumeRampScheduler& operator=(const VolumeRampScheduler&) = delete;
+    static gboolean _tick(gpointer data);
+    void tick();
+    void finishRamp(int sinkIndex, VOLUME_RAMP_T &ramp, gint64 now);
+    bool hasActiveRamps();
+
+    PulseAudioMixer *mMixer;
+    std::map<int, VOLUME_RAMP_T> mRamps;
+    guint mTickTimerID;
+    //Timing of the ramps ended so far, for the report
+    guint mCompletedRamps;
+    gint64 mTotalLateUs;
+    gint64 mMaxLateUs;
+    //Steps of the tick which could not be queued in a row
+    guint mFailedSteps;
+};
+
+#endif /* VOLUMERAMPSCHEDULER_H_ */
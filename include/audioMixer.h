@@ -22,6 +22,7 @@
 #include "utils.h"
 #include "messageUtils.h"
 #include "PulseAudioMixer.h"
+#include "VolumeRampScheduler.h"
 #include "umiaudiomixer.h"
 #include "moduleManager.h"
 #include "main.h"
@@ -36,6 +37,7 @@ class AudioMixer : public MixerInterface
         AudioMixer();
         umiaudiomixer* mObjUmiAudioMixer;
         PulseAudioMixer* mObjPulseAudioMixer;
+        VolumeRampScheduler* mObjRampScheduler;
         ModuleManager *mObjModuleManager;
         utils::vectorVirtualSink mActiveStreams;
         utils::vectorVirtualSource mActiveSources;
@@ -51,6 +53,8 @@ class AudioMixer : public MixerInterface
         void removeAudioSource(EVirtualSource audioSource, utils::EMIXER_TYPE mixerType);
 
         void resetStreamInfo(utils::EMIXER_TYPE mixerType);
+        //Sends entries together with the volumes of the ramps which moved, cb gets one reply for all of them
+        bool programRampStep(std::vector<utils::SINK_VOLUME_ENTRY_T> &entries, LSHandle *lshandle, LSMessage *message, void *ctx, PulseCallBackFunc cb);
 
     public:
         ~AudioMixer();
@@ -79,6 +83,7 @@ class AudioMixer : public MixerInterface
         //pulseAudioMixer calls
         bool programTrackVolume(EVirtualAudioSink sink, int sinkIndex, int volume, LSHandle *lshandle, LSMessage *message, void *ctx, PulseCallBackFunc cb, bool ramp = false);
         bool programVolume(EVirtualSource source, int volume, LSHandle *lshandle, LSMessage *message, void *ctx, PulseCallBackFunc cb, bool ramp = false);
+        bool programVolumes(const std::vector<utils::SINK_VOLUME_ENTRY_T> &entries, LSHandle *lshandle, LSMessage *message, void *ctx, PulseCallBackFunc cb);
         bool rampVolume(EVirtualAudioSink sink, int endVolume);
         bool setSoundOutputOnRange(EVirtualAudioSink startSink,\
             EVirtualAudioSink endSink, const char* deviceName);
@@ -96,9 +101,10 @@ class AudioMixer : public MixerInterface
         bool setMicVolume(const char* deviceName, const int& volume, LSHandle *lshandle, LSMessage *message, void *ctx, PulseCallBackFunc cb);
         bool playSystemSound(const char *snd, EVirtualAudioSink sink);
         std::string playSound(const char *snd, EVirtualAudioSink sink, \
-            const char *format, int rate, int channels);
+            const char *format, int rate, int channels, int volume);
+        int queueSound(std::string playbackId, const char *snd, const char *format, int rate, int channels);
         bool controlPlayback(std::string playbackId, std::string requestType);
-        std::string getPlaybackStatus(std::string playbackId);
+        std::string getPlaybackStatus(std::string playbackId, PLAYBACK_TIMING_T *timing = nullptr);
         bool externalSoundcardPathCheck(std::string filename,  int status);
         bool loadUSBSinkSource(char cmd,int cardno, int deviceno, int status, PulseCallBackFunc cb);
         bool sendUsbMultipleDeviceInfo(int isOutput, int maxDeviceCount, const std::string &deviceBaseName);
@@ -143,7 +149,7 @@ class AudioMixer : public MixerInterface
         void callBackDeviceConnectionStatus(const std::string &deviceName, const std::string &deviceNameDetail, const std::string &deviceIcon, utils::E_DEVICE_STATUS deviceStatus, utils::EMIXER_TYPE mixerType, const bool& isOutput);
         void callBackMasterVolumeStatus();
 
-        void callBackPlaybackStatusChanged(const std::string &playbackId, const std::string &state);
+        void callBackPlaybackStatusChanged(const std::string &playbackId, const std::string &state, int item = -1);
 
 
 };
@@ -21,13 +21,17 @@
 #include "utils.h"
 #include <functional>
 
+//Track and playback ids are generated per use and never repeat, so they are not interned.
+//They stay short enough for std::string to keep them inline, copying one does not allocate.
+static_assert(AUDIOD_UNIQUE_ID_LENGTH <= 15, "unique ids no longer fit the inline std::string buffer");
+
 namespace events
 {
     typedef struct
     {
         EModuleEventType eventName;
-        std::string source;
-        std::string sink;
+        InternedString source;
+        InternedString sink;
         EVirtualAudioSink audioSink;
         utils::ESINK_STATUS sinkStatus;
         utils::EMIXER_TYPE mixerType;
@@ -38,8 +42,8 @@ namespace events
     typedef struct
     {
         EModuleEventType eventName;
-        std::string source;
-        std::string sink;
+        InternedString source;
+        InternedString sink;
         EVirtualSource audioSource;
         utils::ESINK_STATUS sourceStatus;
         utils::EMIXER_TYPE mixerType;
@@ -118,15 +122,17 @@ namespace events
     {
         EModuleEventType eventName;
         std::string playbackId;
-        std::string state;
+        InternedString state;
+        //Index of the queued file, -1 for the whole playback
+        int item;
     }EVENT_GET_PLAYBACK_STATUS_INFO_T;
 
     typedef struct
     {
         EModuleEventType eventName;
-        std::string devicename;
-        std::string deviceNameDetail;
-        std::string deviceIcon;
+        InternedString devicename;
+        InternedString deviceNameDetail;
+        InternedString deviceIcon;
         utils::E_DEVICE_STATUS deviceStatus;
         utils::EMIXER_TYPE mixerType;
         bool isOutput;
@@ -135,8 +141,8 @@ namespace events
     typedef struct
     {
         EModuleEventType eventName;
-        std::string deviceName;
-        std::string display;
+        InternedString deviceName;
+        InternedString display;
         bool isConnected;
         bool isOutput;
         bool isActive;
@@ -146,7 +152,7 @@ namespace events
     {
         EModuleEventType eventName;
         bool state;
-        std::string address;
+        InternedString address;
         int displayId;
     }EVENT_BT_DEVICE_DISPAY_INFO_T;
 
@@ -154,7 +160,7 @@ namespace events
     {
         EModuleEventType eventName;
         std::string trackId;
-        std::string streamType;
+        InternedString streamType;
     }EVENT_REGISTER_TRACK_T;
 
     typedef struct
@@ -195,6 +201,62 @@ namespace events
     {
         EModuleEventType eventName;
     }EVENTS_T;
+
+    //Event types each payload struct may be published with. Only payload
+    //structs have traits, so using any other type fails to compile.
+    template<typename T> struct EventTraits;
+
+    #define EVENT_PAYLOAD(payloadType, firstEvent, lastEvent) \
+        template<> struct EventTraits<payloadType> \
+        { \
+            static bool accepts(int eventType) \
+                { return eventType >= (int)(firstEvent) && eventType <= (int)(lastEvent); } \
+        };
+
+    EVENT_PAYLOAD(EVENT_SINK_STATUS_T, utils::eEventSinkStatus, utils::eEventSinkStatus)
+    EVENT_PAYLOAD(EVENT_SOURCE_STATUS_T, utils::eEventSourceStatus, utils::eEventSourceStatus)
+    EVENT_PAYLOAD(EVENT_SINK_APP_ID, utils::eEventSinkAppId, utils::eEventSinkAppId)
+    EVENT_PAYLOAD(EVENT_KEY_INFO_T, eLunaEventKeyFirst, eLunaEventKeyLast)
+    EVENT_PAYLOAD(EVENT_SUBSCRIBE_KEY_T, utils::eEventLunaKeySubscription, utils::eEventLunaKeySubscription)
+    EVENT_PAYLOAD(EVENT_SERVER_STATUS_INFO_T, utils::eEventServerStatusSubscription, utils::eEventServerStatusSubscription)
+    EVENT_PAYLOAD(EVENT_MIXER_STATUS_T, utils::eEventMixerStatus, utils::eEventMixerStatus)
+    EVENT_PAYLOAD(EVENT_INPUT_VOLUME_T, utils::eEventInputVolume, utils::eEventInputVolume)
+    EVENT_PAYLOAD(EVENT_MASTER_VOLUME_STATUS_T, utils::eEventMasterVolumeStatus, utils::eEventMasterVolumeStatus)
+    EVENT_PAYLOAD(EVENT_SUBSCRIBE_SERVER_STATUS_T, utils::eEventLunaServerStatusSubscription,\
+        utils::eEventLunaServerStatusSubscription)
+    EVENT_PAYLOAD(EVENT_SINK_POLICY_INFO_T, utils::eEventSinkPolicyInfo, utils::eEventSinkPolicyInfo)
+    EVENT_PAYLOAD(EVENT_SOURCE_POLICY_INFO_T, utils::eEventSourcePolicyInfo, utils::eEventSourcePolicyInfo)
+    EVENT_PAYLOAD(EVENT_GET_PLAYBACK_STATUS_INFO_T, utils::eEventGetPlaybackStatus, utils::eEventGetPlaybackStatus)
+    EVENT_PAYLOAD(EVENT_DEVICE_CONNECTION_STATUS_T, utils::eEventDeviceConnectionStatus,\
+        utils::eEventDeviceConnectionStatus)
+    EVENT_PAYLOAD(EVENT_ACTIVE_DEVICE_INFO_T, utils::eEventActiveDeviceInfo, utils::eEventActiveDeviceInfo)
+    EVENT_PAYLOAD(EVENT_BT_DEVICE_DISPAY_INFO_T, utils::eEventBTDeviceDisplayInfo, utils::eEventBTDeviceDisplayInfo)
+    EVENT_PAYLOAD(EVENT_REGISTER_TRACK_T, utils::eEventRegisterTrack, utils::eEventRegisterTrack)
+    EVENT_PAYLOAD(EVENT_UNREGISTER_TRACK_T, utils::eEventUnregisterTrack, utils::eEventUnregisterTrack)
+    EVENT_PAYLOAD(EVENT_REQUEST_SOUNDOUTPUT_INFO_T, utils::eEventRequestSoundOutputDeviceInfo,\
+        utils::eEventRequestSoundOutputDeviceInfo)
+    EVENT_PAYLOAD(EVENT_RESPONSE_SOUNDOUTPUT_INFO_T, utils::eEventResponseSoundOutputDeviceInfo,\
+        utils::eEventResponseSoundOutputDeviceInfo)
+    EVENT_PAYLOAD(EVENT_REQUEST_SOUNDINPUT_INFO_T, utils::eEventRequestSoundInputDeviceInfo,\
+        utils::eEventRequestSoundInputDeviceInfo)
+    EVENT_PAYLOAD(EVENT_RESPONSE_SOUNDINPUT_INFO_T, utils::eEventResponseSoundInputDeviceInfo,\
+        utils::eEventResponseSoundInputDeviceInfo)
+    EVENT_PAYLOAD(EVENT_REQUEST_INTERNAL_DEVICES_INFO_T, utils::eEventRequestInternalDevices,\
+        utils::eEventRequestInternalDevices)
+
+    #undef EVENT_PAYLOAD
+
+    //Checked access to the payload of an event received in handleEvent,
+    //nullptr when T is not the payload of the event type
+    template<typename T>
+    const T* getEventPayload(const EVENTS_T* ev)
+    {
+        if (ev && EventTraits<T>::accepts(ev->eventName))
+            return (const T*)ev;
+        PM_LOG_ERROR(MSGID_MODULE_MANAGER, INIT_KVCOUNT,\
+            "getEventPayload: payload does not match eventType:%d", ev ? (int)ev->eventName : -1);
+        return nullptr;
+    }
 }
 
 #endif //_EVENTS_H_
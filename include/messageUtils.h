@@ -68,6 +68,7 @@ extern const char * STANDARD_JSON_SUCCESS;
 #define PROPS_4(p1, p2, p3, p4)                       ",\"properties\":{" p1 "," p2 "," p3 "," p4 "}"
 #define PROPS_5(p1, p2, p3, p4, p5)                   ",\"properties\":{" p1 "," p2 "," p3 "," p4 "," p5 "}"
 #define PROPS_6(p1, p2, p3, p4, p5, p6)               ",\"properties\":{" p1 "," p2 "," p3 "," p4 "," p5 "," p6 "}"
+#define PROPS_7(p1, p2, p3, p4, p5, p6, p7)           ",\"properties\":{" p1 "," p2 "," p3 "," p4 "," p5 "," p6 "," p7 "}"
 #define PROPS_9(p1, p2, p3, p4, p5, p6, p7, p8, p9)   ",\"properties\":{" p1 "," p2 "," p3 "," p4 "," p5 "," p6 "," p7 "," p8 "," p9 "}"
 
 #define PROP(name, type)                              "\"" #name "\":{\"type\":\"" #type "\"}"
@@ -35,7 +35,8 @@ class MixerInterface
         virtual void callBackMixerStatus(const bool& mixerStatus, utils::EMIXER_TYPE mixerType) = 0;
         virtual void callBackMasterVolumeStatus() = 0;
         virtual void callBackDeviceConnectionStatus(const std::string &deviceName, const std::string &deviceNameDetail, const std::string &deviceIcon, utils::E_DEVICE_STATUS deviceStatus, utils::EMIXER_TYPE mixerType, const bool& isOutput) = 0;
-        virtual void callBackPlaybackStatusChanged(const std::string &playbackId, const std::string &state) = 0;
+        //item is the index of the queued file the state is about, -1 for the whole playback
+        virtual void callBackPlaybackStatusChanged(const std::string &playbackId, const std::string &state, int item = -1) = 0;
 
 };
 #endif
\ No newline at end of file
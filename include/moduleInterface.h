@@ -31,6 +31,8 @@ class ModuleInterface
         //Every module must override this method
         virtual void initialize() = 0;
         virtual void handleEvent(events::EVENTS_T* ev) = 0;
+        //Called on shutdown while every module still exists, before any of them is removed
+        virtual void prepareShutdown() {}
         //Every module must override this method
         virtual void deInitialize() = 0;
 };
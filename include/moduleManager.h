@@ -24,6 +24,7 @@
 #include "moduleFactory.h"
 
 #include <list>
+#include <deque>
 #include <string>
 #include <algorithm>
 #include <pbnjson/cxx/JValue.h>
@@ -31,6 +32,18 @@
 
 using namespace pbnjson;
 
+//Number of buckets in the per subscriber handleEvent latency histogram
+#define EVENT_LATENCY_BUCKET_COUNT 8
+
+//How a subscriber wants an event to be delivered
+typedef enum EventDelivery
+{
+    //handleEvent is called from within publishModuleEvent
+    eEventDeliverySync = 0,
+    //event is copied, coalesced and delivered later from an idle source
+    eEventDeliveryDeferred
+}EVENT_DELIVERY_E;
+
 class ModuleManager
 {
     private:
@@ -39,7 +52,41 @@ class ModuleManager
         ModuleManager& operator=(const ModuleManager&) = delete;
         ModuleManager();
 
-        std::multimap<EModuleEventType, ModuleInterface*> mapEventsSubscribers;
+        //Subscriber along with its dispatch statistics for one event type
+        struct EVENT_SUBSCRIBER_T
+        {
+            ModuleInterface* module;
+            EVENT_DELIVERY_E delivery;
+            unsigned long dispatchCount;
+            gint64 totalLatency;
+            gint64 maxLatency;
+            unsigned long latencyHistogram[EVENT_LATENCY_BUCKET_COUNT];
+        };
+        //Subscribers indexed by EModuleEventType
+        std::vector<EVENT_SUBSCRIBER_T> mEventSubscribers[eLunaEventCount];
+        unsigned long mEventDispatchCount[eLunaEventCount];
+        bool isValidEventType(int eventType) const;
+        void addEventSubscriber(ModuleInterface* module, EModuleEventType eventType,\
+            EVENT_DELIVERY_E delivery = eEventDeliverySync);
+        void dispatchToSubscriber(int eventType, size_t index, events::EVENTS_T* ev);
+
+        //Copy of a published event waiting for its deferred subscribers
+        struct QUEUED_EVENT_T
+        {
+            int eventType;
+            std::string coalesceKey;
+            events::EVENTS_T* event;
+        };
+        std::deque<QUEUED_EVENT_T> mDeferredEvents;
+        //Released event copies per event type, reused for the next deferred event
+        std::vector<events::EVENTS_T*> mEventPool[eLunaEventCount];
+        guint mDeferredSourceID;
+        unsigned long mCoalescedEventCount;
+        unsigned long mDeferredEventCount;
+        void queueDeferredEvent(events::EVENTS_T* ev);
+        void releaseDeferredEvent(int eventType, events::EVENTS_T* ev);
+        void clearDeferredEvents();
+        std::string getModuleName(ModuleInterface* module) const;
         std::map<std::string, ModuleInterface*> mModuleHandlersMap;
         std::vector<std::string> mSupportedModulesVector;
         ModuleFactory *mModuleFactory;
@@ -48,6 +95,8 @@ class ModuleManager
 
     public:
         bool createModules();
+        //Lets the modules finish their work on shutdown, the main context can still dispatch to all of them
+        void prepareShutdown();
         bool removeModules();
         bool loadConfig(const std::string &audioModuleConfigPath);
         static ModuleManager* initialize();
@@ -55,11 +104,27 @@ class ModuleManager
         static ModuleManager* mObjModuleManager;
         ~ModuleManager();
         //subscription for events
-        void subscribeModuleEvent(ModuleInterface* module, EModuleEventType eventType);
+        void subscribeModuleEvent(ModuleInterface* module, EModuleEventType eventType,\
+                EVENT_DELIVERY_E delivery = eEventDeliverySync);
         void subscribeKeyInfo(ModuleInterface* module, EModuleEventType event, \
                 SERVER_TYPE_E eService, const std::string& key, const std::string& payload);
         void subscribeServerStatusInfo(ModuleInterface* module, SERVER_TYPE_E eStatus);
         //handling events
         void publishModuleEvent(events::EVENTS_T* ev);
+        //typed publish, rejects a payload whose eventName does not belong to its type
+        template<typename T>
+        void publishModuleEvent(T &ev)
+        {
+            if (!events::EventTraits<T>::accepts(ev.eventName))
+            {
+                PM_LOG_ERROR(MSGID_MODULE_MANAGER, INIT_KVCOUNT,\
+                    "publishModuleEvent: payload does not match eventType:%d", (int)ev.eventName);
+                return;
+            }
+            publishModuleEvent((events::EVENTS_T*)&ev);
+        }
+        bool dispatchDeferredEvents();
+        //dispatch statistics
+        void logEventDispatchStats();
 };
 #endif //_MODULE_MANAGER_H_
\ No newline at end of file
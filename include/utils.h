@@ -153,8 +153,8 @@ namespace utils
         eEventRequestSoundInputDeviceInfo,
         eEventResponseSoundInputDeviceInfo,
         eEventRequestInternalDevices,
-        eEventType_Count,
         eEventGetPlaybackStatus,
+        eEventType_Count,
         eEventType_First = 0,
         eEventType_Last = eEventResponseSoundInputDeviceInfo
     }EVENT_TYPE_E;
@@ -191,6 +191,7 @@ namespace utils
         bool isStreamActive;
         bool ramp;
         std::string category;
+        int categoryId;
         volumePolicyInfo()
         {
             streamType = "";
@@ -210,6 +211,7 @@ namespace utils
             isStreamActive = false;
             ramp = false;
             category = "";
+            categoryId = -1;
         }
     }VOLUME_POLICY_INFO_T;
     //TODO: delete this
@@ -312,6 +314,15 @@ namespace utils
         }
     }TRACK_VOLUME_INFO_T;
 
+    //One sink input volume of a batch programmed through programVolumes
+    typedef struct sinkVolumeEntry
+    {
+        EVirtualAudioSink audioSink;
+        int sinkInputIndex;
+        int volume;
+        bool ramp;
+    }SINK_VOLUME_ENTRY_T;
+
     typedef struct deviceDetails
     {
         int cardNumber;
@@ -392,6 +403,9 @@ namespace utils
 
     void LSMessageResponse(LSHandle* handle, LSMessage * message,\
         const char* reply, utils::EReplyType eType, bool isReferenced);
+
+    //Path of an on-demand system sound, the compressed file is used when it is installed
+    std::string getSystemSoundPath(const std::string &name);
 }
 
 typedef enum LunaKeyType {
@@ -460,6 +474,32 @@ class VirtualSinkSet
         long mSet;
 };
 
+//Handle to a string kept once in a process wide table. Used for the sink,
+//source and device names carried by module events so that building an
+//event does not copy the names and comparing two handles is a pointer compare.
+//Only strings from a bounded set of values belong here, the table never shrinks.
+//Handles may be created from any thread, the table is locked while a string is added.
+class InternedString
+{
+    public:
+        InternedString();
+        InternedString(const std::string &str);
+        InternedString(const char *str);
+        const std::string& str() const { return *mString; }
+        operator const std::string&() const { return *mString; }
+        const char* c_str() const { return mString->c_str(); }
+        bool empty() const { return mString->empty(); }
+        bool operator == (const InternedString &rhs) const { return mString == rhs.mString; }
+        bool operator != (const InternedString &rhs) const { return mString != rhs.mString; }
+        bool operator == (const std::string &rhs) const { return *mString == rhs; }
+        bool operator != (const std::string &rhs) const { return *mString != rhs; }
+        bool operator == (const char *rhs) const { return *mString == rhs; }
+        bool operator != (const char *rhs) const { return *mString != rhs; }
+    private:
+        static const std::string* intern(const std::string &str);
+        const std::string *mString;
+};
+
 class GenerateUniqueID {
     const std::string           source_;
     const int                   base_;
@@ -0,0 +1,52 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+
+#include "DtmfOscillator.h"
+#include <cmath>
+
+DtmfOscillator::DtmfOscillator(int lowFrequency, int highFrequency, int sampleRate) :
+    mSampleRate(sampleRate > 0 ? sampleRate : 1),
+    mPosition(0)
+{
+    mOmega[0] = M_PI * 2 * lowFrequency / mSampleRate;
+    mOmega[1] = M_PI * 2 * highFrequency / mSampleRate;
+}
+
+void DtmfOscillator::generate(int16_t *buffer, int samples)
+{
+    const double c1 = 2 * cos(mOmega[0]);
+    const double c2 = 2 * cos(mOmega[1]);
+    while (samples > 0)
+    {
+        int chunk = samples < DTMF_OSCILLATOR_RESEED_SAMPLES ? samples : DTMF_OSCILLATOR_RESEED_SAMPLES;
+        double a0 = sin((double)(mPosition - 1) * mOmega[0]);
+        double a1 = sin((double)mPosition * mOmega[0]);
+        double b0 = sin((double)(mPosition - 1) * mOmega[1]);
+        double b1 = sin((double)mPosition * mOmega[1]);
+        for (int i = 0; i < chunk; i++)
+        {
+            buffer[i] = (int16_t)((a1 + b1) * 8192);
+            double a2 = c1 * a1 - a0;
+            double b2 = c2 * b1 - b0;
+            a0 = a1; a1 = a2;
+            b0 = b1; b1 = b2;
+        }
+        mPosition = (mPosition + chunk) % mSampleRate;
+        buffer += chunk;
+        samples -= chunk;
+    }
+}
@@ -0,0 +1,203 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+// This file is also built into the host sound encoder, keep it free of audiod dependencies
+
+#include "ImaAdpcm.h"
+#include <algorithm>
+#include <cstring>
+
+static const int16_t kStepTable[89] = {
+    7, 8, 9, 10, 11, 12, 13, 14, 16, 17, 19, 21, 23, 25, 28, 31, 34, 37, 41, 45,
+    50, 55, 60, 66, 73, 80, 88, 97, 107, 118, 130, 143, 157, 173, 190, 209, 230,
+    253, 279, 307, 337, 371, 408, 449, 494, 544, 598, 658, 724, 796, 876, 963,
+    1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066, 2272, 2499, 2749, 3024, 3327,
+    3660, 4026, 4428, 4871, 5358, 5894, 6484, 7132, 7845, 8630, 9493, 10442, 11487,
+    12635, 13899, 15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767
+};
+
+static const int8_t kIndexTable[16] = {
+    -1, -1, -1, -1, 2, 4, 6, 8,
+    -1, -1, -1, -1, 2, 4, 6, 8
+};
+
+typedef struct imaAdpcmState
+{
+    int predictor;
+    int index;
+}IMA_ADPCM_STATE_T;
+
+static inline uint16_t readU16(const uint8_t *data)
+{
+    return (uint16_t)(data[0] | data[1] << 8);
+}
+
+static inline uint32_t readU32(const uint8_t *data)
+{
+    return (uint32_t)data[0] | (uint32_t)data[1] << 8 | (uint32_t)data[2] << 16 | (uint32_t)data[3] << 24;
+}
+
+static inline void writeU16(std::vector<uint8_t> &output, uint16_t value)
+{
+    output.push_back((uint8_t)(value & 0xff));
+    output.push_back((uint8_t)(value >> 8));
+}
+
+static inline void writeU32(std::vector<uint8_t> &output, uint32_t value)
+{
+    writeU16(output, (uint16_t)(value & 0xffff));
+    writeU16(output, (uint16_t)(value >> 16));
+}
+
+static inline int16_t decodeNibble(IMA_ADPCM_STATE_T &state, uint8_t nibble)
+{
+    int step = kStepTable[state.index];
+    int diff = step >> 3;
+    if (nibble & 4) diff += step;
+    if (nibble & 2) diff += step >> 1;
+    if (nibble & 1) diff += step >> 2;
+    state.predictor += (nibble & 8) ? -diff : diff;
+    state.predictor = std::min(32767, std::max(-32768, state.predictor));
+    state.index = std::min(88, std::max(0, state.index + kIndexTable[nibble]));
+    return (int16_t)state.predictor;
+}
+
+static inline uint8_t encodeSample(IMA_ADPCM_STATE_T &state, int16_t sample)
+{
+    int step = kStepTable[state.index];
+    int diff = sample - state.predictor;
+    uint8_t nibble = 0;
+    if (diff < 0)
+    {
+        nibble = 8;
+        diff = -diff;
+    }
+    if (diff >= step) { nibble |= 4; diff -= step; }
+    if (diff >= step >> 1) { nibble |= 2; diff -= step >> 1; }
+    if (diff >= step >> 2) { nibble |= 1; }
+    //Track the decoder so both sides stay in step
+    decodeNibble(state, nibble);
+    return nibble;
+}
+
+bool ImaAdpcm::readHeader(const uint8_t *data, size_t size, IMA_ADPCM_HEADER_T &header)
+{
+    if (!data || size < IMA_ADPCM_HEADER_SIZE || memcmp(data, IMA_ADPCM_MAGIC, 4) != 0)
+        return false;
+    if (IMA_ADPCM_VERSION != readU16(data + 4))
+        return false;
+    header.channels = readU16(data + 6);
+    header.rate = readU32(data + 8);
+    header.frames = readU32(data + 12);
+    header.blockFrames = readU16(data + 16);
+    return header.channels > 0 && header.channels <= IMA_ADPCM_MAX_CHANNELS &&
+           header.rate > 0 && header.blockFrames > 0;
+}
+
+size_t ImaAdpcm::getBlockSize(const IMA_ADPCM_HEADER_T &header, size_t frames)
+{
+    if (0 == frames)
+        return 0;
+    return 4 * header.channels + ((frames - 1) * header.channels + 1) / 2;
+}
+
+void ImaAdpcm::decodeBlock(const IMA_ADPCM_HEADER_T &header, const uint8_t *block, size_t frames, int16_t *output)
+{
+    if (0 == frames)
+        return;
+    const size_t channels = header.channels;
+    IMA_ADPCM_STATE_T state[IMA_ADPCM_MAX_CHANNELS];
+    for (size_t c = 0; c < channels; c++, block += 4)
+    {
+        state[c].predictor = (int16_t)readU16(block);
+        state[c].index = std::min(88, (int)block[2]);
+        output[c] = (int16_t)state[c].predictor;
+    }
+    output += channels;
+
+    size_t nibbles = (frames - 1) * channels;
+    for (size_t i = 0; i < nibbles; i++)
+    {
+        uint8_t nibble = (i & 1) ? (block[i >> 1] >> 4) : (block[i >> 1] & 0x0f);
+        output[i] = decodeNibble(state[i % channels], nibble);
+    }
+}
+
+bool ImaAdpcm::decode(const uint8_t *data, size_t size, std::vector<uint8_t> &output)
+{
+    IMA_ADPCM_HEADER_T header;
+    if (!readHeader(data, size, header))
+        return false;
+
+    const uint8_t *block = data + IMA_ADPCM_HEADER_SIZE;
+    const uint8_t *end = data + size;
+    size_t frameSize = header.channels * sizeof(int16_t);
+    output.resize((size_t)header.frames * frameSize);
+    size_t decoded = 0;
+    while (decoded < header.frames)
+    {
+        size_t frames = std::min((size_t)header.blockFrames, (size_t)header.frames - decoded);
+        size_t blockSize = getBlockSize(header, frames);
+        if ((size_t)(end - block) < blockSize)
+            break;
+        decodeBlock(header, block, frames, (int16_t*)(output.data() + decoded * frameSize));
+        block += blockSize;
+        decoded += frames;
+    }
+    //A truncated file plays what could be decoded
+    output.resize(decoded * frameSize);
+    return true;
+}
+
+void ImaAdpcm::encode(const int16_t *pcm, size_t frames, uint16_t channels, uint32_t rate, std::vector<uint8_t> &output)
+{
+    channels = std::max((uint16_t)1, std::min(channels, (uint16_t)IMA_ADPCM_MAX_CHANNELS));
+    output.insert(output.end(), IMA_ADPCM_MAGIC, IMA_ADPCM_MAGIC + 4);
+    writeU16(output, IMA_ADPCM_VERSION);
+    writeU16(output, channels);
+    writeU32(output, rate);
+    writeU32(output, (uint32_t)frames);
+    writeU16(output, IMA_ADPCM_BLOCK_FRAMES);
+    writeU16(output, 0);
+
+    //The step index is carried from one block to the next
+    IMA_ADPCM_STATE_T state[IMA_ADPCM_MAX_CHANNELS];
+    for (size_t c = 0; c < channels; c++)
+        state[c].index = 0;
+
+    for (size_t start = 0; start < frames; start += IMA_ADPCM_BLOCK_FRAMES)
+    {
+        size_t count = std::min((size_t)IMA_ADPCM_BLOCK_FRAMES, frames - start);
+        const int16_t *samples = pcm + start * channels;
+        for (size_t c = 0; c < channels; c++)
+        {
+            state[c].predictor = samples[c];
+            writeU16(output, (uint16_t)samples[c]);
+            output.push_back((uint8_t)state[c].index);
+            output.push_back(0);
+        }
+        samples += channels;
+
+        size_t nibbles = (count - 1) * channels;
+        for (size_t i = 0; i < nibbles; i += 2)
+        {
+            uint8_t byte = encodeSample(state[i % channels], samples[i]);
+            if (i + 1 < nibbles)
+                byte |= encodeSample(state[(i + 1) % channels], samples[i + 1]) << 4;
+            output.push_back(byte);
+        }
+    }
+}
@@ -0,0 +1,336 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "PcmConverter.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+//PCM_CONVERTER_SCALAR builds only the portable path, the host tests check both against each other
+#if defined(__SSE2__) && !defined(PCM_CONVERTER_SCALAR)
+#define PCM_CONVERTER_SSE2
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) && !defined(PCM_CONVERTER_SCALAR)
+#define PCM_CONVERTER_NEON
+#include <arm_neon.h>
+#endif
+
+//Frames converted at once, bounds the size of the intermediate buffers
+#define PCM_CONVERTER_BLOCK_FRAMES 4096
+
+static void s16ToFloat(const uint8_t *input, float *output, size_t count)
+{
+    const float scale = 1.0f / 32768.0f;
+    size_t i = 0;
+#if defined(PCM_CONVERTER_SSE2)
+    const __m128 vscale = _mm_set1_ps(scale);
+    for (; i + 8 <= count; i += 8)
+    {
+        __m128i v = _mm_loadu_si128((const __m128i*)(input + i * 2));
+        //Interleaving a sample with itself and shifting back sign extends it
+        __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16);
+        __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16);
+        _mm_storeu_ps(output + i, _mm_mul_ps(_mm_cvtepi32_ps(lo), vscale));
+        _mm_storeu_ps(output + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), vscale));
+    }
+#elif defined(PCM_CONVERTER_NEON)
+    for (; i + 8 <= count; i += 8)
+    {
+        int16x8_t v = vreinterpretq_s16_u8(vld1q_u8(input + i * 2));
+        vst1q_f32(output + i, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(v))), scale));
+        vst1q_f32(output + i + 4, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(v))), scale));
+    }
+#endif
+    for (; i < count; i++)
+    {
+        int16_t sample;
+        memcpy(&sample, input + i * 2, sizeof(sample));
+        output[i] = sample * scale;
+    }
+}
+
+static void floatToS16(const float *input, uint8_t *output, size_t count)
+{
+    size_t i = 0;
+#if defined(PCM_CONVERTER_SSE2)
+    //cvtps rounds to nearest, packs saturates to the int16 range.
+    //cvtps turns values out of the int32 range into INT_MIN, so they are clamped first.
+    const __m128 vscale = _mm_set1_ps(32768.0f);
+    const __m128 vmin = _mm_set1_ps(-32768.0f);
+    const __m128 vmax = _mm_set1_ps(32767.0f);
+    for (; i + 8 <= count; i += 8)
+    {
+        __m128 a = _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(input + i), vscale), vmin), vmax);
+        __m128 b = _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(input + i + 4), vscale), vmin), vmax);
+        _mm_storeu_si128((__m128i*)(output + i * 2), _mm_packs_epi32(_mm_cvtps_epi32(a), _mm_cvtps_epi32(b)));
+    }
+#elif defined(PCM_CONVERTER_NEON) && defined(__aarch64__)
+    for (; i + 8 <= count; i += 8)
+    {
+        int32x4_t lo = vcvtnq_s32_f32(vmulq_n_f32(vld1q_f32(input + i), 32768.0f));
+        int32x4_t hi = vcvtnq_s32_f32(vmulq_n_f32(vld1q_f32(input + i + 4), 32768.0f));
+        vst1q_u8(output + i * 2, vreinterpretq_u8_s16(vcombine_s16(vqmovn_s32(lo), vqmovn_s32(hi))));
+    }
+#endif
+    for (; i < count; i++)
+    {
+        //Clamped like the SIMD path, so values lrintf cannot represent saturate the same way
+        float value = std::min(32767.0f, std::max(-32768.0f, input[i] * 32768.0f));
+        int16_t sample = (int16_t)lrintf(value);
+        memcpy(output + i * 2, &sample, sizeof(sample));
+    }
+}
+
+PcmConverter::PcmConverter() : mPassthrough(true),
+                               mInputFrameSize(0),
+                               mOutputFrameSize(0),
+                               mPosition(0),
+                               mHasLastFrame(false)
+{
+    memset(&mFrom, 0, sizeof(mFrom));
+    memset(&mTo, 0, sizeof(mTo));
+}
+
+bool PcmConverter::isSupportedFormat(pa_sample_format_t format)
+{
+    switch (format)
+    {
+        case PA_SAMPLE_S16LE:
+        case PA_SAMPLE_S24LE:
+        case PA_SAMPLE_S32LE:
+        case PA_SAMPLE_FLOAT32LE:
+            return true;
+        default:
+            return false;
+    }
+}
+
+bool PcmConverter::setup(const pa_sample_spec &from, const pa_sample_spec &to)
+{
+    mFrom = from;
+    mTo = to;
+    mPassthrough = true;
+    reset();
+    if (!pa_sample_spec_valid(&from) || !pa_sample_spec_valid(&to) ||
+        !isSupportedFormat(from.format) || !isSupportedFormat(to.format))
+        return false;
+
+    mPassthrough = (from.format == to.format && from.rate == to.rate && from.channels == to.channels);
+    mInputFrameSize = pa_frame_size(&from);
+    mOutputFrameSize = pa_frame_size(&to);
+    return true;
+}
+
+void PcmConverter::reset()
+{
+    mPosition = 0;
+    mHasLastFrame = false;
+    mPartialFrame.clear();
+}
+
+size_t PcmConverter::getMaxOutputSize(size_t bytes) const
+{
+    if (mPassthrough)
+        return bytes;
+    size_t frames = (bytes + mPartialFrame.size()) / mInputFrameSize + 1;
+    return (size_t)((uint64_t)frames * mTo.rate / mFrom.rate + 2) * mOutputFrameSize;
+}
+
+void PcmConverter::convert(const void *input, size_t bytes, std::vector<uint8_t> &output)
+{
+    const uint8_t *data = (const uint8_t*)input;
+    if (mPassthrough)
+    {
+        output.insert(output.end(), data, data + bytes);
+        return;
+    }
+
+    if (!mPartialFrame.empty())
+    {
+        size_t missing = std::min(mInputFrameSize - mPartialFrame.size(), bytes);
+        mPartialFrame.insert(mPartialFrame.end(), data, data + missing);
+        data += missing;
+        bytes -= missing;
+        if (mPartialFrame.size() < mInputFrameSize)
+            return;
+        convertFrames(mPartialFrame.data(), 1, output);
+        mPartialFrame.clear();
+    }
+
+    size_t frames = bytes / mInputFrameSize;
+    if (frames > 0)
+        convertFrames(data, frames, output);
+    size_t consumed = frames * mInputFrameSize;
+    if (consumed < bytes)
+        mPartialFrame.assign(data + consumed, data + bytes);
+}
+
+void PcmConverter::convertFrames(const uint8_t *input, size_t frames, std::vector<uint8_t> &output)
+{
+    while (frames > 0)
+    {
+        size_t block = std::min(frames, (size_t)PCM_CONVERTER_BLOCK_FRAMES);
+        decode(input, block);
+        remapChannels(block);
+        size_t converted = resample(block);
+        if (converted > 0)
+        {
+            size_t offset = output.size();
+            output.resize(offset + converted * mOutputFrameSize);
+            encode(mResampled.data(), converted * mTo.channels, output.data() + offset);
+        }
+        input += block * mInputFrameSize;
+        frames -= block;
+    }
+}
+
+void PcmConverter::decode(const uint8_t *input, size_t frames)
+{
+    size_t count = frames * mFrom.channels;
+    mDecoded.resize(count);
+    float *output = mDecoded.data();
+    switch (mFrom.format)
+    {
+        case PA_SAMPLE_S16LE:
+            s16ToFloat(input, output, count);
+            break;
+        case PA_SAMPLE_S24LE:
+            for (size_t i = 0; i < count; i++, input += 3)
+            {
+                int32_t sample = (int32_t)((uint32_t)input[0] << 8 | (uint32_t)input[1] << 16 | (uint32_t)input[2] << 24) >> 8;
+                output[i] = sample * (1.0f / 8388608.0f);
+            }
+            break;
+        case PA_SAMPLE_S32LE:
+            for (size_t i = 0; i < count; i++)
+            {
+                int32_t sample;
+                memcpy(&sample, input + i * 4, sizeof(sample));
+                output[i] = (float)(sample * (1.0 / 2147483648.0));
+            }
+            break;
+        case PA_SAMPLE_FLOAT32LE:
+        default:
+            memcpy(output, input, count * sizeof(float));
+            break;
+    }
+}
+
+void PcmConverter::remapChannels(size_t frames)
+{
+    size_t inChannels = mFrom.channels;
+    size_t outChannels = mTo.channels;
+    if (inChannels == outChannels)
+    {
+        mRemapped.swap(mDecoded);
+        return;
+    }
+
+    mRemapped.resize(frames * outChannels);
+    const float *in = mDecoded.data();
+    float *out = mRemapped.data();
+    for (size_t frame = 0; frame < frames; frame++, in += inChannels, out += outChannels)
+    {
+        if (1 == outChannels)
+        {
+            //Down mix to mono
+            float sum = 0.0f;
+            for (size_t c = 0; c < inChannels; c++)
+                sum += in[c];
+            out[0] = sum / inChannels;
+        }
+        else
+        {
+            //Mono is duplicated, extra channels are dropped or repeated
+            for (size_t c = 0; c < outChannels; c++)
+                out[c] = in[c % inChannels];
+        }
+    }
+}
+
+size_t PcmConverter::resample(size_t frames)
+{
+    size_t channels = mTo.channels;
+    if (mFrom.rate == mTo.rate)
+    {
+        mResampled.swap(mRemapped);
+        return frames;
+    }
+
+    const float *in = mRemapped.data();
+    if (!mHasLastFrame)
+    {
+        //The first input frame is the first output frame
+        mLastFrame.assign(in, in + channels);
+        mHasLastFrame = true;
+        mPosition = 0;
+        in += channels;
+        frames--;
+    }
+
+    //Frame 0 is mLastFrame, frame k is in[k - 1]
+    const uint64_t end = (uint64_t)frames * mTo.rate;
+    mResampled.resize((size_t)((uint64_t)(frames + 1) * mTo.rate / mFrom.rate + 2) * channels);
+    float *out = mResampled.data();
+    size_t converted = 0;
+    while (mPosition < end)
+    {
+        size_t index = (size_t)(mPosition / mTo.rate);
+        float fraction = (float)(mPosition % mTo.rate) / (float)mTo.rate;
+        const float *a = (0 == index) ? mLastFrame.data() : in + (index - 1) * channels;
+        const float *b = in + index * channels;
+        for (size_t c = 0; c < channels; c++)
+            out[c] = a[c] + (b[c] - a[c]) * fraction;
+        out += channels;
+        converted++;
+        mPosition += mFrom.rate;
+    }
+    mPosition -= end;
+    if (frames > 0)
+        mLastFrame.assign(in + (frames - 1) * channels, in + frames * channels);
+    return converted;
+}
+
+void PcmConverter::encode(const float *samples, size_t count, uint8_t *output)
+{
+    switch (mTo.format)
+    {
+        case PA_SAMPLE_S16LE:
+            floatToS16(samples, output, count);
+            break;
+        case PA_SAMPLE_S24LE:
+            for (size_t i = 0; i < count; i++, output += 3)
+            {
+                long value = std::min(8388607L, std::max(-8388608L, lrintf(samples[i] * 8388608.0f)));
+                output[0] = (uint8_t)(value & 0xff);
+                output[1] = (uint8_t)((value >> 8) & 0xff);
+                output[2] = (uint8_t)((value >> 16) & 0xff);
+            }
+            break;
+        case PA_SAMPLE_S32LE:
+            for (size_t i = 0; i < count; i++)
+            {
+                double value = std::min(2147483647.0, std::max(-2147483648.0, std::rint(samples[i] * 2147483648.0)));
+                int32_t sample = (int32_t)value;
+                memcpy(output + i * 4, &sample, sizeof(sample));
+            }
+            break;
+        case PA_SAMPLE_FLOAT32LE:
+        default:
+            memcpy(output, samples, count * sizeof(float));
+            break;
+    }
+}
@@ -0,0 +1,94 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "PcmMixer.h"
+#include <algorithm>
+
+//PCM_MIXER_SCALAR builds only the portable path, the host tests check both against each other
+#if defined(__SSE2__) && !defined(PCM_MIXER_SCALAR)
+#define PCM_MIXER_SSE2
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) && !defined(PCM_MIXER_SCALAR)
+#define PCM_MIXER_NEON
+#include <arm_neon.h>
+#endif
+
+static inline int16_t saturate(int32_t value)
+{
+    return (int16_t)std::min(32767, std::max(-32768, value));
+}
+
+void PcmMixer::mix(int16_t *output, const int16_t *input, size_t samples, uint32_t gain)
+{
+    if (0 == gain)
+        return;
+    size_t i = 0;
+    if (gain >= PCM_MIXER_GAIN_UNITY)
+    {
+#if defined(PCM_MIXER_SSE2)
+        for (; i + 8 <= samples; i += 8)
+        {
+            __m128i a = _mm_loadu_si128((const __m128i*)(output + i));
+            __m128i b = _mm_loadu_si128((const __m128i*)(input + i));
+            _mm_storeu_si128((__m128i*)(output + i), _mm_adds_epi16(a, b));
+        }
+#elif defined(PCM_MIXER_NEON)
+        for (; i + 8 <= samples; i += 8)
+            vst1q_s16(output + i, vqaddq_s16(vld1q_s16(output + i), vld1q_s16(input + i)));
+#endif
+        for (; i < samples; i++)
+            output[i] = saturate((int32_t)output[i] + input[i]);
+        return;
+    }
+
+    //The scaled sample is floor(sample * gain / 2^15), the same in every path
+#if defined(PCM_MIXER_SSE2)
+    const __m128i vgain = _mm_set1_epi16((int16_t)gain);
+    for (; i + 8 <= samples; i += 8)
+    {
+        __m128i b = _mm_loadu_si128((const __m128i*)(input + i));
+        //Bits 15 to 30 of the 32 bit products
+        __m128i hi = _mm_mulhi_epi16(b, vgain);
+        __m128i lo = _mm_mullo_epi16(b, vgain);
+        __m128i scaled = _mm_or_si128(_mm_slli_epi16(hi, 1), _mm_srli_epi16(lo, 15));
+        __m128i a = _mm_loadu_si128((const __m128i*)(output + i));
+        _mm_storeu_si128((__m128i*)(output + i), _mm_adds_epi16(a, scaled));
+    }
+#elif defined(PCM_MIXER_NEON)
+    const int16x4_t vgain = vdup_n_s16((int16_t)gain);
+    for (; i + 8 <= samples; i += 8)
+    {
+        int16x8_t b = vld1q_s16(input + i);
+        int16x4_t lo = vshrn_n_s32(vmull_s16(vget_low_s16(b), vgain), 15);
+        int16x4_t hi = vshrn_n_s32(vmull_s16(vget_high_s16(b), vgain), 15);
+        vst1q_s16(output + i, vqaddq_s16(vld1q_s16(output + i), vcombine_s16(lo, hi)));
+    }
+#endif
+    for (; i < samples; i++)
+        output[i] = saturate((int32_t)output[i] + (((int32_t)input[i] * (int32_t)gain) >> 15));
+}
+
+uint32_t PcmMixer::volumeToGain(int volume)
+{
+    volume = std::min(100, std::max(0, volume));
+    return (uint32_t)(volume * PCM_MIXER_GAIN_UNITY / 100);
+}
+
+uint32_t PcmMixer::linearToGain(double linear)
+{
+    linear = std::min(1.0, std::max(0.0, linear));
+    return (uint32_t)(linear * PCM_MIXER_GAIN_UNITY + 0.5);
+}
@@ -0,0 +1,232 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "PcmRamp.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+//Phase of a ramp, PCM_RAMP_CURVE_POINTS in 16.16 fixed point
+#define PCM_RAMP_PHASE_END ((uint64_t)PCM_RAMP_CURVE_POINTS << 16)
+//Extra fraction bits of the phase step, a truncated step would leave long ramps short of their target
+#define PCM_RAMP_STEP_SHIFT 16
+//Largest gain of a block, the samples are scaled by signed 16 bit multiplies
+#define PCM_RAMP_MAX_BLOCK_GAIN 32767
+
+struct QuarterSine
+{
+    int32_t points[PCM_RAMP_CURVE_POINTS + 1];
+    QuarterSine()
+    {
+        for (int i = 0; i <= PCM_RAMP_CURVE_POINTS; i++)
+            points[i] = (int32_t)lrint(sin(M_PI / 2 * i / PCM_RAMP_CURVE_POINTS) * PCM_MIXER_GAIN_UNITY);
+    }
+};
+
+//sin(pi/2 * phase) in Q15, phase in 16.16 fixed point points of the table
+static inline int32_t quarterSine(uint64_t phase)
+{
+    static const QuarterSine table;
+    uint32_t index = (uint32_t)(phase >> 16);
+    if (index >= PCM_RAMP_CURVE_POINTS)
+        return table.points[PCM_RAMP_CURVE_POINTS];
+    int32_t a = table.points[index];
+    int32_t b = table.points[index + 1];
+    return a + (int32_t)(((int64_t)(b - a) * (int64_t)(phase & 0xffff)) >> 16);
+}
+
+void PcmRamp::start(PCM_RAMP_T &ramp, uint32_t from, uint32_t to, uint32_t frames, PCM_RAMP_CURVE_E curve)
+{
+    ramp.from = std::min(from, (uint32_t)PCM_MIXER_GAIN_UNITY);
+    ramp.to = std::min(to, (uint32_t)PCM_MIXER_GAIN_UNITY);
+    ramp.frames = (ramp.from == ramp.to) ? 0 : frames;
+    ramp.position = 0;
+    ramp.curve = curve;
+}
+
+void PcmRamp::retarget(PCM_RAMP_T &ramp, uint32_t to, uint32_t frames)
+{
+    start(ramp, getGain(ramp), to, frames, ramp.curve);
+}
+
+uint32_t PcmRamp::getGain(const PCM_RAMP_T &ramp)
+{
+    if (!isActive(ramp))
+        return ramp.to;
+    return getGainAt(ramp, ramp.position, getPhaseStep(ramp));
+}
+
+uint64_t PcmRamp::getPhaseStep(const PCM_RAMP_T &ramp)
+{
+    return ramp.frames ? (PCM_RAMP_PHASE_END << PCM_RAMP_STEP_SHIFT) / ramp.frames : 0;
+}
+
+uint32_t PcmRamp::getGainAt(const PCM_RAMP_T &ramp, uint32_t position, uint64_t phaseStep)
+{
+    if (position >= ramp.frames)
+        return ramp.to;
+    uint64_t phase = ((uint64_t)position * phaseStep) >> PCM_RAMP_STEP_SHIFT;
+    //Share of the way from from to to, in Q15
+    int32_t shape;
+    if (ePcmRampLinear == ramp.curve)
+        shape = (int32_t)(phase >> 9);
+    else if (ramp.to > ramp.from)
+        shape = quarterSine(phase);
+    else
+        shape = PCM_MIXER_GAIN_UNITY - quarterSine(PCM_RAMP_PHASE_END - phase);
+    int64_t delta = (int64_t)ramp.to - (int64_t)ramp.from;
+    return (uint32_t)((int64_t)ramp.from + ((delta * shape) >> 15));
+}
+
+bool PcmRamp::isSupportedFormat(pa_sample_format_t format)
+{
+    return PA_SAMPLE_S16LE == format || PA_SAMPLE_S24LE == format ||
+           PA_SAMPLE_S32LE == format || PA_SAMPLE_FLOAT32LE == format;
+}
+
+PCM_RAMP_CURVE_E PcmRamp::getCurve(const char *name)
+{
+    if (name && 0 == strcmp(name, "equalPower"))
+        return ePcmRampEqualPower;
+    return ePcmRampLinear;
+}
+
+void PcmRamp::apply(PCM_RAMP_T &ramp, void *buffer, size_t frames, pa_sample_format_t format, uint8_t channels)
+{
+    if (!buffer || 0 == channels || !isSupportedFormat(format))
+        return;
+    const size_t frameSize = pa_sample_size_of_format(format) * channels;
+    const size_t blockFrames = std::max((size_t)1, (size_t)PCM_RAMP_BLOCK_SAMPLES / channels);
+    const uint64_t phaseStep = getPhaseStep(ramp);
+    int16_t gains[PCM_RAMP_BLOCK_SAMPLES];
+    uint8_t *data = (uint8_t*)buffer;
+
+    while (frames > 0)
+    {
+        size_t count = std::min(frames, blockFrames);
+        if (isActive(ramp))
+        {
+            count = std::min(count, (size_t)(ramp.frames - ramp.position));
+            for (size_t f = 0; f < count; f++)
+            {
+                int16_t gain = (int16_t)std::min(getGainAt(ramp, ramp.position + (uint32_t)f, phaseStep),
+                                                 (uint32_t)PCM_RAMP_MAX_BLOCK_GAIN);
+                std::fill(gains + f * channels, gains + (f + 1) * channels, gain);
+            }
+            ramp.position += (uint32_t)count;
+        }
+        else if (ramp.to >= PCM_MIXER_GAIN_UNITY)
+            return;
+        else if (0 == ramp.to)
+        {
+            memset(data, 0, frames * frameSize);
+            return;
+        }
+        else
+            std::fill(gains, gains + count * channels, (int16_t)ramp.to);
+        scale(data, gains, count * channels, format);
+        data += count * frameSize;
+        frames -= count;
+    }
+}
+
+// Every path computes floor(sample * gain / 2^15) for integer formats and
+// sample * (gain * 2^-15) for floats, so SIMD and scalar output are identical
+void PcmRamp::scale(void *buffer, const int16_t *gains, size_t samples, pa_sample_format_t format)
+{
+    size_t i = 0;
+    switch (format)
+    {
+        case PA_SAMPLE_S16LE:
+        {
+            int16_t *pcm = (int16_t*)buffer;
+#if defined(__SSE2__)
+            for (; i + 8 <= samples; i += 8)
+            {
+                __m128i s = _mm_loadu_si128((const __m128i*)(pcm + i));
+                __m128i g = _mm_loadu_si128((const __m128i*)(gains + i));
+                __m128i hi = _mm_mulhi_epi16(s, g);
+                __m128i lo = _mm_mullo_epi16(s, g);
+                _mm_storeu_si128((__m128i*)(pcm + i), _mm_or_si128(_mm_slli_epi16(hi, 1), _mm_srli_epi16(lo, 15)));
+            }
+#elif defined(__ARM_NEON)
+            for (; i + 8 <= samples; i += 8)
+            {
+                int16x8_t s = vld1q_s16(pcm + i);
+                int16x8_t g = vld1q_s16(gains + i);
+                int16x4_t lo = vshrn_n_s32(vmull_s16(vget_low_s16(s), vget_low_s16(g)), 15);
+                int16x4_t hi = vshrn_n_s32(vmull_s16(vget_high_s16(s), vget_high_s16(g)), 15);
+                vst1q_s16(pcm + i, vcombine_s16(lo, hi));
+            }
+#endif
+            for (; i < samples; i++)
+                pcm[i] = (int16_t)(((int32_t)pcm[i] * gains[i]) >> 15);
+            break;
+        }
+        case PA_SAMPLE_FLOAT32LE:
+        {
+            float *pcm = (float*)buffer;
+            const float unit = 1.0f / PCM_MIXER_GAIN_UNITY;
+#if defined(__SSE2__)
+            const __m128 vunit = _mm_set1_ps(unit);
+            for (; i + 4 <= samples; i += 4)
+            {
+                __m128i g = _mm_loadl_epi64((const __m128i*)(gains + i));
+                __m128i g32 = _mm_srai_epi32(_mm_unpacklo_epi16(g, g), 16);
+                __m128 gain = _mm_mul_ps(_mm_cvtepi32_ps(g32), vunit);
+                _mm_storeu_ps(pcm + i, _mm_mul_ps(_mm_loadu_ps(pcm + i), gain));
+            }
+#elif defined(__ARM_NEON)
+            for (; i + 4 <= samples; i += 4)
+            {
+                float32x4_t gain = vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vld1_s16(gains + i))), unit);
+                vst1q_f32(pcm + i, vmulq_f32(vld1q_f32(pcm + i), gain));
+            }
+#endif
+            for (; i < samples; i++)
+                pcm[i] = pcm[i] * ((float)gains[i] * unit);
+            break;
+        }
+        case PA_SAMPLE_S32LE:
+        {
+            int32_t *pcm = (int32_t*)buffer;
+            for (; i < samples; i++)
+                pcm[i] = (int32_t)(((int64_t)pcm[i] * gains[i]) >> 15);
+            break;
+        }
+        case PA_SAMPLE_S24LE:
+        {
+            uint8_t *pcm = (uint8_t*)buffer;
+            for (; i < samples; i++, pcm += 3)
+            {
+                int32_t sample = (int32_t)((uint32_t)pcm[0] << 8 | (uint32_t)pcm[1] << 16 | (uint32_t)pcm[2] << 24) >> 8;
+                sample = (int32_t)(((int64_t)sample * gains[i]) >> 15);
+                pcm[0] = (uint8_t)(sample & 0xff);
+                pcm[1] = (uint8_t)((sample >> 8) & 0xff);
+                pcm[2] = (uint8_t)((sample >> 16) & 0xff);
+            }
+            break;
+        }
+        default:
+            break;
+    }
+}
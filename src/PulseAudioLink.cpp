@@ -16,6 +16,10 @@
 
 
 #include "PulseAudioLink.h"
+#include "PcmConverter.h"
+#include "ImaAdpcm.h"
+#include <pbnjson.hpp>
+#include <algorithm>
 
 #define DEFAULT_SAMPLE_RATE 44100
 #define DEFAULT_CHANNELS 1
@@ -34,18 +38,18 @@ struct ssound_t {
 };
 
 
-static void initializeDtmf();
-
-PulseAudioLink::PulseAudioLink() : mContext(0), mMainLoop(0), mPulseAudioReady(false)
+PulseAudioLink::PulseAudioLink() : mContext(0), mMainLoop(0), mPulseAudioReady(false), mSinkSpec(),
+    mSampleCacheBudget(SAMPLE_CACHE_DEFAULT_BUDGET_KB * 1024), mSampleCacheBytes(0), mSampleCacheHits(0),
+    mSampleCacheMisses(0), mSampleCacheEvictions(0), mPreloadRequestId(0),
+    mWarmUpParallelUploads(SOUND_WARMUP_DEFAULT_PARALLEL_UPLOADS), mWarmUpStartTime(0), mLowLatencyEnabled(false),
+    mFeedbackStreamsPerSink(LOW_LATENCY_DEFAULT_STREAMS_PER_SINK), mFeedbackTargetLatency(0),
+    mFeedbackBudget(LOW_LATENCY_DEFAULT_BUDGET_KB * 1024), mFeedbackSpec(), mFeedbackStreamsArmed(false)
 {
-    initializeDtmf();
+    memset(mPlayLatency, 0, sizeof(mPlayLatency));
 }
 
 PulseAudioLink::~PulseAudioLink()
 {
-    for (const auto& it : mMapAudioList)
-        delete it.second;
-    mMapAudioList.clear();
 }
 
 void PulseAudioLink::pulseAudioStateChanged(pa_context_state_t state)
@@ -68,6 +72,7 @@ void PulseAudioLink::pulseAudioStateChanged(pa_context_state_t state)
 
 void PulseAudioLink::killPulseConnection()
 {
+    releaseFeedbackStreams();
     if (mContext)
         pa_context_unref(mContext);
     if (mMainLoop)
@@ -75,7 +80,16 @@ void PulseAudioLink::killPulseConnection()
     mMainLoop = 0;
     mContext = 0;
     mPulseAudioReady = false;
+    memset(&mSinkSpec, 0, sizeof(mSinkSpec));
     mLoadedSounds.clear();
+    mSampleCacheBytes = 0;
+    if (!mPendingPreloads.empty())
+        PM_LOG_WARNING(MSGID_PULSE_LINK, INIT_KVCOUNT,\
+            "killPulseConnection: dropping %zu pending preload(s)", mPendingPreloads.size());
+    mPendingPreloads.clear();
+    mSoundReadiness.clear();
+    mWarmUpQueue.clear();
+    mWarmUpUploads.clear();
 }
 
 bool PulseAudioLink::iteratePulse(int block)
@@ -118,8 +132,54 @@ struct PlaySampleDeferData {
     char samplename[kSampleNameMaxSize];
     const char* sink;
     pa_context* pacontext;
+    PulseAudioLink* link;
+    //Time of the play request, 0 when the play is not probed
+    gint64 requestTime;
+};
+
+struct PlayLatencyProbeData {
+    PulseAudioLink* link;
+    PLAY_LATENCY_MODE_E mode;
+    gint64 requestTime;
+    gint64 latencyUs;
 };
 
+static PlayLatencyProbeData* newPlayLatencyProbe(PulseAudioLink* link, PLAY_LATENCY_MODE_E mode, gint64 requestTime)
+{
+    PlayLatencyProbeData* probe = new PlayLatencyProbeData;
+    probe->link = link;
+    probe->mode = mode;
+    probe->requestTime = requestTime;
+    probe->latencyUs = 0;
+    return probe;
+}
+
+static gboolean playLatencyResultCB(gpointer userdata)
+{
+    PlayLatencyProbeData* probe = (PlayLatencyProbeData*)userdata;
+    if (probe && probe->link)
+        probe->link->recordPlayLatency(probe->mode, probe->latencyUs);
+    delete probe;
+    return FALSE;
+}
+
+// The probe stops when the server acknowledges that the sound started playing.
+// The sink latency comes on top of it and is the same in both modes.
+static void postPlayLatency(PlayLatencyProbeData* probe)
+{
+    probe->latencyUs = g_get_monotonic_time() - probe->requestTime;
+    g_idle_add(playLatencyResultCB, probe);
+}
+
+static void play_sample_latency_cb(pa_context *c, int success, void *userdata)
+{
+    PlayLatencyProbeData* probe = (PlayLatencyProbeData*)userdata;
+    if (success)
+        postPlayLatency(probe);
+    else
+        delete probe;
+}
+
 static void PlaySampleDeferCB(pa_mainloop_api *a, pa_defer_event *e, void *userdata)
 {
     PlaySampleDeferData* data  = (PlaySampleDeferData*)userdata;
@@ -140,41 +200,35 @@ static void PlaySampleDeferCB(pa_mainloop_api *a, pa_defer_event *e, void *userd
         //gAudioDevice.prepareHWForPlayback();
     }
 
+    PlayLatencyProbeData* probe = NULL;
+    if (data->requestTime)
+        probe = newPlayLatencyProbe(data->link, ePlayLatencySample, data->requestTime);
     pa_operation * op = pa_context_play_sample(data->pacontext,
                                                data->samplename,
                                                data->sink,
                                                PA_VOLUME_NORM,
-                                               NULL, NULL);
+                                               probe ? play_sample_latency_cb : NULL, probe);
     if (op)
     {
         pa_operation_unref(op);
     }
+    else
+        delete probe;
     free(data);
     a->defer_free(e);
 }
 
-bool PulseAudioLink::play(const char * samplename, const char * sink)
+bool PulseAudioLink::playSample(const char * samplename, const char * sink, gint64 requestTime)
 {
-    PMTRACE_FUNCTION;
-    std::string path = SYSTEMSOUNDS_PATH;
-    if (nullptr == samplename)
-        return false;
-    path += samplename;
-    path += "-ondemand.pcm";
-
-    preload(samplename, DEFAULT_SAMPLE_FORMAT, DEFAULT_SAMPLE_RATE, DEFAULT_CHANNELS, path.c_str());
-
-    // This will affect latency severely, but then again, how often will
-    //we lose connection (ie, pulseaudio crashed)
-    if (!checkConnection())
-        return false;
-
     PlaySampleDeferData* data = (PlaySampleDeferData*)malloc(sizeof(PlaySampleDeferData));
     if (data)
     {
         strncpy(data->samplename, samplename, sizeof(data->samplename)-1);
+        data->samplename[sizeof(data->samplename)-1] = '\0';
         data->sink = sink;
         data->pacontext = mContext;
+        data->link = this;
+        data->requestTime = requestTime;
         pa_mainloop_get_api(mMainLoop)->defer_new(pa_mainloop_get_api(mMainLoop),
                                                   &PlaySampleDeferCB, data);
     }
@@ -187,48 +241,71 @@ bool PulseAudioLink::play(const char * samplename, const char * sink)
     return true;
 }
 
-std::string PulseAudioLink::playSound(const char * samplename, const char * sink, const char * format, int rate, int channels)
+// Only plays of loaded samples are probed, queued plays wait for their upload
+bool PulseAudioLink::playWhenLoaded(const char * samplename, const char * sink, bool loaded, gint64 requestTime)
 {
-    std::string playbackID = GenerateUniqueID()();
-    PlaybackThread *thread = new PlaybackThread(mCallback, playbackID);;
-    bool ret = thread->play(samplename, sink, format, rate, channels);
-    if (ret)
+    if (loaded)
+    {
+        ++mSampleCacheHits;
+        touchSample(samplename);
+    }
+    else
     {
-        mMapAudioList[playbackID] = thread;
-        return playbackID;
+        ++mSampleCacheMisses;
+        //The sample is still being uploaded, play it once the upload completes
+        auto it = mPendingPreloads.find(samplename);
+        if (it != mPendingPreloads.end())
+        {
+            it->second.pendingSinks.push_back(sink);
+            return true;
+        }
     }
-    delete thread;
-    return std::string();
+
+    // This will affect latency severely, but then again, how often will
+    //we lose connection (ie, pulseaudio crashed)
+    if (!checkConnection())
+        return false;
+    return playSample(samplename, sink, loaded ? requestTime : 0);
 }
 
-bool PulseAudioLink::controlPlayback(std::string playbackId, std::string requestType)
+bool PulseAudioLink::play(const char * samplename, const char * sink)
 {
-    std::map<std::string, PlaybackThread *>::iterator it = mMapAudioList.find (playbackId);
-    if (it == mMapAudioList.end())
+    PMTRACE_FUNCTION;
+    if (nullptr == samplename)
         return false;
+    gint64 requestTime = g_get_monotonic_time();
+    if (mLowLatencyEnabled && playLowLatency(samplename, sink, requestTime))
+        return true;
+    std::string path = utils::getSystemSoundPath(samplename);
+
+    bool loaded = preload(samplename, DEFAULT_SAMPLE_FORMAT, DEFAULT_SAMPLE_RATE, DEFAULT_CHANNELS, path.c_str());
+    return playWhenLoaded(samplename, sink, loaded, requestTime);
+}
+
+std::string PulseAudioLink::playSound(const char * samplename, const char * sink, const char * format, int rate, int channels, int volume)
+{
+    return mPlaybackEngine.play(samplename, sink, format, rate, channels, volume);
+}
 
+int PulseAudioLink::queueSound(std::string playbackId, const char *filename, const char *format, int rate, int channels)
+{
+    return mPlaybackEngine.enqueue(playbackId, filename, format, rate, channels);
+}
+
+bool PulseAudioLink::controlPlayback(std::string playbackId, std::string requestType)
+{
     if (requestType == "pause")
-        return it->second->pause();
+        return mPlaybackEngine.pause(playbackId);
     if (requestType == "resume")
-        return it->second->resume();
-    if(requestType == "stop")
-    {
-        if (it->second->stop())
-        {
-            delete it->second;
-            mMapAudioList.erase(it);
-            return true;
-        }
-    }
+        return mPlaybackEngine.resume(playbackId);
+    if (requestType == "stop")
+        return mPlaybackEngine.stop(playbackId);
     return false;
 }
 
-std::string PulseAudioLink::getPlaybackStatus(std::string playbackId)
+std::string PulseAudioLink::getPlaybackStatus(std::string playbackId, PLAYBACK_TIMING_T *timing)
 {
-    std::map<std::string, PlaybackThread *>::iterator it = mMapAudioList.find (playbackId);
-    if(it == mMapAudioList.end())
-        return std::string();
-    return it->second->getPlaybackStatus();
+    return mPlaybackEngine.getPlaybackStatus(playbackId, timing);
 }
 
 bool PulseAudioLink::play(const char * samplename, const char * sink, const char * format, int rate, int channels)
@@ -241,30 +318,8 @@ bool PulseAudioLink::play(const char * samplename, const char * sink, const char
     found = filename.find_last_of(".");
     std::string preloadName = filename.substr(0, found);
 
-    preload(preloadName.c_str(), format, rate, DEFAULT_CHANNELS, samplename);
-
-    // This will affect latency severely, but then again, how often will
-    //we lose connection (ie, pulseaudio crashed)
-    if (!checkConnection())
-        return false;
-
-    PlaySampleDeferData* data = (PlaySampleDeferData*)malloc(sizeof(PlaySampleDeferData));
-    if (data)
-    {
-        strncpy(data->samplename, preloadName.c_str(), sizeof(data->samplename)-1);
-        data->sink = sink;
-        data->pacontext = mContext;
-        pa_mainloop_get_api(mMainLoop)->defer_new(pa_mainloop_get_api(mMainLoop),
-                                              &PlaySampleDeferCB, data);
-    }
-    else
-    {
-        PM_LOG_ERROR(MSGID_PULSE_LINK, INIT_KVCOUNT,\
-                "PulseAudioLink::play: data handle is NULL");
-        return false;
-    }
-
-    return true;
+    bool loaded = preload(preloadName.c_str(), format, rate, DEFAULT_CHANNELS, samplename);
+    return playWhenLoaded(preloadName.c_str(), sink, loaded);
 }
 
 PulseAudioDataProvider::PulseAudioDataProvider()
@@ -386,19 +441,19 @@ bool PulseAudioLink::play(PulseAudioDataProvider* data, const char* sinkname)
     return true;
 }
 
-std::string PulseAudioLink::play(const char *snd, EVirtualAudioSink sink, const char *format, int rate, int channels)
+std::string PulseAudioLink::play(const char *snd, EVirtualAudioSink sink, const char *format, int rate, int channels, int volume)
 {
     PMTRACE_FUNCTION;
     PM_LOG_INFO(MSGID_PULSE_LINK, INIT_KVCOUNT,\
-        "Inside play function with filename %s, sink %d, format %s, rate %d and channels %d", \
-                 snd, (int)sink, format, rate, channels);
+        "Inside play function with filename %s, sink %d, format %s, rate %d, channels %d and volume %d", \
+                 snd, (int)sink, format, rate, channels, volume);
     if (!IsValidVirtualSink(sink))
     {
         PM_LOG_ERROR(MSGID_PULSE_LINK, INIT_KVCOUNT,\
             "'%d' is not a valid sink id", (int)sink);
         return std::string();
     }
-    return playSound(snd, virtualSinkName(sink, false), format, rate, channels);
+    return playSound(snd, virtualSinkName(sink, false), format, rate, channels, volume);
 }
 
 bool PulseAudioLink::connectToPulse()
@@ -420,8 +475,10 @@ bool PulseAudioLink::connectToPulse()
         {
             PM_LOG_INFO(MSGID_PULSE_LINK, INIT_KVCOUNT,\
                 "Connected to Pulse for system sounds");
+            querySinkSpec();
             if (pthread_create(&mThread, NULL, &pathread_func, this)==0) {
                 pthread_detach(mThread);
+                armFeedbackStreams();
                 return true;
             } else {
                 mPulseAudioReady = false;
@@ -431,9 +488,35 @@ bool PulseAudioLink::connectToPulse()
     return false;
 }
 
+void PulseAudioLink::server_info_callback(pa_context *c, const pa_server_info *info, void *userdata)
+{
+    PulseAudioLink* link = (PulseAudioLink*)userdata;
+    if (link && info && PcmConverter::isSupportedFormat(info->sample_spec.format))
+        link->mSinkSpec = info->sample_spec;
+}
+
+// Called before the pulse thread is started, the server info is waited for here
+void PulseAudioLink::querySinkSpec()
+{
+    int ret;
+    memset(&mSinkSpec, 0, sizeof(mSinkSpec));
+    pa_operation* op = pa_context_get_server_info(mContext, server_info_callback, this);
+    if (!op)
+        return;
+    while (PA_OPERATION_RUNNING == pa_operation_get_state(op) && mPulseAudioReady)
+    {
+        if (pa_mainloop_iterate(mMainLoop, 1, &ret) < 0)
+            break;
+    }
+    pa_operation_unref(op);
+    PM_LOG_INFO(MSGID_PULSE_LINK, INIT_KVCOUNT, "querySinkSpec: format:%d rate:%u channels:%u", \
+        (int)mSinkSpec.format, mSinkSpec.rate, (unsigned)mSinkSpec.channels);
+}
+
 void PulseAudioLink::registerCallback(MixerInterface *mixerCallBack)
 {
     mCallback = mixerCallBack;
+    mPlaybackEngine.registerCallback(mixerCallBack);
 }
 
 class PreloadDeferCBData : public RefObj
@@ -445,6 +528,9 @@ public:
         mainloop = NULL;
         context = NULL;
         s = NULL;
+        link = NULL;
+        requestId = 0;
+        memset(&sinkSpec, 0, sizeof(sinkSpec));
     }
 
     ~PreloadDeferCBData()
@@ -468,8 +554,43 @@ public:
     pa_mainloop* mainloop;
     pa_context* context;
     pa_stream *s;
+    PulseAudioLink* link;
+    unsigned int requestId;
+    //Spec the sample is converted to, invalid to upload it as is
+    pa_sample_spec sinkSpec;
+    //Decoded or converted sample, empty when the file is uploaded as is
+    std::vector<uint8_t> staged;
+};
+
+struct PreloadResultData {
+    PulseAudioLink* link;
+    std::string samplename;
+    unsigned int requestId;
+    bool isSuccess;
+    size_t bytes;
 };
 
+static gboolean preloadResultCB(gpointer userdata)
+{
+    PreloadResultData* result = (PreloadResultData*)userdata;
+    if (result && result->link)
+        result->link->preloadCompleted(result->samplename, result->requestId, result->isSuccess, result->bytes);
+    delete result;
+    return FALSE;
+}
+
+// Upload results are handled on the glib main loop, like the rest of audiod
+static void postPreloadResult(PreloadDeferCBData* data)
+{
+    PreloadResultData* result = new PreloadResultData;
+    result->link = data->link;
+    result->samplename = data->snd.samplename;
+    result->requestId = data->requestId;
+    result->isSuccess = data->snd.isSuccess;
+    result->bytes = data->snd.length;
+    g_idle_add(preloadResultCB, result);
+}
+
 static void preload_stream_state_cb(pa_stream * s, void *userdata)
 {
     PreloadDeferCBData* data = (PreloadDeferCBData*)userdata;
@@ -493,6 +614,8 @@ static void preload_stream_state_cb(pa_stream * s, void *userdata)
 
             snd->loading = false;
             snd->isSuccess = false;
+            if (pa_stream_get_state(s) == PA_STREAM_FAILED)
+                pa_stream_disconnect(s);
             unref = true;
             break;
 
@@ -506,7 +629,10 @@ static void preload_stream_state_cb(pa_stream * s, void *userdata)
    }
     data->unlock();
     if (unref)
+    {
+        postPreloadResult(data);
         data->unref();
+    }
 }
 
 static void preload_stream_write_cb(pa_stream * s, size_t length, void * userdata)
@@ -518,7 +644,14 @@ static void preload_stream_write_cb(pa_stream * s, size_t length, void * userdat
 
     void * data = pa_xmalloc(length);
 
-    size_t len = fread(data, 1, length, snd->file);
+    size_t len;
+    if (!cbdata->staged.empty())
+    {
+        len = std::min(length, cbdata->staged.size() - snd->tot_written);
+        memcpy(data, cbdata->staged.data() + snd->tot_written, len);
+    }
+    else
+        len = fread(data, 1, length, snd->file);
     if(len < length){
     PM_LOG_ERROR(MSGID_PULSE_LINK, INIT_KVCOUNT,
               "PulseAudioLink::preload_stream_write_cb: Error reading from file");
@@ -535,12 +668,70 @@ static void preload_stream_write_cb(pa_stream * s, size_t length, void * userdat
     cbdata->unlock();
 }
 
+// Reads a whole sound file as PCM, compressed sounds are decoded and the PCM is
+// converted to sinkSpec when it is valid. spec is the spec of a raw file on input
+// and the spec of output on return.
+static bool readSoundPcm(FILE *file, size_t length, pa_sample_spec &spec, const pa_sample_spec &sinkSpec,
+                         std::vector<uint8_t> &output)
+{
+    std::vector<uint8_t> pcm(length);
+    pcm.resize(fread(pcm.data(), 1, pcm.size(), file));
+    IMA_ADPCM_HEADER_T adpcm;
+    if (ImaAdpcm::readHeader(pcm.data(), pcm.size(), adpcm))
+    {
+        std::vector<uint8_t> encoded;
+        encoded.swap(pcm);
+        ImaAdpcm::decode(encoded.data(), encoded.size(), pcm);
+        spec.format = PA_SAMPLE_S16LE;
+        spec.rate = adpcm.rate;
+        spec.channels = (uint8_t)adpcm.channels;
+    }
+    PcmConverter converter;
+    if (pa_sample_spec_valid(&sinkSpec) && converter.setup(spec, sinkSpec) && !converter.isPassthrough())
+    {
+        converter.convert(pcm.data(), pcm.size(), output);
+        spec = converter.getOutputSpec();
+    }
+    else
+        output.swap(pcm);
+    return !output.empty();
+}
+
+// Compressed sounds are decoded and every sound is converted to the sink spec
+// here, once, so pulse does not resample the sample on every play
+static void stagePreloadData(PreloadDeferCBData* cbdata)
+{
+    ssound_t * snd = &(cbdata->snd);
+    uint8_t header[IMA_ADPCM_HEADER_SIZE];
+    IMA_ADPCM_HEADER_T adpcm;
+    size_t len = fread(header, 1, sizeof(header), snd->file);
+    bool compressed = ImaAdpcm::readHeader(header, len, adpcm);
+    if (compressed)
+    {
+        snd->spec.format = PA_SAMPLE_S16LE;
+        snd->spec.rate = adpcm.rate;
+        snd->spec.channels = (uint8_t)adpcm.channels;
+    }
+    PcmConverter converter;
+    bool convert = pa_sample_spec_valid(&cbdata->sinkSpec) &&
+                   converter.setup(snd->spec, cbdata->sinkSpec) && !converter.isPassthrough();
+    if (fseek(snd->file, 0, SEEK_SET) != 0 || (!compressed && !convert))
+        return;
+
+    guint64 startTime = getCurrentTimeInMs();
+    readSoundPcm(snd->file, snd->length, snd->spec, cbdata->sinkSpec, cbdata->staged);
+    snd->length = cbdata->staged.size();
+    PM_LOG_DEBUG("PulseAudioLink::preload: staged '%s', %zu bytes in %llu ms", snd->samplename, \
+        snd->length, (unsigned long long)(getCurrentTimeInMs() - startTime));
+}
+
 static void preloadDeferCB(pa_mainloop_api *a, pa_defer_event *e, void *userdata) {
     PMTRACE_FUNCTION;
     a->defer_free(e);
     struct PreloadDeferCBData* cbdata = (struct PreloadDeferCBData*)userdata;
     bool unref= false;
     cbdata->lock();
+    stagePreloadData(cbdata);
     PM_LOG_DEBUG("PulseAudioLink::preload: Pre-loading '%s', %u bytes.",\
         cbdata->snd.samplename,\
         cbdata->snd.length);
@@ -554,104 +745,794 @@ static void preloadDeferCB(pa_mainloop_api *a, pa_defer_event *e, void *userdata
         pa_stream_set_write_callback(cbdata->s, preload_stream_write_cb, userdata);
         pa_stream_connect_upload(cbdata->s, cbdata->snd.length);
     } else {
+        cbdata->snd.loading = false;
+        cbdata->snd.isSuccess = false;
         unref = true;
     }
     cbdata->unlock();
     if (unref)
+    {
+        postPreloadResult(cbdata);
         cbdata->unref();
+    }
 }
 
-void PulseAudioLink::preload(const char * samplename, const char * format, int rate, int channels, const char * path)
+bool PulseAudioLink::preload(const char * samplename, const char * format, int rate, int channels, const char * path)
 {
     // is the sound file loaded?
     PMTRACE_FUNCTION;
-    if (strlen(samplename) >= kSampleNameMaxSize ||
-                              mLoadedSounds.find(samplename) != mLoadedSounds.end())
-        return;
+    if (strlen(samplename) >= kSampleNameMaxSize)
+        return false;
+    if (mLoadedSounds.find(samplename) != mLoadedSounds.end())
+        return true;
+
+    // is it already being uploaded?
+    auto pending = mPendingPreloads.find(samplename);
+    if (pending != mPendingPreloads.end())
+    {
+        if (getCurrentTimeInMs() < pending->second.startTime + PRELOAD_TIMEOUT_MS)
+            return false;
+        PM_LOG_ERROR(MSGID_PULSE_LINK, INIT_KVCOUNT,\
+                "PulseAudioLink::preload: failed to load sample %s in time, retrying", samplename);
+    }
 
     struct stat fileStat;
     FILE* f = fopen(path, "r");
     if (!f)
     {
         PM_LOG_DEBUG("PulseAudioLink::preload:File Open Failed for %s. Returning from Here", path);
+        completePreload(samplename, false);
+        return false;
+    }
+    if (stat(path, &fileStat) != 0 || !VERIFY(checkConnection()))
+    {
+        PM_LOG_ERROR(MSGID_PULSE_LINK, INIT_KVCOUNT, \
+                "PulseAudioLink::preload: cannot upload %s", samplename);
+        if (fclose(f))
+        {
+            PM_LOG_DEBUG("PulseAudioLink::preload: Failed to close the file");
+        }
+        completePreload(samplename, false);
+        return false;
+    }
+
+    PreloadDeferCBData* data = new PreloadDeferCBData();
+    data->snd.file = f;
+    strncpy(data->snd.samplename, samplename, sizeof(data->snd.samplename)-1);
+    data->snd.length = fileStat.st_size;
+    data->snd.tot_written = 0;
+    if (std::strncmp(format, "PA_SAMPLE_S16LE", 15) == 0)
+        data->snd.spec.format = PA_SAMPLE_S16LE;
+    else if (std::strncmp(format,"PA_SAMPLE_S24LE", 15) == 0)
+        data->snd.spec.format = PA_SAMPLE_S24LE;
+    else
+        data->snd.spec.format = PA_SAMPLE_S32LE;
+    data->snd.spec.rate = rate;
+    data->snd.spec.channels = channels;
+    data->sinkSpec = mSinkSpec;
+    data->snd.loading = true;
+    data->snd.isSuccess = false;
+    data->context = mContext;
+    data->mainloop = mMainLoop;
+    data->link = this;
+    data->requestId = ++mPreloadRequestId;
+
+    //Plays queued by an earlier attempt stay queued
+    PRELOAD_REQUEST_T &request = mPendingPreloads[samplename];
+    request.requestId = data->requestId;
+    request.startTime = getCurrentTimeInMs();
+    mSoundReadiness[samplename] = eSoundLoading;
+
+    //The upload reference is released by the stream callbacks
+    pa_mainloop_get_api(mMainLoop)->defer_new(pa_mainloop_get_api(mMainLoop),
+                                                  &preloadDeferCB,
+                                                  data);
+    return false;
+}
+
+void PulseAudioLink::preloadCompleted(const std::string &samplename, unsigned int requestId, bool isSuccess, size_t bytes)
+{
+    auto it = mPendingPreloads.find(samplename);
+    if (it == mPendingPreloads.end() || it->second.requestId != requestId)
+    {
+        PM_LOG_DEBUG("PulseAudioLink::preloadCompleted: stale result for %s", samplename.c_str());
+        return;
+    }
+    if (!isSuccess)
+        PM_LOG_ERROR(MSGID_PULSE_LINK, INIT_KVCOUNT,\
+                "PulseAudioLink::preload: failed to load sample %s", samplename.c_str());
+
+    // success or failure, no need to try again
+    if (mLoadedSounds.find(samplename) == mLoadedSounds.end())
+    {
+        SAMPLE_CACHE_ENTRY_T &entry = mLoadedSounds[samplename];
+        entry.bytes = isSuccess ? bytes : 0;
+        entry.hits = 0;
+        entry.lastUse = getCurrentTimeInMs();
+        entry.pinned = (mPinnedSounds.find(samplename) != mPinnedSounds.end());
+        mSampleCacheBytes += entry.bytes;
+    }
+    else
+        PM_LOG_DEBUG("sample name %s already loaded", samplename.c_str());
+    mSoundReadiness[samplename] = isSuccess ? eSoundReady : eSoundFailed;
+    completePreload(samplename, isSuccess);
+    evictSamples(samplename);
+
+    if (mWarmUpUploads.erase(samplename))
+        startWarmUpUploads();
+}
+
+// Size of a sound once loaded in pulse, compressed sounds take their decoded size
+static size_t getSoundSize(const std::string &path)
+{
+    FILE* f = fopen(path.c_str(), "r");
+    if (!f)
+        return 0;
+    struct stat fileStat;
+    size_t size = (0 == fstat(fileno(f), &fileStat)) ? (size_t)fileStat.st_size : 0;
+    uint8_t header[IMA_ADPCM_HEADER_SIZE];
+    IMA_ADPCM_HEADER_T adpcm;
+    if (ImaAdpcm::readHeader(header, fread(header, 1, sizeof(header), f), adpcm))
+        size = (size_t)adpcm.frames * adpcm.channels * sizeof(int16_t);
+    if (fclose(f))
+        PM_LOG_DEBUG("getSoundSize: Failed to close the file");
+    return size;
+}
+
+void PulseAudioLink::warmUpSounds()
+{
+    PMTRACE_FUNCTION;
+    if (!mWarmUpQueue.empty() || !mWarmUpUploads.empty())
+        return;
+
+    pbnjson::JValue warmUpConfig = pbnjson::JDomParser::fromFile(SOUND_WARMUP_CONFIG, pbnjson::JSchema::AllSchema());
+    if (!warmUpConfig.isValid() || !warmUpConfig.isObject())
+    {
+        PM_LOG_INFO(MSGID_PULSE_LINK, INIT_KVCOUNT, "warmUpSounds: no warm-up manifest %s", SOUND_WARMUP_CONFIG);
         return;
     }
-    if (stat(path, &fileStat) == 0)
+    configureSampleCache(warmUpConfig["sampleCache"]);
+    configureLowLatency(warmUpConfig["lowLatency"]);
+    configureGainRamp(warmUpConfig["gainRamp"]);
+
+    bool enabled = true;
+    if (warmUpConfig.hasKey("enabled"))
+        enabled = warmUpConfig["enabled"].asBool();
+    pbnjson::JValue sounds = warmUpConfig["sounds"];
+    if (!enabled || !sounds.isArray())
+        return;
+
+    size_t budget = SOUND_WARMUP_DEFAULT_BUDGET_KB * 1024;
+    if (warmUpConfig["memoryBudgetKB"].isNumber())
+        budget = (size_t)warmUpConfig["memoryBudgetKB"].asNumber<int>() * 1024;
+    mWarmUpParallelUploads = SOUND_WARMUP_DEFAULT_PARALLEL_UPLOADS;
+    if (warmUpConfig["maxParallelUploads"].isNumber())
+        mWarmUpParallelUploads = std::max(1, warmUpConfig["maxParallelUploads"].asNumber<int>());
+
+    //Sounds are listed hottest first, the ones past the budget are loaded on first use
+    size_t total = 0;
+    for (const pbnjson::JValue &sound : sounds.items())
     {
-        // can we talk to Pulse to load it?
-        if (!VERIFY(checkConnection()))
+        std::string samplename;
+        if (sound.asString(samplename) != CONV_OK || samplename.empty())
+            continue;
+        std::string path = utils::getSystemSoundPath(samplename);
+        size_t size = getSoundSize(path);
+        if (0 == size)
         {
-            if (fclose(f))
-            {
-                PM_LOG_DEBUG("PulseAudioLink::preload: Failed to close the file");
-            }
-            else
-            {
-                PM_LOG_DEBUG("PulseAudioLink::preload: Successfully closed the file");
-            }
-            return;
+            PM_LOG_WARNING(MSGID_PULSE_LINK, INIT_KVCOUNT, "warmUpSounds: %s not found", path.c_str());
+            continue;
         }
-        PreloadDeferCBData* data = new PreloadDeferCBData();
-        data->snd.file = f;
-        strncpy(data->snd.samplename, samplename, sizeof(data->snd.samplename)-1);
-        data->snd.length = fileStat.st_size;
-        data->snd.tot_written = 0;
-        if (std::strncmp(format, "PA_SAMPLE_S16LE", 15) == 0)
-            data->snd.spec.format = PA_SAMPLE_S16LE;
-        else if (std::strncmp(format,"PA_SAMPLE_S24LE", 15) == 0)
-            data->snd.spec.format = PA_SAMPLE_S24LE;
+        if (total + size > budget)
+        {
+            PM_LOG_INFO(MSGID_PULSE_LINK, INIT_KVCOUNT, "warmUpSounds: %s exceeds the budget of %zu bytes", \
+                samplename.c_str(), budget);
+            continue;
+        }
+        total += size;
+        mWarmUpQueue.push_back(samplename);
+    }
+    PM_LOG_INFO(MSGID_PULSE_LINK, INIT_KVCOUNT, "warmUpSounds: uploading %zu sound(s), %zu bytes, %d in parallel", \
+        mWarmUpQueue.size(), total, mWarmUpParallelUploads);
+    mWarmUpStartTime = getCurrentTimeInMs();
+    startWarmUpUploads();
+}
+
+void PulseAudioLink::startWarmUpUploads()
+{
+    while ((int)mWarmUpUploads.size() < mWarmUpParallelUploads && !mWarmUpQueue.empty())
+    {
+        std::string samplename = mWarmUpQueue.front();
+        mWarmUpQueue.pop_front();
+        std::string path = utils::getSystemSoundPath(samplename);
+        if (preload(samplename.c_str(), DEFAULT_SAMPLE_FORMAT, DEFAULT_SAMPLE_RATE, DEFAULT_CHANNELS, path.c_str()))
+            continue;
+        if (mPendingPreloads.find(samplename) != mPendingPreloads.end())
+            mWarmUpUploads.insert(samplename);
         else
-            data->snd.spec.format = PA_SAMPLE_S32LE;
-        data->snd.spec.rate = rate;
-        data->snd.spec.channels = channels;
-        data->snd.loading = true;
-        data->snd.isSuccess = false;
-        data->context = mContext;
-        data->mainloop = mMainLoop;
-        data->ref();
+            mSoundReadiness[samplename] = eSoundFailed;
+    }
+    if (mWarmUpUploads.empty() && mWarmUpQueue.empty() && mWarmUpStartTime)
+    {
+        PM_LOG_INFO(MSGID_PULSE_LINK, INIT_KVCOUNT, "warmUpSounds: completed in %llu ms", \
+            (unsigned long long)(getCurrentTimeInMs() - mWarmUpStartTime));
+        mWarmUpStartTime = 0;
+    }
+}
+
+SOUND_READINESS_E PulseAudioLink::getSoundReadiness(const std::string &samplename) const
+{
+    auto it = mSoundReadiness.find(samplename);
+    if (it != mSoundReadiness.end())
+        return it->second;
+    return eSoundNotLoaded;
+}
+
+void PulseAudioLink::configureSampleCache(const pbnjson::JValue &cacheConfig)
+{
+    if (!cacheConfig.isObject())
+        return;
+    if (cacheConfig["budgetKB"].isNumber())
+        mSampleCacheBudget = (size_t)std::max(0, cacheConfig["budgetKB"].asNumber<int>()) * 1024;
+    pbnjson::JValue pinned = cacheConfig["pinned"];
+    if (pinned.isArray())
+    {
+        mPinnedSounds.clear();
+        for (const pbnjson::JValue &sound : pinned.items())
+        {
+            std::string samplename;
+            if (sound.asString(samplename) == CONV_OK && !samplename.empty())
+                mPinnedSounds.insert(samplename);
+        }
+    }
+    for (auto &it : mLoadedSounds)
+        it.second.pinned = (mPinnedSounds.find(it.first) != mPinnedSounds.end());
+    PM_LOG_INFO(MSGID_PULSE_LINK, INIT_KVCOUNT, "configureSampleCache: budget %zu bytes, %zu pinned sound(s)", \
+        mSampleCacheBudget, mPinnedSounds.size());
+}
+
+void PulseAudioLink::touchSample(const std::string &samplename)
+{
+    auto it = mLoadedSounds.find(samplename);
+    if (it == mLoadedSounds.end())
+        return;
+    ++it->second.hits;
+    it->second.lastUse = getCurrentTimeInMs();
+}
+
+struct RemoveSampleDeferData {
+    char samplename[kSampleNameMaxSize];
+    pa_context* pacontext;
+};
+
+static void RemoveSampleDeferCB(pa_mainloop_api *a, pa_defer_event *e, void *userdata)
+{
+    RemoveSampleDeferData* data = (RemoveSampleDeferData*)userdata;
+    pa_operation * op = pa_context_remove_sample(data->pacontext, data->samplename, NULL, NULL);
+    if (op)
+    {
+        pa_operation_unref(op);
+    }
+    free(data);
+    a->defer_free(e);
+}
+
+// Drops the least recently used samples until the cache fits its budget.
+// Pinned samples and the sample just loaded are never evicted.
+void PulseAudioLink::evictSamples(const std::string &keepSample)
+{
+    while (mSampleCacheBudget > 0 && mSampleCacheBytes > mSampleCacheBudget)
+    {
+        auto victim = mLoadedSounds.end();
+        for (auto it = mLoadedSounds.begin(); it != mLoadedSounds.end(); ++it)
+        {
+            if (it->second.pinned || 0 == it->second.bytes || it->first == keepSample)
+                continue;
+            if (victim == mLoadedSounds.end() || it->second.lastUse < victim->second.lastUse)
+                victim = it;
+        }
+        if (victim == mLoadedSounds.end())
+        {
+            PM_LOG_WARNING(MSGID_PULSE_LINK, INIT_KVCOUNT, \
+                "evictSamples: %zu bytes loaded, nothing left to evict under %zu bytes", \
+                mSampleCacheBytes, mSampleCacheBudget);
+            return;
+        }
+
+        RemoveSampleDeferData* data = (RemoveSampleDeferData*)malloc(sizeof(RemoveSampleDeferData));
+        if (!data)
+        {
+            PM_LOG_ERROR(MSGID_PULSE_LINK, INIT_KVCOUNT, "evictSamples: data handle is NULL");
+            return;
+        }
+        strncpy(data->samplename, victim->first.c_str(), sizeof(data->samplename)-1);
+        data->samplename[sizeof(data->samplename)-1] = '\0';
+        data->pacontext = mContext;
         pa_mainloop_get_api(mMainLoop)->defer_new(pa_mainloop_get_api(mMainLoop),
-                                                      &preloadDeferCB,
-                                                      data);
+                                                  &RemoveSampleDeferCB, data);
+
+        PM_LOG_DEBUG("PulseAudioLink::evictSamples: %s, %zu bytes, %u hits", \
+            victim->first.c_str(), victim->second.bytes, victim->second.hits);
+        mSampleCacheBytes -= victim->second.bytes;
+        mSoundReadiness.erase(victim->first);
+        mLoadedSounds.erase(victim);
+        ++mSampleCacheEvictions;
+    }
+}
 
-        // make sure we never loop for ever trying to load...
-        guint64 maxTime = getCurrentTimeInMs() + 5000;
-        while (data->snd.loading && getCurrentTimeInMs() < maxTime)
+pbnjson::JValue PulseAudioLink::getSampleCacheStats() const
+{
+    pbnjson::JValue stats = pbnjson::JObject();
+    stats.put("budgetBytes", (int64_t)mSampleCacheBudget);
+    stats.put("usedBytes", (int64_t)mSampleCacheBytes);
+    stats.put("hits", (int64_t)mSampleCacheHits);
+    stats.put("misses", (int64_t)mSampleCacheMisses);
+    stats.put("evictions", (int64_t)mSampleCacheEvictions);
+    stats.put("uploading", (int64_t)mPendingPreloads.size());
+
+    guint64 now = getCurrentTimeInMs();
+    pbnjson::JValue samples = pbnjson::JArray();
+    for (const auto &it : mLoadedSounds)
+    {
+        pbnjson::JValue sample = pbnjson::JObject();
+        sample.put("name", it.first);
+        sample.put("bytes", (int64_t)it.second.bytes);
+        sample.put("hits", (int64_t)it.second.hits);
+        sample.put("idleMs", (int64_t)(now - it.second.lastUse));
+        sample.put("pinned", it.second.pinned);
+        samples.append(sample);
+    }
+    stats.put("samples", samples);
+    return stats;
+}
+
+// "gainRamp":{"defaultMs":10, "curve":"linear"|"equalPower", "sinks":{"<sink>":ms}}
+void PulseAudioLink::configureGainRamp(const pbnjson::JValue &rampConfig)
+{
+    if (!rampConfig.isObject())
+        return;
+    std::string curveName;
+    if (rampConfig["curve"].isString())
+        curveName = rampConfig["curve"].asString();
+    PCM_RAMP_CURVE_E curve = PcmRamp::getCurve(curveName.c_str());
+    int defaultMs = PLAYBACK_RAMP_DEFAULT_MS;
+    if (rampConfig["defaultMs"].isNumber())
+        defaultMs = rampConfig["defaultMs"].asNumber<int>();
+    mPlaybackEngine.setGainRamp(std::string(), defaultMs, curve);
+
+    pbnjson::JValue sinks = rampConfig["sinks"];
+    if (sinks.isObject())
+    {
+        for (const auto &sink : sinks.children())
         {
-            usleep(1000);
+            if (sink.second.isNumber())
+                mPlaybackEngine.setGainRamp(sink.first.asString(), sink.second.asNumber<int>(), curve);
         }
-        data->lock();
-        if (data->snd.loading)
+    }
+    PM_LOG_INFO(MSGID_PULSE_LINK, INIT_KVCOUNT, "configureGainRamp: %d ms by default, curve %s", \
+        defaultMs, curveName.empty() ? "linear" : curveName.c_str());
+}
+
+int PulseAudioLink::getGainRampMs(const char *sink, int defaultMs)
+{
+    int milliseconds = defaultMs;
+    if (sink)
+        mPlaybackEngine.getGainRamp(sink, milliseconds);
+    return milliseconds;
+}
+
+void PulseAudioLink::configureLowLatency(const pbnjson::JValue &lowLatencyConfig)
+{
+    if (!lowLatencyConfig.isObject())
+        return;
+    bool enabled = false;
+    if (lowLatencyConfig.hasKey("enabled"))
+        enabled = lowLatencyConfig["enabled"].asBool();
+    mFeedbackStreamsPerSink = LOW_LATENCY_DEFAULT_STREAMS_PER_SINK;
+    if (lowLatencyConfig["streamsPerSink"].isNumber())
+        mFeedbackStreamsPerSink = std::min(LOW_LATENCY_MAX_STREAMS_PER_SINK,
+                                           std::max(1, lowLatencyConfig["streamsPerSink"].asNumber<int>()));
+    mFeedbackTargetLatency = 0;
+    if (lowLatencyConfig["targetLatencyMs"].isNumber())
+        mFeedbackTargetLatency = (pa_usec_t)std::max(0, lowLatencyConfig["targetLatencyMs"].asNumber<int>()) * PA_USEC_PER_MSEC;
+    mFeedbackBudget = LOW_LATENCY_DEFAULT_BUDGET_KB * 1024;
+    if (lowLatencyConfig["memoryBudgetKB"].isNumber())
+        mFeedbackBudget = (size_t)std::max(0, lowLatencyConfig["memoryBudgetKB"].asNumber<int>()) * 1024;
+
+    mFeedbackSinks.clear();
+    mFeedbackSoundNames.clear();
+    pbnjson::JValue sinks = lowLatencyConfig["sinks"];
+    if (sinks.isArray())
+    {
+        for (const pbnjson::JValue &sink : sinks.items())
         {
-            PM_LOG_ERROR(MSGID_PULSE_LINK, INIT_KVCOUNT,\
-                    "PulseAudioLink::preload: failed to load sample");
+            std::string sinkname;
+            if (sink.asString(sinkname) == CONV_OK && !sinkname.empty())
+                mFeedbackSinks.push_back(sinkname);
         }
-        else
+    }
+    pbnjson::JValue sounds = lowLatencyConfig["sounds"];
+    if (sounds.isArray())
+    {
+        for (const pbnjson::JValue &sound : sounds.items())
         {
-            if (!data->snd.isSuccess && data->s) pa_stream_disconnect(data->s);
+            std::string samplename;
+            if (sound.asString(samplename) == CONV_OK && !samplename.empty())
+                mFeedbackSoundNames.push_back(samplename);
         }
-        data->unlock();
-        data->unref();
     }
-    else
+    mLowLatencyEnabled = enabled && !mFeedbackSinks.empty() && !mFeedbackSoundNames.empty();
+    mFeedbackSounds.clear();
+    PM_LOG_INFO(MSGID_PULSE_LINK, INIT_KVCOUNT, "configureLowLatency: enabled:%d, %zu sink(s), %d stream(s) per sink", \
+        (int)mLowLatencyEnabled, mFeedbackSinks.size(), mFeedbackStreamsPerSink);
+    if (mLowLatencyEnabled && checkConnection())
+        armFeedbackStreams();
+}
+
+// Sounds are listed hottest first, the ones past the budget are played as samples
+void PulseAudioLink::stageFeedbackSounds()
+{
+    mFeedbackSounds.clear();
+    guint64 startTime = getCurrentTimeInMs();
+    size_t total = 0;
+    for (const std::string &samplename : mFeedbackSoundNames)
     {
-        PM_LOG_ERROR(MSGID_PULSE_LINK, INIT_KVCOUNT, \
-                "fstat Operation failed returning from here");
+        std::string path = utils::getSystemSoundPath(samplename);
+        FILE* f = fopen(path.c_str(), "r");
+        if (!f)
+        {
+            PM_LOG_WARNING(MSGID_PULSE_LINK, INIT_KVCOUNT, "stageFeedbackSounds: %s not found", path.c_str());
+            continue;
+        }
+        struct stat fileStat;
+        pa_sample_spec spec;
+        spec.format = PA_SAMPLE_S16LE;
+        spec.rate = DEFAULT_SAMPLE_RATE;
+        spec.channels = DEFAULT_CHANNELS;
+        std::shared_ptr<std::vector<uint8_t>> pcm = std::make_shared<std::vector<uint8_t>>();
+        if (0 == fstat(fileno(f), &fileStat))
+            readSoundPcm(f, fileStat.st_size, spec, mFeedbackSpec, *pcm);
         if (fclose(f))
+            PM_LOG_DEBUG("stageFeedbackSounds: Failed to close the file");
+
+        //Every stream of the pool is connected with the same spec
+        if (pcm->empty() || !pa_sample_spec_equal(&spec, &mFeedbackSpec))
         {
-            PM_LOG_DEBUG("PulseAudioLink::preload: Failed to close the file");
+            PM_LOG_WARNING(MSGID_PULSE_LINK, INIT_KVCOUNT, "stageFeedbackSounds: cannot stage %s", samplename.c_str());
+            continue;
         }
-        else
+        if (total + pcm->size() > mFeedbackBudget)
         {
-            PM_LOG_DEBUG("PulseAudioLink::preload: Successfully closed the file");
+            PM_LOG_INFO(MSGID_PULSE_LINK, INIT_KVCOUNT, "stageFeedbackSounds: %s exceeds the budget of %zu bytes", \
+                samplename.c_str(), mFeedbackBudget);
+            continue;
         }
+        total += pcm->size();
+        mFeedbackSounds[samplename] = pcm;
+    }
+    PM_LOG_INFO(MSGID_PULSE_LINK, INIT_KVCOUNT, "stageFeedbackSounds: %zu sound(s), %zu bytes in %llu ms", \
+        mFeedbackSounds.size(), total, (unsigned long long)(getCurrentTimeInMs() - startTime));
+}
+
+struct ArmFeedbackDeferData {
+    PulseAudioLink* link;
+    pa_context* pacontext;
+    pa_sample_spec spec;
+    pa_usec_t targetLatency;
+    std::vector<std::string> sinks;
+    int streamsPerSink;
+};
+
+// Stages the sounds in the spec of the server and connects the corked streams,
+// once per connection to Pulse
+void PulseAudioLink::armFeedbackStreams()
+{
+    if (!mLowLatencyEnabled || !mPulseAudioReady)
         return;
+    pa_sample_spec spec = mSinkSpec;
+    if (!pa_sample_spec_valid(&spec))
+    {
+        spec.format = PA_SAMPLE_S16LE;
+        spec.rate = DEFAULT_SAMPLE_RATE;
+        spec.channels = DEFAULT_CHANNELS;
     }
+    if (mFeedbackSounds.empty() || !pa_sample_spec_equal(&spec, &mFeedbackSpec))
+    {
+        mFeedbackSpec = spec;
+        stageFeedbackSounds();
+    }
+    if (mFeedbackStreamsArmed || mFeedbackSounds.empty())
+        return;
 
-    // success or failure, no need to try again
-    if (mLoadedSounds.find(samplename) == mLoadedSounds.end())
-        mLoadedSounds.insert(samplename);
+    ArmFeedbackDeferData* data = new ArmFeedbackDeferData;
+    data->link = this;
+    data->pacontext = mContext;
+    data->spec = mFeedbackSpec;
+    data->targetLatency = mFeedbackTargetLatency;
+    data->sinks = mFeedbackSinks;
+    data->streamsPerSink = mFeedbackStreamsPerSink;
+    pa_mainloop_get_api(mMainLoop)->defer_new(pa_mainloop_get_api(mMainLoop),
+                                              &ArmFeedbackStreamsDeferCB, data);
+    mFeedbackStreamsArmed = true;
+}
+
+// Called with the connection, once the pulse thread is gone
+void PulseAudioLink::releaseFeedbackStreams()
+{
+    for (FEEDBACK_STREAM_T *entry : mFeedbackStreams)
+    {
+        pa_stream_set_state_callback(entry->stream, NULL, NULL);
+        pa_stream_unref(entry->stream);
+        delete entry;
+    }
+    mFeedbackStreams.clear();
+    mFeedbackStreamsArmed = false;
+}
+
+void PulseAudioLink::ArmFeedbackStreamsDeferCB(pa_mainloop_api *a, pa_defer_event *e, void *userdata)
+{
+    PMTRACE_FUNCTION;
+    ArmFeedbackDeferData* data = (ArmFeedbackDeferData*)userdata;
+    for (const std::string &sink : data->sinks)
+    {
+        for (int i = 0; i < data->streamsPerSink; i++)
+            connectFeedbackStream(data->link, data->pacontext, data->spec, data->targetLatency, sink);
+    }
+    delete data;
+    a->defer_free(e);
+}
+
+PulseAudioLink::FEEDBACK_STREAM_T* PulseAudioLink::connectFeedbackStream(PulseAudioLink *link, pa_context *context,
+    const pa_sample_spec &spec, pa_usec_t targetLatency, const std::string &sink)
+{
+    pa_stream* stream = pa_stream_new(context, "feedback", &spec, NULL);
+    if (!stream)
+    {
+        PM_LOG_ERROR(MSGID_PULSE_LINK, INIT_KVCOUNT, "connectFeedbackStream: cannot create a stream for %s", sink.c_str());
+        return NULL;
+    }
+    FEEDBACK_STREAM_T *entry = new FEEDBACK_STREAM_T();
+    entry->stream = stream;
+    entry->sink = sink;
+    entry->state = eFeedbackArming;
+    entry->link = link;
+    entry->requestTime = 0;
+
+    //No prebuffering, a sound shorter than the buffer starts as soon as the stream is uncorked
+    pa_buffer_attr attr;
+    attr.maxlength = (uint32_t)-1;
+    attr.tlength = targetLatency ? (uint32_t)pa_usec_to_bytes(targetLatency, &spec) : (uint32_t)-1;
+    attr.prebuf = 0;
+    attr.minreq = (uint32_t)-1;
+    attr.fragsize = (uint32_t)-1;
+    int flags = PA_STREAM_START_CORKED;
+    if (targetLatency)
+        flags |= PA_STREAM_ADJUST_LATENCY;
+
+    pa_stream_set_state_callback(stream, feedback_stream_state_cb, entry);
+    link->mFeedbackStreams.push_back(entry);
+    if (pa_stream_connect_playback(stream, sink.c_str(), &attr, (pa_stream_flags_t)flags, NULL, NULL) < 0)
+    {
+        PM_LOG_ERROR(MSGID_PULSE_LINK, INIT_KVCOUNT, "connectFeedbackStream: cannot connect to %s: %s", \
+            sink.c_str(), pa_strerror(pa_context_errno(context)));
+        link->mFeedbackStreams.pop_back();
+        pa_stream_set_state_callback(stream, NULL, NULL);
+        pa_stream_unref(stream);
+        delete entry;
+        return NULL;
+    }
+    return entry;
+}
+
+// The sound is queued while the stream is still corked, the uncork starts it
+// and the stream is corked again once the sound is drained
+void PulseAudioLink::startFeedbackStream(FEEDBACK_STREAM_T *entry, const std::shared_ptr<const std::vector<uint8_t>> &pcm,
+                                         gint64 requestTime)
+{
+    entry->requestTime = requestTime;
+    if (pa_stream_write(entry->stream, pcm->data(), pcm->size(), NULL, 0, PA_SEEK_RELATIVE) < 0)
+    {
+        PM_LOG_ERROR(MSGID_PULSE_LINK, INIT_KVCOUNT, "startFeedbackStream: write failed on %s", entry->sink.c_str());
+        entry->state = eFeedbackIdle;
+        return;
+    }
+    entry->state = eFeedbackPlaying;
+    pa_operation *op = pa_stream_cork(entry->stream, 0, feedback_stream_uncork_cb, entry);
+    if (op)
+        pa_operation_unref(op);
+    op = pa_stream_drain(entry->stream, feedback_stream_drain_cb, entry);
+    if (op)
+        pa_operation_unref(op);
     else
-        PM_LOG_DEBUG("sample name %s already loaded", samplename);
+        feedback_stream_drain_cb(entry->stream, 0, entry);
+}
+
+void PulseAudioLink::feedback_stream_state_cb(pa_stream *s, void *userdata)
+{
+    FEEDBACK_STREAM_T *entry = (FEEDBACK_STREAM_T*)userdata;
+    switch (pa_stream_get_state(s))
+    {
+        case PA_STREAM_READY:
+            if (entry->pending)
+            {
+                startFeedbackStream(entry, entry->pending, entry->requestTime);
+                entry->pending.reset();
+            }
+            else
+                entry->state = eFeedbackIdle;
+            break;
+
+        case PA_STREAM_FAILED:
+        case PA_STREAM_TERMINATED:
+        {
+            PM_LOG_WARNING(MSGID_PULSE_LINK, INIT_KVCOUNT, "feedback_stream_state_cb: stream on %s lost: %s", \
+                entry->sink.c_str(), pa_strerror(pa_context_errno(pa_stream_get_context(s))));
+            std::vector<FEEDBACK_STREAM_T*> &streams = entry->link->mFeedbackStreams;
+            streams.erase(std::remove(streams.begin(), streams.end(), entry), streams.end());
+            pa_stream_set_state_callback(s, NULL, NULL);
+            pa_stream_unref(s);
+            delete entry;
+            break;
+        }
+
+        default:
+            break;
+    }
+}
+
+void PulseAudioLink::feedback_stream_uncork_cb(pa_stream *s, int success, void *userdata)
+{
+    FEEDBACK_STREAM_T *entry = (FEEDBACK_STREAM_T*)userdata;
+    if (success && entry->requestTime)
+        postPlayLatency(newPlayLatencyProbe(entry->link, ePlayLatencyStream, entry->requestTime));
+}
+
+void PulseAudioLink::feedback_stream_drain_cb(pa_stream *s, int success, void *userdata)
+{
+    FEEDBACK_STREAM_T *entry = (FEEDBACK_STREAM_T*)userdata;
+    pa_operation *op = pa_stream_cork(s, 1, NULL, NULL);
+    if (op)
+        pa_operation_unref(op);
+    entry->state = eFeedbackIdle;
+}
+
+struct PlayFeedbackDeferData {
+    PulseAudioLink* link;
+    pa_context* pacontext;
+    std::string samplename;
+    std::string sink;
+    std::shared_ptr<const std::vector<uint8_t>> pcm;
+    pa_sample_spec spec;
+    pa_usec_t targetLatency;
+    gint64 requestTime;
+};
+
+void PulseAudioLink::PlayFeedbackDeferCB(pa_mainloop_api *a, pa_defer_event *e, void *userdata)
+{
+    PMTRACE_FUNCTION;
+    PlayFeedbackDeferData* data = (PlayFeedbackDeferData*)userdata;
+    FEEDBACK_STREAM_T *idle = NULL;
+    int sinkStreams = 0;
+    for (FEEDBACK_STREAM_T *entry : data->link->mFeedbackStreams)
+    {
+        if (entry->sink != data->sink)
+            continue;
+        ++sinkStreams;
+        if (eFeedbackIdle == entry->state)
+        {
+            idle = entry;
+            break;
+        }
+    }
+
+    if (idle)
+        startFeedbackStream(idle, data->pcm, data->requestTime);
+    else if (sinkStreams < LOW_LATENCY_MAX_STREAMS_PER_SINK)
+    {
+        //Every stream is busy, the sound starts once the added stream is ready
+        FEEDBACK_STREAM_T *entry = connectFeedbackStream(data->link, data->pacontext, data->spec,
+                                                         data->targetLatency, data->sink);
+        if (entry)
+        {
+            entry->pending = data->pcm;
+            entry->requestTime = data->requestTime;
+        }
+    }
+    else
+    {
+        //Played from the Pulse sample cache, if the sound was uploaded
+        PM_LOG_DEBUG("PulseAudioLink::PlayFeedbackDeferCB: no stream left on %s", data->sink.c_str());
+        PlayLatencyProbeData* probe = newPlayLatencyProbe(data->link, ePlayLatencySample, data->requestTime);
+        pa_operation * op = pa_context_play_sample(data->pacontext, data->samplename.c_str(), data->sink.c_str(),
+                                                   PA_VOLUME_NORM, play_sample_latency_cb, probe);
+        if (op)
+            pa_operation_unref(op);
+        else
+            delete probe;
+    }
+    delete data;
+    a->defer_free(e);
+}
+
+// Returns false if the sound or the sink is not handled in low latency mode
+bool PulseAudioLink::playLowLatency(const char * samplename, const char * sink, gint64 requestTime)
+{
+    if (nullptr == sink ||
+        std::find(mFeedbackSinks.begin(), mFeedbackSinks.end(), sink) == mFeedbackSinks.end())
+        return false;
+    //A reconnection stages the sounds again
+    if (!checkConnection() || !mFeedbackStreamsArmed)
+        return false;
+    auto sound = mFeedbackSounds.find(samplename);
+    if (sound == mFeedbackSounds.end())
+        return false;
+
+    PlayFeedbackDeferData* data = new PlayFeedbackDeferData;
+    data->link = this;
+    data->pacontext = mContext;
+    data->samplename = samplename;
+    data->sink = sink;
+    data->pcm = sound->second;
+    data->spec = mFeedbackSpec;
+    data->targetLatency = mFeedbackTargetLatency;
+    data->requestTime = requestTime;
+    pa_mainloop_get_api(mMainLoop)->defer_new(pa_mainloop_get_api(mMainLoop),
+                                              &PlayFeedbackDeferCB, data);
+    return true;
+}
+
+void PulseAudioLink::recordPlayLatency(PLAY_LATENCY_MODE_E mode, gint64 latencyUs)
+{
+    if (mode < 0 || mode >= ePlayLatencyModeCount)
+        return;
+    PLAY_LATENCY_PROBE_T &probe = mPlayLatency[mode];
+    if (0 == probe.count || latencyUs < probe.minUs)
+        probe.minUs = latencyUs;
+    if (0 == probe.count || latencyUs > probe.maxUs)
+        probe.maxUs = latencyUs;
+    probe.totalUs += latencyUs;
+    ++probe.count;
+}
+
+pbnjson::JValue PulseAudioLink::getPlayLatencyStats() const
+{
+    static const char * const modeNames[ePlayLatencyModeCount] = {"sample", "stream"};
+    pbnjson::JValue stats = pbnjson::JObject();
+    stats.put("lowLatency", mLowLatencyEnabled);
+    size_t stagedBytes = 0;
+    for (const auto &it : mFeedbackSounds)
+        stagedBytes += it.second->size();
+    stats.put("stagedSounds", (int64_t)mFeedbackSounds.size());
+    stats.put("stagedBytes", (int64_t)stagedBytes);
+
+    for (int mode = 0; mode < ePlayLatencyModeCount; mode++)
+    {
+        const PLAY_LATENCY_PROBE_T &probe = mPlayLatency[mode];
+        pbnjson::JValue latency = pbnjson::JObject();
+        latency.put("count", (int64_t)probe.count);
+        latency.put("avgUs", (int64_t)(probe.count ? probe.totalUs / probe.count : 0));
+        latency.put("minUs", (int64_t)probe.minUs);
+        latency.put("maxUs", (int64_t)probe.maxUs);
+        stats.put(modeNames[mode], latency);
+    }
+    return stats;
+}
+
+void PulseAudioLink::completePreload(const std::string &samplename, bool isSuccess)
+{
+    auto it = mPendingPreloads.find(samplename);
+    if (it == mPendingPreloads.end())
+        return;
+    std::vector<const char*> pendingSinks;
+    pendingSinks.swap(it->second.pendingSinks);
+    mPendingPreloads.erase(it);
+
+    PM_LOG_DEBUG("PulseAudioLink::completePreload: %s status:%d queued plays:%zu", \
+        samplename.c_str(), (int)isSuccess, pendingSinks.size());
+    if (pendingSinks.empty() || !checkConnection())
+        return;
+    for (const auto &sink : pendingSinks)
+        playSample(samplename.c_str(), sink);
 }
 
 void* PulseAudioLink::pathread_func(void* p) {
@@ -665,14 +1546,7 @@ void* PulseAudioLink::pathread_func(void* p) {
     return (void*)ret;
 }
 
-#define DTMF_SAMPLE_RATE 44100
-#ifdef MACHINE_NO_LONGDTMF
-#define DTMF_SAMPLE (DTMF_SAMPLE_RATE/5)  // 0.2s for short dtmf
-#else
-#define DTMF_SAMPLE DTMF_SAMPLE_RATE
-#endif
 #define DTMF_SAMPLE_BYTES_PER_FRAME 2
-#define DTMF_FADE_SAMPLES (DTMF_SAMPLE_RATE/50)   // 0.02s
 
 enum DtmfSine {
     Sine_697,
@@ -704,52 +1578,54 @@ static int dtmf_mapping[Dtmf_ArrayCount][2] = {
     {Sine_941, Sine_1477},
 };
 
-static bool dtmf_buffer_intiailized = false;
-static gint16 dtmf_buffer[Dtmf_ArrayCount][DTMF_SAMPLE];
-
-static void initializeDtmf() {
-    if (dtmf_buffer_intiailized) return;
-    dtmf_buffer_intiailized = true;
-
-    struct timeval tv1, tv2;
-    gettimeofday(&tv1, NULL);
-#define FLOAT_TYPE double
-    FLOAT_TYPE* sine_buffer= new FLOAT_TYPE[Sine_ArrayCount*DTMF_SAMPLE];
-    for (DtmfSine i=(DtmfSine)0; i<Sine_ArrayCount; i=(DtmfSine)(i+1) ) {
-        FLOAT_TYPE temp = M_PI*2*sine_frequency[i]/DTMF_SAMPLE_RATE;
-        FLOAT_TYPE* b = sine_buffer + i * DTMF_SAMPLE;
-        for (int j = 0; j < DTMF_SAMPLE; ++j)
-            b[j] = sin((FLOAT_TYPE) j * temp)/2;
-    }
-    for (Dtmf i=(Dtmf)0; i<Dtmf_ArrayCount; i=(Dtmf)(i+1)) {
-        gint16* dtmf_buffer_i = dtmf_buffer[i];
-        FLOAT_TYPE* sine1 = sine_buffer + dtmf_mapping[i][0] * DTMF_SAMPLE;
-        FLOAT_TYPE* sine2 = sine_buffer + dtmf_mapping[i][1] * DTMF_SAMPLE;
-        for (int j=0; j<DTMF_SAMPLE; ++j) {
-            dtmf_buffer_i[j] = (gint16)((sine1[j] + sine2[j]) *16384);
-        }
-    }
-    delete[] sine_buffer;
-#undef FLOAT_TYPE
-    gettimeofday(&tv2, NULL);
-    PM_LOG_INFO(MSGID_PULSEAUDIO_MIXER, INIT_KVCOUNT,\
-        "initializeDtmf in %d ms\n",(int)((tv2.tv_sec - tv1.tv_sec)*1000) + \
-        (int)((tv2.tv_usec - tv1.tv_usec)/1000));
-
-}
-
-PulseDtmfGenerator::PulseDtmfGenerator(Dtmf tone, int milliseconds)
-:PulseAudioDataProvider(),mDtmf(tone),mWritePos(0)
+PulseDtmfGenerator::PulseDtmfGenerator(Dtmf tone, int milliseconds, int sampleRate, int fadeMs)
+:PulseAudioDataProvider(),mDtmf(tone)
 ,mAccumulatedSamples(0),mPlaySamples(0)
+,mOscillator(sine_frequency[dtmf_mapping[tone][0]], sine_frequency[dtmf_mapping[tone][1]],
+    sampleRate > 0 ? sampleRate : DTMF_SAMPLE_RATE)
 {
-    if (milliseconds>0) mPlaySamples = DTMF_SAMPLE_RATE / 1000 * milliseconds;
+    sampleRate = mOscillator.getSampleRate();
+    mSampleSpec.rate = sampleRate;
+    mFadeSamples = (int)((gint64)sampleRate * std::max(0, fadeMs) / 1000);
+    if (milliseconds>0) mPlaySamples = (int)((gint64)sampleRate * milliseconds / 1000);
     setAudioEffect(AUDIO_EFFECT_FADE_OUT | AUDIO_EFFECT_FADE_IN);
 }
 
 PulseDtmfGenerator::~PulseDtmfGenerator(){}
 
-// stream_write_callback() is invoked from single thread, safe to make it global
-static gint16 fadebuffer[DTMF_FADE_SAMPLES];
+void PulseDtmfGenerator::generateTone(gint16 *buffer, int samples)
+{
+    mOscillator.generate(buffer, samples);
+}
+
+// Linear fades, the ramp is placed where the tone is in its fade
+void PulseDtmfGenerator::applyFades(gint16 *buffer, int samples, bool isStopping)
+{
+    if (mFadeSamples <= 0)
+        return;
+    PCM_RAMP_T ramp;
+    if ((mAudioEffect & AUDIO_EFFECT_FADE_IN) && mAccumulatedSamples < mFadeSamples) {
+        PcmRamp::start(ramp, 0, PCM_MIXER_GAIN_UNITY, mFadeSamples, ePcmRampLinear);
+        ramp.position = mAccumulatedSamples;
+        PcmRamp::apply(ramp, buffer, std::min(samples, mFadeSamples - mAccumulatedSamples), PA_SAMPLE_S16LE, 1);
+    }
+    if (!(mAudioEffect & AUDIO_EFFECT_FADE_OUT))
+        return;
+    int first;
+    if (mPlaySamples>0 && mAccumulatedSamples + samples > mPlaySamples - mFadeSamples) {
+        // fixed duration: fade out over the last samples of the tone
+        first = std::max(0, mPlaySamples - mFadeSamples - mAccumulatedSamples);
+        PcmRamp::start(ramp, PCM_MIXER_GAIN_UNITY, 0, mFadeSamples, ePcmRampLinear);
+        ramp.position = mAccumulatedSamples + first - (mPlaySamples - mFadeSamples);
+    } else if (isStopping) {
+        // stopped by the user: fade out at the end of this buffer
+        first = std::max(0, samples - mFadeSamples);
+        PcmRamp::start(ramp, PCM_MIXER_GAIN_UNITY, 0, mFadeSamples, ePcmRampLinear);
+        ramp.position = mFadeSamples - (samples - first);
+    } else
+        return;
+    PcmRamp::apply(ramp, buffer + first, samples - first, PA_SAMPLE_S16LE, 1);
+}
 
 bool PulseDtmfGenerator::stream_write_callback(pa_stream *stream, size_t length)
 {
@@ -766,274 +1642,32 @@ bool PulseDtmfGenerator::stream_write_callback(pa_stream *stream, size_t length)
         pthread_mutex_unlock(&mutex);
         return false;
     }
-    gint16* b = dtmf_buffer[mDtmf];
     int samples = length/DTMF_SAMPLE_BYTES_PER_FRAME;
-    while (samples>0) {
-        int samplesToPlay;
-        if (mWritePos+samples>=DTMF_SAMPLE) samplesToPlay = DTMF_SAMPLE-mWritePos;
-        else samplesToPlay = samples;
-        if (mPlaySamples>0 && mAccumulatedSamples+samplesToPlay>=mPlaySamples) {
-            samplesToPlay = mPlaySamples-mAccumulatedSamples;
-        }
-
-        if (samplesToPlay>0) {
-            int fadeInSamples = 0;
-            int normalSamples = samplesToPlay;
-            int fadeOutSamples = 0;
-            if ((mAudioEffect | AUDIO_EFFECT_FADE_IN)) {
-                if (mAccumulatedSamples < DTMF_FADE_SAMPLES) {
-                    fadeInSamples = DTMF_FADE_SAMPLES - mAccumulatedSamples;
-                    if (fadeInSamples>samplesToPlay) fadeInSamples = samplesToPlay;
-                    normalSamples = samplesToPlay - fadeInSamples;
-                    gint16 * originalbuffer = b+mWritePos;
-                    for (int i=0; i<fadeInSamples; i++) {
-                        fadebuffer[i] = originalbuffer[i] *
-                                        (mAccumulatedSamples+i) /
-                                         DTMF_FADE_SAMPLES;
-                    }
-                }
-            }
-            if (fadeInSamples>0) pa_stream_write(stream,
-                                                 fadebuffer,
-                                                 fadeInSamples*DTMF_SAMPLE_BYTES_PER_FRAME,
-                                                 NULL,
-                                                 0,
-                                                 PA_SEEK_RELATIVE );
-
-
-            if (normalSamples>0 && (mAudioEffect | AUDIO_EFFECT_FADE_OUT)) {
-                if ((mPlaySamples>0 && mAccumulatedSamples + samplesToPlay >
-                                       mPlaySamples - DTMF_FADE_SAMPLES) ) {
-                    normalSamples = mPlaySamples -
-                                    DTMF_FADE_SAMPLES -
-                                    mAccumulatedSamples -
-                                    fadeInSamples; // could be <0
-                    fadeOutSamples = normalSamples>=0?
-                                     (samplesToPlay - normalSamples - fadeInSamples) :
-                                     (samplesToPlay-fadeInSamples);
-                    gint16 * originalbuffer = b+mWritePos+fadeInSamples + normalSamples;
-                    if (normalSamples>0) {
-                        for (int i=0; i<fadeOutSamples; i++) {
-                            fadebuffer[i] = originalbuffer[i] *
-                                            (DTMF_FADE_SAMPLES-i) /
-                                             DTMF_FADE_SAMPLES;
-                        }
-                    } else {
-                        for (int i=0; i<fadeOutSamples; i++) {
-                            fadebuffer[i] = originalbuffer[i] *
-                                            (DTMF_FADE_SAMPLES-i-normalSamples) /
-                                            DTMF_FADE_SAMPLES;
-                        }
-                        normalSamples = 0;
-                    }
-                } else if (isStopping && samples - samplesToPlay < DTMF_FADE_SAMPLES) {
-                    fadeOutSamples = samplesToPlay - (samples-DTMF_FADE_SAMPLES); // >0
-                    if (fadeOutSamples > normalSamples) fadeOutSamples = normalSamples;
-                    normalSamples = normalSamples - fadeOutSamples;
-                    gint16 * originalbuffer = b+mWritePos+fadeInSamples + normalSamples;
-                    for (int i=0; i<fadeOutSamples; i++) {
-                        fadebuffer[i] = originalbuffer[i] *
-                                        (samples - samplesToPlay + fadeOutSamples - i) /
-                                         DTMF_FADE_SAMPLES;
-                    }
-                }
-            }
-            if (normalSamples>0) {
-                pa_stream_write(stream,
-                                b+mWritePos+fadeInSamples,
-                                normalSamples*DTMF_SAMPLE_BYTES_PER_FRAME,
-                                NULL,
-                                0,
-                                PA_SEEK_RELATIVE );
-            }
-            if (fadeOutSamples>0) {
-                pa_stream_write(stream,
-                                fadebuffer,
-                                fadeOutSamples*DTMF_SAMPLE_BYTES_PER_FRAME,
-                                NULL,
-                                0,
-                                PA_SEEK_RELATIVE );
-            }
-
-            mWritePos += samplesToPlay;
-            if (mWritePos==DTMF_SAMPLE) mWritePos=0;
-            mAccumulatedSamples+=samplesToPlay;
-            samples -= samplesToPlay;
-        } else {
-            isStopping = true;
-            break;
-        }
-    }
-    pthread_mutex_unlock(&mutex);
-    if (isStopping) {
-        return false;
-    } else return true;
-
-}
-
-PlaybackThread::PlaybackThread(MixerInterface* mixerCallBack, std::string playbackID)
-{
-    mCallback = mixerCallBack;
-    mPlaybackId = playbackID;
-    mDataAvailable = false;
-    fptr = NULL;
-    mStream = NULL;
-    mPlayData = NULL;
-}
-
-bool PlaybackThread::playThread()
-{
-    // Read and write data in chunks of 1024 bytes
-    size_t dataSize = 1024;
-    mPlayData = (uint8_t*)malloc(dataSize);
-    if (!mPlayData)
-    {
-        pa_simple_free(mStream);
-        if(fptr != nullptr)
-        {
-            if(fclose(fptr))
-            {
-                PM_LOG_ERROR(MSGID_PULSE_LINK, INIT_KVCOUNT,"PulseAudioLink::playThread: Error closing file");
-            }
-        }
-        playbackState = "error";
-        PM_LOG_DEBUG(" PlaybackThread::playThread playbackState = %s", playbackState.c_str());
-        playbackStatusChanged(mPlaybackId, playbackState);
-        return false;
-    }
-    playbackState = "playing";
-    PM_LOG_DEBUG(" PlaybackThread::playThread playbackState = %s", playbackState.c_str());
-    while (mDataAvailable) {
-    // Read data from the file
-    size_t n = fread(mPlayData, 1, dataSize, fptr);
-    if (n <= 0) {
-        playbackState = "stopped";
-        playbackStatusChanged(mPlaybackId, playbackState);
-        mDataAvailable = false;
-        break;
-    }
-    // Write data to the stream
-    if (pa_simple_write(mStream, mPlayData, n, NULL) < 0) {
-        break;
-    }
-    }
-    mDataAvailable = false;
-    return true;
-}
-
-
-bool PlaybackThread::play(const char * samplename, const char * sink, const char * format, int rate, int channels)
-{
-    PMTRACE_FUNCTION;
-    PM_LOG_DEBUG(" PlaybackThread::play");
-
-    if (nullptr == samplename)
-        return false;
-
-    fptr = fopen(samplename, "r");
-    if (!fptr)
-    {
-        PM_LOG_ERROR(MSGID_PULSE_LINK, INIT_KVCOUNT,\
-                "PulseAudioLink::play: File Open Failed");
-        return false;
-    }
-    pa_sample_spec ss;
-    if (std::strncmp(format, "PA_SAMPLE_S16LE", 15) == 0)
-        ss.format = PA_SAMPLE_S16LE;
-    else if (std::strncmp(format,"PA_SAMPLE_S24LE", 15) == 0)
-        ss.format = PA_SAMPLE_S24LE;
-    else
-        ss.format = PA_SAMPLE_S32LE;
-    ss.channels = channels;
-    ss.rate = rate;
-    mStream = pa_simple_new(NULL, NULL, PA_STREAM_PLAYBACK, sink,
-            "playback", &ss, NULL, NULL, NULL);
-    if (!mStream)
-    {
-        PM_LOG_ERROR(MSGID_PULSE_LINK, INIT_KVCOUNT,\
-                "PulseAudioLink::play: failed to create stream");
-        playbackState = "error";
-        PM_LOG_DEBUG(" PlaybackThread::play playbackState = %s", playbackState.c_str());
-        return false;
-    }
-    mDataAvailable = true;
-    playbackThread = std::thread(&PlaybackThread::playThread, this);
-    return true;
-}
-
-bool PlaybackThread::pause()
-{
-    PM_LOG_DEBUG(" PlaybackThread::pause");
-    if (playbackState != "playing")
-        return false;
-    if (pa_simple_cork(mStream, 1, NULL) < 0) {
-        PM_LOG_ERROR(MSGID_PULSE_LINK, INIT_KVCOUNT,\
-                "PulseAudioLink::pause: Failed to pause stream");
-        free((void*)mPlayData);
-        pa_simple_free(mStream);
-        playbackState = "error";
-        PM_LOG_DEBUG(" PlaybackThread::pause playbackState = %s", playbackState.c_str());
-        playbackStatusChanged(mPlaybackId, playbackState);
+    if (mPlaySamples>0 && mAccumulatedSamples+samples>mPlaySamples)
+        samples = mPlaySamples-mAccumulatedSamples;
+    if (samples<=0) {
+        pthread_mutex_unlock(&mutex);
         return false;
     }
-    playbackState = "paused";
-    PM_LOG_DEBUG(" PlaybackThread::pause playbackState = %s", playbackState.c_str());
-    playbackStatusChanged(mPlaybackId, playbackState);
-    return true;
-}
 
-bool PlaybackThread::resume()
-{
-    PM_LOG_DEBUG(" PlaybackThread::resume");
-    if (playbackState != "paused")
-        return false;
-    if (pa_simple_cork(mStream, 0, NULL) < 0) {
+    void *data = NULL;
+    size_t bytes = samples*DTMF_SAMPLE_BYTES_PER_FRAME;
+    if (pa_stream_begin_write(stream, &data, &bytes) < 0 || !data) {
         PM_LOG_ERROR(MSGID_PULSE_LINK, INIT_KVCOUNT,\
-                "PulseAudioLink::resume: Failed to resume stream");
-        free((void*)mPlayData);
-        pa_simple_free(mStream);
-        playbackState = "error";
-        PM_LOG_DEBUG(" PlaybackThread::resume playbackState = %s", playbackState.c_str());
-        playbackStatusChanged(mPlaybackId, playbackState);
-        return false;
-    }
-    playbackState = "playing";
-    PM_LOG_DEBUG(" PlaybackThread::resume playbackState = %s", playbackState.c_str());
-    playbackStatusChanged(mPlaybackId, playbackState);
-    return true;
-}
-
-bool PlaybackThread::stop()
-{
-    PM_LOG_DEBUG(" PlaybackThread::stop");
-    if (pa_simple_flush(mStream, NULL) < 0) {
-        free((void*)mPlayData);
-        pa_simple_free(mStream);
-        playbackState = "error";
-        PM_LOG_DEBUG(" PlaybackThread::stop playbackState = %s", playbackState.c_str());
-        playbackStatusChanged(mPlaybackId, playbackState);
+            "stream_write_callback: pa_stream_begin_write failed");
+        pthread_mutex_unlock(&mutex);
         return false;
     }
-    mDataAvailable = false;
-    playbackThread.join();
-    free(mPlayData);
-
-    pa_simple_free(mStream);
-    if(playbackState != "stopped")
-    {
-        playbackState = "stopped";
-        PM_LOG_DEBUG(" PlaybackThread::stop playbackState = %s", playbackState.c_str());
-        playbackStatusChanged(mPlaybackId, playbackState);
-    }
-    return true;
-}
-
-std::string PlaybackThread::getPlaybackStatus()
-{
-    return playbackState;
-}
-
-void PlaybackThread::playbackStatusChanged(std::string playbackID, std::string state)
-{
-   mCallback->callBackPlaybackStatusChanged(playbackID, state);
+    if ((int)(bytes/DTMF_SAMPLE_BYTES_PER_FRAME) < samples)
+        samples = bytes/DTMF_SAMPLE_BYTES_PER_FRAME;
+
+    gint16 *buffer = (gint16*)data;
+    generateTone(buffer, samples);
+    applyFades(buffer, samples, isStopping);
+    pa_stream_write(stream, buffer, samples*DTMF_SAMPLE_BYTES_PER_FRAME, NULL, 0, PA_SEEK_RELATIVE);
+    mAccumulatedSamples += samples;
+    if (mPlaySamples>0 && mAccumulatedSamples>=mPlaySamples)
+        isStopping = true;
+    pthread_mutex_unlock(&mutex);
+    return !isStopping;
 }
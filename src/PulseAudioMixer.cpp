@@ -32,6 +32,9 @@
 
 const int cMinTimeout = 50;
 const int cMaxTimeout = 5000;
+//Time allowed for pulseaudio to reply to a request before its caller gets a failure
+const guint64 cPulseReplyTimeout = 3000;
+const int cPendingRequestCheckInterval = 500;
 
 PulseAudioMixer::PulseAudioMixer(MixerInterface* mixerCallBack) : mChannel(0),
                                      mTimeout(cMinTimeout),
@@ -52,6 +55,15 @@ PulseAudioMixer::PulseAudioMixer(MixerInterface* mixerCallBack) : mChannel(0),
                                      mEffectGainControlEnabled(false),
                                      mEffectBeamformingEnabled(false),
                                      mEffectDynamicRangeCompressorEnabled(false),
+                                     mPendingTimerID(0),
+                                     mSendHead(0),
+                                     mSendCount(0),
+                                     mSendOffset(0),
+                                     mSendSourceID(0),
+                                     mRecvLength(0),
+                                     mRecvFrameCount(0),
+                                     mShortReadCount(0),
+                                     mMalformedFrameCount(0),
                                      mObjMixerCallBack(mixerCallBack)
 {
     // initialize table for the pulse state lookup table
@@ -75,6 +87,9 @@ PulseAudioMixer::PulseAudioMixer(MixerInterface* mixerCallBack) : mChannel(0),
 PulseAudioMixer::~PulseAudioMixer()
 {
     PM_LOG_DEBUG("PulseAudioMixer destructor");
+    if (mPendingTimerID)
+        g_source_remove(mPendingTimerID);
+    resetSendQueue();
 }
 
 paudiodMsgHdr PulseAudioMixer::addAudioMsgHeader(uint8_t msgType, uint8_t msgID)
@@ -88,9 +103,197 @@ paudiodMsgHdr PulseAudioMixer::addAudioMsgHeader(uint8_t msgType, uint8_t msgID)
     return audioMsgHdr;
 }
 
+static gboolean
+_pendingRequestTimer(gpointer data)
+{
+    PulseAudioMixer *pulseMixerObj = (PulseAudioMixer*)data;
+    if (pulseMixerObj)
+        return pulseMixerObj->_expirePendingRequests();
+    PM_LOG_ERROR(MSGID_PULSEAUDIO_MIXER, INIT_KVCOUNT, "_pendingRequestTimer: pulseMixerObj is null");
+    return FALSE;
+}
+
+uint32_t PulseAudioMixer::addPendingRequest(uint32_t replyID, const pulseCallBackInfo &pci)
+{
+    pulseCallBackInfo pending = pci;
+    pending.replyID = replyID;
+    pending.deadline = getCurrentTimeInMs() + cPulseReplyTimeout;
+    uint32_t sequence = mReplyTracker.add(replyID, pending.deadline);
+    mPulseCallBackInfo[sequence] = pending;
+
+    if (0 == mPendingTimerID)
+        mPendingTimerID = g_timeout_add(cPendingRequestCheckInterval, ::_pendingRequestTimer, this);
+    PM_LOG_DEBUG("addPendingRequest: seq:%u reply id:%u pending:%zu", sequence, replyID, mPulseCallBackInfo.size());
+    return sequence;
+}
+
+void PulseAudioMixer::completePendingRequest(uint32_t replyID, bool status)
+{
+    uint32_t sequence = mReplyTracker.complete(replyID);
+    auto it = mPulseCallBackInfo.find(sequence);
+    if (it == mPulseCallBackInfo.end())
+    {
+        PM_LOG_INFO(MSGID_PULSEAUDIO_MIXER, INIT_KVCOUNT,\
+            "no pending request for reply id %u, late replies so far:%u", replyID, mReplyTracker.getLateReplies());
+        return;
+    }
+    pulseCallBackInfo cbk = it->second;
+    mPulseCallBackInfo.erase(it);
+    PM_LOG_DEBUG("completePendingRequest: seq:%u reply id:%u status:%d", sequence, replyID, (int)status);
+    if (cbk.cb)
+        cbk.cb(cbk.lshandle, cbk.message, cbk.ctx, status);
+    else
+        PM_LOG_INFO(MSGID_PULSEAUDIO_MIXER, INIT_KVCOUNT, "CallBack function is null");
+}
+
+bool PulseAudioMixer::_expirePendingRequests()
+{
+    std::vector<pulseCallBackInfo> expired;
+    for (uint32_t sequence : mReplyTracker.expire(getCurrentTimeInMs()))
+    {
+        auto it = mPulseCallBackInfo.find(sequence);
+        if (it == mPulseCallBackInfo.end())
+            continue;
+        PM_LOG_WARNING(MSGID_PULSEAUDIO_MIXER, INIT_KVCOUNT,\
+            "no reply from pulse for seq:%u reply id:%u, failing the request", sequence, it->second.replyID);
+        expired.push_back(it->second);
+        mPulseCallBackInfo.erase(it);
+    }
+    if (mPulseCallBackInfo.empty())
+        mPendingTimerID = 0;
+    bool keepTimer = (0 != mPendingTimerID);
+
+    //Callbacks may issue new requests, so call them once the table is consistent
+    for (const auto &cbk : expired)
+    {
+        if (cbk.cb)
+            cbk.cb(cbk.lshandle, cbk.message, cbk.ctx, false);
+    }
+    return keepTimer;
+}
+
+void PulseAudioMixer::failAllPendingRequests()
+{
+    std::map<uint32_t, pulseCallBackInfo> pending;
+    pending.swap(mPulseCallBackInfo);
+    mReplyTracker.clear();
+    if (mPendingTimerID)
+    {
+        g_source_remove(mPendingTimerID);
+        mPendingTimerID = 0;
+    }
+    for (const auto &it : pending)
+    {
+        PM_LOG_WARNING(MSGID_PULSEAUDIO_MIXER, INIT_KVCOUNT,\
+            "pulse connection lost, failing request seq:%u reply id:%u", it.first, it.second.replyID);
+        if (it.second.cb)
+            it.second.cb(it.second.lshandle, it.second.message, it.second.ctx, false);
+    }
+}
+
+static gboolean
+_pulseWritable(GIOChannel *ch, GIOCondition condition, gpointer user_data)
+{
+    PulseAudioMixer *pulseMixerObj = (PulseAudioMixer*)user_data;
+    if (pulseMixerObj)
+        return pulseMixerObj->_pulseWritable(ch, condition);
+    PM_LOG_ERROR(MSGID_PULSEAUDIO_MIXER, INIT_KVCOUNT, "_pulseWritable: pulseMixerObj is null");
+    return FALSE;
+}
+
+char* PulseAudioMixer::reserveSendFrame()
+{
+    //Give the socket a chance to take the queued frames before giving up
+    if (PULSE_SEND_RING_SIZE == mSendCount)
+        flushSendQueue();
+    if (PULSE_SEND_RING_SIZE == mSendCount)
+        return nullptr;
+
+    char *frame = mSendRing[(mSendHead + mSendCount) % PULSE_SEND_RING_SIZE];
+    memset(frame, 0, SIZE_MESG_TO_PULSE);
+    return frame;
+}
+
+void PulseAudioMixer::commitSendFrame()
+{
+    mSendCount++;
+    if (0 == mSendSourceID)
+        mSendSourceID = g_io_add_watch(mChannel, G_IO_OUT, ::_pulseWritable, this);
+}
+
+bool PulseAudioMixer::flushSendQueue()
+{
+    if (mChannel == nullptr)
+        return false;
+
+    int sockfd = g_io_channel_unix_get_fd (mChannel);
+    while (mSendCount > 0)
+    {
+        //Queued frames are contiguous in the ring except when they wrap around
+        struct iovec iov[2];
+        int contiguous = std::min(mSendCount, PULSE_SEND_RING_SIZE - mSendHead);
+        iov[0].iov_base = mSendRing[mSendHead] + mSendOffset;
+        iov[0].iov_len = (size_t)contiguous * SIZE_MESG_TO_PULSE - mSendOffset;
+        iov[1].iov_base = mSendRing[0];
+        iov[1].iov_len = (size_t)(mSendCount - contiguous) * SIZE_MESG_TO_PULSE;
+
+        struct msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = iov;
+        msg.msg_iovlen = (contiguous < mSendCount) ? 2 : 1;
+
+        ssize_t bytes = sendmsg(sockfd, &msg, MSG_DONTWAIT | MSG_NOSIGNAL);
+        if (bytes < 0)
+        {
+            if (EINTR == errno)
+                continue;
+            if (EAGAIN != errno && EWOULDBLOCK != errno)
+                PM_LOG_ERROR(MSGID_PULSEAUDIO_MIXER, INIT_KVCOUNT, "flushSendQueue: send to Pulse failed: %s", strerror(errno));
+            return false;
+        }
+
+        size_t sent = mSendOffset + (size_t)bytes;
+        int frames = sent / SIZE_MESG_TO_PULSE;
+        mSendOffset = sent % SIZE_MESG_TO_PULSE;
+        mSendHead = (mSendHead + frames) % PULSE_SEND_RING_SIZE;
+        mSendCount -= frames;
+        PM_LOG_DEBUG("flushSendQueue: %d frame(s) sent to Pulse, %d queued", frames, mSendCount);
+        if (mSendOffset)
+            PM_LOG_INFO(MSGID_PULSEAUDIO_MIXER, INIT_KVCOUNT, "flushSendQueue: partial frame sent, %zu of %d bytes", \
+                mSendOffset, SIZE_MESG_TO_PULSE);
+    }
+    return true;
+}
+
+void PulseAudioMixer::resetSendQueue()
+{
+    if (mSendCount)
+        PM_LOG_WARNING(MSGID_PULSEAUDIO_MIXER, INIT_KVCOUNT, "resetSendQueue: dropping %d frame(s) queued for Pulse", mSendCount);
+    mSendHead = 0;
+    mSendCount = 0;
+    mSendOffset = 0;
+    if (mSendSourceID)
+    {
+        g_source_remove(mSendSourceID);
+        mSendSourceID = 0;
+    }
+}
+
+bool PulseAudioMixer::_pulseWritable(GIOChannel *ch, GIOCondition condition)
+{
+    //Socket errors are handled by _pulseStatus, which resets the queue
+    if ((condition & (G_IO_ERR | G_IO_HUP)) || flushSendQueue())
+    {
+        mSendSourceID = 0;
+        return FALSE;
+    }
+    return TRUE;
+}
+
 template<typename T>
-bool PulseAudioMixer::sendDataToPulse (uint32_t msgType, uint32_t msgID, T subObj)
+bool PulseAudioMixer::sendDataToPulse (uint32_t msgType, uint32_t msgID, T subObj, const pulseCallBackInfo *pci)
 {
+    static_assert(sizeof(struct paudiodMsgHdr) + sizeof(T) <= SIZE_MESG_TO_PULSE, "message does not fit in a pulse frame");
     paudiodMsgHdr audioMsgHdr = addAudioMsgHeader(msgType, msgID);
 
     if (mChannel == nullptr)
@@ -98,7 +301,7 @@ bool PulseAudioMixer::sendDataToPulse (uint32_t msgType, uint32_t msgID, T subOb
         PM_LOG_ERROR(MSGID_PULSEAUDIO_MIXER, INIT_KVCOUNT, "pulse connection is not available");
         return false;
     }
-    char *data=(char*)malloc(sizeof(struct paudiodMsgHdr) + sizeof(T));
+    char *data = reserveSendFrame();
 
     if (data)
     {
@@ -106,24 +309,16 @@ bool PulseAudioMixer::sendDataToPulse (uint32_t msgType, uint32_t msgID, T subOb
         memcpy(data, &audioMsgHdr, sizeof(struct paudiodMsgHdr));
         memcpy(data + sizeof(struct paudiodMsgHdr), &subObj, sizeof(T));
 
-        int sockfd = g_io_channel_unix_get_fd (mChannel);
-        ssize_t bytes = send(sockfd, data, SIZE_MESG_TO_PULSE, MSG_DONTWAIT);
+        //Register before queuing, the reply can only be read after we return to the main loop
+        if (pci)
+            addPendingRequest(msgID, *pci);
 
-        free(data);
-
-        if (bytes != SIZE_MESG_TO_PULSE)
-        {
-            if (bytes >= 0)
-                PM_LOG_INFO(MSGID_PULSEAUDIO_MIXER, INIT_KVCOUNT, "sendDataToPulse: only %u bytes sent to Pulse out of %d (%s).", \
-                                       bytes, SIZE_MESG_TO_PULSE, strerror(errno));
-            else
-                PM_LOG_ERROR(MSGID_PULSEAUDIO_MIXER, INIT_KVCOUNT, "sendHeaderToPA: send to Pulse failed: %s", strerror(errno));
-        }
+        commitSendFrame();
     }
     else
     {
         PM_LOG_ERROR(MSGID_PULSEAUDIO_MIXER, INIT_KVCOUNT,\
-                "PulseAudioMixer::sendDataToPulse: data handle is NULL");
+                "PulseAudioMixer::sendDataToPulse: send queue to Pulse is full");
         return false;
     }
     return true;
@@ -137,10 +332,9 @@ PulseAudioMixer::setMute(const char* deviceName, const int& mutestatus, LSHandle
 
     pulseCallBackInfo pci;
     pci.lshandle = lshandle;
-    pci.message=message;
-    pci.ctx=ctx;
-    pci.cb=cb;
-    mPulseCallBackInfo.insert(std::make_pair(esink_set_master_mute_reply, pci));
+    pci.message = message;
+    pci.ctx = ctx;
+    pci.cb = cb;
 
     struct paVolumeSet volumeSet;
     volumeSet.Type = PAUDIOD_VOLUME_SINK_MUTE;
@@ -156,7 +350,7 @@ PulseAudioMixer::setMute(const char* deviceName, const int& mutestatus, LSHandle
     strncpy(volumeSet.device, deviceName, DEVICE_NAME_LENGTH);
     volumeSet.device[DEVICE_NAME_LENGTH-1] = '\0';
 
-    int status = sendDataToPulse<paVolumeSet>(PAUDIOD_MSGTYPE_VOLUME, esink_set_master_mute_reply, volumeSet);
+    int status = sendDataToPulse<paVolumeSet>(PAUDIOD_MSGTYPE_VOLUME, esink_set_master_mute_reply, volumeSet, &pci);
 
     return status;
 }
@@ -165,10 +359,9 @@ bool PulseAudioMixer::setPhysicalSourceMute(const char* source, const int& mutes
 {
     pulseCallBackInfo pci;
     pci.lshandle = lshandle;
-    pci.message=message;
-    pci.ctx=ctx;
-    pci.cb=cb;
-    mPulseCallBackInfo.insert(std::make_pair(esource_set_master_mute_reply, pci));
+    pci.message = message;
+    pci.ctx = ctx;
+    pci.cb = cb;
 
     struct paVolumeSet volumeSet;
     volumeSet.Type = PAUDIOD_VOLUME_SOURCE_MUTE;
@@ -184,7 +377,7 @@ bool PulseAudioMixer::setPhysicalSourceMute(const char* source, const int& mutes
     strncpy(volumeSet.device, source, DEVICE_NAME_LENGTH);
     volumeSet.device[DEVICE_NAME_LENGTH-1] = '\0';
 
-    int status = sendDataToPulse<paVolumeSet>(PAUDIOD_MSGTYPE_VOLUME, esource_set_master_mute_reply, volumeSet);
+    int status = sendDataToPulse<paVolumeSet>(PAUDIOD_MSGTYPE_VOLUME, esource_set_master_mute_reply, volumeSet, &pci);
 
     return status;
 }
@@ -194,10 +387,9 @@ PulseAudioMixer::setVirtualSourceMute(int sink, int mutestatus, LSHandle *lshand
 {
     pulseCallBackInfo pci;
     pci.lshandle = lshandle;
-    pci.message=message;
-    pci.ctx=ctx;
-    pci.cb=cb;
-    mPulseCallBackInfo.insert(std::make_pair(evirtual_source_set_mute_reply, pci));
+    pci.message = message;
+    pci.ctx = ctx;
+    pci.cb = cb;
 
     struct paVolumeSet volumeSet;
     volumeSet.Type = PAUDIOD_VOLUME_SOURCEOUTPUT_MUTE;
@@ -212,7 +404,7 @@ PulseAudioMixer::setVirtualSourceMute(int sink, int mutestatus, LSHandle *lshand
     volumeSet.index = 0;
     volumeSet.device[DEVICE_NAME_LENGTH-1] = {'\0'};
 
-    int status = sendDataToPulse<paVolumeSet>(PAUDIOD_MSGTYPE_VOLUME, evirtual_source_set_mute_reply, volumeSet);
+    int status = sendDataToPulse<paVolumeSet>(PAUDIOD_MSGTYPE_VOLUME, evirtual_source_set_mute_reply, volumeSet, &pci);
 
     return status;
 }
@@ -222,10 +414,9 @@ PulseAudioMixer::muteSink(const int& sink, const int& mutestatus, LSHandle *lsha
 {
     pulseCallBackInfo pci;
     pci.lshandle = lshandle;
-    pci.message=message;
-    pci.ctx=ctx;
-    pci.cb=cb;
-    mPulseCallBackInfo.insert(std::make_pair(evirtual_sink_input_set_mute_reply, pci));
+    pci.message = message;
+    pci.ctx = ctx;
+    pci.cb = cb;
 
     struct paVolumeSet volumeSet;
     volumeSet.Type = PAUDIOD_VOLUME_SINKINPUT_MUTE;
@@ -240,7 +431,7 @@ PulseAudioMixer::muteSink(const int& sink, const int& mutestatus, LSHandle *lsha
     volumeSet.index = 0;
     volumeSet.device[DEVICE_NAME_LENGTH-1] = '\0';
 
-    int status = sendDataToPulse<paVolumeSet>(PAUDIOD_MSGTYPE_VOLUME, evirtual_sink_input_set_mute_reply, volumeSet);
+    int status = sendDataToPulse<paVolumeSet>(PAUDIOD_MSGTYPE_VOLUME, evirtual_sink_input_set_mute_reply, volumeSet, &pci);
 
     return status;
 }
@@ -253,10 +444,9 @@ PulseAudioMixer::setVolume(const char* deviceName, const int& volume, LSHandle *
 
     pulseCallBackInfo pci;
     pci.lshandle = lshandle;
-    pci.message=message;
-    pci.ctx=ctx;
-    pci.cb=cb;
-    mPulseCallBackInfo.insert(std::make_pair(esink_set_master_volume_reply, pci));
+    pci.message = message;
+    pci.ctx = ctx;
+    pci.cb = cb;
 
     struct paVolumeSet volumeSet;
     volumeSet.Type = PAUDIOD_VOLUME_SINK_VOLUME;
@@ -272,24 +462,26 @@ PulseAudioMixer::setVolume(const char* deviceName, const int& volume, LSHandle *
     strncpy(volumeSet.device, deviceName, DEVICE_NAME_LENGTH);
     volumeSet.device[DEVICE_NAME_LENGTH-1] = '\0';
 
-    int status = sendDataToPulse<paVolumeSet>(PAUDIOD_MSGTYPE_VOLUME, esink_set_master_volume_reply, volumeSet);
+    int status = sendDataToPulse<paVolumeSet>(PAUDIOD_MSGTYPE_VOLUME, esink_set_master_volume_reply, volumeSet, &pci);
 
     return status;
 }
 
 bool PulseAudioMixer::sendHeaderToPA(char *data, paudiodMsgHdr audioMsgHdr)
 {
-    int sockfd = g_io_channel_unix_get_fd (mChannel);
-    ssize_t bytes = send(sockfd, data, SIZE_MESG_TO_PULSE, MSG_DONTWAIT);
-
-    if (bytes != SIZE_MESG_TO_PULSE)
+    if (mChannel == nullptr)
     {
-        if (bytes >= 0)
-            PM_LOG_INFO(MSGID_PULSEAUDIO_MIXER, INIT_KVCOUNT, "sendHeaderToPA: only %u bytes sent to Pulse out of %d (%s).", \
-                                   bytes, SIZE_MESG_TO_PULSE, strerror(errno));
-        else
-            PM_LOG_ERROR(MSGID_PULSEAUDIO_MIXER, INIT_KVCOUNT, "sendHeaderToPA: send to Pulse failed: %s", strerror(errno));
+        PM_LOG_ERROR(MSGID_PULSEAUDIO_MIXER, INIT_KVCOUNT, "pulse connection is not available");
+        return false;
     }
+    char *frame = reserveSendFrame();
+    if (frame == nullptr)
+    {
+        PM_LOG_ERROR(MSGID_PULSEAUDIO_MIXER, INIT_KVCOUNT, "sendHeaderToPA: send queue to Pulse is full");
+        return false;
+    }
+    memcpy(frame, data, SIZE_MESG_TO_PULSE);
+    commitSendFrame();
     return true;
 }
 
@@ -301,10 +493,9 @@ PulseAudioMixer::setMicVolume(const char* deviceName, const int& volume, LSHandl
 
     pulseCallBackInfo pci;
     pci.lshandle = lshandle;
-    pci.message=message;
-    pci.ctx=ctx;
-    pci.cb=cb;
-    mPulseCallBackInfo.insert(std::make_pair(esource_set_master_volume_reply, pci));
+    pci.message = message;
+    pci.ctx = ctx;
+    pci.cb = cb;
 
     struct paVolumeSet volumeSet;
     volumeSet.Type = PAUDIOD_VOLUME_SOURCE_MIC_VOLUME;
@@ -320,23 +511,13 @@ PulseAudioMixer::setMicVolume(const char* deviceName, const int& volume, LSHandl
     strncpy(volumeSet.device, deviceName, DEVICE_NAME_LENGTH);
     volumeSet.device[DEVICE_NAME_LENGTH-1] = '\0';
 
-    int status = sendDataToPulse<paVolumeSet>(PAUDIOD_MSGTYPE_VOLUME, esource_set_master_volume_reply, volumeSet);
+    int status = sendDataToPulse<paVolumeSet>(PAUDIOD_MSGTYPE_VOLUME, esource_set_master_volume_reply, volumeSet, &pci);
 
     return status;
 }
 
-bool PulseAudioMixer::programTrackVolume(EVirtualAudioSink sink, int sinkIndex, int volume, LSHandle *lshandle, LSMessage *message, void *ctx, PulseCallBackFunc cb, bool ramp)
+bool PulseAudioMixer::queueTrackVolume(EVirtualAudioSink sink, int sinkIndex, int volume, bool ramp, const pulseCallBackInfo &pci)
 {
-    PM_LOG_INFO(MSGID_PULSEAUDIO_MIXER, INIT_KVCOUNT,\
-        "programTrackVolume: sink:%d, sinkIndex:%d volume:%d, ramp%d", (int)sink, sinkIndex, volume, ramp);
-
-    pulseCallBackInfo pci;
-    pci.lshandle = lshandle;
-    pci.message=message;
-    pci.ctx=ctx;
-    pci.cb=cb;
-    mPulseCallBackInfo.insert(std::make_pair(evirtual_sink_input_index_set_volume_reply, pci));
-
     struct paVolumeSet volumeSet;
     volumeSet.Type = PAUDIOD_VOLUME_SINKINPUT_INDEX;
     volumeSet.id = sink;
@@ -350,19 +531,98 @@ bool PulseAudioMixer::programTrackVolume(EVirtualAudioSink sink, int sinkIndex,
     volumeSet.index = sinkIndex;
     volumeSet.device[DEVICE_NAME_LENGTH-1] = {'\0'};
 
-    int status = sendDataToPulse<paVolumeSet>(PAUDIOD_MSGTYPE_VOLUME, evirtual_sink_input_index_set_volume_reply, volumeSet);
+    return sendDataToPulse<paVolumeSet>(PAUDIOD_MSGTYPE_VOLUME, evirtual_sink_input_index_set_volume_reply, volumeSet, &pci);
+}
 
-    return status;
+bool PulseAudioMixer::programTrackVolume(EVirtualAudioSink sink, int sinkIndex, int volume, LSHandle *lshandle, LSMessage *message, void *ctx, PulseCallBackFunc cb, bool ramp)
+{
+    PM_LOG_INFO(MSGID_PULSEAUDIO_MIXER, INIT_KVCOUNT,\
+        "programTrackVolume: sink:%d, sinkIndex:%d volume:%d, ramp%d", (int)sink, sinkIndex, volume, ramp);
+
+    pulseCallBackInfo pci;
+    pci.lshandle = lshandle;
+    pci.message = message;
+    pci.ctx = ctx;
+    pci.cb = cb;
+
+    return queueTrackVolume(sink, sinkIndex, volume, ramp, pci);
+}
+
+bool PulseAudioMixer::_volumeBatchReply(LSHandle *sh, LSMessage *reply, void *ctx, bool status)
+{
+    volumeBatchInfo *batch = (volumeBatchInfo*)ctx;
+    if (!batch)
+        return false;
+    batch->status = batch->status && status;
+    if (--batch->remaining > 0)
+        return true;
+
+    PM_LOG_DEBUG("programVolumes: batch of %d completed, status:%d", batch->count, (int)batch->status);
+    bool result = batch->status;
+    if (batch->pci.cb)
+        result = batch->pci.cb(batch->pci.lshandle, batch->pci.message, batch->pci.ctx, batch->status);
+    delete batch;
+    return result;
+}
+
+bool PulseAudioMixer::programVolumes(const std::vector<utils::SINK_VOLUME_ENTRY_T> &entries, LSHandle *lshandle, LSMessage *message, void *ctx, PulseCallBackFunc cb)
+{
+    PM_LOG_INFO(MSGID_PULSEAUDIO_MIXER, INIT_KVCOUNT, "programVolumes: %zu sink input(s)", entries.size());
+    if (entries.empty())
+        return false;
+    if (mChannel == nullptr)
+    {
+        PM_LOG_ERROR(MSGID_PULSEAUDIO_MIXER, INIT_KVCOUNT, "pulse connection is not available");
+        return false;
+    }
+
+    //The frames of a batch are queued together, never only a part of it.
+    //They are still one message per sink input and are answered one by one.
+    if (PULSE_SEND_RING_SIZE - mSendCount < (int)entries.size())
+        flushSendQueue();
+    if (PULSE_SEND_RING_SIZE - mSendCount < (int)entries.size())
+    {
+        PM_LOG_ERROR(MSGID_PULSEAUDIO_MIXER, INIT_KVCOUNT,\
+            "programVolumes: no room for %zu frame(s), %d queued", entries.size(), mSendCount);
+        return false;
+    }
+
+    pulseCallBackInfo pci;
+    pci.lshandle = nullptr;
+    pci.message = nullptr;
+    pci.ctx = nullptr;
+    pci.cb = nullptr;
+    if (cb)
+    {
+        //Every reply of the batch counts down one shared completion
+        volumeBatchInfo *batch = new volumeBatchInfo;
+        batch->pci.lshandle = lshandle;
+        batch->pci.message = message;
+        batch->pci.ctx = ctx;
+        batch->pci.cb = cb;
+        batch->count = (int)entries.size();
+        batch->remaining = batch->count;
+        batch->status = true;
+        pci.ctx = batch;
+        pci.cb = &PulseAudioMixer::_volumeBatchReply;
+    }
+
+    for (const auto &entry : entries)
+    {
+        PM_LOG_DEBUG("programVolumes: sink:%d sinkIndex:%d volume:%d ramp:%d",\
+            (int)entry.audioSink, entry.sinkInputIndex, entry.volume, (int)entry.ramp);
+        queueTrackVolume(entry.audioSink, entry.sinkInputIndex, entry.volume, entry.ramp, pci);
+    }
+    return true;
 }
 
 bool PulseAudioMixer::programVolume (EVirtualSource source, int volume, LSHandle *lshandle, LSMessage *message, void *ctx, PulseCallBackFunc cb, bool ramp)
 {
     pulseCallBackInfo pci;
     pci.lshandle = lshandle;
-    pci.message=message;
-    pci.ctx=ctx;
-    pci.cb=cb;
-    mPulseCallBackInfo.insert(std::make_pair(evirtual_source_input_set_volume_reply, pci));
+    pci.message = message;
+    pci.ctx = ctx;
+    pci.cb = cb;
 
     struct paVolumeSet volumeSet;
     volumeSet.Type = PAUDIOD_VOLUME_SOURCEOUTPUT_VOLUME;
@@ -377,7 +637,7 @@ bool PulseAudioMixer::programVolume (EVirtualSource source, int volume, LSHandle
     volumeSet.index = 0;
     volumeSet.device[DEVICE_NAME_LENGTH-1] = {'\0'};
 
-    int status = sendDataToPulse<paVolumeSet>(PAUDIOD_MSGTYPE_VOLUME, evirtual_source_input_set_volume_reply, volumeSet);
+    int status = sendDataToPulse<paVolumeSet>(PAUDIOD_MSGTYPE_VOLUME, evirtual_source_input_set_volume_reply, volumeSet, &pci);
 
     return status;
 }
@@ -702,8 +962,7 @@ bool PulseAudioMixer::loadInternalSoundCard(char cmd, int cardNumber, int device
     pci.lshandle = nullptr;
     pci.message = nullptr;
     pci.ctx = nullptr;
-    pci.cb=cb;
-    mPulseCallBackInfo.insert(std::make_pair(eload_lineout_alsa_sink_reply, pci));
+    pci.cb = cb;
 
     struct paDeviceSet deviceSet;
     deviceSet.Type = PAUDIOD_DEVICE_LOAD_LINEOUT_ALSA_SINK;
@@ -719,7 +978,7 @@ bool PulseAudioMixer::loadInternalSoundCard(char cmd, int cardNumber, int device
     strncpy(deviceSet.device, deviceName, DEVICE_NAME_LENGTH);
     deviceSet.device[DEVICE_NAME_LENGTH-1] = '\0';
 
-    returnValue = sendDataToPulse<paDeviceSet>(PAUDIOD_MSGTYPE_DEVICE, eload_lineout_alsa_sink_reply, deviceSet);
+    returnValue = sendDataToPulse<paDeviceSet>(PAUDIOD_MSGTYPE_DEVICE, eload_lineout_alsa_sink_reply, deviceSet, &pci);
 
     return returnValue;
 }
@@ -836,8 +1095,7 @@ bool PulseAudioMixer::loadUSBSinkSource(char cmd,int cardno, int deviceno, int s
     pci.lshandle = nullptr;
     pci.message = nullptr;
     pci.ctx = nullptr;
-    pci.cb=cb;
-    mPulseCallBackInfo.insert(std::make_pair(edetect_usb_device_reply, pci));
+    pci.cb = cb;
 
     deviceSet.cardNo = cardno;
     deviceSet.deviceNo = deviceno;
@@ -850,7 +1108,7 @@ bool PulseAudioMixer::loadUSBSinkSource(char cmd,int cardno, int deviceno, int s
     deviceSet.maxDeviceCnt = 0;
     deviceSet.device[DEVICE_NAME_LENGTH-1] = {'\0'};
 
-    ret = sendDataToPulse<paDeviceSet>(PAUDIOD_MSGTYPE_DEVICE, edetect_usb_device_reply, deviceSet);
+    ret = sendDataToPulse<paDeviceSet>(PAUDIOD_MSGTYPE_DEVICE, edetect_usb_device_reply, deviceSet, &pci);
 
     return ret;
 }
@@ -951,6 +1209,7 @@ PulseAudioMixer::_connectSocket()
     mOutputStreamsCurrentlyOpenedCount = 0;    // shouldn't be necessary
 
     // To do? since we are connected setup a watch for data on the file descriptor.
+    resetSendQueue();
     mChannel = g_io_channel_unix_new(sockfd);
 
     mSourceID = g_io_add_watch (mChannel, condition, ::_pulseStatus, this);
@@ -968,6 +1227,7 @@ PulseAudioMixer::_connectSocket()
         PM_LOG_ERROR(MSGID_PULSEAUDIO_MIXER, INIT_KVCOUNT, "Pulseaudio is not running");
         return false;
     }
+    mPulseLink.warmUpSounds();
 
     return true;
 }
@@ -1100,229 +1360,281 @@ void PulseAudioMixer::deviceConnectionStatus (const std::string &deviceName, con
   ((sink == eDTMF || sink == efeedback || sink == eeffects) ? \
    G_LOG_LEVEL_INFO : G_LOG_LEVEL_MESSAGE)
 
-void
-PulseAudioMixer::_pulseStatus(GIOChannel *ch,
-                              GIOCondition condition,
-                              gpointer user_data)
+void PulseAudioMixer::dispatchPulseMessage(const char *buffer)
 {
-    if (condition & G_IO_IN)
-    {
-        char buffer[SIZE_MESG_TO_AUDIOD];
-
-        int sockfd = g_io_channel_unix_get_fd (ch);
-        ssize_t bytes = recv(sockfd, buffer, SIZE_MESG_TO_AUDIOD, 0);
+    int HdrLen = sizeof(struct paudiodMsgHdr);
+    const struct paudiodMsgHdr *msgHdr = (const struct paudiodMsgHdr*) buffer;
+    PM_LOG_INFO(MSGID_PULSEAUDIO_MIXER, INIT_KVCOUNT,"len = %d message type=%x, message ID=%x",msgHdr->msgLen,msgHdr->msgType, msgHdr->msgID);
 
-        char cmd;
-        int isink;
-        int info;
-        char ip[28];
-        int port;
-        char deviceName[SIZE_MESG_TO_AUDIOD];
-        char deviceNameDetail[SIZE_MESG_TO_AUDIOD];
-
-        int HdrLen = sizeof(struct paudiodMsgHdr);
-        struct paudiodMsgHdr *msgHdr = (struct paudiodMsgHdr*) buffer;
-        PM_LOG_INFO(MSGID_PULSEAUDIO_MIXER, INIT_KVCOUNT,"len = %d message type=%x, message ID=%x",msgHdr->msgLen,msgHdr->msgType, msgHdr->msgID);
-
-        switch(msgHdr->msgType)
+    switch(msgHdr->msgType)
+    {
+        case PAUDIOD_REPLY_MSGTYPE_POLICY:
         {
-            case PAUDIOD_REPLY_MSGTYPE_POLICY:
+            PM_LOG_INFO(MSGID_PULSEAUDIO_MIXER, INIT_KVCOUNT,\
+                "PulseAudioMixer::_pulseStatus: received command PAUDIOD_REPLY_MSGTYPE_POLICY");
+            const struct paReplyToPolicySet *sndHdr  = (const paReplyToPolicySet*)(buffer+HdrLen);
+            PM_LOG_INFO(MSGID_PULSEAUDIO_MIXER, INIT_KVCOUNT,\
+                "recieved subcommand %d",sndHdr->Type);
+            switch(sndHdr->Type)
             {
-                PM_LOG_INFO(MSGID_PULSEAUDIO_MIXER, INIT_KVCOUNT,\
-                    "PulseAudioMixer::_pulseStatus: received command PAUDIOD_REPLY_MSGTYPE_POLICY");
-                struct paReplyToPolicySet *sndHdr  = (paReplyToPolicySet*)(buffer+HdrLen);
-                PM_LOG_INFO(MSGID_PULSEAUDIO_MIXER, INIT_KVCOUNT,\
-                    "recieved subcommand %d",sndHdr->Type);
-                switch(sndHdr->Type)
+                case PAUDIOD_REPLY_POLICY_SINK_CATEGORY:           //case 'O'
                 {
-                    case PAUDIOD_REPLY_POLICY_SINK_CATEGORY:           //case 'O'
-                    {
 
-                        int sinkNumber = sndHdr->stream;
-                        int info = sndHdr->count;
-                        EVirtualAudioSink sink = EVirtualAudioSink(sinkNumber);
-                        PM_LOG_INFO(MSGID_PULSEAUDIO_MIXER, INIT_KVCOUNT,"PAUDIOD_REPLY_MSGTYPE_SINK_CATEGORY:%d,%d",sink,info);
-                        if (IsValidVirtualSink(sink) && VERIFY(info >= 0))
-                        {
-                            PM_LOG_INFO(MSGID_PULSEAUDIO_MIXER, INIT_KVCOUNT, "%s: pulse says %i sink%s of type %i-%s %s already opened", \
-                                    __FUNCTION__, info, \
-                                    ((info > 1) ? "s" : ""), \
-                                    (int)sink, virtualSinkName(sink), \
-                                    ((info > 1) ? "are" : "is"));
-                            while (mPulseStateActiveStreamCount[sink] < info)
-                                outputStreamOpened (sink , -1 , "");
-                            while (mPulseStateActiveStreamCount[sink] > info)
-                                outputStreamClosed (sink , -1, "");
-                        }
-                    }
-                    break;
-                    case PAUDIOD_REPLY_POLICY_SOURCE_CATEGORY:         //case 'I'
+                    int sinkNumber = sndHdr->stream;
+                    int info = sndHdr->count;
+                    EVirtualAudioSink sink = EVirtualAudioSink(sinkNumber);
+                    PM_LOG_INFO(MSGID_PULSEAUDIO_MIXER, INIT_KVCOUNT,"PAUDIOD_REPLY_MSGTYPE_SINK_CATEGORY:%d,%d",sink,info);
+                    if (IsValidVirtualSink(sink) && VERIFY(info >= 0))
                     {
-                        int sourceNumber = sndHdr->stream;
-                        int info = sndHdr->count;
-                        EVirtualSource source = EVirtualSource(sourceNumber);
-                        PM_LOG_INFO(MSGID_PULSEAUDIO_MIXER, INIT_KVCOUNT,"PAUDIOD_REPLY_POLICY_SOURCE_CATEGORY:%d,%d",source,info);
-                        if (VERIFY(IsValidVirtualSource(source)) && VERIFY(info >= 0))
-                        {
-                            PM_LOG_INFO(MSGID_PULSEAUDIO_MIXER, INIT_KVCOUNT, "%s: pulse says %i input source%s already opened",\
-                                     __FUNCTION__, info, \
-                                     ((info > 1) ? "s are" : " is"));
-                            while (mInputStreamsCurrentlyOpenedCount < info)
-                                inputStreamOpened (source);
-                            while (mInputStreamsCurrentlyOpenedCount > info)
-                                inputStreamClosed (source);
-                        }
+                        PM_LOG_INFO(MSGID_PULSEAUDIO_MIXER, INIT_KVCOUNT, "%s: pulse says %i sink%s of type %i-%s %s already opened", \
+                                __FUNCTION__, info, \
+                                ((info > 1) ? "s" : ""), \
+                                (int)sink, virtualSinkName(sink), \
+                                ((info > 1) ? "are" : "is"));
+                        while (mPulseStateActiveStreamCount[sink] < info)
+                            outputStreamOpened (sink , -1 , "");
+                        while (mPulseStateActiveStreamCount[sink] > info)
+                            outputStreamClosed (sink , -1, "");
                     }
-                    break;
-                    case PAUDIOD_REPLY_MSGTYPE_SINK_OPEN:         //case 'o'
-                    {
-                        int sinkNumber = sndHdr->id;
-                        int sinkIndex = sndHdr->index;
-                        char appname[APP_NAME_LENGTH];
-                        strncpy(appname, sndHdr->appName, APP_NAME_LENGTH);
-                        appname[APP_NAME_LENGTH-1]='\0';
-                        EVirtualAudioSink sink = EVirtualAudioSink(sinkNumber);
-                        PM_LOG_INFO(MSGID_PULSEAUDIO_MIXER, INIT_KVCOUNT,"PAUDIOD_REPLY_MSGTYPE_STREAM_OPEN:%d,%d,%s",sink,sinkIndex,appname);
-                        if (VERIFY(IsValidVirtualSink(sink)))
-                        {
-                            outputStreamOpened (sink , sinkIndex, appname);
-                            PM_LOG_INFO(MSGID_PULSEAUDIO_MIXER, INIT_KVCOUNT, \
-                            "%s sink %i-%s opened. Volume: %d, Headset: %d, Route: %d, Streams: %d.",
-                                    __FUNCTION__, (int)sink, virtualSinkName(sink), \
-                                    mPulseStateVolume[sink],\
-                                    mPulseStateVolumeHeadset[sink], \
-                                    mPulseStateRoute[sink], \
-                                    mPulseStateActiveStreamCount[sink]);
-                        }
-                    }
-                    break;
-                    case PAUDIOD_REPLY_MSGTYPE_SOURCE_OPEN:         //case 'd'
-                    {
-                        int sourceNumber = sndHdr->id;
-                        EVirtualSource source = EVirtualSource(sourceNumber);
-                        PM_LOG_INFO(MSGID_PULSEAUDIO_MIXER, INIT_KVCOUNT,"PAUDIOD_REPLY_MSGTYPE_STREAM_OPEN:%d",source);
-
-                        PM_LOG_INFO(MSGID_PULSEAUDIO_MIXER, INIT_KVCOUNT, "InputStream opened recieved");
-                        inputStreamOpened (source);
-                    }
-                    break;
-                    case PAUDIOD_REPLY_MSGTYPE_SINK_CLOSE:          //case 'c'
-                    {
-                        int sinkNumber = sndHdr->id;
-                        int sinkIndex = sndHdr->index;
-                        char appname[APP_NAME_LENGTH];
-                        strncpy(appname, sndHdr->appName, APP_NAME_LENGTH);
-                        appname[APP_NAME_LENGTH-1]='\0';
-                        EVirtualAudioSink sink = EVirtualAudioSink(sinkNumber);
-                        PM_LOG_INFO(MSGID_PULSEAUDIO_MIXER, INIT_KVCOUNT,"PAUDIOD_REPLY_MSGTYPE_SINK_CLOSE:%d,%d,%s",sink,sinkIndex,appname);
-                        if (VERIFY(IsValidVirtualSink(sink)))
-                        {
-                            outputStreamClosed (sink,sinkIndex,appname);
-
-                            PM_LOG_INFO(MSGID_PULSEAUDIO_MIXER, INIT_KVCOUNT, \
-                            "%s sink %i-%s closed stream. Volume: %d, Headset: %d, Route: %d, Streams: %d.", \
-                                    __FUNCTION__, (int)sink, virtualSinkName(sink),\
-                                    mPulseStateVolume[sink], \
-                                    mPulseStateVolumeHeadset[sink], \
-                                    mPulseStateRoute[sink], \
-                                    mPulseStateActiveStreamCount[sink]);
-                        }
-                    }
-                    break;
-                    case PAUDIOD_REPLY_MSGTYPE_SOURCE_CLOSE:            //case 'k'
-                    {
-                        int sourceNum = sndHdr->id;
-                        EVirtualSource source = EVirtualSource(sourceNum);
-                        PM_LOG_INFO(MSGID_PULSEAUDIO_MIXER, INIT_KVCOUNT,"PAUDIOD_REPLY_MSGTYPE_SOURCE_CLOSE:%d",source);
-                        inputStreamClosed (source);
-                    }
-                    break;
-                    default:
+                }
+                break;
+                case PAUDIOD_REPLY_POLICY_SOURCE_CATEGORY:         //case 'I'
+                {
+                    int sourceNumber = sndHdr->stream;
+                    int info = sndHdr->count;
+                    EVirtualSource source = EVirtualSource(sourceNumber);
+                    PM_LOG_INFO(MSGID_PULSEAUDIO_MIXER, INIT_KVCOUNT,"PAUDIOD_REPLY_POLICY_SOURCE_CATEGORY:%d,%d",source,info);
+                    if (VERIFY(IsValidVirtualSource(source)) && VERIFY(info >= 0))
                     {
-                        PM_LOG_INFO(MSGID_PULSEAUDIO_MIXER, INIT_KVCOUNT,"Unknown command");
+                        PM_LOG_INFO(MSGID_PULSEAUDIO_MIXER, INIT_KVCOUNT, "%s: pulse says %i input source%s already opened",\
+                                 __FUNCTION__, info, \
+                                 ((info > 1) ? "s are" : " is"));
+                        while (mInputStreamsCurrentlyOpenedCount < info)
+                            inputStreamOpened (source);
+                        while (mInputStreamsCurrentlyOpenedCount > info)
+                            inputStreamClosed (source);
                     }
-                    break;
                 }
-            }
-            break;
-            case PAUDIOD_REPLY_MSGTYPE_ROUTING:
-            {
-                PM_LOG_INFO(MSGID_PULSEAUDIO_MIXER, INIT_KVCOUNT,\
-                    "PulseAudioMixer::_pulseStatus: received command PAUDIOD_REPLY_MSGTYPE_ROUTING");
-                struct paReplyToRoutingSet *sndHdr  = (paReplyToRoutingSet*)(buffer+HdrLen);
-                PM_LOG_INFO(MSGID_PULSEAUDIO_MIXER, INIT_KVCOUNT,\
-                    "recieved subcommand %d",sndHdr->Type);
-                switch (sndHdr->Type)
+                break;
+                case PAUDIOD_REPLY_MSGTYPE_SINK_OPEN:         //case 'o'
                 {
-                    case PAUDIOD_REPLY_MSGTYPE_DEVICE_CONNECTION:       //case '3'
+                    int sinkNumber = sndHdr->id;
+                    int sinkIndex = sndHdr->index;
+                    char appname[APP_NAME_LENGTH];
+                    strncpy(appname, sndHdr->appName, APP_NAME_LENGTH);
+                    appname[APP_NAME_LENGTH-1]='\0';
+                    EVirtualAudioSink sink = EVirtualAudioSink(sinkNumber);
+                    PM_LOG_INFO(MSGID_PULSEAUDIO_MIXER, INIT_KVCOUNT,"PAUDIOD_REPLY_MSGTYPE_STREAM_OPEN:%d,%d,%s",sink,sinkIndex,appname);
+                    if (VERIFY(IsValidVirtualSink(sink)))
                     {
-                        char deviceName[DEVICE_NAME_LENGTH];
-                        char deviceIcon[DEVICE_NAME_LENGTH];
-                        char deviceNameDetail[DEVICE_NAME_DETAILS_LENGTH];
-
-                        strncpy(deviceName, sndHdr->device, DEVICE_NAME_LENGTH);
-                        strncpy(deviceNameDetail, sndHdr->deviceNameDetail, DEVICE_NAME_DETAILS_LENGTH);
-                        strncpy(deviceIcon, sndHdr->deviceIcon, DEVICE_NAME_LENGTH);
-                        deviceName[DEVICE_NAME_LENGTH-1]='\0';
-                        deviceNameDetail[DEVICE_NAME_DETAILS_LENGTH-1]='\0';
-                        deviceIcon[DEVICE_NAME_LENGTH-1]='\0';
-
-                        char isOutput = sndHdr->isOutput;
-                        PM_LOG_INFO(MSGID_PULSEAUDIO_MIXER, INIT_KVCOUNT,\
-                            "PAUDIOD_REPLY_MSGTYPE_DEVICE_CONNECTION : %s:%s",deviceName,deviceNameDetail);
-                        deviceConnectionStatus(deviceName, deviceNameDetail, deviceIcon, true, (isOutput==0)?false:true);
+                        outputStreamOpened (sink , sinkIndex, appname);
+                        PM_LOG_INFO(MSGID_PULSEAUDIO_MIXER, INIT_KVCOUNT, \
+                        "%s sink %i-%s opened. Volume: %d, Headset: %d, Route: %d, Streams: %d.",
+                                __FUNCTION__, (int)sink, virtualSinkName(sink), \
+                                mPulseStateVolume[sink],\
+                                mPulseStateVolumeHeadset[sink], \
+                                mPulseStateRoute[sink], \
+                                mPulseStateActiveStreamCount[sink]);
                     }
-                    break;
-                    case PAUDIOD_REPLY_MSGTYPE_DEVICE_REMOVED:
+                }
+                break;
+                case PAUDIOD_REPLY_MSGTYPE_SOURCE_OPEN:         //case 'd'
+                {
+                    int sourceNumber = sndHdr->id;
+                    EVirtualSource source = EVirtualSource(sourceNumber);
+                    PM_LOG_INFO(MSGID_PULSEAUDIO_MIXER, INIT_KVCOUNT,"PAUDIOD_REPLY_MSGTYPE_STREAM_OPEN:%d",source);
+
+                    PM_LOG_INFO(MSGID_PULSEAUDIO_MIXER, INIT_KVCOUNT, "InputStream opened recieved");
+                    inputStreamOpened (source);
+                }
+                break;
+                case PAUDIOD_REPLY_MSGTYPE_SINK_CLOSE:          //case 'c'
+                {
+                    int sinkNumber = sndHdr->id;
+                    int sinkIndex = sndHdr->index;
+                    char appname[APP_NAME_LENGTH];
+                    strncpy(appname, sndHdr->appName, APP_NAME_LENGTH);
+                    appname[APP_NAME_LENGTH-1]='\0';
+                    EVirtualAudioSink sink = EVirtualAudioSink(sinkNumber);
+                    PM_LOG_INFO(MSGID_PULSEAUDIO_MIXER, INIT_KVCOUNT,"PAUDIOD_REPLY_MSGTYPE_SINK_CLOSE:%d,%d,%s",sink,sinkIndex,appname);
+                    if (VERIFY(IsValidVirtualSink(sink)))
                     {
-                        char deviceName[DEVICE_NAME_LENGTH];
-                        strncpy(deviceName, sndHdr->device, DEVICE_NAME_LENGTH);
-                        deviceName[DEVICE_NAME_LENGTH-1]='\0';
-                        char deviceNameDetail[DEVICE_NAME_DETAILS_LENGTH];
-                        strncpy(deviceNameDetail, sndHdr->deviceNameDetail, DEVICE_NAME_DETAILS_LENGTH);
-                        deviceNameDetail[DEVICE_NAME_DETAILS_LENGTH-1]='\0';
-                        char isOutput = sndHdr->isOutput;
-                        PM_LOG_INFO(MSGID_PULSEAUDIO_MIXER, INIT_KVCOUNT,\
-                            "PAUDIOD_REPLY_MSGTYPE_DEVICE_REMOVED : %s:%s, %d",deviceName,deviceNameDetail, isOutput);
-                        deviceConnectionStatus(deviceName, deviceNameDetail, "", false, (isOutput==0)?false:true);
+                        outputStreamClosed (sink,sinkIndex,appname);
+
+                        PM_LOG_INFO(MSGID_PULSEAUDIO_MIXER, INIT_KVCOUNT, \
+                        "%s sink %i-%s closed stream. Volume: %d, Headset: %d, Route: %d, Streams: %d.", \
+                                __FUNCTION__, (int)sink, virtualSinkName(sink),\
+                                mPulseStateVolume[sink], \
+                                mPulseStateVolumeHeadset[sink], \
+                                mPulseStateRoute[sink], \
+                                mPulseStateActiveStreamCount[sink]);
                     }
-                    break;
-                    default:
-                        break;
                 }
+                break;
+                case PAUDIOD_REPLY_MSGTYPE_SOURCE_CLOSE:            //case 'k'
+                {
+                    int sourceNum = sndHdr->id;
+                    EVirtualSource source = EVirtualSource(sourceNum);
+                    PM_LOG_INFO(MSGID_PULSEAUDIO_MIXER, INIT_KVCOUNT,"PAUDIOD_REPLY_MSGTYPE_SOURCE_CLOSE:%d",source);
+                    inputStreamClosed (source);
+                }
+                break;
+                default:
+                {
+                    PM_LOG_INFO(MSGID_PULSEAUDIO_MIXER, INIT_KVCOUNT,"Unknown command");
+                }
+                break;
             }
-            break;
-            case PAUDIOD_REPLY_MSGTYPE_CALLBACK:
+        }
+        break;
+        case PAUDIOD_REPLY_MSGTYPE_ROUTING:
+        {
+            PM_LOG_INFO(MSGID_PULSEAUDIO_MIXER, INIT_KVCOUNT,\
+                "PulseAudioMixer::_pulseStatus: received command PAUDIOD_REPLY_MSGTYPE_ROUTING");
+            const struct paReplyToRoutingSet *sndHdr  = (const paReplyToRoutingSet*)(buffer+HdrLen);
+            PM_LOG_INFO(MSGID_PULSEAUDIO_MIXER, INIT_KVCOUNT,\
+                "recieved subcommand %d",sndHdr->Type);
+            switch (sndHdr->Type)
             {
-
-                paReplyToAudiod *replyHdr = (paReplyToAudiod*)(buffer+HdrLen);
-                PM_LOG_INFO(MSGID_PULSEAUDIO_MIXER, INIT_KVCOUNT,\
-                    "callback from pulseaudio id :%d", replyHdr->id);
-                auto it = mPulseCallBackInfo.find(replyHdr->id);
-                if (it != mPulseCallBackInfo.end())
+                case PAUDIOD_REPLY_MSGTYPE_DEVICE_CONNECTION:       //case '3'
                 {
-                    pulseCallBackInfo cbk = it->second;
-                    PulseCallBackFunc fun = cbk.cb;
-                    if (fun)
-                        fun(cbk.lshandle, cbk.message, cbk.ctx, true);
-                    else
-                        PM_LOG_INFO(MSGID_PULSEAUDIO_MIXER, INIT_KVCOUNT, "CallBack function is null");
-                    mPulseCallBackInfo.erase(replyHdr->id);
+                    char deviceName[DEVICE_NAME_LENGTH];
+                    char deviceIcon[DEVICE_NAME_LENGTH];
+                    char deviceNameDetail[DEVICE_NAME_DETAILS_LENGTH];
+
+                    strncpy(deviceName, sndHdr->device, DEVICE_NAME_LENGTH);
+                    strncpy(deviceNameDetail, sndHdr->deviceNameDetail, DEVICE_NAME_DETAILS_LENGTH);
+                    strncpy(deviceIcon, sndHdr->deviceIcon, DEVICE_NAME_LENGTH);
+                    deviceName[DEVICE_NAME_LENGTH-1]='\0';
+                    deviceNameDetail[DEVICE_NAME_DETAILS_LENGTH-1]='\0';
+                    deviceIcon[DEVICE_NAME_LENGTH-1]='\0';
+
+                    char isOutput = sndHdr->isOutput;
+                    PM_LOG_INFO(MSGID_PULSEAUDIO_MIXER, INIT_KVCOUNT,\
+                        "PAUDIOD_REPLY_MSGTYPE_DEVICE_CONNECTION : %s:%s",deviceName,deviceNameDetail);
+                    deviceConnectionStatus(deviceName, deviceNameDetail, deviceIcon, true, (isOutput==0)?false:true);
                 }
-                else
+                break;
+                case PAUDIOD_REPLY_MSGTYPE_DEVICE_REMOVED:
                 {
-                    PM_LOG_INFO(MSGID_PULSEAUDIO_MIXER, INIT_KVCOUNT, "CallBack map cannot find the entry");
+                    char deviceName[DEVICE_NAME_LENGTH];
+                    strncpy(deviceName, sndHdr->device, DEVICE_NAME_LENGTH);
+                    deviceName[DEVICE_NAME_LENGTH-1]='\0';
+                    char deviceNameDetail[DEVICE_NAME_DETAILS_LENGTH];
+                    strncpy(deviceNameDetail, sndHdr->deviceNameDetail, DEVICE_NAME_DETAILS_LENGTH);
+                    deviceNameDetail[DEVICE_NAME_DETAILS_LENGTH-1]='\0';
+                    char isOutput = sndHdr->isOutput;
+                    PM_LOG_INFO(MSGID_PULSEAUDIO_MIXER, INIT_KVCOUNT,\
+                        "PAUDIOD_REPLY_MSGTYPE_DEVICE_REMOVED : %s:%s, %d",deviceName,deviceNameDetail, isOutput);
+                    deviceConnectionStatus(deviceName, deviceNameDetail, "", false, (isOutput==0)?false:true);
                 }
-
+                break;
+                default:
+                    break;
             }
+        }
+        break;
+        case PAUDIOD_REPLY_MSGTYPE_CALLBACK:
+        {
+
+            const paReplyToAudiod *replyHdr = (const paReplyToAudiod*)(buffer+HdrLen);
+            PM_LOG_INFO(MSGID_PULSEAUDIO_MIXER, INIT_KVCOUNT,\
+                "callback from pulseaudio id :%d", replyHdr->id);
+            completePendingRequest(replyHdr->id, true);
+
+        }
+        break;
+        default:
+        {
+            PM_LOG_INFO(MSGID_PULSEAUDIO_MIXER, INIT_KVCOUNT,\
+                "invalid command given");
+        }
+    }
+}
+
+bool PulseAudioMixer::isValidPulseFrame(const char *buffer)
+{
+    const struct paudiodMsgHdr *msgHdr = (const struct paudiodMsgHdr*) buffer;
+    if (msgHdr->msgLen > SIZE_MESG_TO_AUDIOD)
+        return false;
+    switch (msgHdr->msgType)
+    {
+        case PAUDIOD_REPLY_MSGTYPE_POLICY:
+        case PAUDIOD_REPLY_MSGTYPE_ROUTING:
+        case PAUDIOD_REPLY_MSGTYPE_CALLBACK:
+            return true;
+        default:
+            return false;
+    }
+}
+
+void PulseAudioMixer::receiveFromPulse(GIOChannel *ch, bool &peerClosed)
+{
+    int sockfd = g_io_channel_unix_get_fd (ch);
+    int frames = 0;
+
+    //Drain everything pulse has queued, so a burst costs a single wakeup
+    while (true)
+    {
+        ssize_t bytes = recv(sockfd, mRecvBuffer + mRecvLength, sizeof(mRecvBuffer) - mRecvLength, MSG_DONTWAIT);
+        if (bytes < 0)
+        {
+            if (EINTR == errno)
+                continue;
+            if (EAGAIN != errno && EWOULDBLOCK != errno)
+                PM_LOG_ERROR(MSGID_PULSEAUDIO_MIXER, INIT_KVCOUNT, "receiveFromPulse: recv failed: %s", strerror(errno));
+            break;
+        }
+        if (0 == bytes)
+        {
+            peerClosed = true;
             break;
-            default:
+        }
+        mRecvLength += bytes;
+
+        //Pulse writes fixed size frames, msgLen is only checked for sanity
+        size_t offset = 0;
+        while (mRecvLength - offset >= SIZE_MESG_TO_AUDIOD)
+        {
+            const char *frame = mRecvBuffer + offset;
+            offset += SIZE_MESG_TO_AUDIOD;
+            if (!isValidPulseFrame(frame))
             {
-                PM_LOG_INFO(MSGID_PULSEAUDIO_MIXER, INIT_KVCOUNT,\
-                    "invalid command given");
+                mMalformedFrameCount++;
+                const struct paudiodMsgHdr *msgHdr = (const struct paudiodMsgHdr*) frame;
+                PM_LOG_WARNING(MSGID_PULSEAUDIO_MIXER, INIT_KVCOUNT,\
+                    "receiveFromPulse: dropping malformed frame len:%d type:%x (malformed:%u)",\
+                    msgHdr->msgLen, msgHdr->msgType, mMalformedFrameCount);
+                continue;
             }
+            mRecvFrameCount++;
+            frames++;
+            dispatchPulseMessage(frame);
+        }
+        mRecvLength -= offset;
+        if (mRecvLength)
+        {
+            memmove(mRecvBuffer, mRecvBuffer + offset, mRecvLength);
+            mShortReadCount++;
+            PM_LOG_DEBUG("receiveFromPulse: keeping %zu bytes of a partial frame (short reads:%u)", mRecvLength, mShortReadCount);
         }
     }
+    PM_LOG_DEBUG("receiveFromPulse: dispatched %d frame(s), total:%u short:%u malformed:%u",\
+        frames, mRecvFrameCount, mShortReadCount, mMalformedFrameCount);
+}
+
+void
+PulseAudioMixer::_pulseStatus(GIOChannel *ch,
+                              GIOCondition condition,
+                              gpointer user_data)
+{
+    if (condition & G_IO_IN)
+    {
+        bool peerClosed = false;
+        receiveFromPulse(ch, peerClosed);
+        if (peerClosed)
+            condition = GIOCondition(condition | G_IO_HUP);
+    }
 
     if (condition & G_IO_ERR)
     {
@@ -1336,8 +1648,14 @@ PulseAudioMixer::_pulseStatus(GIOChannel *ch,
 
         mTimeout = cMinTimeout;
         g_source_remove (mSourceID);
+        resetSendQueue();
+        mRecvLength = 0;
+        PM_LOG_INFO(MSGID_PULSEAUDIO_MIXER, INIT_KVCOUNT, "%s: frames received:%u short reads:%u malformed:%u", \
+            __FUNCTION__, mRecvFrameCount, mShortReadCount, mMalformedFrameCount);
         g_io_channel_unref(mChannel);
         mChannel = NULL;
+        //Replies to requests sent on the old connection will never come
+        failAllPendingRequests();
         g_timeout_add (0, ::_timer, this);
     }
 }
@@ -1412,9 +1730,14 @@ bool PulseAudioMixer::playSystemSound(const char *snd, EVirtualAudioSink sink)
     return mPulseLink.play(snd, sink);
 }
 
-std::string PulseAudioMixer::playSound(const char *snd, EVirtualAudioSink sink, const char *format, int rate, int channels)
+std::string PulseAudioMixer::playSound(const char *snd, EVirtualAudioSink sink, const char *format, int rate, int channels, int volume)
+{
+    return mPulseLink.play(snd, sink, format, rate, channels, volume);
+}
+
+int PulseAudioMixer::queueSound(std::string playbackId, const char *snd, const char *format, int rate, int channels)
 {
-    return mPulseLink.play(snd, sink, format, rate, channels);
+    return mPulseLink.queueSound(playbackId, snd, format, rate, channels);
 }
 
 bool PulseAudioMixer::controlPlayback(std::string playbackId, std::string requestType)
@@ -1422,18 +1745,26 @@ bool PulseAudioMixer::controlPlayback(std::string playbackId, std::string reques
     return mPulseLink.controlPlayback(playbackId, requestType);
 }
 
-std::string PulseAudioMixer::getPlaybackStatus(std::string playbackId)
+std::string PulseAudioMixer::getPlaybackStatus(std::string playbackId, PLAYBACK_TIMING_T *timing)
+{
+    return mPulseLink.getPlaybackStatus(playbackId, timing);
+}
+
+pbnjson::JValue PulseAudioMixer::getSampleCacheStats()
+{
+    return mPulseLink.getSampleCacheStats();
+}
+
+pbnjson::JValue PulseAudioMixer::getPlayLatencyStats()
 {
-    return mPulseLink.getPlaybackStatus(playbackId);
+    return mPulseLink.getPlayLatencyStats();
 }
 
 void PulseAudioMixer::preloadSystemSound(const char * snd)
 {
-    std::string path = SYSTEMSOUNDS_PATH;
     if (nullptr == snd)
         return;
-    path += snd;
-    path += "-ondemand.pcm";
+    std::string path = utils::getSystemSoundPath(snd);
 
     mPulseLink.preload(snd, DEFAULT_SAMPLE_FORMAT, DEFAULT_SAMPLE_RATE, DEFAULT_CHANNELS, path.c_str());
 }
@@ -1462,7 +1793,7 @@ void PulseAudioMixer::playDtmf(const char *snd, const char* sink)
     if ((tone=IdToDtmf(snd))<0) return;
     if (mCurrentDtmf && tone==mCurrentDtmf->getTone()) return;
     stopDtmf();
-    mCurrentDtmf = new PulseDtmfGenerator((Dtmf)tone, 0);
+    mCurrentDtmf = new PulseDtmfGenerator((Dtmf)tone, 0, DTMF_SAMPLE_RATE, mPulseLink.getGainRampMs(sink, DTMF_FADE_MS));
     //Will be updated once DAP design is updated
     mPulseLink.play(mCurrentDtmf, sink);
 }
@@ -1500,7 +1831,51 @@ void PulseAudioMixer::createPulseSocketCommunication()
 }
 
 #if defined(AUDIOD_TEST_API)
+static bool
+_getSampleCacheStats(LSHandle *lshandle, LSMessage *message, void *ctx)
+{
+    LSMessageJsonParser msg(message, SCHEMA_0);
+    if (!msg.parse(__FUNCTION__, lshandle))
+        return true;
+
+    CLSError lserror;
+    PulseAudioMixer *pulseMixerObj = (PulseAudioMixer*)ctx;
+    if (!pulseMixerObj)
+    {
+        std::string reply = STANDARD_JSON_ERROR(AUDIOD_ERRORCODE_INTERNAL_ERROR, "Could not get the mixer instance");
+        LSMessageReply(lshandle, message, reply.c_str(), &lserror);
+        return true;
+    }
+    pbnjson::JValue resp = pulseMixerObj->getSampleCacheStats();
+    resp.put("returnValue", true);
+    utils::LSMessageResponse(lshandle, message, resp.stringify().c_str(), utils::eLSRespond, false);
+    return true;
+}
+
+static bool
+_getPlayLatencyStats(LSHandle *lshandle, LSMessage *message, void *ctx)
+{
+    LSMessageJsonParser msg(message, SCHEMA_0);
+    if (!msg.parse(__FUNCTION__, lshandle))
+        return true;
+
+    CLSError lserror;
+    PulseAudioMixer *pulseMixerObj = (PulseAudioMixer*)ctx;
+    if (!pulseMixerObj)
+    {
+        std::string reply = STANDARD_JSON_ERROR(AUDIOD_ERRORCODE_INTERNAL_ERROR, "Could not get the mixer instance");
+        LSMessageReply(lshandle, message, reply.c_str(), &lserror);
+        return true;
+    }
+    pbnjson::JValue resp = pulseMixerObj->getPlayLatencyStats();
+    resp.put("returnValue", true);
+    utils::LSMessageResponse(lshandle, message, resp.stringify().c_str(), utils::eLSRespond, false);
+    return true;
+}
+
 static LSMethod pulseMethods[] = {
+    { "getSampleCacheStats", _getSampleCacheStats},
+    { "getPlayLatencyStats", _getPlayLatencyStats},
     { },
 };
 #endif
@@ -1511,7 +1886,7 @@ void PulseAudioMixer::init(GMainLoop * loop, LSHandle * handle)
     bool result;
     CLSError lserror;
 
-    result = ServiceRegisterCategory ("/state/pulse", pulseMethods, NULL, loop);
+    result = ServiceRegisterCategory ("/state/pulse", pulseMethods, NULL, this);
     if (!result)
     {
         lserror.Print(__FUNCTION__, __LINE__);
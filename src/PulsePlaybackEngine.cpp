@@ -0,0 +1,1173 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "PulsePlaybackEngine.h"
+#include "VolumeCurve.h"
+#include <algorithm>
+#include <cstring>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <audiodTracer.h>
+
+static pa_sample_format_t getSampleFormat(const char *format)
+{
+    if (format && std::strncmp(format, "PA_SAMPLE_S16LE", 15) == 0)
+        return PA_SAMPLE_S16LE;
+    else if (format && std::strncmp(format, "PA_SAMPLE_S24LE", 15) == 0)
+        return PA_SAMPLE_S24LE;
+    return PA_SAMPLE_S32LE;
+}
+
+PcmFileSource::PcmFileSource() : mData(nullptr),
+                                 mLength(0),
+                                 mOffset(0),
+                                 mFile(nullptr),
+                                 mCompressed(false),
+                                 mHeader(),
+                                 mDecodedFrames(0),
+                                 mPendingOffset(0)
+{
+}
+
+PcmFileSource::~PcmFileSource()
+{
+    close();
+}
+
+bool PcmFileSource::open(const char *fileName)
+{
+    close();
+    int fd = ::open(fileName, O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return false;
+
+    struct stat fileStat;
+    if (0 == fstat(fd, &fileStat) && S_ISREG(fileStat.st_mode) && fileStat.st_size > 0)
+    {
+        void *data = mmap(nullptr, (size_t)fileStat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (MAP_FAILED != data)
+        {
+            //Playback reads the file once from start to end
+            madvise(data, (size_t)fileStat.st_size, MADV_SEQUENTIAL);
+            mData = (const uint8_t*)data;
+            mLength = (size_t)fileStat.st_size;
+            mOffset = 0;
+            ::close(fd);
+        }
+        else
+            PM_LOG_DEBUG("PcmFileSource: mmap failed for %s, using buffered reads", fileName);
+    }
+
+    if (!mData)
+    {
+        mFile = fdopen(fd, "r");
+        if (!mFile)
+        {
+            ::close(fd);
+            return false;
+        }
+    }
+
+    uint8_t header[IMA_ADPCM_HEADER_SIZE];
+    size_t len = readRaw(header, sizeof(header));
+    mCompressed = ImaAdpcm::readHeader(header, len, mHeader);
+    if (!mCompressed)
+        mPending.assign(header, header + len);
+    return true;
+}
+
+bool PcmFileSource::getSampleSpec(pa_sample_spec &spec) const
+{
+    if (!mCompressed)
+        return false;
+    spec.format = PA_SAMPLE_S16LE;
+    spec.rate = mHeader.rate;
+    spec.channels = (uint8_t)mHeader.channels;
+    return true;
+}
+
+void PcmFileSource::prefetch()
+{
+    if (mData && mOffset < mLength)
+        madvise((void*)mData, mLength, MADV_WILLNEED);
+}
+
+void PcmFileSource::close()
+{
+    if (mData)
+    {
+        munmap((void*)mData, mLength);
+        mData = nullptr;
+        mLength = 0;
+        mOffset = 0;
+    }
+    if (mFile)
+    {
+        if (fclose(mFile))
+            PM_LOG_ERROR(MSGID_PULSE_LINK, INIT_KVCOUNT, "PcmFileSource: Error closing file");
+        mFile = nullptr;
+    }
+    mCompressed = false;
+    mDecodedFrames = 0;
+    mPending.clear();
+    mPendingOffset = 0;
+}
+
+size_t PcmFileSource::read(void *buffer, size_t bytes)
+{
+    size_t copied = 0;
+    while (copied < bytes)
+    {
+        if (mPendingOffset < mPending.size())
+        {
+            size_t count = std::min(bytes - copied, mPending.size() - mPendingOffset);
+            memcpy((uint8_t*)buffer + copied, mPending.data() + mPendingOffset, count);
+            mPendingOffset += count;
+            copied += count;
+        }
+        else if (!mCompressed)
+        {
+            copied += readRaw((uint8_t*)buffer + copied, bytes - copied);
+            break;
+        }
+        else if (!decodeNextBlock())
+            break;
+    }
+    return copied;
+}
+
+bool PcmFileSource::decodeNextBlock()
+{
+    size_t frames = std::min((size_t)mHeader.blockFrames, (size_t)(mHeader.frames - mDecodedFrames));
+    size_t blockSize = ImaAdpcm::getBlockSize(mHeader, frames);
+    if (0 == blockSize)
+        return false;
+    mBlock.resize(blockSize);
+    if (readRaw(mBlock.data(), blockSize) < blockSize)
+        return false;
+    mPending.resize(frames * mHeader.channels * sizeof(int16_t));
+    ImaAdpcm::decodeBlock(mHeader, mBlock.data(), frames, (int16_t*)mPending.data());
+    mPendingOffset = 0;
+    mDecodedFrames += frames;
+    return true;
+}
+
+size_t PcmFileSource::readRaw(void *buffer, size_t bytes)
+{
+    if (mData)
+    {
+        size_t count = std::min(bytes, mLength - mOffset);
+        memcpy(buffer, mData + mOffset, count);
+        mOffset += count;
+        return count;
+    }
+    if (mFile)
+        return fread(buffer, 1, bytes, mFile);
+    return 0;
+}
+
+PulsePlaybackEngine::PulsePlaybackEngine() : mMainLoop(nullptr),
+                                             mContext(nullptr),
+                                             mContextFailed(false),
+                                             mSinkSpecKnown(false),
+                                             mCallback(nullptr),
+                                             mUnderruns(0)
+{
+    memset(&mSinkSpec, 0, sizeof(mSinkSpec));
+    mDefaultRamp.milliseconds = PLAYBACK_RAMP_DEFAULT_MS;
+    mDefaultRamp.curve = ePcmRampLinear;
+    PM_LOG_DEBUG("PulsePlaybackEngine constructor");
+}
+
+PulsePlaybackEngine::~PulsePlaybackEngine()
+{
+    PM_LOG_DEBUG("PulsePlaybackEngine destructor");
+    if (!mMainLoop)
+        return;
+
+    pa_threaded_mainloop_lock(mMainLoop);
+    mCallback = nullptr;
+    std::map<std::string, PLAYBACK_STREAM_T*> streams = mStreams;
+    for (const auto &it : streams)
+        finishStream(it.second, eStateStopped);
+    std::map<std::string, PLAYBACK_MIXER_T*> mixers = mMixers;
+    for (const auto &it : mixers)
+        closeMixer(it.second, false);
+    if (mContext)
+        pa_context_disconnect(mContext);
+    pa_threaded_mainloop_unlock(mMainLoop);
+
+    pa_threaded_mainloop_stop(mMainLoop);
+    std::set<PLAYBACK_MIXER_T*> closing = mClosingMixers;
+    for (const auto &mixer : closing)
+        releaseMixer(mixer);
+    if (mContext)
+        pa_context_unref(mContext);
+    pa_threaded_mainloop_free(mMainLoop);
+}
+
+void PulsePlaybackEngine::registerCallback(MixerInterface *mixerCallBack)
+{
+    if (mMainLoop)
+        pa_threaded_mainloop_lock(mMainLoop);
+    mCallback = mixerCallBack;
+    if (mMainLoop)
+        pa_threaded_mainloop_unlock(mMainLoop);
+}
+
+const char* PulsePlaybackEngine::getStateName(PLAYBACK_STATE_E state)
+{
+    switch (state)
+    {
+        case eStateConnecting:
+        case eStatePlaying:
+        case eStateDraining:
+            return "playing";
+        case eStatePaused:
+            return "paused";
+        case eStateStopped:
+            return "stopped";
+        case eStateError:
+        default:
+            return "error";
+    }
+}
+
+gboolean PulsePlaybackEngine::_notifyPlaybackStatus(gpointer data)
+{
+    PLAYBACK_STATUS_NOTIFY_T *notify = (PLAYBACK_STATUS_NOTIFY_T*)data;
+    if (notify && notify->callback)
+        notify->callback->callBackPlaybackStatusChanged(notify->playbackId, notify->state, notify->item);
+    delete notify;
+    return FALSE;
+}
+
+void PulsePlaybackEngine::setState(PLAYBACK_STREAM_T *playback, PLAYBACK_STATE_E state)
+{
+    const char *previous = getStateName(playback->state);
+    playback->state = state;
+    PM_LOG_DEBUG("PulsePlaybackEngine: %s state %d", playback->playbackId.c_str(), (int)state);
+    if (0 != std::strcmp(previous, getStateName(state)))
+        notifyStatus(playback->playbackId, getStateName(state), -1);
+}
+
+// item is -1 for the state of the whole playback
+void PulsePlaybackEngine::notifyStatus(const std::string &playbackId, const char *state, int item)
+{
+    if (!mCallback)
+        return;
+    //Subscribers are notified from the glib main loop, not from the pulse thread
+    PLAYBACK_STATUS_NOTIFY_T *notify = new PLAYBACK_STATUS_NOTIFY_T;
+    notify->callback = mCallback;
+    notify->playbackId = playbackId;
+    notify->state = state;
+    notify->item = item;
+    g_idle_add(&PulsePlaybackEngine::_notifyPlaybackStatus, notify);
+}
+
+bool PulsePlaybackEngine::connectContext()
+{
+    if (mContext)
+    {
+        pa_context_set_state_callback(mContext, nullptr, nullptr);
+        pa_context_disconnect(mContext);
+        pa_context_unref(mContext);
+    }
+    mContextFailed = false;
+    mSinkSpecKnown = false;
+    mContext = pa_context_new(pa_threaded_mainloop_get_api(mMainLoop), "AudioD-playback");
+    if (!mContext)
+    {
+        PM_LOG_ERROR(MSGID_PULSE_LINK, INIT_KVCOUNT, "PulsePlaybackEngine: failed to create context");
+        mContextFailed = true;
+        return false;
+    }
+    pa_context_set_state_callback(mContext, &PulsePlaybackEngine::contextStateCallback, this);
+    if (pa_context_connect(mContext, nullptr, PA_CONTEXT_NOFLAGS, nullptr) < 0)
+    {
+        PM_LOG_ERROR(MSGID_PULSE_LINK, INIT_KVCOUNT, "PulsePlaybackEngine: failed to connect context: %s", \
+            pa_strerror(pa_context_errno(mContext)));
+        mContextFailed = true;
+        return false;
+    }
+    return true;
+}
+
+void PulsePlaybackEngine::contextStateCallback(pa_context *context, void *userdata)
+{
+    PulsePlaybackEngine *engine = (PulsePlaybackEngine*)userdata;
+    if (!engine)
+        return;
+
+    switch (pa_context_get_state(context))
+    {
+        case PA_CONTEXT_READY:
+        {
+            PM_LOG_INFO(MSGID_PULSE_LINK, INIT_KVCOUNT, "PulsePlaybackEngine: connected to Pulse");
+            //Streams are started once the spec they are mixed at is known
+            pa_operation *op = pa_context_get_server_info(context, &PulsePlaybackEngine::serverInfoCallback, engine);
+            if (op)
+                pa_operation_unref(op);
+            else
+            {
+                engine->mSinkSpecKnown = true;
+                engine->startWaitingMixers();
+            }
+            break;
+        }
+        case PA_CONTEXT_FAILED:
+        case PA_CONTEXT_TERMINATED:
+        {
+            PM_LOG_WARNING(MSGID_PULSE_LINK, INIT_KVCOUNT, "PulsePlaybackEngine: Pulse connection lost");
+            //The context is replaced by the next play request
+            engine->mContextFailed = true;
+            std::map<std::string, PLAYBACK_MIXER_T*> mixers = engine->mMixers;
+            for (const auto &it : mixers)
+                engine->failMixer(it.second);
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+void PulsePlaybackEngine::serverInfoCallback(pa_context *context, const pa_server_info *info, void *userdata)
+{
+    PulsePlaybackEngine *engine = (PulsePlaybackEngine*)userdata;
+    if (!engine || context != engine->mContext)
+        return;
+    if (info && PcmConverter::isSupportedFormat(info->sample_spec.format))
+        engine->mSinkSpec = info->sample_spec;
+    else
+        memset(&engine->mSinkSpec, 0, sizeof(engine->mSinkSpec));
+    engine->mSinkSpecKnown = true;
+    PM_LOG_INFO(MSGID_PULSE_LINK, INIT_KVCOUNT, "PulsePlaybackEngine: sink spec format:%d rate:%u channels:%u", \
+        (int)engine->mSinkSpec.format, engine->mSinkSpec.rate, (unsigned)engine->mSinkSpec.channels);
+    engine->startWaitingMixers();
+}
+
+// Playbacks are mixed in S16, at the rate and channels of the server so pulse does not resample them
+pa_sample_spec PulsePlaybackEngine::getMixSpec() const
+{
+    pa_sample_spec spec;
+    bool known = pa_sample_spec_valid(&mSinkSpec);
+    spec.format = PA_SAMPLE_S16LE;
+    spec.rate = known ? mSinkSpec.rate : PLAYBACK_MIX_DEFAULT_RATE;
+    spec.channels = known ? mSinkSpec.channels : PLAYBACK_MIX_DEFAULT_CHANNELS;
+    return spec;
+}
+
+PulsePlaybackEngine::PLAYBACK_MIXER_T* PulsePlaybackEngine::getMixer(const std::string &sink)
+{
+    auto it = mMixers.find(sink);
+    if (it != mMixers.end())
+        return it->second;
+    PLAYBACK_MIXER_T *mixer = new PLAYBACK_MIXER_T;
+    mixer->engine = this;
+    mixer->sink = sink;
+    memset(&mixer->spec, 0, sizeof(mixer->spec));
+    mixer->stream = nullptr;
+    mixer->framesWritten = 0;
+    mMixers[sink] = mixer;
+    return mixer;
+}
+
+void PulsePlaybackEngine::startWaitingMixers()
+{
+    std::vector<PLAYBACK_MIXER_T*> waiting;
+    for (const auto &it : mMixers)
+    {
+        if (!it.second->stream)
+            waiting.push_back(it.second);
+    }
+    for (const auto &mixer : waiting)
+    {
+        if (!startMixer(mixer))
+            failMixer(mixer);
+    }
+}
+
+bool PulsePlaybackEngine::setupPlayback(PLAYBACK_STREAM_T *playback)
+{
+    if (!playback->converter.setup(playback->spec, playback->mixer->spec))
+    {
+        PM_LOG_ERROR(MSGID_PULSE_LINK, INIT_KVCOUNT, "PulsePlaybackEngine: cannot convert %s", playback->playbackId.c_str());
+        return false;
+    }
+    if (!playback->converter.isPassthrough())
+        PM_LOG_DEBUG("PulsePlaybackEngine: converting %s from %uHz %uch", playback->playbackId.c_str(), \
+            playback->spec.rate, (unsigned)playback->spec.channels);
+    return true;
+}
+
+bool PulsePlaybackEngine::startMixer(PLAYBACK_MIXER_T *mixer)
+{
+    mixer->spec = getMixSpec();
+    std::vector<PLAYBACK_STREAM_T*> playbacks = mixer->playbacks;
+    for (const auto &playback : playbacks)
+    {
+        if (!setupPlayback(playback))
+            finishStream(playback, eStateError);
+    }
+    if (mixer->playbacks.empty())
+    {
+        closeMixer(mixer, false);
+        return true;
+    }
+
+    mixer->stream = pa_stream_new(mContext, "playback", &mixer->spec, nullptr);
+    if (!mixer->stream)
+    {
+        PM_LOG_ERROR(MSGID_PULSE_LINK, INIT_KVCOUNT, "PulsePlaybackEngine: failed to create stream: %s", \
+            pa_strerror(pa_context_errno(mContext)));
+        return false;
+    }
+    pa_stream_set_state_callback(mixer->stream, &PulsePlaybackEngine::mixerStateCallback, mixer);
+    pa_stream_set_write_callback(mixer->stream, &PulsePlaybackEngine::mixerWriteCallback, mixer);
+    pa_stream_set_underflow_callback(mixer->stream, &PulsePlaybackEngine::mixerUnderflowCallback, mixer);
+
+    //No prebuffering, the stream plays whatever was mixed as soon as it is uncorked
+    pa_buffer_attr attr;
+    attr.maxlength = (uint32_t)-1;
+    attr.tlength = (uint32_t)pa_usec_to_bytes(PLAYBACK_MIX_LATENCY_MS * PA_USEC_PER_MSEC, &mixer->spec);
+    attr.prebuf = 0;
+    attr.minreq = (uint32_t)-1;
+    attr.fragsize = (uint32_t)-1;
+    //Playbacks paused before pulse was ready start corked
+    bool playing = std::any_of(mixer->playbacks.begin(), mixer->playbacks.end(),
+                               [](const PLAYBACK_STREAM_T *playback) { return eStatePaused != playback->state; });
+    //Timing updates let getPlaybackStatus report what is heard, not only what is written
+    int flags = PA_STREAM_ADJUST_LATENCY | PA_STREAM_INTERPOLATE_TIMING | PA_STREAM_AUTO_TIMING_UPDATE;
+    if (!playing)
+        flags |= PA_STREAM_START_CORKED;
+    if (pa_stream_connect_playback(mixer->stream, mixer->sink.c_str(), &attr, (pa_stream_flags_t)flags, nullptr, nullptr) < 0)
+    {
+        PM_LOG_ERROR(MSGID_PULSE_LINK, INIT_KVCOUNT, "PulsePlaybackEngine: failed to connect stream: %s", \
+            pa_strerror(pa_context_errno(mContext)));
+        return false;
+    }
+    PM_LOG_DEBUG("PulsePlaybackEngine: mixing %s at %uHz %uch", mixer->sink.c_str(), mixer->spec.rate, \
+        (unsigned)mixer->spec.channels);
+    return true;
+}
+
+void PulsePlaybackEngine::mixerStateCallback(pa_stream *stream, void *userdata)
+{
+    PLAYBACK_MIXER_T *mixer = (PLAYBACK_MIXER_T*)userdata;
+    if (!mixer)
+        return;
+    PulsePlaybackEngine *engine = mixer->engine;
+    bool closing = (engine->mClosingMixers.find(mixer) != engine->mClosingMixers.end());
+
+    switch (pa_stream_get_state(stream))
+    {
+        case PA_STREAM_READY:
+            if (closing)
+                break;
+            for (const auto &playback : mixer->playbacks)
+            {
+                if (eStateConnecting == playback->state)
+                    playback->state = eStatePlaying;
+            }
+            //Corks the stream if every playback was paused while it was created
+            engine->updateMixer(mixer, true);
+            break;
+        case PA_STREAM_FAILED:
+            PM_LOG_ERROR(MSGID_PULSE_LINK, INIT_KVCOUNT, "PulsePlaybackEngine: stream of %s failed", mixer->sink.c_str());
+            if (closing)
+                engine->releaseMixer(mixer);
+            else
+                engine->failMixer(mixer);
+            break;
+        case PA_STREAM_TERMINATED:
+            engine->releaseMixer(mixer);
+            break;
+        default:
+            break;
+    }
+}
+
+void PulsePlaybackEngine::mixerWriteCallback(pa_stream *stream, size_t length, void *userdata)
+{
+    PLAYBACK_MIXER_T *mixer = (PLAYBACK_MIXER_T*)userdata;
+    if (mixer)
+        mixer->engine->writeMixer(mixer, length);
+}
+
+// The stream ran out of mixed data while it was playing, the sink played silence
+void PulsePlaybackEngine::mixerUnderflowCallback(pa_stream *stream, void *userdata)
+{
+    PLAYBACK_MIXER_T *mixer = (PLAYBACK_MIXER_T*)userdata;
+    if (!mixer)
+        return;
+    mixer->engine->mUnderruns++;
+    PM_LOG_DEBUG("PulsePlaybackEngine: underrun on %s", mixer->sink.c_str());
+}
+
+// Sums the playing playbacks of the mixer into the stream write buffer.
+// A playback is reported stopped once its last data is queued, at most
+// PLAYBACK_MIX_LATENCY_MS before it is heard.
+void PulsePlaybackEngine::writeMixer(PLAYBACK_MIXER_T *mixer, size_t length)
+{
+    const size_t frameSize = pa_frame_size(&mixer->spec);
+    std::vector<PLAYBACK_STREAM_T*> ended;
+    while (length >= frameSize)
+    {
+        void *buffer = nullptr;
+        size_t bytes = std::min(length, (size_t)PLAYBACK_MIX_CHUNK_FRAMES * frameSize);
+        if (pa_stream_begin_write(mixer->stream, &buffer, &bytes) < 0 || !buffer)
+        {
+            PM_LOG_ERROR(MSGID_PULSE_LINK, INIT_KVCOUNT, "PulsePlaybackEngine: begin write failed for %s", \
+                mixer->sink.c_str());
+            failMixer(mixer);
+            return;
+        }
+        bytes -= bytes % frameSize;
+        memset(buffer, 0, bytes);
+        mixer->buffer.resize(bytes);
+
+        size_t mixed = 0;
+        const uint64_t chunkStart = mixer->framesWritten;
+        for (const auto &playback : mixer->playbacks)
+        {
+            if (!isMixed(playback) || playback->endOfFile)
+                continue;
+            if (playback->fadingOut && !PcmRamp::isActive(playback->ramp))
+            {
+                endFadeOut(playback, ended);
+                continue;
+            }
+            //A fading out playback is mixed up to the end of its fade
+            size_t wanted = bytes;
+            if (playback->fadingOut)
+                wanted = std::min(bytes, (size_t)(playback->ramp.frames - playback->ramp.position) * frameSize);
+            size_t read = readPlayback(playback, mixer->buffer.data(), wanted);
+            read -= read % frameSize;
+            if (read < wanted)
+            {
+                playback->endOfFile = true;
+                ended.push_back(playback);
+            }
+            if (PcmRamp::isActive(playback->ramp))
+            {
+                //The ramp gains include the playback gain
+                PcmRamp::apply(playback->ramp, mixer->buffer.data(), read / frameSize, mixer->spec.format, mixer->spec.channels);
+                PcmMixer::mix((int16_t*)buffer, (const int16_t*)mixer->buffer.data(), read / sizeof(int16_t), \
+                    PCM_MIXER_GAIN_UNITY);
+                if (playback->fadingOut && !PcmRamp::isActive(playback->ramp) && !playback->endOfFile)
+                    endFadeOut(playback, ended);
+            }
+            else
+                PcmMixer::mix((int16_t*)buffer, (const int16_t*)mixer->buffer.data(), read / sizeof(int16_t), playback->gain);
+            playback->framesWritten += read / frameSize;
+            if (read > 0)
+                playback->writeEnd = chunkStart + read / frameSize;
+            mixed = std::max(mixed, read);
+        }
+        if (0 == mixed)
+        {
+            pa_stream_cancel_write(mixer->stream);
+            break;
+        }
+        pa_stream_write(mixer->stream, buffer, mixed, nullptr, 0, PA_SEEK_RELATIVE);
+        mixer->framesWritten += mixed / frameSize;
+        length -= std::min(length, mixed);
+    }
+
+    if (ended.empty())
+        return;
+    //Paused playbacks are only listed to cork the stream
+    for (const auto &playback : ended)
+    {
+        if (playback->endOfFile)
+            finishStream(playback, eStateStopped);
+    }
+    updateMixer(mixer, true);
+}
+
+// A paused playback stays and is no longer mixed, a stopped one is finished
+// like a playback which reached its end
+void PulsePlaybackEngine::endFadeOut(PLAYBACK_STREAM_T *playback, std::vector<PLAYBACK_STREAM_T*> &ended)
+{
+    playback->fadingOut = false;
+    if (eStatePaused != playback->state)
+        playback->endOfFile = true;
+    ended.push_back(playback);
+}
+
+bool PulsePlaybackEngine::isMixed(const PLAYBACK_STREAM_T *playback)
+{
+    return eStatePlaying == playback->state || playback->fadingOut;
+}
+
+// Reads the current item and goes on with the queued ones, so the
+// playback only ends with the last item
+size_t PulsePlaybackEngine::readPlayback(PLAYBACK_STREAM_T *playback, void *buffer, size_t bytes)
+{
+    const size_t frameSize = pa_frame_size(&playback->mixer->spec);
+    size_t read = readSource(playback, buffer, bytes);
+    //A stopped playback fades out on its current item, the queued ones are dropped instead of started
+    if (eStateStopped == playback->state)
+    {
+        dropQueue(playback);
+        return read;
+    }
+    while (read < bytes && !playback->queue.empty())
+    {
+        //A truncated last frame would shift the channels of the next item
+        read -= read % frameSize;
+        if (startNextItem(playback))
+            read += readSource(playback, (uint8_t*)buffer + read, bytes - read);
+    }
+    return read;
+}
+
+size_t PulsePlaybackEngine::readSource(PLAYBACK_STREAM_T *playback, void *buffer, size_t bytes)
+{
+    if (playback->converter.isPassthrough())
+        return playback->source->read(buffer, bytes);
+    return readConverted(playback, buffer, bytes);
+}
+
+void PulsePlaybackEngine::dropQueue(PLAYBACK_STREAM_T *playback)
+{
+    for (const auto &item : playback->queue)
+        delete item.source;
+    playback->queue.clear();
+}
+
+bool PulsePlaybackEngine::startNextItem(PLAYBACK_STREAM_T *playback)
+{
+    notifyStatus(playback->playbackId, getStateName(eStateStopped), playback->item);
+    PLAYBACK_ITEM_T next = playback->queue.front();
+    playback->queue.pop_front();
+    delete playback->source;
+    playback->source = next.source;
+    playback->spec = next.spec;
+    playback->item = next.index;
+    playback->converted.clear();
+    playback->convertedOffset = 0;
+    if (!playback->queue.empty())
+        playback->queue.front().source->prefetch();
+    if (!setupPlayback(playback))
+    {
+        //The item is skipped, the source is left empty until the next one starts
+        notifyStatus(playback->playbackId, getStateName(eStateError), playback->item);
+        playback->source->close();
+        playback->converter.setup(playback->mixer->spec, playback->mixer->spec);
+        return false;
+    }
+    notifyStatus(playback->playbackId, getStateName(eStatePlaying), playback->item);
+    return true;
+}
+
+size_t PulsePlaybackEngine::readConverted(PLAYBACK_STREAM_T *playback, void *buffer, size_t bytes)
+{
+    uint8_t input[PLAYBACK_CONVERT_CHUNK_SIZE];
+    size_t copied = 0;
+    while (copied < bytes)
+    {
+        if (playback->convertedOffset == playback->converted.size())
+        {
+            playback->converted.clear();
+            playback->convertedOffset = 0;
+            size_t read = playback->source->read(input, sizeof(input));
+            if (0 == read)
+                break;
+            playback->converter.convert(input, read, playback->converted);
+            continue;
+        }
+        size_t count = std::min(bytes - copied, playback->converted.size() - playback->convertedOffset);
+        memcpy((uint8_t*)buffer + copied, playback->converted.data() + playback->convertedOffset, count);
+        playback->convertedOffset += count;
+        copied += count;
+    }
+    return copied;
+}
+
+// Keeps the stream of a mixer in line with its playbacks: closed once it has none,
+// corked while all of them are paused. drain lets the stream play out what is queued.
+void PulsePlaybackEngine::updateMixer(PLAYBACK_MIXER_T *mixer, bool drain)
+{
+    if (mixer->playbacks.empty())
+    {
+        closeMixer(mixer, drain);
+        return;
+    }
+    if (!mixer->stream || PA_STREAM_READY != pa_stream_get_state(mixer->stream))
+        return;
+
+    bool playing = std::any_of(mixer->playbacks.begin(), mixer->playbacks.end(),
+                               [](const PLAYBACK_STREAM_T *playback) { return isMixed(playback); });
+    bool corked = pa_stream_is_corked(mixer->stream);
+    if (playing == corked)
+    {
+        pa_operation *op = pa_stream_cork(mixer->stream, playing ? 0 : 1, &PulsePlaybackEngine::mixerCorkCallback, mixer);
+        if (op)
+            pa_operation_unref(op);
+    }
+    //Pulse only asks for data as the stream plays, a new or resumed playback is mixed in right away
+    if (playing)
+        writeMixer(mixer, pa_stream_writable_size(mixer->stream));
+}
+
+void PulsePlaybackEngine::failMixer(PLAYBACK_MIXER_T *mixer)
+{
+    std::vector<PLAYBACK_STREAM_T*> playbacks = mixer->playbacks;
+    for (const auto &playback : playbacks)
+        finishStream(playback, eStateError);
+    closeMixer(mixer, false);
+}
+
+void PulsePlaybackEngine::closeMixer(PLAYBACK_MIXER_T *mixer, bool drain)
+{
+    auto it = mMixers.find(mixer->sink);
+    if (it != mMixers.end() && it->second == mixer)
+        mMixers.erase(it);
+    if (mClosingMixers.count(mixer))
+        return;
+
+    pa_stream_state_t streamState = mixer->stream ? pa_stream_get_state(mixer->stream) : PA_STREAM_UNCONNECTED;
+    if (PA_STREAM_CREATING != streamState && PA_STREAM_READY != streamState)
+    {
+        releaseMixer(mixer);
+        return;
+    }
+    //Pending operations are cancelled once pulse terminates the stream.
+    //A drained stream runs empty on purpose, that is not an underrun.
+    pa_stream_set_write_callback(mixer->stream, nullptr, nullptr);
+    pa_stream_set_underflow_callback(mixer->stream, nullptr, nullptr);
+    mClosingMixers.insert(mixer);
+    pa_operation *op = nullptr;
+    if (drain && PA_STREAM_READY == streamState)
+        op = pa_stream_drain(mixer->stream, &PulsePlaybackEngine::mixerDrainCallback, mixer);
+    if (op)
+        pa_operation_unref(op);
+    else
+        pa_stream_disconnect(mixer->stream);
+}
+
+void PulsePlaybackEngine::mixerDrainCallback(pa_stream *stream, int success, void *userdata)
+{
+    PLAYBACK_MIXER_T *mixer = (PLAYBACK_MIXER_T*)userdata;
+    if (!mixer)
+        return;
+    if (!success)
+        PM_LOG_WARNING(MSGID_PULSE_LINK, INIT_KVCOUNT, "PulsePlaybackEngine: drain failed for %s", mixer->sink.c_str());
+    pa_stream_disconnect(stream);
+}
+
+void PulsePlaybackEngine::mixerCorkCallback(pa_stream *stream, int success, void *userdata)
+{
+    PLAYBACK_MIXER_T *mixer = (PLAYBACK_MIXER_T*)userdata;
+    if (!mixer || success || mixer->engine->mClosingMixers.count(mixer))
+        return;
+    PM_LOG_ERROR(MSGID_PULSE_LINK, INIT_KVCOUNT, "PulsePlaybackEngine: cork failed for %s", mixer->sink.c_str());
+    mixer->engine->failMixer(mixer);
+}
+
+void PulsePlaybackEngine::releaseMixer(PLAYBACK_MIXER_T *mixer)
+{
+    if (mixer->stream)
+    {
+        pa_stream_set_state_callback(mixer->stream, nullptr, nullptr);
+        pa_stream_set_write_callback(mixer->stream, nullptr, nullptr);
+        pa_stream_set_underflow_callback(mixer->stream, nullptr, nullptr);
+        pa_stream_unref(mixer->stream);
+        mixer->stream = nullptr;
+    }
+    mClosingMixers.erase(mixer);
+    auto it = mMixers.find(mixer->sink);
+    if (it != mMixers.end() && it->second == mixer)
+        mMixers.erase(it);
+    delete mixer;
+}
+
+// Removes the playback from its mixer, the caller updates the mixer
+void PulsePlaybackEngine::finishStream(PLAYBACK_STREAM_T *playback, PLAYBACK_STATE_E state)
+{
+    mStreams.erase(playback->playbackId);
+    mFinishedPlaybacks.push_back(std::make_pair(playback->playbackId, state));
+    if (mFinishedPlaybacks.size() > PLAYBACK_FINISHED_HISTORY_SIZE)
+        mFinishedPlaybacks.pop_front();
+    //The last item of a queue ends with the playback
+    if (playback->itemCount > 1)
+        notifyStatus(playback->playbackId, getStateName(state), playback->item);
+    setState(playback, state);
+
+    if (playback->mixer)
+    {
+        std::vector<PLAYBACK_STREAM_T*> &playbacks = playback->mixer->playbacks;
+        playbacks.erase(std::remove(playbacks.begin(), playbacks.end(), playback), playbacks.end());
+    }
+    //Items which did not start are dropped with the playback
+    dropQueue(playback);
+    delete playback->source;
+    delete playback;
+}
+
+PulsePlaybackEngine::PLAYBACK_STREAM_T* PulsePlaybackEngine::findStream(const std::string &playbackId)
+{
+    auto it = mStreams.find(playbackId);
+    if (it == mStreams.end())
+        return nullptr;
+    return it->second;
+}
+
+PcmFileSource* PulsePlaybackEngine::openSource(const char *fileName, const char *format, int rate, int channels, \
+    pa_sample_spec &spec)
+{
+    PcmFileSource *source = new PcmFileSource;
+    if (!source->open(fileName))
+    {
+        delete source;
+        PM_LOG_ERROR(MSGID_PULSE_LINK, INIT_KVCOUNT, "PulsePlaybackEngine: File Open Failed");
+        return nullptr;
+    }
+    //A compressed file carries its own spec
+    if (!source->getSampleSpec(spec))
+    {
+        spec.format = getSampleFormat(format);
+        spec.rate = rate;
+        spec.channels = channels;
+    }
+    return source;
+}
+
+std::string PulsePlaybackEngine::play(const char *fileName, const char *sink, const char *format, int rate, int channels, int volume)
+{
+    PMTRACE_FUNCTION;
+    if (nullptr == fileName || nullptr == sink)
+        return std::string();
+
+    pa_sample_spec spec;
+    PcmFileSource *source = openSource(fileName, format, rate, channels, spec);
+    if (!source)
+        return std::string();
+
+    if (!mMainLoop)
+    {
+        mMainLoop = pa_threaded_mainloop_new();
+        if (!mMainLoop || pa_threaded_mainloop_start(mMainLoop) < 0)
+        {
+            PM_LOG_ERROR(MSGID_PULSE_LINK, INIT_KVCOUNT, "PulsePlaybackEngine: failed to start mainloop");
+            if (mMainLoop)
+                pa_threaded_mainloop_free(mMainLoop);
+            mMainLoop = nullptr;
+            delete source;
+            return std::string();
+        }
+    }
+
+    pa_threaded_mainloop_lock(mMainLoop);
+    if (mStreams.size() >= PLAYBACK_STREAM_POOL_SIZE)
+    {
+        pa_threaded_mainloop_unlock(mMainLoop);
+        PM_LOG_ERROR(MSGID_PULSE_LINK, INIT_KVCOUNT, "PulsePlaybackEngine::play: %d playbacks already active", \
+            PLAYBACK_STREAM_POOL_SIZE);
+        delete source;
+        return std::string();
+    }
+    if ((!mContext || mContextFailed) && !connectContext())
+    {
+        pa_threaded_mainloop_unlock(mMainLoop);
+        delete source;
+        return std::string();
+    }
+
+    PLAYBACK_STREAM_T *playback = new PLAYBACK_STREAM_T;
+    playback->engine = this;
+    playback->playbackId = GenerateUniqueID()();
+    playback->sink = sink;
+    playback->spec = spec;
+    playback->mixer = getMixer(playback->sink);
+    playback->item = 0;
+    playback->itemCount = 1;
+    playback->source = source;
+    playback->convertedOffset = 0;
+    //Pulse maps the sink input volume of the stream, a curve only shapes the gain of audiod
+    if (VolumeCurve::hasCurve(playback->sink))
+        playback->gain = PcmMixer::linearToGain(pa_sw_volume_to_linear(VolumeCurve::getVolume(playback->sink, volume)));
+    else
+        playback->gain = PcmMixer::volumeToGain(volume);
+    playback->fadingOut = false;
+    const PLAYBACK_RAMP_CONFIG_T &rampConfig = getRampConfig(playback->sink);
+    PcmRamp::start(playback->ramp, 0, playback->gain, getRampFrames(playback), rampConfig.curve);
+    playback->framesWritten = 0;
+    playback->writeEnd = 0;
+    playback->endOfFile = false;
+    playback->state = eStateConnecting;
+    mStreams[playback->playbackId] = playback;
+    playback->mixer->playbacks.push_back(playback);
+
+    //Otherwise the mixer is started once the context is ready and the sink spec known
+    PLAYBACK_MIXER_T *mixer = playback->mixer;
+    std::string playbackId = playback->playbackId;
+    if (mixer->stream)
+    {
+        if (setupPlayback(playback))
+        {
+            if (PA_STREAM_READY == pa_stream_get_state(mixer->stream))
+                playback->state = eStatePlaying;
+            updateMixer(mixer, false);
+        }
+        else
+        {
+            finishStream(playback, eStateError);
+            updateMixer(mixer, false);
+            playbackId.clear();
+        }
+    }
+    else if (PA_CONTEXT_READY == pa_context_get_state(mContext) && mSinkSpecKnown)
+    {
+        if (!startMixer(mixer))
+            failMixer(mixer);
+        //startMixer finishes the playbacks it cannot convert
+        if (!findStream(playbackId))
+            playbackId.clear();
+    }
+    PM_LOG_DEBUG("PulsePlaybackEngine::play: %s active:%zu", playbackId.c_str(), mStreams.size());
+    pa_threaded_mainloop_unlock(mMainLoop);
+    return playbackId;
+}
+
+int PulsePlaybackEngine::enqueue(const std::string &playbackId, const char *fileName, const char *format, int rate, int channels)
+{
+    PMTRACE_FUNCTION;
+    if (!mMainLoop || nullptr == fileName)
+        return -1;
+
+    //The file is opened here so a missing file is reported to the caller
+    PLAYBACK_ITEM_T item;
+    item.source = openSource(fileName, format, rate, channels, item.spec);
+    if (!item.source)
+        return -1;
+
+    pa_threaded_mainloop_lock(mMainLoop);
+    PLAYBACK_STREAM_T *playback = findStream(playbackId);
+    //Nothing is queued on a playback which is ending, stopped or fading out
+    if (!playback || playback->endOfFile || eStateStopped == playback->state || eStateError == playback->state || \
+        playback->fadingOut || playback->queue.size() >= PLAYBACK_QUEUE_MAX_ITEMS)
+    {
+        pa_threaded_mainloop_unlock(mMainLoop);
+        PM_LOG_ERROR(MSGID_PULSE_LINK, INIT_KVCOUNT, "PulsePlaybackEngine::enqueue: cannot queue on %s", \
+            playbackId.c_str());
+        delete item.source;
+        return -1;
+    }
+    item.index = playback->itemCount++;
+    //The item following the current one is read ahead while the current one plays
+    if (playback->queue.empty())
+        item.source->prefetch();
+    playback->queue.push_back(item);
+    PM_LOG_DEBUG("PulsePlaybackEngine::enqueue: %s item %d", playbackId.c_str(), item.index);
+    pa_threaded_mainloop_unlock(mMainLoop);
+    return item.index;
+}
+
+bool PulsePlaybackEngine::pause(const std::string &playbackId)
+{
+    if (!mMainLoop)
+        return false;
+    bool status = false;
+    pa_threaded_mainloop_lock(mMainLoop);
+    PLAYBACK_STREAM_T *playback = findStream(playbackId);
+    if (playback && (eStatePlaying == playback->state || eStateConnecting == playback->state))
+    {
+        //The playback fades out, then it is no longer mixed and the stream is corked if no other one plays
+        playback->fadingOut = canFade(playback);
+        PcmRamp::retarget(playback->ramp, 0, playback->fadingOut ? getRampFrames(playback) : 0);
+        setState(playback, eStatePaused);
+        updateMixer(playback->mixer, false);
+        status = true;
+    }
+    pa_threaded_mainloop_unlock(mMainLoop);
+    return status;
+}
+
+bool PulsePlaybackEngine::resume(const std::string &playbackId)
+{
+    if (!mMainLoop)
+        return false;
+    bool status = false;
+    pa_threaded_mainloop_lock(mMainLoop);
+    PLAYBACK_STREAM_T *playback = findStream(playbackId);
+    if (playback && eStatePaused == playback->state)
+    {
+        PLAYBACK_MIXER_T *mixer = playback->mixer;
+        bool ready = mixer->stream && PA_STREAM_READY == pa_stream_get_state(mixer->stream);
+        //Fades in from where a fade out in progress got to
+        playback->fadingOut = false;
+        PcmRamp::retarget(playback->ramp, playback->gain, getRampFrames(playback));
+        setState(playback, ready ? eStatePlaying : eStateConnecting);
+        updateMixer(mixer, false);
+        status = true;
+    }
+    pa_threaded_mainloop_unlock(mMainLoop);
+    return status;
+}
+
+bool PulsePlaybackEngine::stop(const std::string &playbackId)
+{
+    if (!mMainLoop)
+        return false;
+    bool status = false;
+    pa_threaded_mainloop_lock(mMainLoop);
+    PLAYBACK_STREAM_T *playback = findStream(playbackId);
+    if (playback && (canFade(playback) || playback->fadingOut))
+    {
+        //The playback is finished by writeMixer once it faded out
+        if (!playback->fadingOut)
+            PcmRamp::retarget(playback->ramp, 0, getRampFrames(playback));
+        playback->fadingOut = true;
+        setState(playback, eStateStopped);
+        dropQueue(playback);
+        status = true;
+    }
+    else if (playback)
+    {
+        PLAYBACK_MIXER_T *mixer = playback->mixer;
+        finishStream(playback, eStateStopped);
+        //The last playback of a sink is cut at once, what is queued is dropped with the stream
+        updateMixer(mixer, false);
+        status = true;
+    }
+    else
+    {
+        //Playbacks which already ended were reclaimed, stopping them is a no-op
+        for (const auto &it : mFinishedPlaybacks)
+        {
+            if (it.first == playbackId)
+                status = true;
+        }
+    }
+    pa_threaded_mainloop_unlock(mMainLoop);
+    return status;
+}
+
+const PulsePlaybackEngine::PLAYBACK_RAMP_CONFIG_T& PulsePlaybackEngine::getRampConfig(const std::string &sink) const
+{
+    auto it = mSinkRamps.find(sink);
+    return (it != mSinkRamps.end()) ? it->second : mDefaultRamp;
+}
+
+uint32_t PulsePlaybackEngine::getRampFrames(PLAYBACK_STREAM_T *playback) const
+{
+    uint32_t rate = playback->mixer->spec.rate ? playback->mixer->spec.rate : getMixSpec().rate;
+    return (uint32_t)((uint64_t)getRampConfig(playback->sink).milliseconds * rate / 1000);
+}
+
+// A fade needs the stream to take the data, a corked or connecting stream is cut at once
+bool PulsePlaybackEngine::canFade(PLAYBACK_STREAM_T *playback) const
+{
+    PLAYBACK_MIXER_T *mixer = playback->mixer;
+    return eStatePlaying == playback->state && getRampFrames(playback) > 0 &&
+           mixer->stream && PA_STREAM_READY == pa_stream_get_state(mixer->stream);
+}
+
+void PulsePlaybackEngine::setGainRamp(const std::string &sink, int milliseconds, PCM_RAMP_CURVE_E curve)
+{
+    if (mMainLoop)
+        pa_threaded_mainloop_lock(mMainLoop);
+    PLAYBACK_RAMP_CONFIG_T config;
+    config.milliseconds = std::max(0, milliseconds);
+    config.curve = curve;
+    if (sink.empty())
+        mDefaultRamp = config;
+    else
+        mSinkRamps[sink] = config;
+    if (mMainLoop)
+        pa_threaded_mainloop_unlock(mMainLoop);
+}
+
+bool PulsePlaybackEngine::getGainRamp(const std::string &sink, int &milliseconds)
+{
+    if (mMainLoop)
+        pa_threaded_mainloop_lock(mMainLoop);
+    auto it = mSinkRamps.find(sink);
+    bool found = (it != mSinkRamps.end());
+    if (found)
+        milliseconds = it->second.milliseconds;
+    if (mMainLoop)
+        pa_threaded_mainloop_unlock(mMainLoop);
+    return found;
+}
+
+// The playback data still queued in pulse is what the mixer wrote after
+// the stream read position, the stream latency tells where that is
+void PulsePlaybackEngine::getTiming(PLAYBACK_STREAM_T *playback, PLAYBACK_TIMING_T &timing)
+{
+    PLAYBACK_MIXER_T *mixer = playback->mixer;
+    timing.framesWritten = playback->framesWritten;
+    timing.positionFrames = 0;
+    timing.latency = 0;
+    //A playback waiting for its stream is reported at the rate it will be mixed at
+    timing.rate = mixer->spec.rate ? mixer->spec.rate : getMixSpec().rate;
+    timing.item = playback->item;
+    if (!mixer->stream || PA_STREAM_READY != pa_stream_get_state(mixer->stream))
+        return;
+
+    uint64_t queued = mixer->framesWritten;
+    int negative = 0;
+    if (0 == pa_stream_get_latency(mixer->stream, &timing.latency, &negative))
+    {
+        if (negative)
+            timing.latency = 0;
+        queued = std::min(queued, (uint64_t)timing.latency * mixer->spec.rate / PA_USEC_PER_SEC);
+    }
+    //Without timing info yet nothing is assumed to be heard
+    uint64_t played = mixer->framesWritten - queued;
+    uint64_t pending = playback->writeEnd > played ? playback->writeEnd - played : 0;
+    timing.positionFrames = playback->framesWritten - std::min(pending, playback->framesWritten);
+}
+
+uint32_t PulsePlaybackEngine::getUnderrunCount()
+{
+    if (!mMainLoop)
+        return 0;
+    pa_threaded_mainloop_lock(mMainLoop);
+    uint32_t underruns = mUnderruns;
+    pa_threaded_mainloop_unlock(mMainLoop);
+    return underruns;
+}
+
+std::string PulsePlaybackEngine::getPlaybackStatus(const std::string &playbackId, PLAYBACK_TIMING_T *timing)
+{
+    if (!mMainLoop)
+        return std::string();
+    std::string state;
+    pa_threaded_mainloop_lock(mMainLoop);
+    PLAYBACK_STREAM_T *playback = findStream(playbackId);
+    if (playback)
+    {
+        state = getStateName(playback->state);
+        if (timing)
+            getTiming(playback, *timing);
+    }
+    else
+    {
+        for (const auto &it : mFinishedPlaybacks)
+        {
+            if (it.first == playbackId)
+                state = getStateName(it.second);
+        }
+    }
+    pa_threaded_mainloop_unlock(mMainLoop);
+    return state;
+}
@@ -0,0 +1,99 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+// This file is also built into the host tests, keep it free of audiod dependencies
+
+#include "PulseReplyTracker.h"
+#include <algorithm>
+
+PulseReplyTracker::PulseReplyTracker() : mSequence(0), mLateReplies(0)
+{
+}
+
+uint32_t PulseReplyTracker::add(uint32_t replyID, uint64_t deadline)
+{
+    //0 is never used, it tells the caller a reply matched no request
+    if (0 == ++mSequence)
+        ++mSequence;
+    mRequests[mSequence] = {replyID, deadline};
+    mPendingReplies[replyID].push_back(mSequence);
+    return mSequence;
+}
+
+void PulseReplyTracker::remove(uint32_t sequence)
+{
+    auto it = mRequests.find(sequence);
+    if (it == mRequests.end())
+        return;
+    auto itReply = mPendingReplies.find(it->second.replyID);
+    if (itReply != mPendingReplies.end())
+    {
+        std::deque<uint32_t> &sequences = itReply->second;
+        sequences.erase(std::remove(sequences.begin(), sequences.end(), sequence), sequences.end());
+        if (sequences.empty())
+            mPendingReplies.erase(itReply);
+    }
+    mRequests.erase(it);
+}
+
+uint32_t PulseReplyTracker::complete(uint32_t replyID)
+{
+    //Expired requests are older than the pending ones, their replies come first
+    auto itExpired = mExpiredReplies.find(replyID);
+    if (itExpired != mExpiredReplies.end())
+    {
+        if (0 == --itExpired->second)
+            mExpiredReplies.erase(itExpired);
+        mLateReplies++;
+        return 0;
+    }
+    auto itReply = mPendingReplies.find(replyID);
+    if (itReply == mPendingReplies.end() || itReply->second.empty())
+        return 0;
+    uint32_t sequence = itReply->second.front();
+    remove(sequence);
+    return sequence;
+}
+
+std::vector<uint32_t> PulseReplyTracker::expire(uint64_t now)
+{
+    std::vector<uint32_t> expired;
+    auto it = mRequests.begin();
+    while (it != mRequests.end())
+    {
+        uint32_t sequence = it->first;
+        uint32_t replyID = it->second.replyID;
+        bool due = (it->second.deadline <= now);
+        ++it;
+        if (!due)
+            continue;
+        mExpiredReplies[replyID]++;
+        expired.push_back(sequence);
+        remove(sequence);
+    }
+    return expired;
+}
+
+std::vector<uint32_t> PulseReplyTracker::clear()
+{
+    std::vector<uint32_t> pending;
+    for (const auto &it : mRequests)
+        pending.push_back(it.first);
+    mRequests.clear();
+    mPendingReplies.clear();
+    mExpiredReplies.clear();
+    return pending;
+}
@@ -0,0 +1,127 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "VolumeCurve.h"
+#include "log.h"
+#include <algorithm>
+
+static constexpr VOLUME_CURVE_TABLE_T kLinearCurve = VolumeCurve::makeLinear();
+static constexpr VOLUME_CURVE_TABLE_T kLogCurve = VolumeCurve::makeLog(VOLUME_CURVE_LOG_MIN_DB, 0.0);
+
+//The built in curves are checked when audiod is built
+static_assert(VolumeCurve::isMonotonic(kLinearCurve), "linear volume curve is not monotonic");
+static_assert(VolumeCurve::isMonotonic(kLogCurve), "log volume curve is not monotonic");
+static_assert(0 == VolumeCurve::findCollapsedStep(kLinearCurve), "linear volume curve has collapsed steps");
+static_assert(0 == VolumeCurve::findCollapsedStep(kLogCurve), "log volume curve has collapsed steps");
+static_assert(PA_VOLUME_MUTED == kLinearCurve.volume[0] && PA_VOLUME_NORM == kLinearCurve.volume[VOLUME_CURVE_MAX_STEP],
+    "linear volume curve does not end at mute and PA_VOLUME_NORM");
+static_assert(PA_VOLUME_MUTED == kLogCurve.volume[0] && PA_VOLUME_NORM == kLogCurve.volume[VOLUME_CURVE_MAX_STEP],
+    "log volume curve does not end at mute and PA_VOLUME_NORM");
+//-60 dB is 10^-1 of PA_VOLUME_NORM, allow one unit of rounding
+static_assert(kLogCurve.volume[1] >= PA_VOLUME_NORM / 10 - 1 && kLogCurve.volume[1] <= PA_VOLUME_NORM / 10 + 1,
+    "log volume curve does not start at its minimum dB");
+
+std::map<std::string, VOLUME_CURVE_TABLE_T> VolumeCurve::mCurves;
+
+bool VolumeCurve::setCurve(const std::string &name, const pbnjson::JValue &curve)
+{
+    std::string type;
+    if (!curve.isObject() || curve["type"].asString(type) != CONV_OK)
+    {
+        PM_LOG_ERROR(MSGID_VOLUME_CURVE, INIT_KVCOUNT, "setCurve: volumeCurve of %s has no type", name.c_str());
+        return false;
+    }
+
+    VOLUME_CURVE_TABLE_T table = kLinearCurve;
+    if ("log" == type)
+    {
+        double minDb = VOLUME_CURVE_LOG_MIN_DB;
+        double maxDb = 0.0;
+        if (curve.hasKey("minDb"))
+            minDb = curve["minDb"].asNumber<double>();
+        if (curve.hasKey("maxDb"))
+            maxDb = curve["maxDb"].asNumber<double>();
+        if (minDb >= maxDb || maxDb > 0.0)
+        {
+            PM_LOG_ERROR(MSGID_VOLUME_CURVE, INIT_KVCOUNT, "setCurve: invalid log range %.1f to %.1f dB for %s",\
+                minDb, maxDb, name.c_str());
+            return false;
+        }
+        table = (VOLUME_CURVE_LOG_MIN_DB == minDb && 0.0 == maxDb) ? kLogCurve : makeLog(minDb, maxDb);
+    }
+    else if ("piecewise" == type)
+    {
+        pbnjson::JValue points = curve["points"];
+        if (!points.isArray() || points.arraySize() < 2 || points.arraySize() > VOLUME_CURVE_MAX_POINTS)
+        {
+            PM_LOG_ERROR(MSGID_VOLUME_CURVE, INIT_KVCOUNT, "setCurve: piecewise curve of %s needs 2 to %d points",\
+                name.c_str(), VOLUME_CURVE_MAX_POINTS);
+            return false;
+        }
+        VOLUME_CURVE_POINT_T curvePoints[VOLUME_CURVE_MAX_POINTS];
+        size_t count = 0;
+        for (const pbnjson::JValue &point : points.items())
+        {
+            VOLUME_CURVE_POINT_T &curvePoint = curvePoints[count];
+            curvePoint.step = point["step"].asNumber<int>();
+            curvePoint.dB = point["dB"].asNumber<double>();
+            //Steps must rise and the dB must not fall, so the table stays monotonic
+            if (curvePoint.step < 1 || curvePoint.step > VOLUME_CURVE_MAX_STEP || curvePoint.dB > 0.0 ||
+                (count > 0 && (curvePoint.step <= curvePoints[count - 1].step || curvePoint.dB < curvePoints[count - 1].dB)))
+            {
+                PM_LOG_ERROR(MSGID_VOLUME_CURVE, INIT_KVCOUNT, "setCurve: invalid point %zu of %s", count, name.c_str());
+                return false;
+            }
+            count++;
+        }
+        table = makePiecewise(curvePoints, count);
+    }
+    else if ("linear" != type)
+    {
+        PM_LOG_ERROR(MSGID_VOLUME_CURVE, INIT_KVCOUNT, "setCurve: unknown curve type %s for %s", type.c_str(), name.c_str());
+        return false;
+    }
+
+    //A step muted below its range or a flat part of a curve would make volume keys do nothing
+    int collapsedStep = findCollapsedStep(table);
+    if (collapsedStep)
+    {
+        PM_LOG_ERROR(MSGID_VOLUME_CURVE, INIT_KVCOUNT, "setCurve: steps %d and %d of %s curve for %s give the same volume %u",\
+            collapsedStep - 1, collapsedStep, type.c_str(), name.c_str(), table.volume[collapsedStep]);
+        return false;
+    }
+
+    mCurves[name] = table;
+    PM_LOG_INFO(MSGID_VOLUME_CURVE, INIT_KVCOUNT, "setCurve: %s curve for %s, step 1:%u step 50:%u step 100:%u",\
+        type.c_str(), name.c_str(), table.volume[1], table.volume[50], table.volume[VOLUME_CURVE_MAX_STEP]);
+    return true;
+}
+
+bool VolumeCurve::hasCurve(const std::string &name)
+{
+    return mCurves.find(name) != mCurves.end();
+}
+
+const VOLUME_CURVE_TABLE_T& VolumeCurve::getTable(const std::string &name)
+{
+    auto it = mCurves.find(name);
+    return (it != mCurves.end()) ? it->second : kLinearCurve;
+}
+
+pa_volume_t VolumeCurve::getVolume(const std::string &name, int step)
+{
+    return getTable(name).volume[std::max(0, std::min(step, VOLUME_CURVE_MAX_STEP))];
+}
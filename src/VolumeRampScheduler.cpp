@@ -0,0 +1,200 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "VolumeRampScheduler.h"
+#include "PulseAudioMixer.h"
+#include <algorithm>
+
+VolumeRampScheduler::VolumeRampScheduler(PulseAudioMixer *mixer) : mMixer(mixer), mTickTimerID(0),
+    mCompletedRamps(0), mTotalLateUs(0), mMaxLateUs(0), mFailedSteps(0)
+{
+}
+
+VolumeRampScheduler::~VolumeRampScheduler()
+{
+    clear();
+}
+
+void VolumeRampScheduler::setVolume(EVirtualAudioSink sink, int sinkIndex, int volume)
+{
+    VOLUME_RAMP_T &ramp = mRamps[sinkIndex];
+    if (ramp.active)
+        PM_LOG_DEBUG("VolumeRampScheduler: ramp of sink input %d cancelled by volume %d", sinkIndex, volume);
+    ramp.sink = sink;
+    ramp.volume = volume;
+    ramp.active = false;
+}
+
+bool VolumeRampScheduler::startRamp(EVirtualAudioSink sink, int sinkIndex, int volume, guint durationMs)
+{
+    auto it = mRamps.find(sinkIndex);
+    if (it == mRamps.end())
+        return false;
+    VOLUME_RAMP_T &ramp = it->second;
+    if (ramp.active)
+        PM_LOG_DEBUG("VolumeRampScheduler: ramp of sink input %d retargeted from %d to %d at %d",\
+            sinkIndex, ramp.to, volume, ramp.volume);
+    ramp.sink = sink;
+    ramp.from = ramp.volume;
+    ramp.to = volume;
+    ramp.start = g_get_monotonic_time();
+    ramp.duration = (gint64)durationMs * 1000;
+    ramp.steps = 0;
+    ramp.active = true;
+    if (0 == mTickTimerID)
+        mTickTimerID = g_timeout_add(VOLUME_RAMP_TICK_MS, &VolumeRampScheduler::_tick, this);
+    return true;
+}
+
+int VolumeRampScheduler::startSinkRamp(EVirtualAudioSink sink, int volume, guint durationMs)
+{
+    int count = 0;
+    for (auto &items : mRamps)
+    {
+        if (items.second.sink == sink && startRamp(sink, items.first, volume, durationMs))
+            count++;
+    }
+    return count;
+}
+
+void VolumeRampScheduler::cancelRamp(int sinkIndex)
+{
+    auto it = mRamps.find(sinkIndex);
+    if (it != mRamps.end() && it->second.active)
+    {
+        PM_LOG_DEBUG("VolumeRampScheduler: ramp of sink input %d cancelled at %d", sinkIndex, it->second.volume);
+        it->second.active = false;
+    }
+}
+
+void VolumeRampScheduler::removeSinkInput(int sinkIndex)
+{
+    mRamps.erase(sinkIndex);
+}
+
+void VolumeRampScheduler::clear()
+{
+    mRamps.clear();
+    if (mTickTimerID)
+    {
+        g_source_remove(mTickTimerID);
+        mTickTimerID = 0;
+    }
+}
+
+bool VolumeRampScheduler::hasActiveRamps()
+{
+    for (const auto &items : mRamps)
+    {
+        if (items.second.active)
+            return true;
+    }
+    return false;
+}
+
+void VolumeRampScheduler::collectStep(std::vector<utils::SINK_VOLUME_ENTRY_T> &entries)
+{
+    //All ramps are advanced from the same clock
+    gint64 now = g_get_monotonic_time();
+    for (auto &items : mRamps)
+    {
+        VOLUME_RAMP_T &ramp = items.second;
+        if (!ramp.active)
+            continue;
+        gint64 elapsed = now - ramp.start;
+        bool finished = (elapsed >= ramp.duration);
+        int volume = ramp.to;
+        //Late ticks do not stretch the ramp, the volume follows the elapsed time
+        if (!finished)
+            volume = ramp.from + (int)(((gint64)(ramp.to - ramp.from) * elapsed * 2 + (ramp.to > ramp.from ? ramp.duration : -ramp.duration)) / (ramp.duration * 2));
+        //A ramp always sends its first step, the reply of the caller comes with it
+        if (volume != ramp.volume || 0 == ramp.steps)
+        {
+            utils::SINK_VOLUME_ENTRY_T entry;
+            entry.audioSink = ramp.sink;
+            entry.sinkInputIndex = items.first;
+            entry.volume = volume;
+            entry.ramp = false;
+            entries.push_back(entry);
+        }
+        else if (finished)
+            finishRamp(items.first, ramp, now);
+    }
+}
+
+void VolumeRampScheduler::commitStep(const std::vector<utils::SINK_VOLUME_ENTRY_T> &entries)
+{
+    gint64 now = g_get_monotonic_time();
+    for (const auto &entry : entries)
+    {
+        auto it = mRamps.find(entry.sinkInputIndex);
+        //Volumes set without a ramp are already recorded by setVolume
+        if (it == mRamps.end() || !it->second.active)
+            continue;
+        VOLUME_RAMP_T &ramp = it->second;
+        ramp.volume = entry.volume;
+        ramp.steps++;
+        if (ramp.volume == ramp.to && now - ramp.start >= ramp.duration)
+            finishRamp(entry.sinkInputIndex, ramp, now);
+    }
+}
+
+void VolumeRampScheduler::finishRamp(int sinkIndex, VOLUME_RAMP_T &ramp, gint64 now)
+{
+    ramp.active = false;
+    gint64 achieved = now - ramp.start;
+    gint64 late = achieved - ramp.duration;
+    mCompletedRamps++;
+    mTotalLateUs += late;
+    mMaxLateUs = std::max(mMaxLateUs, late);
+    PM_LOG_INFO(MSGID_AUDIO_MIXER, INIT_KVCOUNT,\
+        "ramp of sink input %d sink:%d %d->%d scheduled:%lld ms achieved:%lld ms steps:%u, late over %u ramps avg:%lld max:%lld us",\
+        sinkIndex, (int)ramp.sink, ramp.from, ramp.to, (long long)(ramp.duration / 1000), (long long)(achieved / 1000),\
+        ramp.steps, mCompletedRamps, (long long)(mTotalLateUs / mCompletedRamps), (long long)mMaxLateUs);
+}
+
+void VolumeRampScheduler::tick()
+{
+    std::vector<utils::SINK_VOLUME_ENTRY_T> entries;
+    collectStep(entries);
+    if (entries.empty())
+        return;
+    if (!mMixer || !mMixer->programVolumes(entries, nullptr, nullptr, nullptr, nullptr))
+    {
+        //The ramps stay where pulse has them, the next tick sends their volumes again
+        if (0 == mFailedSteps++)
+            PM_LOG_ERROR(MSGID_AUDIO_MIXER, INIT_KVCOUNT, "VolumeRampScheduler: step of %zu volume(s) could not be queued, retrying", entries.size());
+        return;
+    }
+    if (mFailedSteps)
+    {
+        PM_LOG_INFO(MSGID_AUDIO_MIXER, INIT_KVCOUNT, "VolumeRampScheduler: step queued after %u failed tick(s)", mFailedSteps);
+        mFailedSteps = 0;
+    }
+    commitStep(entries);
+}
+
+gboolean VolumeRampScheduler::_tick(gpointer data)
+{
+    VolumeRampScheduler *scheduler = (VolumeRampScheduler*)data;
+    if (!scheduler)
+        return FALSE;
+    scheduler->tick();
+    if (scheduler->hasActiveRamps())
+        return TRUE;
+    scheduler->mTickTimerID = 0;
+    return FALSE;
+}
@@ -24,7 +24,7 @@ AudioMixer* AudioMixer::getAudioMixerInstance()
     return &mAudioMixerObj;
 }
 
-AudioMixer::AudioMixer():mObjUmiAudioMixer(nullptr), mObjPulseAudioMixer(nullptr), \
+AudioMixer::AudioMixer():mObjUmiAudioMixer(nullptr), mObjPulseAudioMixer(nullptr), mObjRampScheduler(nullptr), \
                          mUmiMixerStatus(false), mPulseMixerStatus(false)
 {
     PM_LOG_INFO(MSGID_AUDIO_MIXER, INIT_KVCOUNT,\
@@ -36,12 +36,15 @@ AudioMixer::AudioMixer():mObjUmiAudioMixer(nullptr), mObjPulseAudioMixer(nullptr
         mObjUmiAudioMixer = new (std::nothrow)umiaudiomixer(this);
     if (!mObjPulseAudioMixer)
         mObjPulseAudioMixer = new (std::nothrow)PulseAudioMixer(this);
+    if (mObjPulseAudioMixer)
+        mObjRampScheduler = new (std::nothrow)VolumeRampScheduler(mObjPulseAudioMixer);
     mObjModuleManager = ModuleManager::getModuleManagerInstance();
 }
 
 AudioMixer::~AudioMixer()
 {
     PM_LOG_INFO(MSGID_AUDIO_MIXER, INIT_KVCOUNT, "AudioMixer: destructor");
+    delete mObjRampScheduler;
 }
 
 //Audio mixer calls start//
@@ -227,13 +230,15 @@ void AudioMixer::callBackMixerStatus(const bool& mixerStatus, utils::EMIXER_TYPE
         PM_LOG_ERROR(MSGID_AUDIO_MIXER, INIT_KVCOUNT, "%s Invalid mixer type", __FUNCTION__);
     if (!mixerStatus)
         resetStreamInfo(mixerType);
+    if (!mixerStatus && utils::ePulseMixer == mixerType && mObjRampScheduler)
+        mObjRampScheduler->clear();
     if (mObjModuleManager)
     {
         events::EVENT_MIXER_STATUS_T eventMixerStatus;
         eventMixerStatus.eventName = utils::eEventMixerStatus;
         eventMixerStatus.mixerStatus = mixerStatus ;
         eventMixerStatus.mixerType = mixerType;
-        mObjModuleManager->publishModuleEvent((events::EVENTS_T*)&eventMixerStatus);
+        mObjModuleManager->publishModuleEvent(eventMixerStatus);
     }
 }
 
@@ -250,6 +255,8 @@ void AudioMixer::callBackSinkStatus(const std::string& source, const std::string
             addAudioSink(audioSink, mixerType);
         else if (utils::eSinkClosed == sinkStatus)
             removeAudioSink(audioSink, mixerType);
+        if (utils::eSinkClosed == sinkStatus && mObjRampScheduler)
+            mObjRampScheduler->removeSinkInput(sinkIndex);
         if (mObjModuleManager)
         {
             events::EVENT_SINK_STATUS_T eventSinkStatus;
@@ -261,7 +268,7 @@ void AudioMixer::callBackSinkStatus(const std::string& source, const std::string
             eventSinkStatus.mixerType = mixerType;
             eventSinkStatus.trackId = trackId;
             eventSinkStatus.sinkIndex = sinkIndex;
-            mObjModuleManager->publishModuleEvent((events::EVENTS_T*)&eventSinkStatus);
+            mObjModuleManager->publishModuleEvent(eventSinkStatus);
         }
     }
     else
@@ -294,7 +301,7 @@ void AudioMixer::callBackSourceStatus(const std::string& source, const std::stri
             eventSourceStatus.audioSource = audioSource;
             eventSourceStatus.sourceStatus = sourceStatus;
             eventSourceStatus.mixerType = mixerType;
-            mObjModuleManager->publishModuleEvent((events::EVENTS_T*)&eventSourceStatus);
+            mObjModuleManager->publishModuleEvent(eventSourceStatus);
         }
     }
     else
@@ -322,7 +329,7 @@ void AudioMixer::callBackDeviceConnectionStatus(const std::string &deviceName, c
         stEventDeviceConnectionStatus.deviceStatus = deviceStatus;
         stEventDeviceConnectionStatus.mixerType = mixerType;
         stEventDeviceConnectionStatus.isOutput = isOutput;
-        mObjModuleManager->publishModuleEvent((events::EVENTS_T*)&stEventDeviceConnectionStatus);
+        mObjModuleManager->publishModuleEvent(stEventDeviceConnectionStatus);
     }
     else
         PM_LOG_ERROR(MSGID_AUDIO_MIXER, INIT_KVCOUNT, "callBackDeviceConnectionStatus mObjModuleManager is null");
@@ -335,13 +342,13 @@ void AudioMixer::callBackMasterVolumeStatus()
     {
         events::EVENT_MASTER_VOLUME_STATUS_T eventMasterVolumeStatus;
         eventMasterVolumeStatus.eventName = utils::eEventMasterVolumeStatus;
-        mObjModuleManager->publishModuleEvent((events::EVENTS_T*)&eventMasterVolumeStatus);
+        mObjModuleManager->publishModuleEvent(eventMasterVolumeStatus);
     }
     else
         PM_LOG_ERROR(MSGID_AUDIO_MIXER, INIT_KVCOUNT, "callBackMasterVolumeStatus: mObjModuleManager is null");
 }
 
-void AudioMixer::callBackPlaybackStatusChanged(const std::string &playbackId, const std::string &state)
+void AudioMixer::callBackPlaybackStatusChanged(const std::string &playbackId, const std::string &state, int item)
 {
     PM_LOG_DEBUG("callBackPlaybackStatusChanged");
     if (mObjModuleManager)
@@ -350,7 +357,8 @@ void AudioMixer::callBackPlaybackStatusChanged(const std::string &playbackId, co
         eventPlaybackStatusInfo.eventName = utils::eEventGetPlaybackStatus;
         eventPlaybackStatusInfo.playbackId = playbackId;
         eventPlaybackStatusInfo.state = state;
-        mObjModuleManager->publishModuleEvent((events::EVENTS_T*)&eventPlaybackStatusInfo);
+        eventPlaybackStatusInfo.item = item;
+        mObjModuleManager->publishModuleEvent(eventPlaybackStatusInfo);
     }
     else
         PM_LOG_ERROR(MSGID_AUDIO_MIXER, INIT_KVCOUNT, "callBackPlaybackStatusChanged: mObjModuleManager is null");
@@ -498,7 +506,19 @@ bool AudioMixer::programTrackVolume(EVirtualAudioSink sink, int sinkIndex, int v
 {
     PM_LOG_DEBUG("AudioMixer: programTrackVolume");
     if (mObjPulseAudioMixer)
+    {
+        if (mObjRampScheduler)
+        {
+            if (ramp && mObjRampScheduler->startRamp(sink, sinkIndex, volume))
+            {
+                std::vector<utils::SINK_VOLUME_ENTRY_T> step;
+                return programRampStep(step, lshandle, message, ctx, cb);
+            }
+            //A sink input whose volume is not known yet is still ramped by pulse
+            mObjRampScheduler->setVolume(sink, sinkIndex, volume);
+        }
         return mObjPulseAudioMixer->programTrackVolume(sink, sinkIndex, volume, lshandle, message, ctx, cb, ramp);
+    }
     else
     {
         PM_LOG_ERROR(MSGID_AUDIO_MIXER, INIT_KVCOUNT, "programTrackVolume: mObjPulseAudioMixer is nullptr");
@@ -520,6 +540,55 @@ bool AudioMixer::programVolume(EVirtualSource source, int volume, LSHandle *lsha
     }
 }
 
+bool AudioMixer::programVolumes(const std::vector<utils::SINK_VOLUME_ENTRY_T> &entries, LSHandle *lshandle, LSMessage *message, void *ctx, PulseCallBackFunc cb)
+{
+    PM_LOG_DEBUG("AudioMixer: programVolumes");
+    if (!mObjPulseAudioMixer)
+    {
+        PM_LOG_ERROR(MSGID_AUDIO_MIXER, INIT_KVCOUNT, "programVolumes: mObjPulseAudioMixer is nullptr");
+        return false;
+    }
+    if (!mObjRampScheduler)
+        return mObjPulseAudioMixer->programVolumes(entries, lshandle, message, ctx, cb);
+
+    //Ramps go to the scheduler, the other volumes leave with its current step
+    std::vector<utils::SINK_VOLUME_ENTRY_T> step;
+    for (const auto &entry : entries)
+    {
+        if (entry.ramp && mObjRampScheduler->startRamp(entry.audioSink, entry.sinkInputIndex, entry.volume))
+            continue;
+        mObjRampScheduler->setVolume(entry.audioSink, entry.sinkInputIndex, entry.volume);
+        step.push_back(entry);
+    }
+    return programRampStep(step, lshandle, message, ctx, cb);
+}
+
+bool AudioMixer::programRampStep(std::vector<utils::SINK_VOLUME_ENTRY_T> &entries, LSHandle *lshandle, LSMessage *message, void *ctx, PulseCallBackFunc cb)
+{
+    mObjRampScheduler->collectStep(entries);
+    if (!mObjPulseAudioMixer->programVolumes(entries, lshandle, message, ctx, cb))
+        return false;
+    mObjRampScheduler->commitStep(entries);
+    return true;
+}
+
+bool AudioMixer::rampVolume(EVirtualAudioSink sink, int endVolume)
+{
+    PM_LOG_DEBUG("AudioMixer: rampVolume");
+    if (!mObjPulseAudioMixer || !mObjRampScheduler)
+    {
+        PM_LOG_ERROR(MSGID_AUDIO_MIXER, INIT_KVCOUNT, "rampVolume: mObjPulseAudioMixer is nullptr");
+        return false;
+    }
+    if (0 == mObjRampScheduler->startSinkRamp(sink, endVolume))
+    {
+        PM_LOG_ERROR(MSGID_AUDIO_MIXER, INIT_KVCOUNT, "rampVolume: no sink input with a known volume on sink %d", (int)sink);
+        return false;
+    }
+    std::vector<utils::SINK_VOLUME_ENTRY_T> step;
+    return programRampStep(step, nullptr, nullptr, nullptr, nullptr);
+}
+
 bool AudioMixer::setSoundOutputOnRange(EVirtualAudioSink startSink, EVirtualAudioSink endSink, const char* deviceName)
 {
     PM_LOG_INFO(MSGID_AUDIO_MIXER, INIT_KVCOUNT,\
@@ -675,11 +744,11 @@ bool AudioMixer::playSystemSound(const char *snd, EVirtualAudioSink sink)
 }
 
 std::string AudioMixer::playSound(const char *snd, EVirtualAudioSink sink, \
-               const char *format, int rate, int channels)
+               const char *format, int rate, int channels, int volume)
 {
     PM_LOG_DEBUG("AudioMixer: playSound");
     if (mObjPulseAudioMixer)
-        return mObjPulseAudioMixer->playSound(snd, sink, format, rate, channels);
+        return mObjPulseAudioMixer->playSound(snd, sink, format, rate, channels, volume);
     else
     {
         PM_LOG_ERROR(MSGID_AUDIO_MIXER, INIT_KVCOUNT,\
@@ -688,6 +757,19 @@ std::string AudioMixer::playSound(const char *snd, EVirtualAudioSink sink, \
     }
 }
 
+int AudioMixer::queueSound(std::string playbackId, const char *snd, const char *format, int rate, int channels)
+{
+    PM_LOG_DEBUG("AudioMixer: queueSound");
+    if (mObjPulseAudioMixer)
+        return mObjPulseAudioMixer->queueSound(playbackId, snd, format, rate, channels);
+    else
+    {
+        PM_LOG_ERROR(MSGID_AUDIO_MIXER, INIT_KVCOUNT,\
+            "queueSound: mObjPulseAudioMixer is null");
+        return -1;
+    }
+}
+
 bool AudioMixer::controlPlayback(std::string playbackId, std::string requestType)
 {
     PM_LOG_DEBUG("AudioMixer: controlPlayback");
@@ -701,11 +783,11 @@ bool AudioMixer::controlPlayback(std::string playbackId, std::string requestType
     }
 }
 
-std::string AudioMixer::getPlaybackStatus(std::string playbackId)
+std::string AudioMixer::getPlaybackStatus(std::string playbackId, PLAYBACK_TIMING_T *timing)
 {
     PM_LOG_DEBUG("AudioMixer: getPlaybackStatus");
     if (mObjPulseAudioMixer)
-        return mObjPulseAudioMixer->getPlaybackStatus(playbackId);
+        return mObjPulseAudioMixer->getPlaybackStatus(playbackId, timing);
     else
     {
         PM_LOG_ERROR(MSGID_AUDIO_MIXER, INIT_KVCOUNT,\
@@ -949,6 +1031,8 @@ void AudioMixer::openCloseSink(EVirtualAudioSink sink, bool openNotClose , int s
 bool AudioMixer::closeClient(int sinkIndex)
 {
     PM_LOG_DEBUG("AudioMixer: closeClient");
+    if (mObjRampScheduler)
+        mObjRampScheduler->removeSinkInput(sinkIndex);
     if (mObjPulseAudioMixer)
         return mObjPulseAudioMixer->closeClient(sinkIndex);
     else
@@ -195,6 +195,10 @@ main(int argc, char **argv)
     PM_LOG_INFO(MSGID_STARTUP, INIT_KVCOUNT, "Starting main loop!");
     g_main_loop_run(gMainLoop);
 
+    //Before any module is deleted, modules may still iterate the main context here
+    if (objModuleManager)
+        objModuleManager->prepareShutdown();
+
     g_main_loop_unref(gMainLoop);
 
     oneFreeForAll();
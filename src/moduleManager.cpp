@@ -16,11 +16,165 @@
 
 #include "moduleManager.h"
 
+//Upper bound in microseconds of each handleEvent latency bucket, last bucket is open ended
+static const gint64 cEventLatencyBucketLimit[EVENT_LATENCY_BUCKET_COUNT - 1] =
+    {50, 100, 250, 500, 1000, 5000, 10000};
+//Maximum deferred events delivered per idle callback
+static const int cDeferredEventBatchSize = 16;
+//Maximum released copies kept per event type
+static const size_t cEventPoolSize = 8;
+
+namespace
+{
+    //Copy, release and coalescing rules of an event type that can be deferred
+    typedef struct
+    {
+        events::EVENTS_T* (*clone)(const events::EVENTS_T* ev, events::EVENTS_T* reuse);
+        void (*destroy)(events::EVENTS_T* ev);
+        std::string (*coalesceKey)(const events::EVENTS_T* ev);
+    }DEFERRED_EVENT_OPS_T;
+
+    //An event replaces the newest queued event of its type when both have the same key,
+    //the newest payload is kept. State snapshots are keyed by what they describe,
+    //edge events by their full state so that only exact repeats are merged.
+    std::string coalesceKey(const events::EVENT_SINK_STATUS_T &ev)
+    {
+        return std::to_string(ev.audioSink) + ":" + std::to_string(ev.sinkIndex) + ":" + std::to_string(ev.sinkStatus);
+    }
+    std::string coalesceKey(const events::EVENT_SOURCE_STATUS_T &ev)
+    {
+        return std::to_string(ev.audioSource) + ":" + std::to_string(ev.sourceStatus);
+    }
+    std::string coalesceKey(const events::EVENT_MIXER_STATUS_T &ev)
+    {
+        return std::to_string(ev.mixerType) + ":" + std::to_string(ev.mixerStatus);
+    }
+    std::string coalesceKey(const events::EVENT_MASTER_VOLUME_STATUS_T &ev)
+    {
+        return "";
+    }
+    std::string coalesceKey(const events::EVENT_INPUT_VOLUME_T &ev)
+    {
+        return std::to_string(ev.audioSink);
+    }
+    std::string coalesceKey(const events::EVENT_DEVICE_CONNECTION_STATUS_T &ev)
+    {
+        return ev.devicename.str() + ":" + std::to_string(ev.isOutput) + ":" + std::to_string(ev.deviceStatus);
+    }
+    std::string coalesceKey(const events::EVENT_SINK_POLICY_INFO_T &ev)
+    {
+        return "";
+    }
+    std::string coalesceKey(const events::EVENT_SOURCE_POLICY_INFO_T &ev)
+    {
+        return "";
+    }
+    std::string coalesceKey(const events::EVENT_BT_DEVICE_DISPAY_INFO_T &ev)
+    {
+        return ev.address.str() + ":" + std::to_string(ev.state) + ":" + std::to_string(ev.displayId);
+    }
+    std::string coalesceKey(const events::EVENT_ACTIVE_DEVICE_INFO_T &ev)
+    {
+        return ev.deviceName.str() + ":" + ev.display.str() + ":" + std::to_string(ev.isOutput) + ":" +\
+            std::to_string(ev.isConnected) + ":" + std::to_string(ev.isActive);
+    }
+    std::string coalesceKey(const events::EVENT_REGISTER_TRACK_T &ev)
+    {
+        return ev.trackId;
+    }
+    std::string coalesceKey(const events::EVENT_UNREGISTER_TRACK_T &ev)
+    {
+        return ev.trackId;
+    }
+    std::string coalesceKey(const events::EVENT_SERVER_STATUS_INFO_T &ev)
+    {
+        return std::to_string(ev.serviceName) + ":" + std::to_string(ev.connectionStatus);
+    }
+
+    template<typename T>
+    events::EVENTS_T* cloneEvent(const events::EVENTS_T* ev, events::EVENTS_T* reuse)
+    {
+        if (reuse)
+        {
+            *(T*)reuse = *(const T*)ev;
+            return reuse;
+        }
+        return (events::EVENTS_T*)new T(*(const T*)ev);
+    }
+
+    template<typename T>
+    void destroyEvent(events::EVENTS_T* ev)
+    {
+        delete (T*)ev;
+    }
+
+    template<typename T>
+    std::string eventCoalesceKey(const events::EVENTS_T* ev)
+    {
+        return coalesceKey(*(const T*)ev);
+    }
+
+    template<typename T>
+    const DEFERRED_EVENT_OPS_T* deferredEventOps()
+    {
+        static const DEFERRED_EVENT_OPS_T ops = {cloneEvent<T>, destroyEvent<T>, eventCoalesceKey<T>};
+        return &ops;
+    }
+
+    //Returns nullptr for events that must be delivered synchronously: requests
+    //expecting a reply before publish returns and events holding borrowed pointers
+    const DEFERRED_EVENT_OPS_T* getDeferredEventOps(int eventType)
+    {
+        switch (eventType)
+        {
+            case utils::eEventSinkStatus:
+                return deferredEventOps<events::EVENT_SINK_STATUS_T>();
+            case utils::eEventSourceStatus:
+                return deferredEventOps<events::EVENT_SOURCE_STATUS_T>();
+            case utils::eEventMixerStatus:
+                return deferredEventOps<events::EVENT_MIXER_STATUS_T>();
+            case utils::eEventMasterVolumeStatus:
+                return deferredEventOps<events::EVENT_MASTER_VOLUME_STATUS_T>();
+            case utils::eEventInputVolume:
+                return deferredEventOps<events::EVENT_INPUT_VOLUME_T>();
+            case utils::eEventDeviceConnectionStatus:
+                return deferredEventOps<events::EVENT_DEVICE_CONNECTION_STATUS_T>();
+            case utils::eEventSinkPolicyInfo:
+                return deferredEventOps<events::EVENT_SINK_POLICY_INFO_T>();
+            case utils::eEventSourcePolicyInfo:
+                return deferredEventOps<events::EVENT_SOURCE_POLICY_INFO_T>();
+            case utils::eEventBTDeviceDisplayInfo:
+                return deferredEventOps<events::EVENT_BT_DEVICE_DISPAY_INFO_T>();
+            case utils::eEventActiveDeviceInfo:
+                return deferredEventOps<events::EVENT_ACTIVE_DEVICE_INFO_T>();
+            case utils::eEventRegisterTrack:
+                return deferredEventOps<events::EVENT_REGISTER_TRACK_T>();
+            case utils::eEventUnregisterTrack:
+                return deferredEventOps<events::EVENT_UNREGISTER_TRACK_T>();
+            case utils::eEventServerStatusSubscription:
+                return deferredEventOps<events::EVENT_SERVER_STATUS_INFO_T>();
+            default:
+                return nullptr;
+        }
+    }
+}
+
+static gboolean _dispatchDeferredEvents(gpointer data)
+{
+    ModuleManager *moduleManager = (ModuleManager*)data;
+    if (moduleManager)
+        return moduleManager->dispatchDeferredEvents();
+    return FALSE;
+}
+
 ModuleManager* ModuleManager::mObjModuleManager = nullptr;
-ModuleManager::ModuleManager()
+ModuleManager::ModuleManager():mDeferredSourceID(0),
+                               mCoalescedEventCount(0),
+                               mDeferredEventCount(0)
 {
     PM_LOG_INFO(MSGID_MODULE_MANAGER, INIT_KVCOUNT,\
         "ModuleManager constructor");
+    std::fill(mEventDispatchCount, mEventDispatchCount + eLunaEventCount, 0);
     mModuleFactory = ModuleFactory::getInstance();
     if (!mModuleFactory)
         PM_LOG_ERROR(MSGID_MODULE_MANAGER, INIT_KVCOUNT,\
@@ -119,10 +273,25 @@ bool ModuleManager::createModules()
     return true;
 }
 
+void ModuleManager::prepareShutdown()
+{
+    PM_LOG_INFO(MSGID_MODULE_MANAGER, INIT_KVCOUNT,\
+        "ModuleManager: prepareShutdown");
+    for (auto &items : mModuleHandlersMap)
+    {
+        if (items.second)
+            items.second->prepareShutdown();
+    }
+}
+
 bool ModuleManager::removeModules()
 {
     PM_LOG_INFO(MSGID_MODULE_MANAGER, INIT_KVCOUNT,\
         "ModuleManager: removeModules");
+    logEventDispatchStats();
+    clearDeferredEvents();
+    for (int eventType = 0; eventType < eLunaEventCount; eventType++)
+        mEventSubscribers[eventType].clear();
     if (mModuleFactory)
     {
         std::map<std::string, ModuleInterface*>::iterator it = mModuleHandlersMap.begin();
@@ -141,11 +310,48 @@ ModuleManager::~ModuleManager()
         "ModuleManager destructor");
 }
 
-void ModuleManager::subscribeModuleEvent(ModuleInterface* module, EModuleEventType eventType)
+bool ModuleManager::isValidEventType(int eventType) const
+{
+    return (eventType >= 0 && eventType < eLunaEventCount);
+}
+
+void ModuleManager::addEventSubscriber(ModuleInterface* module, EModuleEventType eventType,\
+    EVENT_DELIVERY_E delivery)
+{
+    if (!isValidEventType(eventType))
+    {
+        PM_LOG_ERROR(MSGID_MODULE_MANAGER, INIT_KVCOUNT,\
+            "addEventSubscriber: invalid eventType:%d", (int)eventType);
+        return;
+    }
+    if (eEventDeliveryDeferred == delivery && !getDeferredEventOps(eventType))
+    {
+        PM_LOG_WARNING(MSGID_MODULE_MANAGER, INIT_KVCOUNT,\
+            "eventType:%d can not be deferred, delivering synchronously", (int)eventType);
+        delivery = eEventDeliverySync;
+    }
+    EVENT_SUBSCRIBER_T subscriber = {};
+    subscriber.module = module;
+    subscriber.delivery = delivery;
+    mEventSubscribers[eventType].push_back(subscriber);
+}
+
+std::string ModuleManager::getModuleName(ModuleInterface* module) const
+{
+    for (const auto &it : mModuleHandlersMap)
+    {
+        if (it.second == module)
+            return it.first;
+    }
+    return "unknown";
+}
+
+void ModuleManager::subscribeModuleEvent(ModuleInterface* module, EModuleEventType eventType,\
+    EVENT_DELIVERY_E delivery)
 {
     PM_LOG_INFO(MSGID_MODULE_MANAGER, INIT_KVCOUNT,\
-        "subscribeModuleEvent for eventype:%d", (int)eventType);
-    mapEventsSubscribers.insert(std::pair<EModuleEventType, ModuleInterface*>(eventType, module));
+        "subscribeModuleEvent for eventype:%d delivery:%d", (int)eventType, (int)delivery);
+    addEventSubscriber(module, eventType, delivery);
 }
 
 void ModuleManager::subscribeKeyInfo(ModuleInterface* module, EModuleEventType event, SERVER_TYPE_E eService, const std::string& key, const std::string& payload)
@@ -165,7 +371,7 @@ void ModuleManager::subscribeKeyInfo(ModuleInterface* module, EModuleEventType e
     }
     if (success)
     {
-        mapEventsSubscribers.insert(std::pair<EModuleEventType, ModuleInterface*>(event, module));
+        addEventSubscriber(module, event);
         //if payload is required from Module during runtime
         events::EVENT_SUBSCRIBE_KEY_T eventSubscribeKey;
         eventSubscribeKey.eventName = utils::eEventLunaKeySubscription;
@@ -173,7 +379,7 @@ void ModuleManager::subscribeKeyInfo(ModuleInterface* module, EModuleEventType e
         eventSubscribeKey.serviceName = eService;
         eventSubscribeKey.api = key;
         eventSubscribeKey.payload = payload;
-        publishModuleEvent((events::EVENTS_T*)&eventSubscribeKey);
+        publishModuleEvent(eventSubscribeKey);
     }
 }
 
@@ -187,22 +393,174 @@ void ModuleManager::subscribeServerStatusInfo(ModuleInterface* module, SERVER_TY
     }
     else
     {
-        mapEventsSubscribers.insert(std::pair<EModuleEventType, ModuleInterface*>(utils::eEventServerStatusSubscription, module));
+        addEventSubscriber(module, utils::eEventServerStatusSubscription);
     }
     events::EVENT_SUBSCRIBE_SERVER_STATUS_T eventSubscribeServerStatus;
     eventSubscribeServerStatus.eventName = utils::eEventLunaServerStatusSubscription;
     eventSubscribeServerStatus.serviceName = eStatus;
-    publishModuleEvent((events::EVENTS_T*)&eventSubscribeServerStatus);
+    publishModuleEvent(eventSubscribeServerStatus);
+}
+
+void ModuleManager::dispatchToSubscriber(int eventType, size_t index, events::EVENTS_T* ev)
+{
+    ModuleInterface *module = mEventSubscribers[eventType][index].module;
+    gint64 startTime = g_get_monotonic_time();
+    module->handleEvent(ev);
+    gint64 latency = g_get_monotonic_time() - startTime;
+
+    //handleEvent may subscribe more modules and move the vector, index it again
+    std::vector<EVENT_SUBSCRIBER_T> &subscribers = mEventSubscribers[eventType];
+    if (index >= subscribers.size())
+        return;
+    EVENT_SUBSCRIBER_T &subscriber = subscribers[index];
+    int bucket = 0;
+    while (bucket < EVENT_LATENCY_BUCKET_COUNT - 1 && latency > cEventLatencyBucketLimit[bucket])
+        bucket++;
+    subscriber.latencyHistogram[bucket]++;
+    subscriber.dispatchCount++;
+    subscriber.totalLatency += latency;
+    if (latency > subscriber.maxLatency)
+        subscriber.maxLatency = latency;
 }
 
 void ModuleManager::publishModuleEvent(events::EVENTS_T *ev)
 {
     PM_LOG_DEBUG("publishModuleEvent for eventType:%d", (int)ev->eventName);
-    for (auto eventsItr = mapEventsSubscribers.begin(); eventsItr != mapEventsSubscribers.end(); ++eventsItr)
+    int eventType = ev->eventName;
+    if (!isValidEventType(eventType))
+    {
+        PM_LOG_ERROR(MSGID_MODULE_MANAGER, INIT_KVCOUNT,\
+            "publishModuleEvent: invalid eventType:%d", eventType);
+        return;
+    }
+    mEventDispatchCount[eventType]++;
+    bool hasDeferredSubscriber = false;
+    //handleEvent may subscribe more modules, so index rather than iterate.
+    //dispatchToSubscriber indexes the subscriber again after the call for the same reason.
+    for (size_t index = 0; index < mEventSubscribers[eventType].size(); index++)
+    {
+        if (eEventDeliveryDeferred == mEventSubscribers[eventType][index].delivery)
+        {
+            hasDeferredSubscriber = true;
+            continue;
+        }
+        dispatchToSubscriber(eventType, index, ev);
+    }
+    if (hasDeferredSubscriber)
+        queueDeferredEvent(ev);
+}
+
+void ModuleManager::queueDeferredEvent(events::EVENTS_T* ev)
+{
+    int eventType = ev->eventName;
+    const DEFERRED_EVENT_OPS_T *ops = getDeferredEventOps(eventType);
+    if (!ops)
+        return;
+    std::string key = ops->coalesceKey(ev);
+    //Only the newest queued event of the type can be replaced, merging into an older one
+    //would move this event ahead of the edges queued after it (open, close, open would end closed)
+    for (auto it = mDeferredEvents.rbegin(); it != mDeferredEvents.rend(); ++it)
+    {
+        if (it->eventType != eventType)
+            continue;
+        if (it->coalesceKey == key)
+        {
+            ops->clone(ev, it->event);
+            mCoalescedEventCount++;
+            return;
+        }
+        break;
+    }
+    events::EVENTS_T *reuse = nullptr;
+    if (!mEventPool[eventType].empty())
+    {
+        reuse = mEventPool[eventType].back();
+        mEventPool[eventType].pop_back();
+    }
+    QUEUED_EVENT_T queuedEvent;
+    queuedEvent.eventType = eventType;
+    queuedEvent.coalesceKey = key;
+    queuedEvent.event = ops->clone(ev, reuse);
+    mDeferredEvents.push_back(queuedEvent);
+    mDeferredEventCount++;
+    if (!mDeferredSourceID)
+        mDeferredSourceID = g_idle_add(_dispatchDeferredEvents, this);
+}
+
+void ModuleManager::releaseDeferredEvent(int eventType, events::EVENTS_T* ev)
+{
+    if (mEventPool[eventType].size() < cEventPoolSize)
+        mEventPool[eventType].push_back(ev);
+    else
+        getDeferredEventOps(eventType)->destroy(ev);
+}
+
+bool ModuleManager::dispatchDeferredEvents()
+{
+    for (int count = 0; count < cDeferredEventBatchSize && !mDeferredEvents.empty(); count++)
+    {
+        //taken off the queue first as handlers may publish more events
+        QUEUED_EVENT_T queuedEvent = mDeferredEvents.front();
+        mDeferredEvents.pop_front();
+        std::vector<EVENT_SUBSCRIBER_T> &subscribers = mEventSubscribers[queuedEvent.eventType];
+        for (size_t index = 0; index < subscribers.size(); index++)
+        {
+            if (eEventDeliveryDeferred == subscribers[index].delivery)
+                dispatchToSubscriber(queuedEvent.eventType, index, queuedEvent.event);
+        }
+        releaseDeferredEvent(queuedEvent.eventType, queuedEvent.event);
+    }
+    if (mDeferredEvents.empty())
+    {
+        mDeferredSourceID = 0;
+        return false;
+    }
+    return true;
+}
+
+void ModuleManager::clearDeferredEvents()
+{
+    if (mDeferredSourceID)
+    {
+        g_source_remove(mDeferredSourceID);
+        mDeferredSourceID = 0;
+    }
+    for (auto &queuedEvent : mDeferredEvents)
+        getDeferredEventOps(queuedEvent.eventType)->destroy(queuedEvent.event);
+    mDeferredEvents.clear();
+    for (int eventType = 0; eventType < eLunaEventCount; eventType++)
+    {
+        for (auto &ev : mEventPool[eventType])
+            getDeferredEventOps(eventType)->destroy(ev);
+        mEventPool[eventType].clear();
+    }
+}
+
+void ModuleManager::logEventDispatchStats()
+{
+    PM_LOG_INFO(MSGID_MODULE_MANAGER, INIT_KVCOUNT,\
+        "deferred events queued:%lu coalesced:%lu pending:%zu",\
+        mDeferredEventCount, mCoalescedEventCount, mDeferredEvents.size());
+    for (int eventType = 0; eventType < eLunaEventCount; eventType++)
     {
-        if (ev->eventName == eventsItr->first)
+        if (0 == mEventDispatchCount[eventType])
+            continue;
+        PM_LOG_INFO(MSGID_MODULE_MANAGER, INIT_KVCOUNT,\
+            "eventType:%d published:%lu subscribers:%zu", eventType,\
+            mEventDispatchCount[eventType], mEventSubscribers[eventType].size());
+        for (const auto &subscriber : mEventSubscribers[eventType])
         {
-            (eventsItr->second)->handleEvent(ev);
+            if (0 == subscriber.dispatchCount)
+                continue;
+            const unsigned long *histogram = subscriber.latencyHistogram;
+            PM_LOG_INFO(MSGID_MODULE_MANAGER, INIT_KVCOUNT,\
+                "  module:%s dispatched:%lu avg:%lldus max:%lldus"\
+                " histogram(<=50,100,250,500,1000,5000,10000,>10000us):%lu,%lu,%lu,%lu,%lu,%lu,%lu,%lu",\
+                getModuleName(subscriber.module).c_str(), subscriber.dispatchCount,\
+                (long long)(subscriber.totalLatency / subscriber.dispatchCount),\
+                (long long)subscriber.maxLatency,\
+                histogram[0], histogram[1], histogram[2], histogram[3],\
+                histogram[4], histogram[5], histogram[6], histogram[7]);
         }
     }
 }
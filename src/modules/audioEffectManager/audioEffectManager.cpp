@@ -493,9 +493,10 @@ void AudioEffectManager::handleEvent(events::EVENTS_T *event)
         {
             PM_LOG_INFO(MSGID_AUDIO_EFFECT_MANAGER, INIT_KVCOUNT,\
                 "handleEvent : eEventDeviceConnectionStatus");
-            events::EVENT_DEVICE_CONNECTION_STATUS_T * stDeviceConnectionStatus = (events::EVENT_DEVICE_CONNECTION_STATUS_T*)event;
-            eventDeviceConnectionStatus(stDeviceConnectionStatus->devicename, stDeviceConnectionStatus->deviceNameDetail, stDeviceConnectionStatus->deviceIcon, \
-                stDeviceConnectionStatus->deviceStatus, stDeviceConnectionStatus->mixerType,stDeviceConnectionStatus->isOutput);
+            const events::EVENT_DEVICE_CONNECTION_STATUS_T *stDeviceConnectionStatus = events::getEventPayload<events::EVENT_DEVICE_CONNECTION_STATUS_T>(event);
+            if (stDeviceConnectionStatus)
+                eventDeviceConnectionStatus(stDeviceConnectionStatus->devicename, stDeviceConnectionStatus->deviceNameDetail, stDeviceConnectionStatus->deviceIcon, \
+                    stDeviceConnectionStatus->deviceStatus, stDeviceConnectionStatus->mixerType,stDeviceConnectionStatus->isOutput);
         }
         break;
         default:
@@ -52,21 +52,18 @@ void AudioPolicyManager::eventSinkStatus(const std::string& source, const std::s
         int priority = 0;
         int currentVolume = 100;
         bool ramp = false;
-        for (auto &elements : mVolumePolicyInfo)
-        {
-            if (elements.streamType == streamType)
-            {
-                elements.source = source;
-                elements.sink = sink;
-                elements.mixerType = mixerType;
-                priority = elements.priority;
-                currentVolume = elements.currentVolume;
-                ramp = elements.ramp;
-                elements.isStreamActive = (sinkStatus == utils::eSinkOpened) ? true : false;
-                PM_LOG_INFO(MSGID_POLICY_MANAGER, INIT_KVCOUNT,\
-                    "mixertype set %d",elements.mixerType);
-                break;
-            }
+        utils::VOLUME_POLICY_INFO_T *policyInfo = getSinkPolicyInfo(audioSink);
+        if (policyInfo)
+        {
+            policyInfo->source = source;
+            policyInfo->sink = sink;
+            policyInfo->mixerType = mixerType;
+            priority = policyInfo->priority;
+            currentVolume = policyInfo->currentVolume;
+            ramp = policyInfo->ramp;
+            policyInfo->isStreamActive = (sinkStatus == utils::eSinkOpened) ? true : false;
+            PM_LOG_INFO(MSGID_POLICY_MANAGER, INIT_KVCOUNT,\
+                "mixertype set %d",policyInfo->mixerType);
         }
         if (utils::eSinkOpened == sinkStatus)
         {
@@ -114,19 +111,16 @@ void AudioPolicyManager::eventSourceStatus(const std::string& source, const std:
         int priority = 0;
         int currentVolume = 100;
         bool ramp = false;
-        for (auto &elements : mSourceVolumePolicyInfo)
+        utils::VOLUME_POLICY_INFO_T *policyInfo = getSourcePolicyInfo(audioSource);
+        if (policyInfo)
         {
-            if (elements.streamType == streamType)
-            {
-                elements.source = source;
-                elements.sink = sink;
-                elements.mixerType = mixerType;
-                priority = elements.priority;
-                currentVolume = elements.currentVolume;
-                ramp = elements.ramp;
-                elements.isStreamActive = (sourceStatus == utils::eSinkOpened) ? true : false;
-                break;
-            }
+            policyInfo->source = source;
+            policyInfo->sink = sink;
+            policyInfo->mixerType = mixerType;
+            priority = policyInfo->priority;
+            currentVolume = policyInfo->currentVolume;
+            ramp = policyInfo->ramp;
+            policyInfo->isStreamActive = (sourceStatus == utils::eSinkOpened) ? true : false;
         }
         if (utils::eSinkOpened == sourceStatus)
         {
@@ -160,7 +154,12 @@ void AudioPolicyManager::eventMixerStatus(bool mixerStatus, utils::EMIXER_TYPE m
     PM_LOG_INFO(MSGID_POLICY_MANAGER, INIT_KVCOUNT,\
         "AudioPolicyManager::eventMixerStatus mixerStatus:%d mixerType:%d", (int)mixerStatus, (int)mixerType);
     if (utils::ePulseMixer == mixerType)
-        initStreamVolume();
+    {
+        if (mixerStatus)
+            initStreamVolume();
+        else
+            mSinkPolicies.clearActiveStreams();
+    }
 }
 
 void AudioPolicyManager::eventCurrentInputVolume(EVirtualAudioSink audioSink, const int& volume)
@@ -206,7 +205,7 @@ void AudioPolicyManager::addSinkInput(const std::string &trackId, const int &sin
                 PM_LOG_INFO(MSGID_POLICY_MANAGER, INIT_KVCOUNT,\
                     "sink found");
                 elements.sinkInputIndex = sinkIndex;
-                int effectiveVolume = (getCurrentVolume(sink)*elements.volume)/100;
+                int effectiveVolume = getEffectiveVolume(sink, getCurrentVolume(sink), elements.volume);
                 //apply initial volume
                 mObjAudioMixer->programTrackVolume(getSinkType(sink), sinkIndex, effectiveVolume, nullptr, nullptr, nullptr, nullptr);
             }
@@ -228,7 +227,7 @@ void AudioPolicyManager::addSinkInput(const std::string &trackId, const int &sin
         stAppVolumeInfo.volume = MAX_VOLUME;
         stAppVolumeInfo.sinkInputIndex = sinkIndex;
         mTrackVolumeInfo[DEFAULT_TRACK_ID].push_back(stAppVolumeInfo);
-        int effectiveVolume = (getCurrentVolume(sink)*MAX_VOLUME)/100;
+        int effectiveVolume = getEffectiveVolume(sink, getCurrentVolume(sink), MAX_VOLUME);
         //apply initial volume
         mObjAudioMixer->programTrackVolume(getSinkType(sink), sinkIndex, effectiveVolume, nullptr, nullptr, nullptr, nullptr);
 
@@ -284,12 +283,12 @@ void AudioPolicyManager::readPolicyInfo()
                 events::EVENT_SINK_POLICY_INFO_T eventSinkPolicyInfo;
                 eventSinkPolicyInfo.eventName = utils::eEventSinkPolicyInfo;
                 eventSinkPolicyInfo.policyInfo =  policyInfo;
-                mObjModuleManager->publishModuleEvent((events::EVENTS_T*)&eventSinkPolicyInfo);
+                mObjModuleManager->publishModuleEvent(eventSinkPolicyInfo);
 
                 events::EVENT_SOURCE_POLICY_INFO_T eventSourcePolicyInfo;
                 eventSourcePolicyInfo.eventName = utils::eEventSourcePolicyInfo;
                 eventSourcePolicyInfo.sourcePolicyInfo = policyInfoSources;
-                mObjModuleManager->publishModuleEvent((events::EVENTS_T*)&eventSourcePolicyInfo);
+                mObjModuleManager->publishModuleEvent(eventSourcePolicyInfo);
             }
             else
                 PM_LOG_ERROR (MSGID_POLICY_MANAGER, INIT_KVCOUNT, \
@@ -324,62 +323,57 @@ bool AudioPolicyManager::initializePolicyInfo(const pbnjson::JValue& policyInfo,
     {
         for (const pbnjson::JValue& elements : policyInfo.items())
         {
-            utils::VOLUME_POLICY_INFO_T stPolicyInfo;
-            std::string streamType;
-            std::string sink;
-            std::string source;
-            std::string category;
-            bool volumeAdjustable = true;
-            bool muteStatus = false;
-            bool ramp = false;
-
-            if (elements["streamType"].asString(streamType) == CONV_OK)
-                stPolicyInfo.streamType = streamType;
-            stPolicyInfo.policyVolume = elements["policyVolume"].asNumber<int>();
-            stPolicyInfo.priority = elements["priority"].asNumber<int>();
-            stPolicyInfo.groupId = elements["group"].asNumber<int>();
-            stPolicyInfo.defaultVolume = elements["defaultVolume"].asNumber<int>();
-            stPolicyInfo.maxVolume = elements["maxVolume"].asNumber<int>();
-            stPolicyInfo.minVolume = elements["minVolume"].asNumber<int>();
-            if (elements["volumeAdjustable"].asBool(volumeAdjustable) == CONV_OK)
-                stPolicyInfo.volumeAdjustable = volumeAdjustable;
-            stPolicyInfo.currentVolume = elements["currentVolume"].asNumber<int>();
-            if (elements["muteStatus"].asBool(muteStatus) == CONV_OK)
-                stPolicyInfo.muteStatus = muteStatus;
-            if (elements["sink"].asString(sink) == CONV_OK)
-                stPolicyInfo.sink = sink;
-            if (elements["source"].asString(source) == CONV_OK)
-                stPolicyInfo.source = source;
-            if (elements["ramp"].asBool(ramp) == CONV_OK)
-                stPolicyInfo.ramp = ramp;
-            if (elements["category"].asString(category) == CONV_OK)
-                stPolicyInfo.category = category;
+            utils::VOLUME_POLICY_INFO_T stPolicyInfo = StreamPolicyTable::parsePolicyInfo(elements);
+            if (isSink && elements.hasKey("volumeCurve"))
+                VolumeCurve::setCurve(stPolicyInfo.streamType, elements["volumeCurve"]);
             if (isSink)
-                mVolumePolicyInfo.push_back(stPolicyInfo);
+                mSinkPolicies.addPolicy(stPolicyInfo, getSinkByName(stPolicyInfo.streamType.c_str()));
             else
-                mSourceVolumePolicyInfo.push_back(stPolicyInfo);
+                mSourcePolicies.addPolicy(stPolicyInfo, getSourceByName(stPolicyInfo.streamType.c_str()));
         }
     }
     printPolicyInfo();
     return true;
 }
 
+utils::VOLUME_POLICY_INFO_T* AudioPolicyManager::getSinkPolicyInfo(EVirtualAudioSink audioSink)
+{
+    return mSinkPolicies.getPolicyInfo(audioSink);
+}
+
+utils::VOLUME_POLICY_INFO_T* AudioPolicyManager::getSinkPolicyInfo(const std::string& streamType)
+{
+    return mSinkPolicies.getPolicyInfo(streamType);
+}
+
+utils::VOLUME_POLICY_INFO_T* AudioPolicyManager::getSourcePolicyInfo(EVirtualSource audioSource)
+{
+    return mSourcePolicies.getPolicyInfo(audioSource);
+}
+
+utils::VOLUME_POLICY_INFO_T* AudioPolicyManager::getSourcePolicyInfo(const std::string& streamType)
+{
+    return mSourcePolicies.getPolicyInfo(streamType);
+}
+
 void AudioPolicyManager::initStreamVolume()
 {
     PM_LOG_INFO(MSGID_POLICY_MANAGER, INIT_KVCOUNT,\
         "AudioPolicyManager::initStreamVolume");
     EVirtualAudioSink sink = eVirtualSink_None;
-    for (const auto &elements : mVolumePolicyInfo)
+    std::vector<utils::SINK_VOLUME_ENTRY_T> entries;
+    for (const auto &elements : mSinkPolicies.getPolicies())
     {
         sink = getSinkType(elements.streamType);
-        if (!setVolume(sink, INIT_VOLUME, utils::ePulseMixer, nullptr, nullptr, nullptr, nullptr))
-            PM_LOG_ERROR(MSGID_POLICY_MANAGER, INIT_KVCOUNT,\
-                "AudioPolicyManager::initStreamVolume volume could not be set for stream:%s",\
-                elements.streamType.c_str());
+        collectSinkVolumes(sink, INIT_VOLUME, false, entries);
         if (mObjAudioMixer)
             mObjAudioMixer->muteSink(sink, false, nullptr, nullptr, nullptr, nullptr);
     }
-    for (const auto &elements : mSourceVolumePolicyInfo)
+    if (!entries.empty() && mObjAudioMixer && \
+        !mObjAudioMixer->programVolumes(entries, nullptr, nullptr, nullptr, nullptr))
+        PM_LOG_ERROR(MSGID_POLICY_MANAGER, INIT_KVCOUNT,\
+            "AudioPolicyManager::initStreamVolume volume could not be set for %zu sink input(s)", entries.size());
+    for (const auto &elements : mSourcePolicies.getPolicies())
     {
         EVirtualSource source = getSourceType(elements.streamType);
         if (!setVolume(source, INIT_VOLUME, utils::ePulseMixer, nullptr, nullptr, nullptr, nullptr))
@@ -394,7 +388,7 @@ void AudioPolicyManager::initStreamVolume()
 void AudioPolicyManager::printPolicyInfo()
 {
     PM_LOG_DEBUG("AudioPolicyManager::printPolicyInfo");
-    for (const auto& elements : mVolumePolicyInfo)
+    for (const auto& elements : mSinkPolicies.getPolicies())
     {
         PM_LOG_DEBUG("*************%s*************", elements.streamType.c_str());
         PM_LOG_DEBUG("policyVolume:%d", elements.policyVolume);
@@ -409,7 +403,7 @@ void AudioPolicyManager::printPolicyInfo()
             (int)elements.isPolicyInProgress, (int)elements.isStreamActive, elements.category.c_str());
     }
     PM_LOG_DEBUG("AudioPolicyManager::Sounces policy:\n");
-    for (const auto& elements : mSourceVolumePolicyInfo)
+    for (const auto& elements : mSourcePolicies.getPolicies())
     {
         PM_LOG_DEBUG("*************%s*************", elements.streamType.c_str());
         PM_LOG_DEBUG("policyVolume:%d", elements.policyVolume);
@@ -428,7 +422,7 @@ void AudioPolicyManager::printPolicyInfo()
 void AudioPolicyManager::printActivePolicyInfo()
 {
     PM_LOG_DEBUG("AudioPolicyManager::printActivePolicyInfo:");
-    for (const auto& elements : mVolumePolicyInfo)
+    for (const auto& elements : mSinkPolicies.getPolicies())
     {
         if (elements.isPolicyInProgress)
         {
@@ -471,13 +465,9 @@ std::string AudioPolicyManager::getStreamType(EVirtualSource audioSource)
 
 bool AudioPolicyManager::getSourceActiveStatus(const std::string& streamType)
 {
-    for (const auto &elements : mSourceVolumePolicyInfo)
-    {
-        if (elements.streamType == streamType)
-        {
-            return elements.isStreamActive;
-        }
-    }
+    const utils::VOLUME_POLICY_INFO_T *policyInfo = getSourcePolicyInfo(streamType);
+    if (policyInfo)
+        return policyInfo->isStreamActive;
     return false;
 }
 
@@ -487,13 +477,9 @@ bool AudioPolicyManager::getStreamActiveStatus(const std::string& streamType)
     PM_LOG_INFO(MSGID_POLICY_MANAGER, INIT_KVCOUNT,\
         "AudioPolicyManager: getStreamActiveStatus :%s", streamType.c_str());
 
-    for (const auto &elements : mVolumePolicyInfo)
-    {
-        if (elements.streamType == streamType)
-        {
-            return elements.isStreamActive;
-        }
-    }
+    const utils::VOLUME_POLICY_INFO_T *policyInfo = getSinkPolicyInfo(streamType);
+    if (policyInfo)
+        return policyInfo->isStreamActive;
     return false;
 }
 
@@ -576,70 +562,14 @@ void AudioPolicyManager::applyVolumePolicy(EVirtualAudioSink audioSink, const st
     PM_LOG_INFO(MSGID_POLICY_MANAGER, INIT_KVCOUNT,\
         "AudioPolicyManager:applyVolumePolicy sink:%d streamType:%s priority:%d",\
         (int)audioSink, streamType.c_str(), priority);
-    if (mObjAudioMixer)
+    std::vector<StreamPolicyTable::POLICY_VOLUME_UPDATE_T> volumeUpdates;
+    if (!mSinkPolicies.activateStream(audioSink, priority, volumeUpdates))
     {
-        int policyPriority = MAX_PRIORITY;
-        bool isPolicyInProgress = false;
-        std::string policyStreamType;
-        int currentPolicyStreamVolume = MAX_VOLUME;
-        int currentVolume = MAX_VOLUME;
-        utils::vectorVirtualSink activeStreams = mObjAudioMixer->getActiveStreams();
-        std::string incomingStreamCategory = getCategory(streamType);
-        std::string activeStreamCategory;
-        for (const auto &it : activeStreams)
-        {
-            policyStreamType = getStreamType(it);
-            policyPriority  = getPriority(policyStreamType);
-            activeStreamCategory  = getCategory(policyStreamType);
-            if (incomingStreamCategory == activeStreamCategory)
-            {
-                if (priority < policyPriority)
-                {
-                    isPolicyInProgress = getPolicyStatus(policyStreamType);
-                    currentPolicyStreamVolume = getPolicyVolume(policyStreamType);
-                    currentVolume  = getCurrentVolume(policyStreamType);
-                    PM_LOG_INFO(MSGID_POLICY_MANAGER, INIT_KVCOUNT,\
-                        "AudioPolicyManager:applyVolumePolicy Incoming stream:%s is high priority than active stream:%s with priority:%d policyStatus:%d",\
-                        streamType.c_str(), policyStreamType.c_str(), policyPriority, isPolicyInProgress);
-                    PM_LOG_INFO(MSGID_POLICY_MANAGER, INIT_KVCOUNT,\
-                        "AudioPolicyManager:currentPolicyStreamVolume:%d currentVolume:%d",\
-                        currentPolicyStreamVolume, currentVolume);
-                    if (!isPolicyInProgress && currentVolume > currentPolicyStreamVolume)
-                    {
-                        if (setVolume(getSinkType(policyStreamType), currentPolicyStreamVolume,\
-                            getMixerType(policyStreamType), nullptr, nullptr, nullptr, nullptr, isRampPolicyActive(policyStreamType)))
-                            updatePolicyStatus(policyStreamType, true);
-                    }
-                    else
-                        PM_LOG_WARNING(MSGID_POLICY_MANAGER, INIT_KVCOUNT,\
-                        "AudioPolicyManager:applyVolumePolicy current volume is less than policy volume");
-                }
-                else if (priority > policyPriority)
-                {
-                    isPolicyInProgress = getPolicyStatus(streamType);
-                    PM_LOG_INFO(MSGID_POLICY_MANAGER, INIT_KVCOUNT,\
-                        "AudioPolicyManager:applyVolumePolicy Incoming stream is low priority than active stream:%s with priority:%d policyStatus:%d",\
-                        policyStreamType.c_str(), policyPriority, isPolicyInProgress);
-                    if (!isPolicyInProgress)
-                    {
-                        if (setVolume(audioSink, getPolicyVolume(streamType), getMixerType(streamType), nullptr, nullptr, nullptr, nullptr, isRampPolicyActive(streamType)))
-                            updatePolicyStatus(streamType, true);
-                    }
-                }
-                else
-                    PM_LOG_INFO(MSGID_POLICY_MANAGER, INIT_KVCOUNT,\
-                        "AudioPolicyManager:applyVolumePolicy Incoming stream:%s and active stream:%s priority is same",\
-                        streamType.c_str(), policyStreamType.c_str());
-            }
-            else
-                PM_LOG_INFO(MSGID_POLICY_MANAGER, INIT_KVCOUNT,\
-                    "AudioPolicyManager:incoming stream category:%s active stream category:%s are not same",\
-                    incomingStreamCategory.c_str(), activeStreamCategory.c_str());
-        }
+        PM_LOG_WARNING(MSGID_POLICY_MANAGER, INIT_KVCOUNT,\
+            "AudioPolicyManager:applyVolumePolicy no policy for sink:%d", (int)audioSink);
+        return;
     }
-    else
-        PM_LOG_ERROR(MSGID_POLICY_MANAGER, INIT_KVCOUNT,\
-            "AudioPolicyManager:applyVolumePolicy mObjAudioMixer is null");
+    applyPolicyVolumeUpdates(volumeUpdates);
 }
 
 
@@ -656,20 +586,22 @@ void AudioPolicyManager::applyVolumePolicy(EVirtualSource audioSource, const std
         int currentPolicyStreamVolume = MAX_VOLUME;
         int currentVolume = MAX_VOLUME;
         utils::vectorVirtualSource activeStreams = mObjAudioMixer->getActiveSources();
-        std::string incomingStreamCategory = getCategoryOfSource(streamType);
-        std::string activeStreamCategory;
+        const utils::VOLUME_POLICY_INFO_T *incomingPolicyInfo = getSourcePolicyInfo(audioSource);
+        int incomingCategoryId = incomingPolicyInfo ? incomingPolicyInfo->categoryId : -1;
         for (const auto &it : activeStreams)
         {
-            policyStreamType = getStreamType(it);
-            policyPriority  = getPriorityOfSource(policyStreamType);
-            activeStreamCategory  = getCategoryOfSource(policyStreamType);
-            if (incomingStreamCategory == activeStreamCategory)
+            const utils::VOLUME_POLICY_INFO_T *activePolicyInfo = getSourcePolicyInfo(it);
+            if (!activePolicyInfo)
+                continue;
+            policyStreamType = activePolicyInfo->streamType;
+            policyPriority  = activePolicyInfo->priority;
+            if (incomingCategoryId == activePolicyInfo->categoryId)
             {
                 if (priority < policyPriority)
                 {
-                    isPolicyInProgress = getPolicyStatusOfSource(policyStreamType);
-                    currentPolicyStreamVolume = getPolicyVolumeofSource(policyStreamType);
-                    currentVolume  = getCurrentVolumeOfSource(policyStreamType);
+                    isPolicyInProgress = activePolicyInfo->isPolicyInProgress;
+                    currentPolicyStreamVolume = activePolicyInfo->policyVolume;
+                    currentVolume  = activePolicyInfo->currentVolume;
                     PM_LOG_INFO(MSGID_POLICY_MANAGER, INIT_KVCOUNT,\
                         "AudioPolicyManager:applyVolumePolicyForSource Incoming stream:%s is high priority than active stream:%s with priority:%d policyStatus:%d",\
                         streamType.c_str(), policyStreamType.c_str(), policyPriority, isPolicyInProgress);
@@ -678,8 +610,8 @@ void AudioPolicyManager::applyVolumePolicy(EVirtualSource audioSource, const std
                         currentPolicyStreamVolume, currentVolume);
                     if (!isPolicyInProgress && currentVolume > currentPolicyStreamVolume)
                     {
-                        if (setVolume(getSourceType(policyStreamType), currentPolicyStreamVolume,\
-                            getMixerTypeofSource(policyStreamType), nullptr, nullptr, nullptr, nullptr, isRampPolicyActiveForSource(policyStreamType)))
+                        if (setVolume(it, currentPolicyStreamVolume,\
+                            activePolicyInfo->mixerType, nullptr, nullptr, nullptr, nullptr, activePolicyInfo->ramp))
                             updatePolicyStatusForSource(policyStreamType, true);
                     }
                     else
@@ -688,13 +620,13 @@ void AudioPolicyManager::applyVolumePolicy(EVirtualSource audioSource, const std
                 }
                 else if (priority > policyPriority)
                 {
-                    isPolicyInProgress = getPolicyStatusOfSource(streamType);
+                    isPolicyInProgress = incomingPolicyInfo->isPolicyInProgress;
                     PM_LOG_INFO(MSGID_POLICY_MANAGER, INIT_KVCOUNT,\
                         "AudioPolicyManager:applyVolumePolicyForSource Incoming stream is low priority than active stream:%s with priority:%d policyStatus:%d",\
                         policyStreamType.c_str(), policyPriority, isPolicyInProgress);
                     if (!isPolicyInProgress)
                     {
-                        if (setVolume(audioSource, getPolicyVolumeofSource(streamType), getMixerTypeofSource(streamType), nullptr, nullptr, nullptr, nullptr, isRampPolicyActiveForSource(streamType)))
+                        if (setVolume(audioSource, incomingPolicyInfo->policyVolume, incomingPolicyInfo->mixerType, nullptr, nullptr, nullptr, nullptr, incomingPolicyInfo->ramp))
                             updatePolicyStatusForSource(streamType, true);
                     }
                 }
@@ -705,8 +637,8 @@ void AudioPolicyManager::applyVolumePolicy(EVirtualSource audioSource, const std
             }
             else
                 PM_LOG_INFO(MSGID_POLICY_MANAGER, INIT_KVCOUNT,\
-                    "AudioPolicyManager:incoming stream category:%s active stream category:%s are not same",\
-                    incomingStreamCategory.c_str(), activeStreamCategory.c_str());
+                    "AudioPolicyManager:incoming stream:%s active stream:%s categories are not same",\
+                    streamType.c_str(), policyStreamType.c_str());
         }
     }
     else
@@ -719,52 +651,88 @@ void AudioPolicyManager::removeVolumePolicy(EVirtualAudioSink audioSink, const s
     PM_LOG_INFO(MSGID_POLICY_MANAGER, INIT_KVCOUNT,\
         "AudioPolicyManager:removeVolumePolicy sink:%d streamType:%s priority:%d",\
         (int)audioSink, streamType.c_str(), priority);
-    if (mObjAudioMixer)
+    std::vector<StreamPolicyTable::POLICY_VOLUME_UPDATE_T> volumeUpdates;
+    if (mSinkPolicies.deactivateStream(audioSink, priority, volumeUpdates))
+        applyPolicyVolumeUpdates(volumeUpdates);
+    else if (getSinkPolicyInfo(audioSink))
+        PM_LOG_WARNING(MSGID_POLICY_MANAGER, INIT_KVCOUNT,\
+            "AudioPolicyManager:removeVolumePolicy sink:%d was not active", (int)audioSink);
+    updatePolicyStatus(streamType, false);
+}
+
+void AudioPolicyManager::collectSinkVolumes(EVirtualAudioSink audioSink, const int &volume, bool ramp,\
+    std::vector<utils::SINK_VOLUME_ENTRY_T> &entries)
+{
+    for (const auto& items:mTrackVolumeInfo)
     {
-        int policyPriority = MAX_PRIORITY;
-        bool isPolicyInProgress = false;
-        std::string policyStreamType;
-        utils::vectorVirtualSink activeStreams = mObjAudioMixer->getActiveStreams();
-        std::string incomingStreamCategory = getCategory(streamType);
-        std::string activeStreamCategory;
-        for (const auto &it : activeStreams)
+        for(const auto& elements:items.second)
         {
-            policyStreamType = getStreamType(it);
-            policyPriority  = getPriority(policyStreamType);
-            activeStreamCategory = getCategory(policyStreamType);
-            if (incomingStreamCategory == activeStreamCategory)
+            if(elements.audioSink == audioSink)
             {
-                if (priority < policyPriority)
+                int effectiveVolume;
+                if (items.first == DEFAULT_TRACK_ID)
                 {
-                    isPolicyInProgress = getPolicyStatus(policyStreamType);
-                    PM_LOG_INFO(MSGID_POLICY_MANAGER, INIT_KVCOUNT,\
-                        "AudioPolicyManager:removeVolumePolicy Incoming stream:%s is high priority than active stream:%s with priority:%d policyStatus:%d",\
-                        streamType.c_str(), policyStreamType.c_str(), policyPriority, isPolicyInProgress);
-                    if (isPolicyInProgress && !isHighPriorityStreamActive(policyPriority, activeStreams, incomingStreamCategory))
-                    {
-                        if (setVolume(getSinkType(policyStreamType), getCurrentVolume(policyStreamType),\
-                            getMixerType(policyStreamType), nullptr, nullptr, nullptr, nullptr, isRampPolicyActive(policyStreamType)))
-                            updatePolicyStatus(policyStreamType, false);
-                    }
-                    else
-                        PM_LOG_WARNING(MSGID_POLICY_MANAGER, INIT_KVCOUNT,\
-                        "AudioPolicyManager:removeVolumePolicy policy is not in progress or still other high priority streams are active");
+                    //setting volume for unregistered tracks
+                    PM_LOG_DEBUG("AudioPolicyManager : programTrackVolume: trackId not set, use default track volume");
+                    effectiveVolume = getEffectiveVolume(getStreamType(audioSink), volume, MAX_VOLUME);
                 }
                 else
-                    PM_LOG_INFO(MSGID_POLICY_MANAGER, INIT_KVCOUNT,\
-                        "AudioPolicyManager:removeVolumePolicy Incoming stream:%s priority is same or less than active stream:%s priority",\
-                        streamType.c_str(), policyStreamType.c_str());
+                {
+                    PM_LOG_DEBUG("AudioPolicyManager : programTrackVolume: trackId found, use actuial track volume");
+                    effectiveVolume = getEffectiveVolume(getStreamType(audioSink), volume, elements.volume);
+                }
+                PM_LOG_DEBUG("AudioPolicyManager : programTrackVolume:  trackId:%s, effective vol : %d, sink : %d, sinkindex:%d",
+                    items.first.c_str(),effectiveVolume, (int)audioSink, elements.sinkInputIndex);
+                utils::SINK_VOLUME_ENTRY_T entry;
+                entry.audioSink = audioSink;
+                entry.sinkInputIndex = elements.sinkInputIndex;
+                entry.volume = effectiveVolume;
+                entry.ramp = ramp;
+                entries.push_back(entry);
             }
-            else
-                PM_LOG_INFO(MSGID_POLICY_MANAGER, INIT_KVCOUNT,\
-                    "AudioPolicyManager:removeVolumePolicy incoming stream category:%s active stream category:%s are not same",\
-                    incomingStreamCategory.c_str(), activeStreamCategory.c_str());
         }
     }
-    else
+}
+
+int AudioPolicyManager::getEffectiveVolume(const std::string &streamType, int volume, int trackVolume)
+{
+    //The policy module maps the percent to pa_volume_t itself
+    return (volume * trackVolume) / MAX_VOLUME;
+}
+
+void AudioPolicyManager::applyPolicyVolumeUpdates(const std::vector<StreamPolicyTable::POLICY_VOLUME_UPDATE_T> &volumeUpdates)
+{
+    if (!mObjAudioMixer)
+        return;
+    //Ducking and restoring of all affected sinks are queued to pulse together
+    std::vector<utils::SINK_VOLUME_ENTRY_T> entries;
+    std::vector<const StreamPolicyTable::POLICY_VOLUME_UPDATE_T*> appliedUpdates;
+    for (const auto &update : volumeUpdates)
+    {
+        const utils::VOLUME_POLICY_INFO_T *policyInfo = getSinkPolicyInfo((EVirtualAudioSink)update.stream);
+        if (!policyInfo)
+            continue;
+        if (utils::ePulseMixer != policyInfo->mixerType)
+            continue;
+        size_t count = entries.size();
+        collectSinkVolumes((EVirtualAudioSink)update.stream, update.volume, policyInfo->ramp, entries);
+        if (entries.size() > count)
+            appliedUpdates.push_back(&update);
+    }
+    if (entries.empty())
+        return;
+    if (!mObjAudioMixer->programVolumes(entries, nullptr, nullptr, nullptr, nullptr))
+    {
         PM_LOG_ERROR(MSGID_POLICY_MANAGER, INIT_KVCOUNT,\
-            "AudioPolicyManager:removeVolumePolicy mObjAudioMixer is null");
-    updatePolicyStatus(streamType, false);
+            "AudioPolicyManager:applyPolicyVolumeUpdates programVolumes failed");
+        return;
+    }
+    for (const auto update : appliedUpdates)
+    {
+        const utils::VOLUME_POLICY_INFO_T *policyInfo = getSinkPolicyInfo((EVirtualAudioSink)update->stream);
+        if (policyInfo)
+            updatePolicyStatus(policyInfo->streamType, update->ducked);
+    }
 }
 
 void AudioPolicyManager::removeVolumePolicy(EVirtualSource audioSource, const std::string& streamType, const int& priority)
@@ -778,25 +746,27 @@ void AudioPolicyManager::removeVolumePolicy(EVirtualSource audioSource, const st
         bool isPolicyInProgress = false;
         std::string policyStreamType;
         utils::vectorVirtualSource activeStreams = mObjAudioMixer->getActiveSources();
-        std::string incomingStreamCategory = getCategoryOfSource(streamType);
-        std::string activeStreamCategory;
+        const utils::VOLUME_POLICY_INFO_T *incomingPolicyInfo = getSourcePolicyInfo(audioSource);
+        int incomingCategoryId = incomingPolicyInfo ? incomingPolicyInfo->categoryId : -1;
         for (const auto &it : activeStreams)
         {
-            policyStreamType = getStreamType(it);
-            policyPriority  = getPriorityOfSource(policyStreamType);
-            activeStreamCategory = getCategoryOfSource(policyStreamType);
-            if (incomingStreamCategory == activeStreamCategory)
+            const utils::VOLUME_POLICY_INFO_T *activePolicyInfo = getSourcePolicyInfo(it);
+            if (!activePolicyInfo)
+                continue;
+            policyStreamType = activePolicyInfo->streamType;
+            policyPriority  = activePolicyInfo->priority;
+            if (incomingCategoryId == activePolicyInfo->categoryId)
             {
                 if (priority < policyPriority)
                 {
-                    isPolicyInProgress = getPolicyStatusOfSource(policyStreamType);
+                    isPolicyInProgress = activePolicyInfo->isPolicyInProgress;
                     PM_LOG_INFO(MSGID_POLICY_MANAGER, INIT_KVCOUNT,\
                         "AudioPolicyManager:removeVolumePolicy Incoming stream:%s is high priority than active stream:%s with priority:%d policyStatus:%d",\
                         streamType.c_str(), policyStreamType.c_str(), policyPriority, isPolicyInProgress);
                     if (isPolicyInProgress && !isHighPrioritySourceActive(policyPriority, activeStreams))
                     {
-                        if (setVolume(getSourceType(policyStreamType), getCurrentVolumeOfSource(policyStreamType),\
-                            getMixerTypeofSource(policyStreamType), nullptr, nullptr, nullptr, nullptr, isRampPolicyActiveForSource(policyStreamType)))
+                        if (setVolume(it, activePolicyInfo->currentVolume,\
+                            activePolicyInfo->mixerType, nullptr, nullptr, nullptr, nullptr, activePolicyInfo->ramp))
                             updatePolicyStatusForSource(policyStreamType, false);
                     }
                     else
@@ -810,8 +780,8 @@ void AudioPolicyManager::removeVolumePolicy(EVirtualSource audioSource, const st
             }
             else
                 PM_LOG_INFO(MSGID_POLICY_MANAGER, INIT_KVCOUNT,\
-                    "AudioPolicyManager:removeVolumePolicy incoming stream category:%s active stream category:%s are not same",\
-                    incomingStreamCategory.c_str(), activeStreamCategory.c_str());
+                    "AudioPolicyManager:removeVolumePolicy incoming stream:%s active stream:%s categories are not same",\
+                    streamType.c_str(), policyStreamType.c_str());
         }
     }
     else
@@ -897,7 +867,8 @@ bool AudioPolicyManager::setTrackVolume(const std::string& trackId, const int &v
                     {
                         if (elements.sinkInputIndex != -1)
                         {
-                            int effectiveVolume  = (getCurrentVolume(getStreamType(elements.audioSink)) * volume) / 100;
+                            std::string streamType = getStreamType(elements.audioSink);
+                            int effectiveVolume = getEffectiveVolume(streamType, getCurrentVolume(streamType), volume);
                             PM_LOG_INFO(MSGID_POLICY_MANAGER, INIT_KVCOUNT, "AudioPolicyManager calling programVolume effective = %d", effectiveVolume);
                             if (mObjAudioMixer->programTrackVolume(elements.audioSink, elements.sinkInputIndex, effectiveVolume, lshandle, message, ctx, cb, ramp))
                                 returnStatus = true;
@@ -933,35 +904,10 @@ bool AudioPolicyManager::setVolume(EVirtualAudioSink audioSink, const int& volum
     {
         if (utils::ePulseMixer == mixerType)
         {
-            for (const auto& items:mTrackVolumeInfo)
-            {
-                for(const auto& elements:items.second)
-                {
-                    if(elements.audioSink == audioSink)
-                    {
-                        int effectiveVolume;
-                        if (items.first == DEFAULT_TRACK_ID)
-                        {
-                            //setting volume for unregistered tracks
-                            PM_LOG_DEBUG("AudioPolicyManager : programTrackVolume: trackId not set, use default track volume");
-                            effectiveVolume = (MAX_VOLUME * volume)/100;
-                        }
-                        else
-                        {
-                            PM_LOG_DEBUG("AudioPolicyManager : programTrackVolume: trackId found, use actuial track volume");
-                            effectiveVolume = (elements.volume * volume)/100;
-                        }
-                        PM_LOG_DEBUG("AudioPolicyManager : programTrackVolume:  trackId:%s, effective vol : %d, sink : %d, sinkindex:%d",
-                            items.first.c_str(),effectiveVolume, (int)audioSink, elements.sinkInputIndex);
-                        returnStatus = mObjAudioMixer->programTrackVolume(audioSink, elements.sinkInputIndex, effectiveVolume, lshandle, message, ctx, cb);
-                        if (!returnStatus)
-                        {
-                            return returnStatus;
-                        }
-
-                    }
-                }
-            }
+            std::vector<utils::SINK_VOLUME_ENTRY_T> entries;
+            collectSinkVolumes(audioSink, volume, ramp, entries);
+            if (!entries.empty())
+                returnStatus = mObjAudioMixer->programVolumes(entries, lshandle, message, ctx, cb);
         }
         else if (utils::eUmiMixer == mixerType)
         {
@@ -986,11 +932,9 @@ std::string AudioPolicyManager::getCategory(const std::string& streamType)
 {
     PM_LOG_INFO(MSGID_POLICY_MANAGER, INIT_KVCOUNT,\
         "AudioPolicyManager:getCategory streamType:%s", streamType.c_str());
-    for (const auto &elements : mVolumePolicyInfo)
-    {
-        if (elements.streamType == streamType)
-            return elements.category;
-    }
+    const utils::VOLUME_POLICY_INFO_T *policyInfo = getSinkPolicyInfo(streamType);
+    if (policyInfo)
+        return policyInfo->category;
     return "";
 }
 
@@ -998,39 +942,20 @@ std::string AudioPolicyManager::getCategoryOfSource(const std::string& streamTyp
 {
     PM_LOG_INFO(MSGID_POLICY_MANAGER, INIT_KVCOUNT,\
         "AudioPolicyManager:getCategoryOfSource streamType:%s", streamType.c_str());
-    for (auto &elements : mSourceVolumePolicyInfo)
-    {
-        if (elements.streamType == streamType)
-            return elements.category;
-    }
+    const utils::VOLUME_POLICY_INFO_T *policyInfo = getSourcePolicyInfo(streamType);
+    if (policyInfo)
+        return policyInfo->category;
     return "";
 }
 
-bool AudioPolicyManager::isHighPriorityStreamActive(const int& policyPriority, utils::vectorVirtualSink activeStreams, const std::string& category)
-{
-    PM_LOG_INFO(MSGID_POLICY_MANAGER, INIT_KVCOUNT,\
-        "AudioPolicyManager:isHighPriorityStreamActive priority:%d", policyPriority);
-    int priority  = MAX_PRIORITY;
-    for (const auto &it : activeStreams)
-    {
-        if (category == getCategory(getStreamType(it)))
-        {
-            priority  = getPriority(getStreamType(it));
-            if (policyPriority > priority)
-                return true;
-        }
-    }
-    return false;
-}
-
-bool AudioPolicyManager::isHighPrioritySourceActive(const int& policyPriority, utils::vectorVirtualSource activeStreams)
+bool AudioPolicyManager::isHighPrioritySourceActive(const int& policyPriority, const utils::vectorVirtualSource &activeStreams)
 {
     PM_LOG_INFO(MSGID_POLICY_MANAGER, INIT_KVCOUNT,\
         "AudioPolicyManager:isHighPrioritySourceActive priority:%d", policyPriority);
-    int priority  = MAX_PRIORITY;
     for (const auto &it : activeStreams)
     {
-        priority  = getPriorityOfSource(getStreamType(it));
+        const utils::VOLUME_POLICY_INFO_T *policyInfo = getSourcePolicyInfo(it);
+        int priority = policyInfo ? policyInfo->priority : MAX_PRIORITY;
         if (policyPriority > priority)
             return true;
     }
@@ -1041,11 +966,9 @@ int AudioPolicyManager::getCurrentVolume(const std::string& streamType)
 {
     PM_LOG_INFO(MSGID_POLICY_MANAGER, INIT_KVCOUNT,\
         "AudioPolicyManager:getCurrentVolume streamType:%s", streamType.c_str());
-    for (const auto &elements : mVolumePolicyInfo)
-    {
-        if (elements.streamType == streamType)
-            return elements.currentVolume;
-    }
+    const utils::VOLUME_POLICY_INFO_T *policyInfo = getSinkPolicyInfo(streamType);
+    if (policyInfo)
+        return policyInfo->currentVolume;
     return MAX_VOLUME;
 }
 
@@ -1053,11 +976,9 @@ int AudioPolicyManager::getCurrentVolumeOfSource(const std::string& streamType)
 {
     PM_LOG_INFO(MSGID_POLICY_MANAGER, INIT_KVCOUNT,\
         "AudioPolicyManager:getCurrentVolumeOfSource streamType:%s", streamType.c_str());
-    for (auto &elements : mSourceVolumePolicyInfo)
-    {
-        if (elements.streamType == streamType)
-            return elements.currentVolume;
-    }
+    const utils::VOLUME_POLICY_INFO_T *policyInfo = getSourcePolicyInfo(streamType);
+    if (policyInfo)
+        return policyInfo->currentVolume;
     return MAX_VOLUME;
 }
 
@@ -1065,14 +986,9 @@ void AudioPolicyManager::updatePolicyStatus(const std::string& streamType, const
 {
     PM_LOG_INFO(MSGID_POLICY_MANAGER, INIT_KVCOUNT,\
         "AudioPolicyManager:updatePolicyStatus streamType:%s status:%d", streamType.c_str(), status);
-    for (auto &elements : mVolumePolicyInfo)
-    {
-        if (elements.streamType == streamType)
-        {
-            elements.isPolicyInProgress = status;
-            break;
-        }
-    }
+    utils::VOLUME_POLICY_INFO_T *policyInfo = getSinkPolicyInfo(streamType);
+    if (policyInfo)
+        policyInfo->isPolicyInProgress = status;
     std::string payload = getStreamStatus(streamType, true);
     notifyGetStreamStatusSubscribers(payload);
 }
@@ -1081,14 +997,9 @@ void AudioPolicyManager::updatePolicyStatusForSource(const std::string& streamTy
 {
     PM_LOG_INFO(MSGID_POLICY_MANAGER, INIT_KVCOUNT,\
         "AudioPolicyManager:updatePolicyStatusForSource streamType:%s status:%d", streamType.c_str(), (int)status);
-    for (auto &elements : mSourceVolumePolicyInfo)
-    {
-        if (elements.streamType == streamType)
-        {
-            elements.isPolicyInProgress = status;
-            break;
-        }
-    }
+    utils::VOLUME_POLICY_INFO_T *policyInfo = getSourcePolicyInfo(streamType);
+    if (policyInfo)
+        policyInfo->isPolicyInProgress = status;
     std::string payload = getSourceStatus(streamType, true);
     notifyGetSourceStatusSubscribers(payload);
 }
@@ -1097,21 +1008,17 @@ bool AudioPolicyManager::getPolicyStatus(const std::string& streamType)
 {
     PM_LOG_INFO(MSGID_POLICY_MANAGER, INIT_KVCOUNT,\
         "AudioPolicyManager:getPolicyStatus streamType:%s", streamType.c_str());
-    for (const auto &elements : mVolumePolicyInfo)
-    {
-        if (elements.streamType == streamType)
-            return elements.isPolicyInProgress;
-    }
+    const utils::VOLUME_POLICY_INFO_T *policyInfo = getSinkPolicyInfo(streamType);
+    if (policyInfo)
+        return policyInfo->isPolicyInProgress;
     return false;
 }
 
 bool AudioPolicyManager::getPolicyStatusOfSource(const std::string& streamType)
 {
-    for (auto &elements : mSourceVolumePolicyInfo)
-    {
-        if (elements.streamType == streamType)
-            return elements.isPolicyInProgress;
-    }
+    const utils::VOLUME_POLICY_INFO_T *policyInfo = getSourcePolicyInfo(streamType);
+    if (policyInfo)
+        return policyInfo->isPolicyInProgress;
     return true;
 }
 
@@ -1119,21 +1026,17 @@ int AudioPolicyManager::getPriority(const std::string& streamType)
 {
     PM_LOG_INFO(MSGID_POLICY_MANAGER, INIT_KVCOUNT,\
         "AudioPolicyManager:getPriority streamType:%s", streamType.c_str());
-    for (const auto &elements : mVolumePolicyInfo)
-    {
-        if (elements.streamType == streamType)
-            return elements.priority;
-    }
+    const utils::VOLUME_POLICY_INFO_T *policyInfo = getSinkPolicyInfo(streamType);
+    if (policyInfo)
+        return policyInfo->priority;
     return MAX_PRIORITY;
 }
 
 int AudioPolicyManager::getPriorityOfSource(const std::string& streamType)
 {
-    for (auto &elements : mSourceVolumePolicyInfo)
-    {
-        if (elements.streamType == streamType)
-            return elements.priority;
-    }
+    const utils::VOLUME_POLICY_INFO_T *policyInfo = getSourcePolicyInfo(streamType);
+    if (policyInfo)
+        return policyInfo->priority;
     return MAX_PRIORITY;
 }
 
@@ -1141,21 +1044,17 @@ int AudioPolicyManager::getPolicyVolume(const std::string& streamType)
 {
     PM_LOG_INFO(MSGID_POLICY_MANAGER, INIT_KVCOUNT,\
         "AudioPolicyManager:getPolicyVolume streamType:%s", streamType.c_str());
-    for (const auto &elements : mVolumePolicyInfo)
-    {
-        if (elements.streamType == streamType)
-            return elements.policyVolume;
-    }
+    const utils::VOLUME_POLICY_INFO_T *policyInfo = getSinkPolicyInfo(streamType);
+    if (policyInfo)
+        return policyInfo->policyVolume;
     return MAX_VOLUME;
 }
 
 int AudioPolicyManager::getPolicyVolumeofSource(const std::string& streamType)
 {
-    for (auto &elements : mSourceVolumePolicyInfo)
-    {
-        if (elements.streamType == streamType)
-            return elements.policyVolume;
-    }
+    const utils::VOLUME_POLICY_INFO_T *policyInfo = getSourcePolicyInfo(streamType);
+    if (policyInfo)
+        return policyInfo->policyVolume;
     return MAX_VOLUME;
 }
 
@@ -1163,21 +1062,17 @@ utils::EMIXER_TYPE AudioPolicyManager::getMixerType(const std::string& streamTyp
 {
     PM_LOG_INFO(MSGID_POLICY_MANAGER, INIT_KVCOUNT,\
         "AudioPolicyManager:getMixerType streamType:%s", streamType.c_str());
-    for (const auto &elements : mVolumePolicyInfo)
-    {
-        if (elements.streamType == streamType)
-            return elements.mixerType;
-    }
+    const utils::VOLUME_POLICY_INFO_T *policyInfo = getSinkPolicyInfo(streamType);
+    if (policyInfo)
+        return policyInfo->mixerType;
     return utils::eMixerNone;
 }
 
 utils::EMIXER_TYPE AudioPolicyManager::getMixerTypeofSource(const std::string& streamType)
 {
-    for (auto &elements : mSourceVolumePolicyInfo)
-    {
-        if (elements.streamType == streamType)
-            return elements.mixerType;
-    }
+    const utils::VOLUME_POLICY_INFO_T *policyInfo = getSourcePolicyInfo(streamType);
+    if (policyInfo)
+        return policyInfo->mixerType;
     return utils::eMixerNone;
 }
 
@@ -1185,65 +1080,40 @@ void AudioPolicyManager::updateCurrentVolume(const std::string& streamType, cons
 {
     PM_LOG_INFO(MSGID_POLICY_MANAGER, INIT_KVCOUNT,\
         "AudioPolicyManager:updateCurrentVolume streamType:%s, Volume = %d", streamType.c_str(), volume);
-    for (auto &elements : mVolumePolicyInfo)
-    {
-        if (elements.streamType == streamType)
-        {
-            elements.currentVolume = volume;
-            break;
-        }
-    }
+    utils::VOLUME_POLICY_INFO_T *policyInfo = getSinkPolicyInfo(streamType);
+    if (policyInfo)
+        policyInfo->currentVolume = volume;
 }
 
 void AudioPolicyManager::updateCurrentVolumeForSource(const std::string& streamType, const int &volume)
 {
-    for (auto &elements : mSourceVolumePolicyInfo)
-    {
-        if (elements.streamType == streamType)
-        {
-            elements.currentVolume = volume;
-            return;
-        }
-    }
+    utils::VOLUME_POLICY_INFO_T *policyInfo = getSourcePolicyInfo(streamType);
+    if (policyInfo)
+        policyInfo->currentVolume = volume;
 }
 
 void AudioPolicyManager::updateMuteStatus(const std::string& streamType, const bool &mute)
 {
     PM_LOG_INFO(MSGID_POLICY_MANAGER, INIT_KVCOUNT,\
         "AudioPolicyManager:updateMuteStatus streamType:%s, MuteStatus = %d", streamType.c_str(), (int)mute);
-    for (auto &elements : mVolumePolicyInfo)
-    {
-        if (elements.streamType == streamType)
-        {
-            elements.muteStatus = mute;
-            return;
-        }
-    }
+    utils::VOLUME_POLICY_INFO_T *policyInfo = getSinkPolicyInfo(streamType);
+    if (policyInfo)
+        policyInfo->muteStatus = mute;
 }
 
 void AudioPolicyManager::updateMuteStatusForSource(const std::string& streamType, const bool &mute)
 {
-    for (auto &elements : mSourceVolumePolicyInfo)
-    {
-        if (elements.streamType == streamType)
-        {
-            elements.muteStatus = mute;
-            return;
-        }
-    }
+    utils::VOLUME_POLICY_INFO_T *policyInfo = getSourcePolicyInfo(streamType);
+    if (policyInfo)
+        policyInfo->muteStatus = mute;
 }
 
 int AudioPolicyManager::getCurrentSinkMuteStatus(const std::string &streamType)
 {
     bool muteStatus = false;
-    for (auto &elements : mVolumePolicyInfo)
-    {
-        if (elements.streamType == streamType)
-        {
-            muteStatus = elements.muteStatus;
-            break;
-        }
-    }
+    const utils::VOLUME_POLICY_INFO_T *policyInfo = getSinkPolicyInfo(streamType);
+    if (policyInfo)
+        muteStatus = policyInfo->muteStatus;
     PM_LOG_INFO(MSGID_POLICY_MANAGER, INIT_KVCOUNT,\
         "getCurrentSinkMuteStatus %s : %d", streamType.c_str(), (int)muteStatus);
     return (int)muteStatus;
@@ -1252,14 +1122,9 @@ int AudioPolicyManager::getCurrentSinkMuteStatus(const std::string &streamType)
 int AudioPolicyManager::getCurrentSourceMuteStatus(const std::string &streamType)
 {
     bool muteStatus = false;
-    for (auto &elements : mSourceVolumePolicyInfo)
-    {
-        if (elements.streamType == streamType)
-        {
-            muteStatus = elements.muteStatus;
-            break;
-        }
-    }
+    const utils::VOLUME_POLICY_INFO_T *policyInfo = getSourcePolicyInfo(streamType);
+    if (policyInfo)
+        muteStatus = policyInfo->muteStatus;
     PM_LOG_INFO(MSGID_POLICY_MANAGER, INIT_KVCOUNT,\
         "getCurrentSourceMuteStatus %s : %d", streamType.c_str(), (int)muteStatus);
     return (int)muteStatus;
@@ -1269,11 +1134,9 @@ bool AudioPolicyManager::isRampPolicyActive(const std::string& streamType)
 {
     PM_LOG_INFO(MSGID_POLICY_MANAGER, INIT_KVCOUNT,\
         "AudioPolicyManager:isRampPolicyActive:%s", streamType.c_str());
-    for (const auto &elements : mVolumePolicyInfo)
-    {
-        if (elements.streamType == streamType)
-            return elements.ramp;
-    }
+    const utils::VOLUME_POLICY_INFO_T *policyInfo = getSinkPolicyInfo(streamType);
+    if (policyInfo)
+        return policyInfo->ramp;
     return false;
 }
 
@@ -1281,11 +1144,9 @@ bool AudioPolicyManager::isRampPolicyActiveForSource(const std::string& streamTy
 {
     PM_LOG_INFO(MSGID_POLICY_MANAGER, INIT_KVCOUNT,\
         "AudioPolicyManager:getMixerType isRampPolicyActive:%s", streamType.c_str());
-    for (auto &elements : mSourceVolumePolicyInfo)
-    {
-        if (elements.streamType == streamType)
-            return elements.ramp;
-    }
+    const utils::VOLUME_POLICY_INFO_T *policyInfo = getSourcePolicyInfo(streamType);
+    if (policyInfo)
+        return policyInfo->ramp;
     return false;
 }
 
@@ -1891,20 +1752,18 @@ std::string AudioPolicyManager::getStreamStatus(const std::string& streamType, b
     pbnjson::JValue streamObjectArray = pbnjson::Array();
     pbnjson::JObject streamObject = pbnjson::JObject();
     pbnjson::JObject finalString = pbnjson::JObject();
-    for (auto &elements : mVolumePolicyInfo)
-    {
-        if (elements.streamType == streamType)
-        {
-            streamObject = pbnjson::JObject();
-            streamObject.put("streamType", elements.streamType);
-            streamObject.put("muteStatus", elements.muteStatus);
-            streamObject.put("inputVolume", elements.currentVolume);
-            streamObject.put("sink", elements.sink);
-            streamObject.put("source", elements.source);
-            streamObject.put("policyStatus", elements.isPolicyInProgress);
-            streamObject.put("activeStatus", elements.isStreamActive);
-            streamObjectArray.append(streamObject);
-        }
+    const utils::VOLUME_POLICY_INFO_T *policyInfo = getSinkPolicyInfo(streamType);
+    if (policyInfo)
+    {
+        streamObject = pbnjson::JObject();
+        streamObject.put("streamType", policyInfo->streamType);
+        streamObject.put("muteStatus", policyInfo->muteStatus);
+        streamObject.put("inputVolume", policyInfo->currentVolume);
+        streamObject.put("sink", policyInfo->sink);
+        streamObject.put("source", policyInfo->source);
+        streamObject.put("policyStatus", policyInfo->isPolicyInProgress);
+        streamObject.put("activeStatus", policyInfo->isStreamActive);
+        streamObjectArray.append(streamObject);
     }
     finalString = pbnjson::JObject{{"streamObject", streamObjectArray}};
     finalString.put("returnValue", true);
@@ -1921,20 +1780,18 @@ std::string AudioPolicyManager::getSourceStatus(const std::string& streamType, b
     pbnjson::JValue streamObjectArray = pbnjson::Array();
     pbnjson::JObject streamObject = pbnjson::JObject();
     pbnjson::JObject finalString = pbnjson::JObject();
-    for (auto &elements : mSourceVolumePolicyInfo)
-    {
-        if (elements.streamType == streamType)
-        {
-            streamObject = pbnjson::JObject();
-            streamObject.put("sourceType", elements.streamType);
-            streamObject.put("muteStatus", elements.muteStatus);
-            streamObject.put("inputVolume", elements.currentVolume);
-            streamObject.put("sink", elements.sink);
-            streamObject.put("source", elements.source);
-            streamObject.put("policyStatus", elements.isPolicyInProgress);
-            streamObject.put("activeStatus", elements.isStreamActive);
-            streamObjectArray.append(streamObject);
-        }
+    const utils::VOLUME_POLICY_INFO_T *policyInfo = getSourcePolicyInfo(streamType);
+    if (policyInfo)
+    {
+        streamObject = pbnjson::JObject();
+        streamObject.put("sourceType", policyInfo->streamType);
+        streamObject.put("muteStatus", policyInfo->muteStatus);
+        streamObject.put("inputVolume", policyInfo->currentVolume);
+        streamObject.put("sink", policyInfo->sink);
+        streamObject.put("source", policyInfo->source);
+        streamObject.put("policyStatus", policyInfo->isPolicyInProgress);
+        streamObject.put("activeStatus", policyInfo->isStreamActive);
+        streamObjectArray.append(streamObject);
     }
     finalString = pbnjson::JObject{{"sourceObject", streamObjectArray}};
     finalString.put("returnValue", true);
@@ -1951,7 +1808,7 @@ std::string AudioPolicyManager::getSourceStatus(bool subscribed)
     pbnjson::JValue streamObjectArray = pbnjson::Array();
     pbnjson::JObject streamObject = pbnjson::JObject();
     pbnjson::JObject finalString = pbnjson::JObject();
-    for (auto &elements : mSourceVolumePolicyInfo)
+    for (auto &elements : mSourcePolicies.getPolicies())
     {
         if (true == elements.isStreamActive)
         {
@@ -2044,7 +1901,7 @@ std::string AudioPolicyManager::getStreamStatus(bool subscribed)
     pbnjson::JValue streamObjectArray = pbnjson::Array();
     pbnjson::JObject streamObject = pbnjson::JObject();
     pbnjson::JObject finalString = pbnjson::JObject();
-    for (auto &elements : mVolumePolicyInfo)
+    for (auto &elements : mSinkPolicies.getPolicies())
     {
         if (true == elements.isStreamActive)
         {
@@ -2269,7 +2126,7 @@ void AudioPolicyManager::notifyInputVolume(EVirtualAudioSink audioSink, const in
     eventInputVolume.volume = volume;
     eventInputVolume.ramp = ramp;
     if (mObjModuleManager)
-        mObjModuleManager->publishModuleEvent((events::EVENTS_T*)&eventInputVolume);
+        mObjModuleManager->publishModuleEvent(eventInputVolume);
 }
 
 bool AudioPolicyManager::_setMediaInputVolume(LSHandle *lshandle, LSMessage *message, void *ctx)
@@ -2867,7 +2724,9 @@ AudioPolicyManager* AudioPolicyManager::getAudioPolicyManagerInstance()
 
 AudioPolicyManager::AudioPolicyManager(ModuleConfig* const pConfObj):mObjModuleManager(nullptr),\
                                                                      mObjPolicyInfoParser(nullptr),\
-                                                                     mObjAudioMixer(nullptr)
+                                                                     mObjAudioMixer(nullptr),\
+                                                                     mSinkPolicies(eAllSink),\
+                                                                     mSourcePolicies(eVirtualSource_Count)
 {
     PM_LOG_DEBUG("AudioPolicyManager: constructor");
     mObjModuleManager = ModuleManager::getModuleManagerInstance();
@@ -2944,41 +2803,46 @@ void AudioPolicyManager::handleEvent(events::EVENTS_T *event)
         {
             PM_LOG_INFO(MSGID_POLICY_MANAGER, INIT_KVCOUNT,\
                     "handleEvent:: eEventSinkStatus");
-            events::EVENT_SINK_STATUS_T *sinkStatusEvent = (events::EVENT_SINK_STATUS_T*)event;
-            eventSinkStatus(sinkStatusEvent->source, sinkStatusEvent->sink, sinkStatusEvent->audioSink, sinkStatusEvent->sinkStatus, sinkStatusEvent->mixerType,sinkStatusEvent->sinkIndex, \
-            sinkStatusEvent->trackId);
+            const events::EVENT_SINK_STATUS_T *sinkStatusEvent = events::getEventPayload<events::EVENT_SINK_STATUS_T>(event);
+            if (sinkStatusEvent)
+                eventSinkStatus(sinkStatusEvent->source, sinkStatusEvent->sink, sinkStatusEvent->audioSink, sinkStatusEvent->sinkStatus, sinkStatusEvent->mixerType,sinkStatusEvent->sinkIndex, \
+                sinkStatusEvent->trackId);
         }
         break;
         case utils::eEventSourceStatus:
         {
             PM_LOG_INFO(MSGID_POLICY_MANAGER, INIT_KVCOUNT,\
                     "handleEvent:: eEventSourceStatus");
-            events::EVENT_SOURCE_STATUS_T *sourceStatusEvent = (events::EVENT_SOURCE_STATUS_T*)event;
-            eventSourceStatus(sourceStatusEvent->source, sourceStatusEvent->sink, sourceStatusEvent->audioSource, sourceStatusEvent->sourceStatus, sourceStatusEvent->mixerType);
+            const events::EVENT_SOURCE_STATUS_T *sourceStatusEvent = events::getEventPayload<events::EVENT_SOURCE_STATUS_T>(event);
+            if (sourceStatusEvent)
+                eventSourceStatus(sourceStatusEvent->source, sourceStatusEvent->sink, sourceStatusEvent->audioSource, sourceStatusEvent->sourceStatus, sourceStatusEvent->mixerType);
         }
         break;
         case utils::eEventMixerStatus:
         {
             PM_LOG_INFO(MSGID_POLICY_MANAGER, INIT_KVCOUNT,\
                 "handleEvent:: eEventMixerStatus");
-            events::EVENT_MIXER_STATUS_T *mixerStatusEvent = (events::EVENT_MIXER_STATUS_T*)event;
-            eventMixerStatus(mixerStatusEvent->mixerStatus, mixerStatusEvent->mixerType);
+            const events::EVENT_MIXER_STATUS_T *mixerStatusEvent = events::getEventPayload<events::EVENT_MIXER_STATUS_T>(event);
+            if (mixerStatusEvent)
+                eventMixerStatus(mixerStatusEvent->mixerStatus, mixerStatusEvent->mixerType);
         }
         break;
         case utils::eEventUnregisterTrack:
         {
             PM_LOG_INFO(MSGID_POLICY_MANAGER, INIT_KVCOUNT,\
                 "handleEvent:: eEventUnregisterTrack");
-            events::EVENT_UNREGISTER_TRACK_T *stUnregisterTrack = (events::EVENT_UNREGISTER_TRACK_T*)event;
-            eventUnregisterTrack(stUnregisterTrack->trackId);
+            const events::EVENT_UNREGISTER_TRACK_T *stUnregisterTrack = events::getEventPayload<events::EVENT_UNREGISTER_TRACK_T>(event);
+            if (stUnregisterTrack)
+                eventUnregisterTrack(stUnregisterTrack->trackId);
         }
         break;
         case utils::eEventRegisterTrack:
         {
             PM_LOG_INFO(MSGID_POLICY_MANAGER, INIT_KVCOUNT,\
                 "handleEvent:: eEventRegisterTrack");
-            events::EVENT_REGISTER_TRACK_T *stRegisterTrack = (events::EVENT_REGISTER_TRACK_T*)event;
-            eventRegisterTrack(stRegisterTrack->trackId, stRegisterTrack->streamType);
+            const events::EVENT_REGISTER_TRACK_T *stRegisterTrack = events::getEventPayload<events::EVENT_REGISTER_TRACK_T>(event);
+            if (stRegisterTrack)
+                eventRegisterTrack(stRegisterTrack->trackId, stRegisterTrack->streamType);
         }
         break;
         default:
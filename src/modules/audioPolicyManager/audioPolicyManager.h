@@ -23,11 +23,14 @@
 #include "messageUtils.h"
 #include "main.h"
 #include <cstdlib>
+#include <unordered_map>
 #include "moduleInterface.h"
 #include "moduleFactory.h"
 #include "moduleManager.h"
 #include "volumePolicyInfoParser.h"
+#include "streamPolicyTable.h"
 #include "audioMixer.h"
+#include "VolumeCurve.h"
 
 #define VOLUME_POLICY_CONFIG "audiod_sink_volume_policy_config.json"
 #define SOURCE_VOLUME_POLICY_CONFIG "audiod_source_volume_policy_config.json"
@@ -40,13 +43,18 @@ class AudioPolicyManager : public ModuleInterface
         ModuleManager* mObjModuleManager;
         VolumePolicyInfoParser* mObjPolicyInfoParser;
         AudioMixer* mObjAudioMixer;
-        std::vector<utils::VOLUME_POLICY_INFO_T> mVolumePolicyInfo;
-        std::vector<utils::VOLUME_POLICY_INFO_T> mSourceVolumePolicyInfo;
+        //Built once the policy config is loaded
+        StreamPolicyTable mSinkPolicies;
+        StreamPolicyTable mSourcePolicies;
         utils::mapSinkToStream mSinkToStream;
         utils::mapStreamToSink mStreamToSink;
         utils::mapSourceToStream mSourceToStream;
         utils::mapStreamToSource mStreamToSource;
         utils::mapTrackVolumeInfo mTrackVolumeInfo;
+        void applyPolicyVolumeUpdates(const std::vector<StreamPolicyTable::POLICY_VOLUME_UPDATE_T> &volumeUpdates);
+        void collectSinkVolumes(EVirtualAudioSink audioSink, const int &volume, bool ramp, std::vector<utils::SINK_VOLUME_ENTRY_T> &entries);
+        //Sink input volume of a track, in percent
+        int getEffectiveVolume(const std::string &streamType, int volume, int trackVolume);
         static bool mIsObjRegistered;
         AudioPolicyManager(ModuleConfig* const pConfObj);
         //Register Object to object factory. This is called automatically
@@ -84,11 +92,14 @@ class AudioPolicyManager : public ModuleInterface
         bool storeTrackVolume(const std::string &trackId, const int &volume, std::string &streamType);
         bool muteSink(EVirtualAudioSink audioSink, const int &muteStatus, utils::EMIXER_TYPE mixerType, LSHandle *lshandle, LSMessage *message, void *ctx, PulseCallBackFunc cb);
         bool initializePolicyInfo(const pbnjson::JValue& policyInfo, bool isSink);
+        utils::VOLUME_POLICY_INFO_T* getSinkPolicyInfo(EVirtualAudioSink audioSink);
+        utils::VOLUME_POLICY_INFO_T* getSinkPolicyInfo(const std::string& streamType);
+        utils::VOLUME_POLICY_INFO_T* getSourcePolicyInfo(EVirtualSource audioSource);
+        utils::VOLUME_POLICY_INFO_T* getSourcePolicyInfo(const std::string& streamType);
 
         bool getPolicyStatus(const std::string& streamType);
         bool getPolicyStatusOfSource(const std::string& streamType);
-        bool isHighPriorityStreamActive(const int& policyPriority, utils::vectorVirtualSink activeStreams, const std::string &category);
-        bool isHighPrioritySourceActive(const int& policyPriority, utils::vectorVirtualSource activeStreams);
+        bool isHighPrioritySourceActive(const int& policyPriority, const utils::vectorVirtualSource &activeStreams);
         bool isRampPolicyActive(const std::string& streamType);
         bool isRampPolicyActiveForSource(const std::string& streamType);
         bool getStreamActiveStatus(const std::string& streamType);
@@ -0,0 +1,170 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "streamPolicyTable.h"
+#include <algorithm>
+#include <limits>
+
+//Top priority of a category without active streams, below every configured priority
+static const int cNoActivePriority = std::numeric_limits<int>::max();
+
+StreamPolicyTable::StreamPolicyTable(int streamCount):mPolicyIndex(streamCount, -1)
+{
+}
+
+utils::VOLUME_POLICY_INFO_T StreamPolicyTable::parsePolicyInfo(const pbnjson::JValue &elements)
+{
+    utils::VOLUME_POLICY_INFO_T stPolicyInfo;
+    std::string streamType;
+    std::string sink;
+    std::string source;
+    std::string category;
+    bool volumeAdjustable = true;
+    bool muteStatus = false;
+    bool ramp = false;
+
+    if (elements["streamType"].asString(streamType) == CONV_OK)
+        stPolicyInfo.streamType = streamType;
+    stPolicyInfo.policyVolume = elements["policyVolume"].asNumber<int>();
+    stPolicyInfo.priority = elements["priority"].asNumber<int>();
+    stPolicyInfo.groupId = elements["group"].asNumber<int>();
+    stPolicyInfo.defaultVolume = elements["defaultVolume"].asNumber<int>();
+    stPolicyInfo.maxVolume = elements["maxVolume"].asNumber<int>();
+    stPolicyInfo.minVolume = elements["minVolume"].asNumber<int>();
+    if (elements["volumeAdjustable"].asBool(volumeAdjustable) == CONV_OK)
+        stPolicyInfo.volumeAdjustable = volumeAdjustable;
+    stPolicyInfo.currentVolume = elements["currentVolume"].asNumber<int>();
+    if (elements["muteStatus"].asBool(muteStatus) == CONV_OK)
+        stPolicyInfo.muteStatus = muteStatus;
+    if (elements["sink"].asString(sink) == CONV_OK)
+        stPolicyInfo.sink = sink;
+    if (elements["source"].asString(source) == CONV_OK)
+        stPolicyInfo.source = source;
+    if (elements["ramp"].asBool(ramp) == CONV_OK)
+        stPolicyInfo.ramp = ramp;
+    if (elements["category"].asString(category) == CONV_OK)
+        stPolicyInfo.category = category;
+    return stPolicyInfo;
+}
+
+void StreamPolicyTable::addPolicy(const utils::VOLUME_POLICY_INFO_T &policyInfo, int stream)
+{
+    int index = (int)mPolicies.size();
+    mPolicies.push_back(policyInfo);
+    utils::VOLUME_POLICY_INFO_T &elements = mPolicies.back();
+    //streams share a category id when they share the category name
+    elements.categoryId = index;
+    for (int first = 0; first < index; first++)
+    {
+        if (mPolicies[first].category == elements.category)
+        {
+            elements.categoryId = mPolicies[first].categoryId;
+            break;
+        }
+    }
+    mPolicyIndexByStream.emplace(elements.streamType, index);
+    if (stream >= 0 && stream < (int)mPolicyIndex.size() && -1 == mPolicyIndex[stream])
+        mPolicyIndex[stream] = index;
+}
+
+utils::VOLUME_POLICY_INFO_T* StreamPolicyTable::getPolicyInfo(int stream)
+{
+    if (stream < 0 || stream >= (int)mPolicyIndex.size() || -1 == mPolicyIndex[stream])
+        return nullptr;
+    return &mPolicies[mPolicyIndex[stream]];
+}
+
+utils::VOLUME_POLICY_INFO_T* StreamPolicyTable::getPolicyInfo(const std::string &streamType)
+{
+    auto it = mPolicyIndexByStream.find(streamType);
+    if (it == mPolicyIndexByStream.end())
+        return nullptr;
+    return &mPolicies[it->second];
+}
+
+bool StreamPolicyTable::isVolumeUpdateQueued(const std::vector<POLICY_VOLUME_UPDATE_T> &volumeUpdates, int stream)
+{
+    for (const auto &update : volumeUpdates)
+    {
+        if (update.stream == stream)
+            return true;
+    }
+    return false;
+}
+
+bool StreamPolicyTable::activateStream(int stream, int priority, std::vector<POLICY_VOLUME_UPDATE_T> &volumeUpdates)
+{
+    utils::VOLUME_POLICY_INFO_T *incomingPolicyInfo = getPolicyInfo(stream);
+    if (!incomingPolicyInfo)
+        return false;
+    //Only streams between the old and the new top priority change state
+    ActiveStreamHeap &activeStreams = mActiveStreamsByCategory[incomingPolicyInfo->categoryId];
+    int oldTopPriority = activeStreams.empty() ? cNoActivePriority : activeStreams.begin()->first;
+    activeStreams.emplace(priority, stream);
+    if (oldTopPriority < priority)
+    {
+        //the incoming stream is below an active one
+        if (!incomingPolicyInfo->isPolicyInProgress)
+            volumeUpdates.push_back({stream, incomingPolicyInfo->policyVolume, true});
+    }
+    else if (priority < oldTopPriority)
+    {
+        auto last = activeStreams.upper_bound(oldTopPriority);
+        for (auto it = activeStreams.upper_bound(priority); it != last; ++it)
+        {
+            utils::VOLUME_POLICY_INFO_T *policyInfo = getPolicyInfo(it->second);
+            if (!policyInfo || policyInfo->isPolicyInProgress || isVolumeUpdateQueued(volumeUpdates, it->second))
+                continue;
+            if (policyInfo->currentVolume > policyInfo->policyVolume)
+                volumeUpdates.push_back({it->second, policyInfo->policyVolume, true});
+        }
+    }
+    return true;
+}
+
+bool StreamPolicyTable::deactivateStream(int stream, int priority, std::vector<POLICY_VOLUME_UPDATE_T> &volumeUpdates)
+{
+    utils::VOLUME_POLICY_INFO_T *closingPolicyInfo = getPolicyInfo(stream);
+    if (!closingPolicyInfo)
+        return false;
+    ActiveStreamHeap &activeStreams = mActiveStreamsByCategory[closingPolicyInfo->categoryId];
+    auto range = activeStreams.equal_range(priority);
+    auto closing = std::find_if(range.first, range.second,\
+        [stream](const ActiveStreamHeap::value_type &entry) { return entry.second == stream; });
+    if (closing == range.second)
+        return false;
+    int oldTopPriority = activeStreams.begin()->first;
+    activeStreams.erase(closing);
+    int newTopPriority = activeStreams.empty() ? cNoActivePriority : activeStreams.begin()->first;
+    if (newTopPriority > oldTopPriority)
+    {
+        //streams no longer below an active higher priority stream get their volume back
+        auto last = activeStreams.upper_bound(newTopPriority);
+        for (auto it = activeStreams.upper_bound(oldTopPriority); it != last; ++it)
+        {
+            utils::VOLUME_POLICY_INFO_T *policyInfo = getPolicyInfo(it->second);
+            if (!policyInfo || !policyInfo->isPolicyInProgress || isVolumeUpdateQueued(volumeUpdates, it->second))
+                continue;
+            volumeUpdates.push_back({it->second, policyInfo->currentVolume, false});
+        }
+    }
+    return true;
+}
+
+void StreamPolicyTable::clearActiveStreams()
+{
+    mActiveStreamsByCategory.clear();
+}
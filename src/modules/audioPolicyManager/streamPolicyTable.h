@@ -0,0 +1,67 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef _STREAM_POLICY_TABLE_H_
+#define _STREAM_POLICY_TABLE_H_
+
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "utils.h"
+
+//Stream policies of the sinks or of the sources. A policy is found through a dense table
+//of virtual streams, or a hash of stream type names at the luna API boundary.
+//Active streams are kept per category ordered by priority for the ducking policy.
+class StreamPolicyTable
+{
+    public:
+        //Volume change for one stream computed by the ducking policy
+        typedef struct
+        {
+            int stream;
+            int volume;
+            bool ducked;
+        }POLICY_VOLUME_UPDATE_T;
+
+        //streamCount is the size of the virtual sink or source enum
+        explicit StreamPolicyTable(int streamCount);
+        static utils::VOLUME_POLICY_INFO_T parsePolicyInfo(const pbnjson::JValue &elements);
+        //stream is the virtual sink or source of the policy, or -1 when it has none.
+        //The first entry wins for duplicate stream types.
+        void addPolicy(const utils::VOLUME_POLICY_INFO_T &policyInfo, int stream);
+        utils::VOLUME_POLICY_INFO_T* getPolicyInfo(int stream);
+        utils::VOLUME_POLICY_INFO_T* getPolicyInfo(const std::string &streamType);
+        std::vector<utils::VOLUME_POLICY_INFO_T>& getPolicies() { return mPolicies; }
+
+        //A stream is ducked while a stream of the same category with a higher priority (lower value)
+        //is active. These return the volume changes of the open or close, false when the stream has
+        //no policy or was not active.
+        bool activateStream(int stream, int priority, std::vector<POLICY_VOLUME_UPDATE_T> &volumeUpdates);
+        bool deactivateStream(int stream, int priority, std::vector<POLICY_VOLUME_UPDATE_T> &volumeUpdates);
+        void clearActiveStreams();
+
+    private:
+        //Active streams of a category, highest priority first
+        typedef std::multimap<int, int> ActiveStreamHeap;
+        static bool isVolumeUpdateQueued(const std::vector<POLICY_VOLUME_UPDATE_T> &volumeUpdates, int stream);
+        std::vector<utils::VOLUME_POLICY_INFO_T> mPolicies;
+        std::vector<int> mPolicyIndex;
+        std::unordered_map<std::string, int> mPolicyIndexByStream;
+        std::map<int, ActiveStreamHeap> mActiveStreamsByCategory;
+};
+
+#endif //_STREAM_POLICY_TABLE_H_
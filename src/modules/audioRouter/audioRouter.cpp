@@ -326,14 +326,14 @@ void AudioRouter::eventResponseSoundDevicesInfo(bool isOutput)
             eventResponseSoundOutputDeviceInfo.eventName = utils::eEventResponseSoundOutputDeviceInfo;
             eventResponseSoundOutputDeviceInfo.soundOutputInfo = getSoundDeviceInfo(true);
             for(auto& it:eventResponseSoundOutputDeviceInfo.soundOutputInfo)
-            mObjModuleManager->publishModuleEvent((events::EVENTS_T*)&eventResponseSoundOutputDeviceInfo);
+            mObjModuleManager->publishModuleEvent(eventResponseSoundOutputDeviceInfo);
         }
         else
         {
             events::EVENT_RESPONSE_SOUNDINPUT_INFO_T eventResponseSoundInputDeviceInfo;
             eventResponseSoundInputDeviceInfo.eventName = utils::eEventResponseSoundInputDeviceInfo;
             eventResponseSoundInputDeviceInfo.soundInputInfo = getSoundDeviceInfo(false);
-            mObjModuleManager->publishModuleEvent((events::EVENTS_T*)&eventResponseSoundInputDeviceInfo);
+            mObjModuleManager->publishModuleEvent(eventResponseSoundInputDeviceInfo);
         }
     }
     else
@@ -391,7 +391,7 @@ void AudioRouter::setBTDeviceRouting(const std::string &deviceName)
                 deviceConnectionStatus.deviceNameDetail = items.deviceNameDetail;
                 deviceConnectionStatus.deviceIcon = items.deviceIcon;
                 deviceConnectionStatus.isOutput = true;
-                //mObjModuleManager->publishModuleEvent((events::EVENTS_T*)&deviceConnectionStatus);
+                //mObjModuleManager->publishModuleEvent(deviceConnectionStatus);
                 eventDeviceConnectionStatus(deviceConnectionStatus.devicename, deviceConnectionStatus.deviceNameDetail, deviceConnectionStatus.deviceIcon,\
                     utils::eDeviceConnected, utils::ePulseMixer, true);
             }
@@ -755,7 +755,7 @@ void AudioRouter::updateDeviceStatus(const std::string& display, const std::stri
             stEventActiveDeviceInfo.isConnected = isConnected;
             stEventActiveDeviceInfo.isActive = isActive;
             stEventActiveDeviceInfo.isOutput = isOutput;
-            mObjModuleManager->publishModuleEvent((events::EVENTS_T*)&stEventActiveDeviceInfo);
+            mObjModuleManager->publishModuleEvent(stEventActiveDeviceInfo);
         }
             //mObjModuleManager->notifyActiveDeviceInfo(getActualOutputDevice(deviceName), display, isConnected, isOutput);
         printDeviceInfo(true);
@@ -785,7 +785,7 @@ void AudioRouter::updateDeviceStatus(const std::string& display, const std::stri
             stEventActiveDeviceInfo.isConnected = isActive;
             stEventActiveDeviceInfo.isOutput = isOutput;
             stEventActiveDeviceInfo.isActive = isActive;
-            mObjModuleManager->publishModuleEvent((events::EVENTS_T*)&stEventActiveDeviceInfo);
+            mObjModuleManager->publishModuleEvent(stEventActiveDeviceInfo);
         }
         if (isActive)
         {
@@ -1832,52 +1832,56 @@ void AudioRouter::handleEvent(events::EVENTS_T *event)
         {
             PM_LOG_INFO(MSGID_AUDIOROUTER, INIT_KVCOUNT,\
                 "handleEvent : eEventSinkStatus");
-            events::EVENT_SINK_STATUS_T *stEventSinkStatus = (events::EVENT_SINK_STATUS_T*)event;
-            eventSinkStatus(stEventSinkStatus->source, stEventSinkStatus->sink, stEventSinkStatus->audioSink,  \
-                stEventSinkStatus->sinkStatus, stEventSinkStatus->mixerType);
+            const events::EVENT_SINK_STATUS_T *stEventSinkStatus = events::getEventPayload<events::EVENT_SINK_STATUS_T>(event);
+            if (stEventSinkStatus)
+                eventSinkStatus(stEventSinkStatus->source, stEventSinkStatus->sink, stEventSinkStatus->audioSink,  \
+                    stEventSinkStatus->sinkStatus, stEventSinkStatus->mixerType);
         }
         break;
         case utils::eEventMixerStatus:
         {
             PM_LOG_INFO(MSGID_AUDIOROUTER, INIT_KVCOUNT,\
                 "handleEvent : eEventMixerStatus");
-            events::EVENT_MIXER_STATUS_T *stEventMixerStatus = (events::EVENT_MIXER_STATUS_T*)event;
-            eventMixerStatus( stEventMixerStatus->mixerStatus, stEventMixerStatus->mixerType);
+            const events::EVENT_MIXER_STATUS_T *stEventMixerStatus = events::getEventPayload<events::EVENT_MIXER_STATUS_T>(event);
+            if (stEventMixerStatus)
+                eventMixerStatus( stEventMixerStatus->mixerStatus, stEventMixerStatus->mixerType);
         }
         break;
         case  utils::eEventDeviceConnectionStatus:
         {
             PM_LOG_INFO(MSGID_AUDIOROUTER, INIT_KVCOUNT,\
                 "handleEvent : eEventDeviceConnectionStatus");
-            events::EVENT_DEVICE_CONNECTION_STATUS_T * stDeviceConnectionStatus = (events::EVENT_DEVICE_CONNECTION_STATUS_T*)event;
-            eventDeviceConnectionStatus(stDeviceConnectionStatus->devicename, stDeviceConnectionStatus->deviceNameDetail, stDeviceConnectionStatus->deviceIcon, \
-                stDeviceConnectionStatus->deviceStatus, stDeviceConnectionStatus->mixerType,stDeviceConnectionStatus->isOutput);
+            const events::EVENT_DEVICE_CONNECTION_STATUS_T *stDeviceConnectionStatus = events::getEventPayload<events::EVENT_DEVICE_CONNECTION_STATUS_T>(event);
+            if (stDeviceConnectionStatus)
+                eventDeviceConnectionStatus(stDeviceConnectionStatus->devicename, stDeviceConnectionStatus->deviceNameDetail, stDeviceConnectionStatus->deviceIcon, \
+                    stDeviceConnectionStatus->deviceStatus, stDeviceConnectionStatus->mixerType,stDeviceConnectionStatus->isOutput);
         }
         break;
         case utils::eEventSinkPolicyInfo:
         {
             PM_LOG_INFO(MSGID_AUDIOROUTER, INIT_KVCOUNT,\
                 "handleEvent : eEventSinkPolicyInfo");
-            events::EVENT_SINK_POLICY_INFO_T *stSinkPolicyInfo = (events::EVENT_SINK_POLICY_INFO_T*)event;
-            eventSinkPolicyInfo(stSinkPolicyInfo->policyInfo);
+            const events::EVENT_SINK_POLICY_INFO_T *stSinkPolicyInfo = events::getEventPayload<events::EVENT_SINK_POLICY_INFO_T>(event);
+            if (stSinkPolicyInfo)
+                eventSinkPolicyInfo(stSinkPolicyInfo->policyInfo);
         }
         break;
         case utils::eEventSourcePolicyInfo:
         {
             PM_LOG_INFO(MSGID_AUDIOROUTER, INIT_KVCOUNT,\
                 "handleEvent : eEventSourcePolicyInfo");
-            events::EVENT_SOURCE_POLICY_INFO_T *stSourcePolicyInfo = (events::EVENT_SOURCE_POLICY_INFO_T*)event;
-            eventSourcePolicyInfo(stSourcePolicyInfo->sourcePolicyInfo);
-
+            const events::EVENT_SOURCE_POLICY_INFO_T *stSourcePolicyInfo = events::getEventPayload<events::EVENT_SOURCE_POLICY_INFO_T>(event);
+            if (stSourcePolicyInfo)
+                eventSourcePolicyInfo(stSourcePolicyInfo->sourcePolicyInfo);
         }
         break;
         case utils::eEventBTDeviceDisplayInfo:
         {
-            events::EVENT_BT_DEVICE_DISPAY_INFO_T * stEventBtDeviceDisplayInfo = (events::EVENT_BT_DEVICE_DISPAY_INFO_T *)event;
             PM_LOG_INFO(MSGID_AUDIOROUTER, INIT_KVCOUNT,\
                 "handleEvent : eEventBTDeviceDisplayInfo");
-            eventBTDeviceDisplayInfo(stEventBtDeviceDisplayInfo->state, stEventBtDeviceDisplayInfo->address, stEventBtDeviceDisplayInfo->displayId);
-
+            const events::EVENT_BT_DEVICE_DISPAY_INFO_T *stEventBtDeviceDisplayInfo = events::getEventPayload<events::EVENT_BT_DEVICE_DISPAY_INFO_T>(event);
+            if (stEventBtDeviceDisplayInfo)
+                eventBTDeviceDisplayInfo(stEventBtDeviceDisplayInfo->state, stEventBtDeviceDisplayInfo->address, stEventBtDeviceDisplayInfo->displayId);
         }
         break;
         case utils::eEventRequestSoundOutputDeviceInfo:
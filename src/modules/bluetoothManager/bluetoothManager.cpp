@@ -173,7 +173,7 @@ void BluetoothManager::setBlueToothA2DPActive (bool state, char *address, char *
             {
                 events::EVENT_MASTER_VOLUME_STATUS_T eventMasterVolumeStatus;
                 eventMasterVolumeStatus.eventName = utils::eEventMasterVolumeStatus;
-                mObjModuleManager->publishModuleEvent((events::EVENTS_T*)&eventMasterVolumeStatus);
+                mObjModuleManager->publishModuleEvent(eventMasterVolumeStatus);
             }
             else
                 PM_LOG_ERROR(MSGID_BLUETOOTH_MANAGER, INIT_KVCOUNT,\
@@ -220,7 +220,7 @@ void BluetoothManager::setBlueToothA2DPActive (bool state, char *address, char *
         stEventBtDeviceDisplayInfo.address = address;
         stEventBtDeviceDisplayInfo.state = state;
         if (display != 0)
-            mObjModuleManager->publishModuleEvent((events::EVENTS_T*)&stEventBtDeviceDisplayInfo);
+            mObjModuleManager->publishModuleEvent(stEventBtDeviceDisplayInfo);
     }
 }
 
@@ -706,8 +706,9 @@ void BluetoothManager::handleEvent(events::EVENTS_T* event)
         {
             PM_LOG_INFO(MSGID_BLUETOOTH_MANAGER, INIT_KVCOUNT,\
                     "handleEvent:: eEventServerStatusSubscription");
-            events::EVENT_SERVER_STATUS_INFO_T *serverStatusInfoEvent = (events::EVENT_SERVER_STATUS_INFO_T*)event;
-            eventServerStatusInfo(serverStatusInfoEvent->serviceName, serverStatusInfoEvent->connectionStatus);
+            const events::EVENT_SERVER_STATUS_INFO_T *serverStatusInfoEvent = events::getEventPayload<events::EVENT_SERVER_STATUS_INFO_T>(event);
+            if (serverStatusInfoEvent)
+                eventServerStatusInfo(serverStatusInfoEvent->serviceName, serverStatusInfoEvent->connectionStatus);
         }
         break;
         case eEventBTDeviceStatus:
@@ -718,8 +719,9 @@ void BluetoothManager::handleEvent(events::EVENTS_T* event)
         {
             PM_LOG_INFO(MSGID_BLUETOOTH_MANAGER, INIT_KVCOUNT,\
                     "handleEvent:: Calling eventKeyInfo");
-            events::EVENT_KEY_INFO_T *keyInfoEvent = (events::EVENT_KEY_INFO_T*)event;
-            eventKeyInfo(keyInfoEvent->type, keyInfoEvent->message);
+            const events::EVENT_KEY_INFO_T *keyInfoEvent = events::getEventPayload<events::EVENT_KEY_INFO_T>(event);
+            if (keyInfoEvent)
+                eventKeyInfo(keyInfoEvent->type, keyInfoEvent->message);
         }
         break;
         default:
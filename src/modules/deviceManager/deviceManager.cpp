@@ -1101,32 +1101,36 @@ void DeviceManager::handleEvent(events::EVENTS_T* ev)
     {
         case utils::eEventMixerStatus:
         {
-            events::EVENT_MIXER_STATUS_T *stMixerStatus = (events::EVENT_MIXER_STATUS_T*)ev;
-            eventMixerStatus(stMixerStatus->mixerStatus, stMixerStatus->mixerType);
+            const events::EVENT_MIXER_STATUS_T *stMixerStatus = events::getEventPayload<events::EVENT_MIXER_STATUS_T>(ev);
+            if (stMixerStatus)
+                eventMixerStatus(stMixerStatus->mixerStatus, stMixerStatus->mixerType);
         }
         break;
         case utils::eEventServerStatusSubscription:
         {
             PM_LOG_INFO(MSGID_DEVICE_MANAGER, INIT_KVCOUNT,\
                     "handleEvent:: eEventServerStatusSubscription");
-            events::EVENT_SERVER_STATUS_INFO_T *serverStatusInfoEvent = (events::EVENT_SERVER_STATUS_INFO_T*)ev;
-            eventServerStatusInfo(serverStatusInfoEvent->serviceName, serverStatusInfoEvent->connectionStatus);
+            const events::EVENT_SERVER_STATUS_INFO_T *serverStatusInfoEvent = events::getEventPayload<events::EVENT_SERVER_STATUS_INFO_T>(ev);
+            if (serverStatusInfoEvent)
+                eventServerStatusInfo(serverStatusInfoEvent->serviceName, serverStatusInfoEvent->connectionStatus);
         }
         break;
         case eEventPdmDeviceStatus:
         {
             PM_LOG_INFO(MSGID_DEVICE_MANAGER, INIT_KVCOUNT,\
                 "handleEvent:: eEventPdmDeviceStatus");
-            events::EVENT_KEY_INFO_T *keySubscribeInfoEvent = (events::EVENT_KEY_INFO_T*)ev;
-            eventKeyInfo(keySubscribeInfoEvent->type, keySubscribeInfoEvent->message);
+            const events::EVENT_KEY_INFO_T *keySubscribeInfoEvent = events::getEventPayload<events::EVENT_KEY_INFO_T>(ev);
+            if (keySubscribeInfoEvent)
+                eventKeyInfo(keySubscribeInfoEvent->type, keySubscribeInfoEvent->message);
         }
         break;
         case utils::eEventRequestInternalDevices:
         {
             PM_LOG_INFO(MSGID_DEVICE_MANAGER, INIT_KVCOUNT,\
                 "handleEvent:: eEventRequestInternalDevices");
-            events::EVENT_REQUEST_INTERNAL_DEVICES_INFO_T *stEventRequestInternalDevices = (events::EVENT_REQUEST_INTERNAL_DEVICES_INFO_T*)ev;
-            eventInternalDeviceRequest(stEventRequestInternalDevices->func);
+            const events::EVENT_REQUEST_INTERNAL_DEVICES_INFO_T *stEventRequestInternalDevices = events::getEventPayload<events::EVENT_REQUEST_INTERNAL_DEVICES_INFO_T>(ev);
+            if (stEventRequestInternalDevices)
+                eventInternalDeviceRequest(stEventRequestInternalDevices->func);
         }
         break;
         default:
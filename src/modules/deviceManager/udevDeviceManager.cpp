@@ -111,7 +111,7 @@ bool UdevDeviceManager::setHeadphoneSoundOut(const bool& connected)
 
     }
     stEventDeviceConnectionStatus.mixerType = utils::ePulseMixer;
-    mObjModuleManager->publishModuleEvent((events::EVENTS_T*)&stEventDeviceConnectionStatus);
+    mObjModuleManager->publishModuleEvent(stEventDeviceConnectionStatus);
     return true;
 }
 
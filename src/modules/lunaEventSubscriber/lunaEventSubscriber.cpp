@@ -97,16 +97,18 @@ void lunaEventSubscriber::handleEvent(events::EVENTS_T* event)
         {
             PM_LOG_INFO(MSGID_LUNA_EVENT_SUBSCRIBER, INIT_KVCOUNT,\
                     "handleEvent:: eEventLunaServerStatusSubscription");
-            events::EVENT_SUBSCRIBE_SERVER_STATUS_T *serverStatusInfoEvent = (events::EVENT_SUBSCRIBE_SERVER_STATUS_T*)event;
-            eventSubscribeServerStatus(serverStatusInfoEvent->serviceName);
+            const events::EVENT_SUBSCRIBE_SERVER_STATUS_T *serverStatusInfoEvent = events::getEventPayload<events::EVENT_SUBSCRIBE_SERVER_STATUS_T>(event);
+            if (serverStatusInfoEvent)
+                eventSubscribeServerStatus(serverStatusInfoEvent->serviceName);
         }
         break;
         case utils::eEventLunaKeySubscription:
         {
             PM_LOG_INFO(MSGID_LUNA_EVENT_SUBSCRIBER, INIT_KVCOUNT,\
                 "handleEvent:: eEventLunaKeySubscription");
-            events::EVENT_SUBSCRIBE_KEY_T *keySubscribeInfoEvent = (events::EVENT_SUBSCRIBE_KEY_T*)event;
-            eventSubscribeKey(keySubscribeInfoEvent->type, keySubscribeInfoEvent->serviceName, keySubscribeInfoEvent->api, keySubscribeInfoEvent->payload);
+            const events::EVENT_SUBSCRIBE_KEY_T *keySubscribeInfoEvent = events::getEventPayload<events::EVENT_SUBSCRIBE_KEY_T>(event);
+            if (keySubscribeInfoEvent)
+                eventSubscribeKey(keySubscribeInfoEvent->type, keySubscribeInfoEvent->serviceName, keySubscribeInfoEvent->api, keySubscribeInfoEvent->payload);
         }
         break;
         default:
@@ -142,7 +144,7 @@ bool lunaEventSubscriber::subscriptionToKeyCallback(LSHandle *lshandle, LSMessag
         eventKeyInfo.eventName = eEventToSubscribe;
         eventKeyInfo.type = eEventToSubscribe;
         eventKeyInfo.message = message;
-        pInstance->publishModuleEvent((events::EVENTS_T*)&eventKeyInfo);
+        pInstance->publishModuleEvent(eventKeyInfo);
     }
     else
     {
@@ -168,7 +170,7 @@ bool lunaEventSubscriber::serviceStatusCallBack( LSHandle *sh,
         eventServerStatus.eventName = utils::eEventServerStatusSubscription;
         eventServerStatus.serviceName = eServerStatus;
         eventServerStatus.connectionStatus = connected;
-        pInstance->publishModuleEvent((events::EVENTS_T*)&eventServerStatus);
+        pInstance->publishModuleEvent(eventServerStatus);
     }
     else
     {
@@ -318,7 +320,7 @@ void lunaEventSubscriber::eventSubscribeServerStatus(SERVER_TYPE_E eService)
         eventServerStatus.eventName = utils::eEventServerStatusSubscription;
         eventServerStatus.serviceName = eService;
         eventServerStatus.connectionStatus = connected;
-        mObjModuleManager->publishModuleEvent((events::EVENTS_T*)&eventServerStatus);
+        mObjModuleManager->publishModuleEvent(eventServerStatus);
     }
     else
     {
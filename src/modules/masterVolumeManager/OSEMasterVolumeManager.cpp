@@ -15,14 +15,66 @@
 // SPDX-License-Identifier: Apache-2.0
 
 #include "OSEMasterVolumeManager.h"
+#include <algorithm>
 
 #define GETSETTINGS "luna://com.webos.service.settings/getSystemSettings"
 #define SETSETTINGS "luna://com.webos.service.settings/setSystemSettings"
 
 bool OSEMasterVolumeManager::mIsObjRegistered = OSEMasterVolumeManager::RegisterObject();
-OSEMasterVolumeManager::OSEMasterVolumeManager(): mCacheRead(false)
+
+#if defined(AUDIOD_TEST_API)
+static bool
+_getDBWriteStats(LSHandle *lshandle, LSMessage *message, void *ctx)
+{
+    LSMessageJsonParser msg(message, SCHEMA_0);
+    if (!msg.parse(__FUNCTION__, lshandle))
+        return true;
+
+    CLSError lserror;
+    OSEMasterVolumeManager *masterVolumeObj = (OSEMasterVolumeManager*)ctx;
+    if (!masterVolumeObj)
+    {
+        std::string reply = STANDARD_JSON_ERROR(AUDIOD_ERRORCODE_INTERNAL_ERROR, "Could not get the master volume instance");
+        LSMessageReply(lshandle, message, reply.c_str(), &lserror);
+        return true;
+    }
+    pbnjson::JValue resp = masterVolumeObj->getDBWriteStats();
+    resp.put("returnValue", true);
+    utils::LSMessageResponse(lshandle, message, resp.stringify().c_str(), utils::eLSRespond, false);
+    return true;
+}
+
+static LSMethod masterVolumeStateMethods[] = {
+    { "getDBWriteStats", _getDBWriteStats},
+    { },
+};
+#endif
+
+static gboolean _DBWriteWaitTimeout(gpointer data)
+{
+    *(bool*)data = true;
+    return FALSE;
+}
+
+OSEMasterVolumeManager::OSEMasterVolumeManager(): mCacheRead(false),
+                                                    mOutputDBDirty(false),
+                                                    mInputDBDirty(false),
+                                                    mDBWriteDelay(DB_WRITE_DEBOUNCE_MS),
+                                                    mDBWriteTimerID(0),
+                                                    mDBRetryDelay(0),
+                                                    mOutputDBWriteToken(LSMESSAGE_TOKEN_INVALID),
+                                                    mInputDBWriteToken(LSMESSAGE_TOKEN_INVALID),
+                                                    mDBWriteRequests(0),
+                                                    mDBWritesSent(0),
+                                                    mDBWritesUnchanged(0),
+                                                    mDBWritesFailed(0)
 {
     PM_LOG_DEBUG("OSEMasterVolumeManager constructor");
+    loadDBWriteConfig();
+#if defined(AUDIOD_TEST_API)
+    if (!ServiceRegisterCategory("/state/master", masterVolumeStateMethods, NULL, this))
+        PM_LOG_ERROR(MSGID_CLIENT_MASTER_VOLUME_MANAGER, INIT_KVCOUNT, "Registering Service for '%s' category failed", "/state/master");
+#endif
 }
 
 bool OSEMasterVolumeManager::readInitialVolume(pbnjson::JValue settingsObj)
@@ -131,68 +183,259 @@ bool OSEMasterVolumeManager::readInitialVolume(pbnjson::JValue settingsObj)
     return true;
 }
 
-void OSEMasterVolumeManager::sendDataToDB()
+std::string OSEMasterVolumeManager::buildDBPayload(bool isOutput)
 {
-    PM_LOG_INFO(MSGID_CLIENT_MASTER_VOLUME_MANAGER, INIT_KVCOUNT,"sendDataToDB");
+    const char *deviceKey = isOutput ? "soundOutput" : "soundInput";
     int count = 1;
-    pbnjson::JObject devicedata = pbnjson::JObject();
+    pbnjson::JValue deviceList = pbnjson::Array();
+    for (const auto *dbList : {&getDBListRef(true, isOutput), &getDBListRef(false, isOutput)})
+    {
+        for (const auto &it : *dbList)
+        {
+            pbnjson::JObject data = pbnjson::JObject();
+            data.put(deviceKey, it.deviceName);
+            data.put("deviceNameDetails", it.deviceNameDetail);
+            data.put("volume", it.volume);
+            data.put("deviceCounter", count++);
+            deviceList.append(data);
+        }
+    }
+    pbnjson::JObject devicedata = pbnjson::JObject {{isOutput ? "soundOutputList" : "soundInputList", deviceList}};
     pbnjson::JObject finalString = pbnjson::JObject();
-    pbnjson::JValue outputlist = pbnjson::Array();
-    pbnjson::JValue inputlist = pbnjson::Array();
-    for(auto &it:mIntOutputDeviceListDB)
-    {
-        pbnjson::JObject data = pbnjson::JObject();
-        data.put("soundOutput",it.deviceName);
-        data.put("deviceNameDetails",it.deviceNameDetail);
-        data.put("volume",it.volume);
-        data.put("deviceCounter",count++);
-        outputlist.append(data);
-    }
-    for(auto &it:mExtOutputDeviceListDB)
-    {
-        pbnjson::JObject data = pbnjson::JObject();
-        data.put("soundOutput",it.deviceName);
-        data.put("deviceNameDetails",it.deviceNameDetail);
-        data.put("volume",it.volume);
-        data.put("deviceCounter",count++);
-        outputlist.append(data);
-    }
-    devicedata = pbnjson::JObject {{"soundOutputList", outputlist}};
-    finalString.put("settings",devicedata);
-    finalString.put("category","sound");
-
-    PM_LOG_INFO(MSGID_CLIENT_MASTER_VOLUME_MANAGER, INIT_KVCOUNT,"DB output %s", finalString.stringify().c_str());
-    //call set settings
-    bool result = false;
+    finalString.put("settings", devicedata);
+    finalString.put("category", "sound");
+    return finalString.stringify();
+}
+
+bool OSEMasterVolumeManager::writeDBPayload(bool isOutput)
+{
+    std::string payload = buildDBPayload(isOutput);
+    std::string &lastPayload = isOutput ? mLastOutputDBPayload : mLastInputDBPayload;
+    if (payload == lastPayload)
+    {
+        //e.g. volume stepped up and back down within the window
+        mDBWritesUnchanged++;
+        return true;
+    }
+    PM_LOG_INFO(MSGID_CLIENT_MASTER_VOLUME_MANAGER, INIT_KVCOUNT,"DB %s %s", isOutput ? "output" : "input", payload.c_str());
     CLSError lserror;
     LSHandle *sh = GetPalmService();
-    result = LSCall(sh, SETSETTINGS, finalString.stringify().c_str(),nullptr,nullptr,nullptr, &lserror);
+    LSMessageToken &token = isOutput ? mOutputDBWriteToken : mInputDBWriteToken;
+    LSFilterFunc replyFunc = isOutput ? &OSEMasterVolumeManager::_outputDBWriteReply : &OSEMasterVolumeManager::_inputDBWriteReply;
+    if (!LSCallOneReply(sh, SETSETTINGS, payload.c_str(), replyFunc, this, &token, &lserror))
+    {
+        PM_LOG_ERROR(MSGID_CLIENT_MASTER_VOLUME_MANAGER, INIT_KVCOUNT, "writeDBPayload: setSystemSettings call failed");
+        token = LSMESSAGE_TOKEN_INVALID;
+        mDBWritesFailed++;
+        return false;
+    }
+    lastPayload = payload;
+    mDBWritesSent++;
+    return true;
+}
+
+bool OSEMasterVolumeManager::_outputDBWriteReply(LSHandle *sh, LSMessage *reply, void *ctx)
+{
+    LSMessageJsonParser msg(reply, NORMAL_SCHEMA(PROPS_1(PROP(returnValue, boolean)) REQUIRED_1(returnValue)));
+    bool returnValue = false;
+    if (msg.parse(__FUNCTION__, sh))
+        msg.get("returnValue", returnValue);
+    OSEMasterVolumeManager *masterVolumeObj = (OSEMasterVolumeManager*)ctx;
+    if (masterVolumeObj)
+        masterVolumeObj->onDBWriteReply(true, returnValue);
+    return true;
+}
+
+bool OSEMasterVolumeManager::_inputDBWriteReply(LSHandle *sh, LSMessage *reply, void *ctx)
+{
+    LSMessageJsonParser msg(reply, NORMAL_SCHEMA(PROPS_1(PROP(returnValue, boolean)) REQUIRED_1(returnValue)));
+    bool returnValue = false;
+    if (msg.parse(__FUNCTION__, sh))
+        msg.get("returnValue", returnValue);
+    OSEMasterVolumeManager *masterVolumeObj = (OSEMasterVolumeManager*)ctx;
+    if (masterVolumeObj)
+        masterVolumeObj->onDBWriteReply(false, returnValue);
+    return true;
+}
 
-    finalString = pbnjson::JObject();
-    count = 1;
-    for(auto &it:mIntInputDeviceListDB)
+void OSEMasterVolumeManager::onDBWriteReply(bool isOutput, bool success)
+{
+    (isOutput ? mOutputDBWriteToken : mInputDBWriteToken) = LSMESSAGE_TOKEN_INVALID;
+    bool &dirty = isOutput ? mOutputDBDirty : mInputDBDirty;
+    if (!success)
+    {
+        PM_LOG_ERROR(MSGID_CLIENT_MASTER_VOLUME_MANAGER, INIT_KVCOUNT, "onDBWriteReply: setSystemSettings failed for %s", isOutput ? "output" : "input");
+        //Force the same payload out again
+        (isOutput ? mLastOutputDBPayload : mLastInputDBPayload).clear();
+        dirty = true;
+        mDBWritesFailed++;
+        scheduleDBRetry();
+        return;
+    }
+    mDBRetryDelay = 0;
+    //Changes made while the write was in flight
+    if (dirty && 0 == mDBWriteTimerID)
     {
-        pbnjson::JObject data = pbnjson::JObject();
-        data.put("soundInput",it.deviceName);
-        data.put("deviceNameDetails",it.deviceNameDetail);
-        data.put("volume",it.volume);
-        data.put("deviceCounter",count++);
-        inputlist.append(data);
+        if (0 == mDBWriteDelay)
+            flushDataToDB();
+        else
+            mDBWriteTimerID = g_timeout_add(mDBWriteDelay, &OSEMasterVolumeManager::_flushDBTimer, this);
     }
-    for(auto &it:mExtInputDeviceListDB)
+}
+
+void OSEMasterVolumeManager::scheduleDBRetry()
+{
+    if (mDBRetryDelay)
+        mDBRetryDelay = std::min<guint>(mDBRetryDelay * 2, DB_WRITE_RETRY_MAX_MS);
+    else
+        mDBRetryDelay = std::max<guint>(mDBWriteDelay, DB_WRITE_DEBOUNCE_MS);
+    PM_LOG_WARNING(MSGID_CLIENT_MASTER_VOLUME_MANAGER, INIT_KVCOUNT, "scheduleDBRetry: retrying DB write in %u ms", mDBRetryDelay);
+    if (mDBWriteTimerID)
+        g_source_remove(mDBWriteTimerID);
+    mDBWriteTimerID = g_timeout_add(mDBRetryDelay, &OSEMasterVolumeManager::_flushDBTimer, this);
+}
+
+void OSEMasterVolumeManager::sendDataToDB(bool isOutput)
+{
+    PM_LOG_DEBUG("sendDataToDB isOutput:%d", (int)isOutput);
+    mDBWriteRequests++;
+    if (isOutput)
+        mOutputDBDirty = true;
+    else
+        mInputDBDirty = true;
+
+    if (0 == mDBWriteDelay)
+        flushDataToDB();
+    else if (0 == mDBWriteTimerID)
+        mDBWriteTimerID = g_timeout_add(mDBWriteDelay, &OSEMasterVolumeManager::_flushDBTimer, this);
+}
+
+gboolean OSEMasterVolumeManager::_flushDBTimer(gpointer data)
+{
+    OSEMasterVolumeManager *masterVolumeObj = (OSEMasterVolumeManager*)data;
+    if (masterVolumeObj)
+    {
+        masterVolumeObj->mDBWriteTimerID = 0;
+        masterVolumeObj->flushDataToDB();
+    }
+    return FALSE;
+}
+
+void OSEMasterVolumeManager::flushDataToDB()
+{
+    if (mDBWriteTimerID)
+    {
+        g_source_remove(mDBWriteTimerID);
+        mDBWriteTimerID = 0;
+    }
+    //A list with a write in flight stays dirty and is written again from its reply
+    bool failed = false;
+    if (mOutputDBDirty && LSMESSAGE_TOKEN_INVALID == mOutputDBWriteToken)
+    {
+        if (writeDBPayload(true))
+            mOutputDBDirty = false;
+        else
+            failed = true;
+    }
+    if (mInputDBDirty && LSMESSAGE_TOKEN_INVALID == mInputDBWriteToken)
+    {
+        if (writeDBPayload(false))
+            mInputDBDirty = false;
+        else
+            failed = true;
+    }
+    if (failed)
+        scheduleDBRetry();
+    PM_LOG_DEBUG("flushDataToDB: requests:%lu sent:%lu unchanged:%lu failed:%lu", mDBWriteRequests, mDBWritesSent, mDBWritesUnchanged, mDBWritesFailed);
+}
+
+void OSEMasterVolumeManager::waitForDBWrites(guint timeoutMs)
+{
+    //The main loop is gone on shutdown, iterate its context until the settings service confirmed the writes.
+    //Only called from prepareShutdown, every module the context dispatches to still exists then
+    bool timedOut = false;
+    guint waitTimerID = g_timeout_add(timeoutMs, _DBWriteWaitTimeout, &timedOut);
+    while (!timedOut && (mOutputDBDirty || mInputDBDirty || LSMESSAGE_TOKEN_INVALID != mOutputDBWriteToken ||\
+        LSMESSAGE_TOKEN_INVALID != mInputDBWriteToken))
+    {
+        //Write what changed while a write was in flight now instead of after the debounce delay
+        if (0 == mDBRetryDelay && LSMESSAGE_TOKEN_INVALID == mOutputDBWriteToken && LSMESSAGE_TOKEN_INVALID == mInputDBWriteToken)
+            flushDataToDB();
+        g_main_context_iteration(nullptr, TRUE);
+    }
+    if (!timedOut)
+        g_source_remove(waitTimerID);
+    cancelDBWrites();
+    if (timedOut)
+        PM_LOG_ERROR(MSGID_CLIENT_MASTER_VOLUME_MANAGER, INIT_KVCOUNT,\
+            "waitForDBWrites: settings service did not confirm the volume DB in %u ms, output dirty:%d input dirty:%d",\
+            timeoutMs, (int)mOutputDBDirty, (int)mInputDBDirty);
+}
+
+void OSEMasterVolumeManager::cancelDBWrites()
+{
+    CLSError lserror;
+    for (LSMessageToken *token : {&mOutputDBWriteToken, &mInputDBWriteToken})
+    {
+        if (LSMESSAGE_TOKEN_INVALID == *token)
+            continue;
+        //The reply must not reach this object once it is deleted
+        if (!LSCallCancel(GetPalmService(), *token, &lserror))
+            lserror.Print(__FUNCTION__, __LINE__);
+        *token = LSMESSAGE_TOKEN_INVALID;
+    }
+    if (mDBWriteTimerID)
+    {
+        g_source_remove(mDBWriteTimerID);
+        mDBWriteTimerID = 0;
+    }
+}
+
+void OSEMasterVolumeManager::setDBWriteDelay(guint delayMs)
+{
+    PM_LOG_INFO(MSGID_CLIENT_MASTER_VOLUME_MANAGER, INIT_KVCOUNT, "setDBWriteDelay: %u ms", delayMs);
+    mDBWriteDelay = delayMs;
+    if (0 == mDBWriteDelay)
+        flushDataToDB();
+}
+
+void OSEMasterVolumeManager::loadDBWriteConfig()
+{
+    pbnjson::JValue configJson = pbnjson::JDomParser::fromFile(MASTER_VOLUME_MODULE_CONFIG, pbnjson::JSchema::AllSchema());
+    if (!configJson.isValid() || !configJson.isObject() || !configJson.hasKey("masterVolume"))
+        return;
+    int delayMs = 0;
+    if (configJson["masterVolume"]["dbWriteDelay"].asNumber<int>(delayMs) != CONV_OK || delayMs < 0)
     {
-        pbnjson::JObject data = pbnjson::JObject();
-        data.put("soundInput",it.deviceName);
-        data.put("deviceNameDetails",it.deviceNameDetail);
-        data.put("volume",it.volume);
-        data.put("deviceCounter",count++);
-        inputlist.append(data);
+        PM_LOG_ERROR(MSGID_CLIENT_MASTER_VOLUME_MANAGER, INIT_KVCOUNT,\
+            "loadDBWriteConfig: invalid masterVolume.dbWriteDelay, using %u ms", mDBWriteDelay);
+        return;
     }
-    devicedata = pbnjson::JObject {{"soundInputList", inputlist}};
-    finalString.put("settings",devicedata);
-    finalString.put("category","sound");
-    PM_LOG_INFO(MSGID_CLIENT_MASTER_VOLUME_MANAGER, INIT_KVCOUNT,"DB input %s", finalString.stringify().c_str());
-    result = LSCall(sh, SETSETTINGS, finalString.stringify().c_str(),nullptr,nullptr,nullptr, &lserror);
+    setDBWriteDelay((guint)delayMs);
+}
+
+pbnjson::JValue OSEMasterVolumeManager::getDBWriteStats()
+{
+    unsigned long saved = (mDBWriteRequests > mDBWritesSent) ? mDBWriteRequests - mDBWritesSent : 0;
+    pbnjson::JObject stats = pbnjson::JObject();
+    stats.put("writeDelay", (int)mDBWriteDelay);
+    stats.put("retryDelay", (int)mDBRetryDelay);
+    stats.put("requests", (int64_t)mDBWriteRequests);
+    stats.put("sent", (int64_t)mDBWritesSent);
+    stats.put("unchanged", (int64_t)mDBWritesUnchanged);
+    stats.put("failed", (int64_t)mDBWritesFailed);
+    stats.put("saved", (int64_t)saved);
+    stats.put("outputPending", mOutputDBDirty || LSMESSAGE_TOKEN_INVALID != mOutputDBWriteToken);
+    stats.put("inputPending", mInputDBDirty || LSMESSAGE_TOKEN_INVALID != mInputDBWriteToken);
+    return stats;
+}
+
+void OSEMasterVolumeManager::logDBWriteStats()
+{
+    unsigned long saved = (mDBWriteRequests > mDBWritesSent) ? mDBWriteRequests - mDBWritesSent : 0;
+    PM_LOG_INFO(MSGID_CLIENT_MASTER_VOLUME_MANAGER, INIT_KVCOUNT,\
+        "DB write stats: requests:%lu sent:%lu unchanged:%lu failed:%lu saved:%lu",\
+        mDBWriteRequests, mDBWritesSent, mDBWritesUnchanged, mDBWritesFailed, saved);
 }
 
 void OSEMasterVolumeManager::printDb()
@@ -239,9 +482,23 @@ void OSEMasterVolumeManager::printDb()
     }
 }
 
+void OSEMasterVolumeManager::prepareShutdown()
+{
+    //Write pending changes and wait a bounded time for the settings service to confirm them
+    mDBRetryDelay = 0;
+    flushDataToDB();
+    waitForDBWrites(DB_WRITE_SHUTDOWN_WAIT_MS);
+}
+
 OSEMasterVolumeManager::~OSEMasterVolumeManager()
 {
     PM_LOG_DEBUG("OSEMasterVolumeManager destructor");
+    //Other modules may be deleted already, so the main context is not iterated here
+    if (mOutputDBDirty || mInputDBDirty)
+        PM_LOG_ERROR(MSGID_CLIENT_MASTER_VOLUME_MANAGER, INIT_KVCOUNT,\
+            "volume DB changes not written on shutdown, output dirty:%d input dirty:%d", (int)mOutputDBDirty, (int)mInputDBDirty);
+    cancelDBWrites();
+    logDBWriteStats();
 }
 
 
@@ -793,7 +1050,7 @@ bool OSEMasterVolumeManager::updateMasterVolumeInMap(std::string deviceName, int
     }
     deviceVolumeMap[deviceName] = volume;
 
-    sendDataToDB();
+    sendDataToDB(isOutput);
     return true;
 }
 
@@ -2412,7 +2669,7 @@ void OSEMasterVolumeManager::requestInternalDevices()
                                                 mInternalInputDeviceList = a;
                                                 mInternalOutputDeviceList = b;
                                             };
-    ModuleManager::getModuleManagerInstance()->publishModuleEvent((events::EVENTS_T*)&stEventRequestInternalDevices);
+    ModuleManager::getModuleManagerInstance()->publishModuleEvent(stEventRequestInternalDevices);
 }
 
 void OSEMasterVolumeManager::requestSoundOutputDeviceInfo()
@@ -2420,7 +2677,7 @@ void OSEMasterVolumeManager::requestSoundOutputDeviceInfo()
     PM_LOG_INFO(MSGID_CLIENT_MASTER_VOLUME_MANAGER, INIT_KVCOUNT,"requestSoundOutputDeviceInfo");
     events::EVENT_REQUEST_SOUNDOUTPUT_INFO_T stEventRequestSoundOutputDeviceInfo;
     stEventRequestSoundOutputDeviceInfo.eventName = utils::eEventRequestSoundOutputDeviceInfo;
-    ModuleManager::getModuleManagerInstance()->publishModuleEvent((events::EVENTS_T*)&stEventRequestSoundOutputDeviceInfo);
+    ModuleManager::getModuleManagerInstance()->publishModuleEvent(stEventRequestSoundOutputDeviceInfo);
 
 }
 
@@ -2430,7 +2687,7 @@ void OSEMasterVolumeManager::requestSoundInputDeviceInfo()
 
     events::EVENT_REQUEST_SOUNDOUTPUT_INFO_T stEventRequestSoundInputDeviceInfo;
     stEventRequestSoundInputDeviceInfo.eventName = utils::eEventRequestSoundInputDeviceInfo;
-    ModuleManager::getModuleManagerInstance()->publishModuleEvent((events::EVENTS_T*)&stEventRequestSoundInputDeviceInfo);
+    ModuleManager::getModuleManagerInstance()->publishModuleEvent(stEventRequestSoundInputDeviceInfo);
 }
 
 void OSEMasterVolumeManager::eventResponseSoundInputDeviceInfo(utils::mapSoundDevicesInfo soundInputInfo)
@@ -2625,7 +2882,7 @@ void OSEMasterVolumeManager::addNewItemToDB(std::string deviceName, std::string
         }
         mExtInputDeviceListDB.push_front(newItem);
     }
-    sendDataToDB();
+    sendDataToDB(isOutput);
 }
 
 bool OSEMasterVolumeManager::DBSetVoulumeCallbackPA(LSHandle *sh, LSMessage *reply, void *ctx, bool status)
@@ -2693,7 +2950,7 @@ void OSEMasterVolumeManager::deviceConnectOp(std::string deviceName, std::string
             //update the connected status of deviceNameDetail to true
             //reorder the list to move the connected device to front.
             updateConnStatusAndReorder(deviceNameDetail,isOutput,false,true);
-            sendDataToDB();
+            sendDataToDB(isOutput);
 
             //call mobjaudiomixer setvolume, with callback to notify master get volume
             //update DB with new device order
@@ -2753,7 +3010,7 @@ void OSEMasterVolumeManager::deviceDisconnectOp(std::string deviceName, std::str
             //reorder the list to move the disconnected device to end of connected list.
             //update DB with new device order
             updateConnStatusAndReorder(deviceNameDetail,isOutput,false,false);
-            sendDataToDB();
+            sendDataToDB(isOutput);
         }
         else
         {
@@ -2898,15 +3155,15 @@ void OSEMasterVolumeManager::handleEvent(events::EVENTS_T *event)
         {
             PM_LOG_INFO(MSGID_CLIENT_MASTER_VOLUME_MANAGER, INIT_KVCOUNT,\
                     "handleEvent:: eEventServerStatusSubscription");
-            events::EVENT_SERVER_STATUS_INFO_T *serverStatusInfoEvent = (events::EVENT_SERVER_STATUS_INFO_T*)event;
-            eventServerStatusInfo(serverStatusInfoEvent->serviceName, serverStatusInfoEvent->connectionStatus);
+            const events::EVENT_SERVER_STATUS_INFO_T *serverStatusInfoEvent = events::getEventPayload<events::EVENT_SERVER_STATUS_INFO_T>(event);
+            if (serverStatusInfoEvent)
+                eventServerStatusInfo(serverStatusInfoEvent->serviceName, serverStatusInfoEvent->connectionStatus);
         }
         break;
         case utils::eEventMasterVolumeStatus:
         {
             PM_LOG_INFO(MSGID_CLIENT_MASTER_VOLUME_MANAGER, INIT_KVCOUNT,\
                     "handleEvent:: eEventMasterVolumeStatus");
-            events::EVENT_MASTER_VOLUME_STATUS_T *masterVolumeStatusEvent = (events::EVENT_MASTER_VOLUME_STATUS_T*)event;
             eventMasterVolumeStatus();
         }
         break;
@@ -2914,41 +3171,46 @@ void OSEMasterVolumeManager::handleEvent(events::EVENTS_T *event)
         {
             PM_LOG_INFO(MSGID_CLIENT_MASTER_VOLUME_MANAGER, INIT_KVCOUNT,\
                     "handleEvent:: eEventActiveDeviceInfo");
-            events::EVENT_ACTIVE_DEVICE_INFO_T *stActiveDeviceInfo = (events::EVENT_ACTIVE_DEVICE_INFO_T*)event;
-            eventActiveDeviceInfo(stActiveDeviceInfo->deviceName, stActiveDeviceInfo->display, stActiveDeviceInfo->isConnected,
-                stActiveDeviceInfo->isOutput, stActiveDeviceInfo->isActive);
+            const events::EVENT_ACTIVE_DEVICE_INFO_T *stActiveDeviceInfo = events::getEventPayload<events::EVENT_ACTIVE_DEVICE_INFO_T>(event);
+            if (stActiveDeviceInfo)
+                eventActiveDeviceInfo(stActiveDeviceInfo->deviceName, stActiveDeviceInfo->display, stActiveDeviceInfo->isConnected,
+                    stActiveDeviceInfo->isOutput, stActiveDeviceInfo->isActive);
         }
         break;
         case utils::eEventResponseSoundOutputDeviceInfo:
         {
             PM_LOG_INFO(MSGID_CLIENT_MASTER_VOLUME_MANAGER, INIT_KVCOUNT,\
                     "handleEvent:: eEventResponseSoundOutputDeviceInfo");
-            events::EVENT_RESPONSE_SOUNDOUTPUT_INFO_T *stSoundOutputDeviceInfo = (events::EVENT_RESPONSE_SOUNDOUTPUT_INFO_T*)event;
-            eventResponseSoundOutputDeviceInfo(stSoundOutputDeviceInfo->soundOutputInfo);
+            const events::EVENT_RESPONSE_SOUNDOUTPUT_INFO_T *stSoundOutputDeviceInfo = events::getEventPayload<events::EVENT_RESPONSE_SOUNDOUTPUT_INFO_T>(event);
+            if (stSoundOutputDeviceInfo)
+                eventResponseSoundOutputDeviceInfo(stSoundOutputDeviceInfo->soundOutputInfo);
         }
         break;
         case utils::eEventResponseSoundInputDeviceInfo:
         {
             PM_LOG_INFO(MSGID_CLIENT_MASTER_VOLUME_MANAGER, INIT_KVCOUNT,\
                     "handleEvent:: eEventResponseSoundInputDeviceInfo");
-            events::EVENT_RESPONSE_SOUNDINPUT_INFO_T *stSoundInputDeviceInfo = (events::EVENT_RESPONSE_SOUNDINPUT_INFO_T*)event;
-            eventResponseSoundInputDeviceInfo(stSoundInputDeviceInfo->soundInputInfo);
+            const events::EVENT_RESPONSE_SOUNDINPUT_INFO_T *stSoundInputDeviceInfo = events::getEventPayload<events::EVENT_RESPONSE_SOUNDINPUT_INFO_T>(event);
+            if (stSoundInputDeviceInfo)
+                eventResponseSoundInputDeviceInfo(stSoundInputDeviceInfo->soundInputInfo);
         }
         break;
         case utils::eEventMixerStatus:
         {
             PM_LOG_INFO(MSGID_CLIENT_MASTER_VOLUME_MANAGER, INIT_KVCOUNT,\
                 "handleEvent : eEventMixerStatus");
-            events::EVENT_MIXER_STATUS_T *stEventMixerStatus = (events::EVENT_MIXER_STATUS_T*)event;
-            eventMixerStatus( stEventMixerStatus->mixerStatus, stEventMixerStatus->mixerType);
+            const events::EVENT_MIXER_STATUS_T *stEventMixerStatus = events::getEventPayload<events::EVENT_MIXER_STATUS_T>(event);
+            if (stEventMixerStatus)
+                eventMixerStatus( stEventMixerStatus->mixerStatus, stEventMixerStatus->mixerType);
         }
         break;
         case  utils::eEventDeviceConnectionStatus:
         {
             PM_LOG_INFO(MSGID_CLIENT_MASTER_VOLUME_MANAGER, INIT_KVCOUNT,\
                 "handleEvent : eEventDeviceConnectionStatus");
-            events::EVENT_DEVICE_CONNECTION_STATUS_T * stDeviceConnectionStatus = (events::EVENT_DEVICE_CONNECTION_STATUS_T*)event;
-            eventDeviceConnectionStatus(stDeviceConnectionStatus->devicename, stDeviceConnectionStatus->deviceNameDetail, stDeviceConnectionStatus->deviceIcon, stDeviceConnectionStatus->deviceStatus, stDeviceConnectionStatus->mixerType, stDeviceConnectionStatus->isOutput);
+            const events::EVENT_DEVICE_CONNECTION_STATUS_T *stDeviceConnectionStatus = events::getEventPayload<events::EVENT_DEVICE_CONNECTION_STATUS_T>(event);
+            if (stDeviceConnectionStatus)
+                eventDeviceConnectionStatus(stDeviceConnectionStatus->devicename, stDeviceConnectionStatus->deviceNameDetail, stDeviceConnectionStatus->deviceIcon, stDeviceConnectionStatus->deviceStatus, stDeviceConnectionStatus->mixerType, stDeviceConnectionStatus->isOutput);
         }
         break;
         default:
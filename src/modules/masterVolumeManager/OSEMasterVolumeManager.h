@@ -37,6 +37,14 @@
 #define DEFAULT_INITIAL_VOLUME 90
 
 #define MUTE_MIC_BOTH_DISPLAY 3
+//Volume and device order changes within this window are written to settings service once
+#define DB_WRITE_DEBOUNCE_MS 500
+//A failed write is retried after the debounce delay, doubled per failure up to this
+#define DB_WRITE_RETRY_MAX_MS 30000
+//How long shutdown waits for the settings service to confirm the last write
+#define DB_WRITE_SHUTDOWN_WAIT_MS 1000
+//"masterVolume":{"dbWriteDelay":<ms>} in this file overrides DB_WRITE_DEBOUNCE_MS
+#define MASTER_VOLUME_MODULE_CONFIG "/etc/palm/audiod/audiod_module_config.json"
 
 struct deviceInfo
 {
@@ -111,6 +119,29 @@ class OSEMasterVolumeManager : public MasterVolumeInterface
         std::list<std::string> mInternalInputDeviceList;
         std::list<connectedDevices> mConnectedDevicesList;
 
+        //Write-behind state of the soundOutputList/soundInputList settings
+        bool mOutputDBDirty;
+        bool mInputDBDirty;
+        guint mDBWriteDelay;
+        guint mDBWriteTimerID;
+        guint mDBRetryDelay;
+        LSMessageToken mOutputDBWriteToken;
+        LSMessageToken mInputDBWriteToken;
+        std::string mLastOutputDBPayload;
+        std::string mLastInputDBPayload;
+        unsigned long mDBWriteRequests;
+        unsigned long mDBWritesSent;
+        unsigned long mDBWritesUnchanged;
+        unsigned long mDBWritesFailed;
+
+        std::string buildDBPayload(bool isOutput);
+        bool writeDBPayload(bool isOutput);
+        void onDBWriteReply(bool isOutput, bool success);
+        void scheduleDBRetry();
+        void loadDBWriteConfig();
+        void waitForDBWrites(guint timeoutMs);
+        void cancelDBWrites();
+
         //Register Object to object factory. This is called automatically
         static bool RegisterObject()
         {
@@ -120,6 +151,7 @@ class OSEMasterVolumeManager : public MasterVolumeInterface
     public :
         ~OSEMasterVolumeManager();
         OSEMasterVolumeManager();
+        void prepareShutdown();
         static MasterVolumeInterface* CreateObject()
         {
             if (mIsObjRegistered)
@@ -147,7 +179,14 @@ class OSEMasterVolumeManager : public MasterVolumeInterface
         void deviceConnectOp(std::string deviceName, std::string deviceNameDetail,bool isOutput);
         void deviceDisconnectOp(std::string deviceName, std::string deviceNameDetail,bool isOutput);
         std::list<deviceInfo>&getDBListRef(bool isInternal, bool isOutput);
-        void sendDataToDB();
+        void sendDataToDB(bool isOutput);
+        void flushDataToDB();
+        void setDBWriteDelay(guint delayMs);
+        void logDBWriteStats();
+        pbnjson::JValue getDBWriteStats();
+        static gboolean _flushDBTimer(gpointer data);
+        static bool _outputDBWriteReply(LSHandle *sh, LSMessage *reply, void *ctx);
+        static bool _inputDBWriteReply(LSHandle *sh, LSMessage *reply, void *ctx);
 
         void setActiveStatus(std::string deviceName, int display, bool isOutput, bool isActive);
         std::string getActiveDevice(int display, bool isOutput);
@@ -62,6 +62,8 @@ public:
     virtual void muteMic(LSHandle *lshandle, LSMessage *message, void *ctx) = 0;
 
     virtual void handleEvent(events::EVENTS_T *event) = 0;
+    //Called on shutdown before any module is removed
+    virtual void prepareShutdown() {}
 };
 
 #endif //MASTERVOLUME_INTERFACE_H
@@ -249,6 +249,12 @@ void MasterVolumeManager::deInitialize()
     }
 }
 
+void MasterVolumeManager::prepareShutdown()
+{
+    if (mMasterVolumeClientInstance)
+        mMasterVolumeClientInstance->prepareShutdown();
+}
+
 void MasterVolumeManager::handleEvent(events::EVENTS_T *event)
 {
     mMasterVolumeClientInstance->handleEvent(event);
@@ -66,6 +66,7 @@ class MasterVolumeManager : public ModuleInterface
         void initialize();
         void deInitialize();
         void handleEvent(events::EVENTS_T *event);
+        void prepareShutdown();
 
 
         //Internal API for Volume and Mute, will be implemented during dynamic audio policy handling redesign
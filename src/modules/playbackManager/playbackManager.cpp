@@ -17,10 +17,13 @@
 * LICENSE@@@ */
 
 #include "playbackManager.h"
+#include "ImaAdpcm.h"
 
 #define DEFAULT_SAMPLE_RATE 48000
 #define DEFAULT_CHANNELS 2
 #define DEFAULT_SAMPLE_FORMAT "PA_SAMPLE_S32LE"
+#define DEFAULT_PLAYBACK_VOLUME 100
+#define MAX_PLAYBACK_VOLUME 100
 
 PlaybackManager* PlaybackManager::mPlaybackManager = nullptr;
 bool PlaybackManager::mIsObjRegistered = PlaybackManager::RegisterObject();
@@ -65,40 +68,34 @@ bool PlaybackManager::isValidFileExtension(const std::string& filePath)
     {
         // return the substring
         extension = filePath.substr(pos);
-        if ((".wav" == extension) || (".pcm" == extension))
+        //IMA-ADPCM files carry their own format, it overrides the one in the request
+        if ((".wav" == extension) || (".pcm" == extension) || (IMA_ADPCM_FILE_EXTENSION == extension))
             success = true;
     }
     return success;
 }
 
 
-void PlaybackManager::stopInternal(std::string playbackId)
+void PlaybackManager::notifyGetPlayabackStatus(const std::string& playbackId, const std::string& state, int item)
 {
     PM_LOG_INFO(MSGID_PLAYBACK_MANAGER, INIT_KVCOUNT, \
-        "stopInternal: playbackId: %s",playbackId.c_str());
-    PlaybackManager* playbackObj = PlaybackManager::getPlaybackManagerInstance();
-
-    AudioMixer* audioMixerObj = playbackObj->mObjAudioMixer;
-
-    if (audioMixerObj && !(audioMixerObj->controlPlayback(playbackId, "stop")))
-    {
-        PM_LOG_ERROR(MSGID_PLAYBACK_MANAGER, INIT_KVCOUNT, "stopPlayback throwed error");
-    }
-}
-
-void PlaybackManager::notifyGetPlayabackStatus(std::string& playbackId, std::string& state)
-{
-    PM_LOG_INFO(MSGID_PLAYBACK_MANAGER, INIT_KVCOUNT, \
-        "notifyGetPlayabackStatus: playbackId: %s %s",playbackId.c_str(), state.c_str());
+        "notifyGetPlayabackStatus: playbackId: %s %s item: %d",playbackId.c_str(), state.c_str(), item);
 
     CLSError lserror;
     std::string reply;
     std::string key(AUDIOD_API_GET_PLAYBACK_STATUS);
-    pbnjson::JValue returnPayload  = pbnjson::Object();
+    pbnjson::JValue returnPayload  = pbnjson::JObject();
     bool retValAcquire = false;
     LSSubscriptionIter *iter = NULL;
 
-    returnPayload.put("playbackStatus", state);
+    //Files queued on the playback report their own state, the playback state is sent separately
+    if (item >= 0)
+    {
+        returnPayload.put("item", item);
+        returnPayload.put("itemStatus", state);
+    }
+    else
+        returnPayload.put("playbackStatus", state);
     returnPayload.put("returnValue", true);
     returnPayload.put("subscribed", true);
     key.append("/" + playbackId);
@@ -110,7 +107,7 @@ void PlaybackManager::notifyGetPlayabackStatus(std::string& playbackId, std::str
     }
     else
     {
-        if(state == "stopped")
+        if(state == "stopped" && item < 0)
         {
             retValAcquire = LSSubscriptionAcquire(GetPalmService(), key.c_str(), &iter, &lserror);
             if(retValAcquire)
@@ -123,8 +120,6 @@ void PlaybackManager::notifyGetPlayabackStatus(std::string& playbackId, std::str
                 }
                 LSSubscriptionRelease(iter);
             }
-            std::thread th(PlaybackManager::stopInternal, playbackId);
-            th.detach();
         }
     }
 }
@@ -132,9 +127,9 @@ void PlaybackManager::notifyGetPlayabackStatus(std::string& playbackId, std::str
 
 bool PlaybackManager::_playSound(LSHandle *lshandle, LSMessage *message, void *ctx)
 {
-    LSMessageJsonParser msg(message, STRICT_SCHEMA(PROPS_5(\
+    LSMessageJsonParser msg(message, STRICT_SCHEMA(PROPS_6(\
         PROP(fileName, string), PROP(sink, string), PROP(format, string), \
-        PROP(sampleRate , integer), PROP(channels, integer))\
+        PROP(sampleRate , integer), PROP(channels, integer), PROP(volume, integer))\
         REQUIRED_2(fileName, sink)));
 
     if (!msg.parse(__FUNCTION__, lshandle))
@@ -146,6 +141,7 @@ bool PlaybackManager::_playSound(LSHandle *lshandle, LSMessage *message, void *c
     std::string format;
     int sampleRate = 0;
     int channels = 0;
+    int volume = DEFAULT_PLAYBACK_VOLUME;
     pbnjson::JValue resp = pbnjson::JObject();
     CLSError lserror;
 
@@ -159,6 +155,8 @@ bool PlaybackManager::_playSound(LSHandle *lshandle, LSMessage *message, void *c
         sampleRate = DEFAULT_SAMPLE_RATE;
     if (!msg.get("channels", channels))
         channels = DEFAULT_CHANNELS;
+    if (!msg.get("volume", volume))
+        volume = DEFAULT_PLAYBACK_VOLUME;
 
     PlaybackManager* playbackObj = PlaybackManager::getPlaybackManagerInstance();
 
@@ -196,6 +194,12 @@ bool PlaybackManager::_playSound(LSHandle *lshandle, LSMessage *message, void *c
             LSMessageReply(lshandle, message, reply.c_str(), &lserror);
             return true;
         }
+        if (volume < 0 || volume > MAX_PLAYBACK_VOLUME)
+        {
+            reply = STANDARD_JSON_ERROR(AUDIOD_ERRORCODE_INVALID_INPUT_PARAMS, "Invalid volume");
+            LSMessageReply(lshandle, message, reply.c_str(), &lserror);
+            return true;
+        }
 
         fp = fopen(filePath.c_str(), "r");
         if (!fp)
@@ -218,7 +222,7 @@ bool PlaybackManager::_playSound(LSHandle *lshandle, LSMessage *message, void *c
         if (audioMixerObj)
         {
             std::string playbackID = audioMixerObj->playSound(filePath.c_str(), \
-                virtualSink, format.c_str(), sampleRate, channels);
+                virtualSink, format.c_str(), sampleRate, channels, volume);
 
             if(playbackID.empty())
             {
@@ -245,6 +249,93 @@ bool PlaybackManager::_playSound(LSHandle *lshandle, LSMessage *message, void *c
     return true;
 }
 
+// Queues files to be played back to back on one stream. The first request
+// omits playbackId and starts the playback on sink, the next ones pass the
+// returned playbackId. Each file is reported as an item of the playback.
+bool PlaybackManager::_queueSound(LSHandle *lshandle, LSMessage *message, void *ctx)
+{
+    LSMessageJsonParser msg(message, STRICT_SCHEMA(PROPS_7(\
+        PROP(playbackId, string), PROP(fileName, string), PROP(sink, string), PROP(format, string), \
+        PROP(sampleRate , integer), PROP(channels, integer), PROP(volume, integer))\
+        REQUIRED_1(fileName)));
+
+    if (!msg.parse(__FUNCTION__, lshandle))
+        return true;
+
+    std::string playbackId;
+    std::string filePath;
+    std::string sink;
+    std::string format;
+    int sampleRate = 0;
+    int channels = 0;
+    int volume = DEFAULT_PLAYBACK_VOLUME;
+    pbnjson::JValue resp = pbnjson::JObject();
+    CLSError lserror;
+
+    std::string reply;
+
+    msg.get("fileName", filePath);
+    bool newPlayback = !msg.get("playbackId", playbackId);
+    if (!msg.get("format", format))
+        format = DEFAULT_SAMPLE_FORMAT;
+    if (!msg.get("sampleRate", sampleRate))
+        sampleRate = DEFAULT_SAMPLE_RATE;
+    if (!msg.get("channels", channels))
+        channels = DEFAULT_CHANNELS;
+    if (!msg.get("volume", volume))
+        volume = DEFAULT_PLAYBACK_VOLUME;
+
+    PlaybackManager* playbackObj = PlaybackManager::getPlaybackManagerInstance();
+    AudioMixer* audioMixerObj = playbackObj ? playbackObj->mObjAudioMixer : nullptr;
+    EVirtualAudioSink virtualSink = eVirtualSink_None;
+    if (newPlayback && msg.get("sink", sink))
+        virtualSink = getSinkByName(sink.c_str());
+
+    if (!audioMixerObj)
+        reply = STANDARD_JSON_ERROR(AUDIOD_ERRORCODE_INTERNAL_ERROR, "Could not get the playbck instance");
+    else if (newPlayback && eVirtualSink_None == virtualSink)
+        reply = STANDARD_JSON_ERROR(AUDIOD_ERRORCODE_INVALID_INPUT_PARAMS, "Invalid virtual sink name");
+    else if (!playbackObj->isValidFileExtension(filePath))
+        reply = STANDARD_JSON_ERROR(AUDIOD_ERRORCODE_INVALID_INPUT_PARAMS, "Invalid file format");
+    else if (!playbackObj->isValidSampleFormat(format))
+        reply = STANDARD_JSON_ERROR(AUDIOD_ERRORCODE_INVALID_INPUT_PARAMS, "Invalid sample format");
+    else if (!playbackObj->isValidSampleRate(sampleRate))
+        reply = STANDARD_JSON_ERROR(AUDIOD_ERRORCODE_INVALID_INPUT_PARAMS, "Invalid sample rate");
+    else if (!playbackObj->isValidChannelCount(channels))
+        reply = STANDARD_JSON_ERROR(AUDIOD_ERRORCODE_INVALID_INPUT_PARAMS, "Invalid channel count");
+    else if (volume < 0 || volume > MAX_PLAYBACK_VOLUME)
+        reply = STANDARD_JSON_ERROR(AUDIOD_ERRORCODE_INVALID_INPUT_PARAMS, "Invalid volume");
+    if (!reply.empty())
+    {
+        LSMessageReply(lshandle, message, reply.c_str(), &lserror);
+        return true;
+    }
+
+    int item = 0;
+    if (newPlayback)
+    {
+        //The volume applies to every file of the playback
+        playbackId = audioMixerObj->playSound(filePath.c_str(), virtualSink, format.c_str(), \
+            sampleRate, channels, volume);
+        if (playbackId.empty())
+            item = -1;
+    }
+    else
+        item = audioMixerObj->queueSound(playbackId, filePath.c_str(), format.c_str(), sampleRate, channels);
+
+    if (item < 0)
+    {
+        reply = STANDARD_JSON_ERROR(AUDIOD_ERRORCODE_INTERNAL_ERROR, "Could not queue the audio file");
+        LSMessageReply(lshandle, message, reply.c_str(), &lserror);
+        return true;
+    }
+    resp.put("playbackId", playbackId);
+    resp.put("item", item);
+    resp.put("returnValue", true);
+    utils::LSMessageResponse(lshandle, message, resp.stringify().c_str(), utils::eLSRespond, false);
+    return true;
+}
+
 bool PlaybackManager::_controlPlayback(LSHandle *lshandle, LSMessage *message, void *ctx)
 {
     LSMessageJsonParser msg(message, STRICT_SCHEMA(PROPS_2(\
@@ -285,9 +376,9 @@ bool PlaybackManager::_controlPlayback(LSHandle *lshandle, LSMessage *message, v
 
 bool PlaybackManager::_getPlaybackStatus(LSHandle *lshandle, LSMessage *message, void *ctx)
 {
-    LSMessageJsonParser msg(message, STRICT_SCHEMA(PROPS_2(\
+    LSMessageJsonParser msg(message, STRICT_SCHEMA(PROPS_3(\
         PROP(subscribe, boolean),
-        PROP(playbackId, string))\
+        PROP(playbackId, string), PROP(interval, integer))\
         REQUIRED_1(playbackId)));
 
     if (!msg.parse(__FUNCTION__, lshandle))
@@ -299,7 +390,12 @@ bool PlaybackManager::_getPlaybackStatus(LSHandle *lshandle, LSMessage *message,
     bool subscribed;
     if (!msg.get("subscribe", subscribed))
         subscribed=false;
+    //Position updates are only pushed when an interval is given
+    int interval = 0;
+    msg.get("interval", interval);
     pbnjson::JValue resp = pbnjson::JObject();
+    PLAYBACK_TIMING_T timing;
+    bool hasTiming = false;
 
 
     msg.get("playbackId", playbackId);
@@ -311,8 +407,15 @@ bool PlaybackManager::_getPlaybackStatus(LSHandle *lshandle, LSMessage *message,
 
         if (audioMixerObj)
         {
-            std::string state = audioMixerObj->getPlaybackStatus(playbackId);
-            if(state.empty())
+            timing.rate = 0;
+            std::string state = audioMixerObj->getPlaybackStatus(playbackId, &timing);
+            hasTiming = (0 != timing.rate);
+            if (interval < 0 || (interval > 0 && interval < PLAYBACK_POSITION_MIN_INTERVAL_MS))
+            {
+                reply = STANDARD_JSON_ERROR(AUDIOD_ERRORCODE_INVALID_PARAMS, "Invalid interval");
+                LSMessageReply(lshandle, message, reply.c_str(), &lserror);
+            }
+            else if(state.empty())
             {
                 reply = STANDARD_JSON_ERROR(AUDIOD_ERRORCODE_INVALID_PARAMS, "Invalid Params");
                 LSMessageReply(lshandle, message, reply.c_str(), &lserror);
@@ -331,8 +434,12 @@ bool PlaybackManager::_getPlaybackStatus(LSHandle *lshandle, LSMessage *message,
                             "LSSubscriptionAdd failed");
                         return true;
                     }
+                    if (interval > 0 && hasTiming)
+                        playbackObj->addPositionSubscription(message, playbackId, (guint)interval);
                 }
                 resp.put("playbackStatus",state);
+                if (hasTiming)
+                    putPlaybackTiming(resp, timing);
                 resp.put("returnValue",true);
                 resp.put("subscribed",subscribed);
                 utils::LSMessageResponse(lshandle, message, resp.stringify().c_str(), \
@@ -349,8 +456,85 @@ bool PlaybackManager::_getPlaybackStatus(LSHandle *lshandle, LSMessage *message,
     return true;
 }
 
+void PlaybackManager::putPlaybackTiming(pbnjson::JValue &payload, const PLAYBACK_TIMING_T &timing)
+{
+    payload.put("item", timing.item);
+    payload.put("sampleRate", (int64_t)timing.rate);
+    payload.put("framesWritten", (int64_t)timing.framesWritten);
+    payload.put("latencyUs", (int64_t)timing.latency);
+    payload.put("position", (int64_t)(timing.positionFrames * 1000 / timing.rate));
+}
+
+void PlaybackManager::addPositionSubscription(LSMessage *message, const std::string& playbackId, guint interval)
+{
+    POSITION_SUBSCRIPTION_T *subscription = new POSITION_SUBSCRIPTION_T;
+    LSMessageRef(message);
+    subscription->message = message;
+    subscription->playbackId = playbackId;
+    subscription->lastPosition = UINT64_MAX;
+    subscription->timerID = g_timeout_add(interval, &PlaybackManager::_positionTimer, subscription);
+    mPositionSubscriptions.push_back(subscription);
+}
+
+void PlaybackManager::removePositionSubscription(POSITION_SUBSCRIPTION_T *subscription)
+{
+    mPositionSubscriptions.remove(subscription);
+    if (subscription->timerID)
+        g_source_remove(subscription->timerID);
+    LSMessageUnref(subscription->message);
+    delete subscription;
+}
+
+// Pushes the position computed from the stream timing, a paused playback
+// is not reported again until it moves
+gboolean PlaybackManager::_positionTimer(gpointer data)
+{
+    POSITION_SUBSCRIPTION_T *subscription = (POSITION_SUBSCRIPTION_T*)data;
+    PlaybackManager* playbackObj = PlaybackManager::getPlaybackManagerInstance();
+    if (!playbackObj || !playbackObj->mObjAudioMixer)
+        return TRUE;
+
+    PLAYBACK_TIMING_T timing;
+    timing.rate = 0;
+    std::string state = playbackObj->mObjAudioMixer->getPlaybackStatus(subscription->playbackId, &timing);
+    if (0 == timing.rate)
+    {
+        //The playback ended, subscribers got its last state from the status notification
+        subscription->timerID = 0;
+        playbackObj->removePositionSubscription(subscription);
+        return FALSE;
+    }
+    if (timing.positionFrames == subscription->lastPosition)
+        return TRUE;
+    subscription->lastPosition = timing.positionFrames;
+
+    CLSError lserror;
+    pbnjson::JValue payload = pbnjson::JObject();
+    payload.put("playbackStatus", state);
+    putPlaybackTiming(payload, timing);
+    payload.put("returnValue", true);
+    payload.put("subscribed", true);
+    if (!LSMessageRespond(subscription->message, payload.stringify().c_str(), &lserror))
+        lserror.Print(__FUNCTION__, __LINE__);
+    return TRUE;
+}
+
+void PlaybackManager::_cancelPositionSubscription(LSMessage *message, LSMessageJsonParser &msgParser)
+{
+    PlaybackManager* playbackObj = PlaybackManager::getPlaybackManagerInstance();
+    if (!playbackObj)
+        return;
+    std::list<POSITION_SUBSCRIPTION_T*> subscriptions = playbackObj->mPositionSubscriptions;
+    for (const auto &subscription : subscriptions)
+    {
+        if (subscription->message == message)
+            playbackObj->removePositionSubscription(subscription);
+    }
+}
+
 LSMethod PlaybackManager::playbackMethods[] = {
     { "playSound", PlaybackManager::_playSound},
+    { "queueSound", PlaybackManager::_queueSound},
     { "controlPlayback", PlaybackManager::_controlPlayback},
     { "getPlaybackStatus", PlaybackManager::_getPlaybackStatus},
     { },
@@ -372,12 +556,15 @@ PlaybackManager::PlaybackManager(ModuleConfig* const pConfObj)
     else
         PM_LOG_ERROR(MSGID_PLAYBACK_MANAGER, INIT_KVCOUNT,\
             "PlaybackManager:mObjModuleManager is null");
+    registerCancelSubscriptionCallback(&PlaybackManager::_cancelPositionSubscription);
     PM_LOG_DEBUG("playback manager constructor");
 }
 
 PlaybackManager::~PlaybackManager()
 {
     PM_LOG_DEBUG("Playback manager destructor");
+    while (!mPositionSubscriptions.empty())
+        removePositionSubscription(mPositionSubscriptions.front());
 }
 
 void PlaybackManager::initialize()
@@ -424,10 +611,10 @@ void PlaybackManager::handleEvent(events::EVENTS_T* event)
         {
             PM_LOG_INFO(MSGID_PLAYBACK_MANAGER, INIT_KVCOUNT,\
                 "handleEvent : eEventGetPlaybackStatus");
-            events::EVENT_GET_PLAYBACK_STATUS_INFO_T *stEventPlaybackStatus = \
-                (events::EVENT_GET_PLAYBACK_STATUS_INFO_T*)event;
-            notifyGetPlayabackStatus(stEventPlaybackStatus->playbackId, \
-                stEventPlaybackStatus->state);
+            const events::EVENT_GET_PLAYBACK_STATUS_INFO_T *stEventPlaybackStatus = events::getEventPayload<events::EVENT_GET_PLAYBACK_STATUS_INFO_T>(event);
+            if (stEventPlaybackStatus)
+                notifyGetPlayabackStatus(stEventPlaybackStatus->playbackId, \
+                    stEventPlaybackStatus->state, stEventPlaybackStatus->item);
         }
         break;
         default:
@@ -27,8 +27,11 @@
 #include "log.h"
 #include "main.h"
 #include "moduleFactory.h"
+#include <list>
 
 #define AUDIOD_API_GET_PLAYBACK_STATUS    "/getPlaybackStatus"
+//Shortest interval of the position updates pushed to subscribers
+#define PLAYBACK_POSITION_MIN_INTERVAL_MS 100
 
 class PlaybackManager : public ModuleInterface
 {
@@ -37,8 +40,22 @@ private:
     bool isValidSampleRate(const int& rate);
     bool isValidChannelCount(const int& channels);
     bool isValidFileExtension(const std::string& filePath);
-    void notifyGetPlayabackStatus(std::string& playbackId, std::string& state);
-    static void stopInternal(std::string playbackId);
+    void notifyGetPlayabackStatus(const std::string& playbackId, const std::string& state, int item);
+
+    //getPlaybackStatus subscription which asked for position updates
+    typedef struct positionSubscription
+    {
+        LSMessage *message;
+        std::string playbackId;
+        guint timerID;
+        uint64_t lastPosition;
+    }POSITION_SUBSCRIPTION_T;
+    std::list<POSITION_SUBSCRIPTION_T*> mPositionSubscriptions;
+    void addPositionSubscription(LSMessage *message, const std::string& playbackId, guint interval);
+    void removePositionSubscription(POSITION_SUBSCRIPTION_T *subscription);
+    static void putPlaybackTiming(pbnjson::JValue &payload, const PLAYBACK_TIMING_T &timing);
+    static gboolean _positionTimer(gpointer data);
+    static void _cancelPositionSubscription(LSMessage *message, LSMessageJsonParser &msgParser);
 
     PlaybackManager(const PlaybackManager&) = delete;
     PlaybackManager& operator=(const PlaybackManager&) = delete;
@@ -72,6 +89,7 @@ public:
     void deInitialize();
     void handleEvent(events::EVENTS_T* ev);
     static bool _playSound(LSHandle *lshandle, LSMessage *message, void *ctx);
+    static bool _queueSound(LSHandle *lshandle, LSMessage *message, void *ctx);
     static bool _controlPlayback(LSHandle *lshandle, LSMessage *message, void *ctx);
     static bool _getPlaybackStatus(LSHandle *lshandle, LSMessage *message, void *ctx);
 };
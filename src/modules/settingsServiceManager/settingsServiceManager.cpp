@@ -165,8 +165,9 @@ void SettingsServiceManager::handleEvent(events::EVENTS_T* event)
         {
             PM_LOG_INFO(MSGID_SETTING_SERVICE_MANAGER, INIT_KVCOUNT,\
                     "handleEvent:: eEventServerStatusSubscription");
-            events::EVENT_SERVER_STATUS_INFO_T *serverStatusInfoEvent = (events::EVENT_SERVER_STATUS_INFO_T*)event;
-            eventServerStatusInfo(serverStatusInfoEvent->serviceName, serverStatusInfoEvent->connectionStatus);
+            const events::EVENT_SERVER_STATUS_INFO_T *serverStatusInfoEvent = events::getEventPayload<events::EVENT_SERVER_STATUS_INFO_T>(event);
+            if (serverStatusInfoEvent)
+                eventServerStatusInfo(serverStatusInfoEvent->serviceName, serverStatusInfoEvent->connectionStatus);
         }
         break;
         case eLunaEventSettingMediaParam:
@@ -174,8 +175,9 @@ void SettingsServiceManager::handleEvent(events::EVENTS_T* event)
         {
             PM_LOG_INFO(MSGID_SETTING_SERVICE_MANAGER, INIT_KVCOUNT,\
                 "handleEvent:: eEventKeySubscription");
-            events::EVENT_KEY_INFO_T *keySubscribeInfoEvent = (events::EVENT_KEY_INFO_T*)event;
-            eventKeyInfo(keySubscribeInfoEvent->type, keySubscribeInfoEvent->message);
+            const events::EVENT_KEY_INFO_T *keySubscribeInfoEvent = events::getEventPayload<events::EVENT_KEY_INFO_T>(event);
+            if (keySubscribeInfoEvent)
+                eventKeyInfo(keySubscribeInfoEvent->type, keySubscribeInfoEvent->message);
         }
         break;
         default:
@@ -62,9 +62,8 @@ bool SystemSoundsManager::_playFeedback(LSHandle *lshandle, LSMessage *message,
     std::string    name, sinkName;
     bool play = true;
     bool override = false;
-    char *filename = NULL;
+    std::string filename;
     FILE *fp = NULL;
-    size_t size = 0;
 
     SystemSoundsManager* SystemSoundsManagerInstance = SystemSoundsManager::getSystemSoundsManagerInstance();
     AudioMixer* audioMixerObj = SystemSoundsManagerInstance->mObjAudioMixer;
@@ -84,26 +83,8 @@ bool SystemSoundsManager::_playFeedback(LSHandle *lshandle, LSMessage *message,
             goto error;
         }
     }
-    size = strlen(SYSTEMSOUNDS_PATH) + strlen(name.c_str()) + strlen("-ondemand.pcm")+ 1;
-    filename = (char *)malloc( size );
-    if (filename == NULL)
-    {
-         reply = STANDARD_JSON_ERROR(4, "Unable to allocate memory");
-         goto error;
-    }
-    if (snprintf(filename, size, SYSTEMSOUNDS_PATH "%s-ondemand.pcm", name.c_str()) < 0)
-    {
-        PM_LOG_ERROR(MSGID_SYSTEMSOUND_MANAGER, INIT_KVCOUNT,"snprintf failed to generate filename. Returning from here\n");
-        goto error;
-    }
-    else if (snprintf(filename, size, SYSTEMSOUNDS_PATH "%s-ondemand.pcm", name.c_str()) >= size)
-    {
-        PM_LOG_ERROR(MSGID_SYSTEMSOUND_MANAGER, INIT_KVCOUNT,"snprintf buffer overflow. Filename might be truncated\n");
-    }
-
-    fp = fopen(filename, "r");
-    free(filename);
-    filename= NULL;
+    filename = utils::getSystemSoundPath(name);
+    fp = fopen(filename.c_str(), "r");
     if (!fp){
         PM_LOG_ERROR(MSGID_SYSTEMSOUND_MANAGER, INIT_KVCOUNT, \
             "Error : %s : file open failed. returning from here\n", __FUNCTION__);
@@ -49,7 +49,7 @@ bool TrackManager::disconnetedCb( LSHandle *sh,
             events::EVENT_UNREGISTER_TRACK_T stUnregisterTrack;
             stUnregisterTrack.eventName = utils::eEventUnregisterTrack;
             stUnregisterTrack.trackId = items->first;
-            trackManagerInstance->mObjModuleManager->publishModuleEvent((events::EVENTS_T*)&stUnregisterTrack);
+            trackManagerInstance->mObjModuleManager->publishModuleEvent(stUnregisterTrack);
             trackManagerInstance->mMapTrackIdList.erase(items->first);
             LSCancelServerStatus(GetPalmService(), trackManagerInstance->mMapPipelineTrackId[items->first].serverCookie, nullptr);
             items = trackManagerInstance->mMapPipelineTrackId.erase(items);
@@ -104,7 +104,7 @@ bool TrackManager::_registerTrack(LSHandle *lshandle, LSMessage *message, void *
             stRegisterTrack.eventName = utils::eEventRegisterTrack;
             stRegisterTrack.streamType = streamType;
             stRegisterTrack.trackId = trackId;
-            trackManagerInstance->mObjModuleManager->publishModuleEvent((events::EVENTS_T*)&stRegisterTrack);
+            trackManagerInstance->mObjModuleManager->publishModuleEvent(stRegisterTrack);
 
             //send success response
             resp.put("trackId",trackId);
@@ -149,7 +149,7 @@ bool TrackManager::_unregisterTrack(LSHandle *lshandle, LSMessage *message, void
             events::EVENT_UNREGISTER_TRACK_T stUnregisterTrack;
             stUnregisterTrack.eventName = utils::eEventUnregisterTrack;
             stUnregisterTrack.trackId = trackId;
-            trackManagerInstance->mObjModuleManager->publishModuleEvent((events::EVENTS_T*)&stUnregisterTrack);
+            trackManagerInstance->mObjModuleManager->publishModuleEvent(stUnregisterTrack);
 
             trackManagerInstance->mMapTrackIdList.erase(trackId);
             //cancel server status subscription and delete entry
@@ -16,9 +16,13 @@
 
 #include <cstdlib>
 #include <cstring>
+#include <mutex>
+#include <unordered_set>
+#include <unistd.h>
 
 #include "utils.h"
 #include "messageUtils.h"
+#include "ImaAdpcm.h"
 
 static GHookList *sInitList         = NULL;
 static GHookList *sModuleStartList  = NULL;
@@ -30,6 +34,14 @@ static GMainLoop *sCurrentLoop = NULL;
 static LSHandle *sCurrentHandle =NULL;
 static LSHandle *gLSHandle = NULL;
 
+std::string utils::getSystemSoundPath(const std::string &name)
+{
+    std::string path = std::string(SYSTEMSOUNDS_PATH) + name + "-ondemand";
+    if (0 == access((path + IMA_ADPCM_FILE_EXTENSION).c_str(), R_OK))
+        return path + IMA_ADPCM_FILE_EXTENSION;
+    return path + ".pcm";
+}
+
 void utils::LSMessageResponse(LSHandle* handle, LSMessage * message, const char* reply, utils::EReplyType eType, bool isReferenced)
 {
     CLSError lserror;
@@ -78,6 +90,30 @@ hookStart(gpointer func)
             "%s: Could not run start function %p", __FUNCTION__, func);
 }
 
+const std::string* InternedString::intern(const std::string &str)
+{
+    //Elements of an unordered_set are never moved, so the pointers stay valid.
+    //audiod also runs threads besides the main loop (pulse playback, tones), so the insert is locked.
+    static std::mutex sInternedStringsLock;
+    static std::unordered_set<std::string> sInternedStrings;
+    std::lock_guard<std::mutex> lock(sInternedStringsLock);
+    return &(*sInternedStrings.insert(str).first);
+}
+
+InternedString::InternedString()
+{
+    static const std::string *sEmptyString = intern(std::string());
+    mString = sEmptyString;
+}
+
+InternedString::InternedString(const std::string &str):mString(intern(str))
+{
+}
+
+InternedString::InternedString(const char *str):mString(intern(str ? str : ""))
+{
+}
+
 guint64 getCurrentTimeInMs ()
 {
     struct timespec now;
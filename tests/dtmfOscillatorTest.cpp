@@ -0,0 +1,107 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+
+#include "DtmfOscillator.h"
+#include "testUtils.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+//Low and high frequency of the keys 0-9, * and #, the order of the Dtmf enum
+static const int cKeyFrequencies[12][2] = {
+    {941, 1336}, {697, 1209}, {697, 1336}, {697, 1477}, {770, 1209}, {770, 1336},
+    {770, 1477}, {852, 1209}, {852, 1336}, {852, 1477}, {941, 1209}, {941, 1477}
+};
+
+//The one second tone table PulseAudioLink used to build in initializeDtmf(), computed the same way
+static std::vector<int16_t> makeFormerTable(int lowFrequency, int highFrequency, int sampleRate)
+{
+    std::vector<int16_t> table(sampleRate);
+    double low = M_PI * 2 * lowFrequency / sampleRate;
+    double high = M_PI * 2 * highFrequency / sampleRate;
+    for (int j = 0; j < sampleRate; ++j)
+        table[j] = (int16_t)((sin((double)j * low) / 2 + sin((double)j * high) / 2) * 16384);
+    return table;
+}
+
+//Largest difference to the table over samples, written in chunks of at most maxChunk samples
+//like the stream write callbacks, past the one second wrap of the position
+static int compareToTable(const int *key, int sampleRate, long samples, int maxChunk, int &differing)
+{
+    std::vector<int16_t> table = makeFormerTable(key[0], key[1], sampleRate);
+    DtmfOscillator oscillator(key[0], key[1], sampleRate);
+    std::vector<int16_t> buffer(maxChunk);
+    int worst = 0;
+    for (long position = 0; position < samples;)
+    {
+        int chunk = (int)std::min((long)(1 + rand() % maxChunk), samples - position);
+        oscillator.generate(buffer.data(), chunk);
+        for (int i = 0; i < chunk; i++, position++)
+        {
+            int diff = abs((int)buffer[i] - (int)table[position % sampleRate]);
+            worst = std::max(worst, diff);
+            differing += (diff != 0);
+        }
+    }
+    return worst;
+}
+
+//Every key stays within 1 LSB of the table, in small writes and in writes long
+//enough that the oscillator has to reseed inside a call
+static void testMatchesFormerTable(int sampleRate, int seconds)
+{
+    srand(16);
+    const int maxChunks[] = {8192, sampleRate * 4};
+    for (int maxChunk : maxChunks)
+    {
+        int differing = 0;
+        for (const int *key : cKeyFrequencies)
+        {
+            int worst = compareToTable(key, sampleRate, (long)sampleRate * seconds, maxChunk, differing);
+            if (worst > 1)
+                fprintf(stderr, "%d Hz: %d + %d Hz is %d LSB off the table\n", sampleRate, key[0], key[1], worst);
+            TEST_CHECK(worst <= 1);
+        }
+        printf("%d Hz, %d s per key, writes up to %d samples: %d of %ld samples differ from the table\n",\
+            sampleRate, seconds, maxChunk, differing, 12L * sampleRate * seconds);
+    }
+}
+
+//The first sample of a tone is 0 and its peak is near the 16384 of the table scaling
+static void testStart()
+{
+    for (const int *key : cKeyFrequencies)
+    {
+        DtmfOscillator oscillator(key[0], key[1], 44100);
+        std::vector<int16_t> buffer(44100);
+        oscillator.generate(buffer.data(), (int)buffer.size());
+        TEST_CHECK_EQ(buffer[0], 0);
+        int peak = 0;
+        for (int16_t sample : buffer)
+            peak = std::max(peak, abs((int)sample));
+        TEST_CHECK(peak > 16000 && peak <= 16384);
+    }
+}
+
+int main()
+{
+    testMatchesFormerTable(44100, 10);
+    testMatchesFormerTable(48000, 3);
+    testStart();
+    return TEST_RESULT();
+}
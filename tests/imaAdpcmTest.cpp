@@ -0,0 +1,164 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+
+#include "ImaAdpcm.h"
+#include "testUtils.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+static std::vector<int16_t> makeTone(size_t frames, uint16_t channels, double amplitude)
+{
+    std::vector<int16_t> pcm(frames * channels);
+    for (size_t i = 0; i < pcm.size(); i++)
+    {
+        size_t frame = i / channels;
+        double value = amplitude * sin(0.01 * frame * (1 + i % channels)) + 0.02 * (rand() / (double)RAND_MAX - 0.5);
+        pcm[i] = (int16_t)std::lrint(std::min(32767.0, std::max(-32768.0, value * 32768.0)));
+    }
+    return pcm;
+}
+
+static double getSnr(const std::vector<int16_t> &pcm, const std::vector<uint8_t> &decoded)
+{
+    double signal = 0.0;
+    double noise = 0.0;
+    for (size_t i = 0; i < pcm.size(); i++)
+    {
+        int16_t sample;
+        memcpy(&sample, decoded.data() + i * 2, sizeof(sample));
+        signal += (double)pcm[i] * pcm[i];
+        noise += ((double)pcm[i] - sample) * ((double)pcm[i] - sample);
+    }
+    return noise > 0.0 ? 10.0 * log10(signal / noise) : INFINITY;
+}
+
+//Frame counts around the block size, so partial and exact last blocks are both decoded
+static void testRoundTrip()
+{
+    const size_t frameCounts[] = {1, 2, 3, IMA_ADPCM_BLOCK_FRAMES - 1, IMA_ADPCM_BLOCK_FRAMES,\
+        IMA_ADPCM_BLOCK_FRAMES + 1, 3 * IMA_ADPCM_BLOCK_FRAMES + 17, 44100};
+    const uint16_t channelCounts[] = {1, 2, 3, 6, IMA_ADPCM_MAX_CHANNELS};
+    srand(18);
+    for (size_t frames : frameCounts)
+    {
+        for (uint16_t channels : channelCounts)
+        {
+            std::vector<int16_t> pcm = makeTone(frames, channels, 0.5);
+            std::vector<uint8_t> encoded;
+            ImaAdpcm::encode(pcm.data(), frames, channels, 44100, encoded);
+
+            IMA_ADPCM_HEADER_T header;
+            TEST_CHECK(ImaAdpcm::readHeader(encoded.data(), encoded.size(), header));
+            TEST_CHECK_EQ(header.channels, channels);
+            TEST_CHECK_EQ(header.rate, 44100);
+            TEST_CHECK_EQ(header.frames, frames);
+            size_t blocks = (frames + IMA_ADPCM_BLOCK_FRAMES - 1) / IMA_ADPCM_BLOCK_FRAMES;
+            size_t lastFrames = frames - (blocks - 1) * IMA_ADPCM_BLOCK_FRAMES;
+            TEST_CHECK_EQ(encoded.size(), IMA_ADPCM_HEADER_SIZE + (blocks - 1) * ImaAdpcm::getBlockSize(header,\
+                IMA_ADPCM_BLOCK_FRAMES) + ImaAdpcm::getBlockSize(header, lastFrames));
+
+            std::vector<uint8_t> decoded;
+            TEST_CHECK(ImaAdpcm::decode(encoded.data(), encoded.size(), decoded));
+            TEST_CHECK_EQ(decoded.size(), pcm.size() * sizeof(int16_t));
+            if (decoded.size() != pcm.size() * sizeof(int16_t))
+                continue;
+            //The first frame of a block is stored as is
+            for (size_t block = 0; block < blocks; block++)
+                TEST_CHECK(0 == memcmp(decoded.data() + block * IMA_ADPCM_BLOCK_FRAMES * channels * 2,\
+                    pcm.data() + block * IMA_ADPCM_BLOCK_FRAMES * channels, channels * 2));
+            //A 4 bit codec keeps a tone well above 25 dB once the step has adapted
+            double snr = getSnr(pcm, decoded);
+            if (frames >= IMA_ADPCM_BLOCK_FRAMES && snr < 25.0)
+                fprintf(stderr, "%zu frames of %u channels: SNR %.1f dB\n", frames, channels, snr);
+            TEST_CHECK(frames < IMA_ADPCM_BLOCK_FRAMES || snr >= 25.0);
+        }
+    }
+}
+
+//Silence stays exact and full scale square waves clamp at the rails instead of wrapping around
+static void testLimits()
+{
+    std::vector<int16_t> silence(5000, 0);
+    std::vector<uint8_t> encoded;
+    std::vector<uint8_t> decoded;
+    ImaAdpcm::encode(silence.data(), silence.size(), 1, 48000, encoded);
+    TEST_CHECK(ImaAdpcm::decode(encoded.data(), encoded.size(), decoded));
+    TEST_CHECK(decoded == std::vector<uint8_t>(silence.size() * 2, 0));
+
+    std::vector<int16_t> square(5000);
+    for (size_t i = 0; i < square.size(); i++)
+        square[i] = ((i / 50) & 1) ? -32768 : 32767;
+    encoded.clear();
+    ImaAdpcm::encode(square.data(), square.size(), 1, 48000, encoded);
+    TEST_CHECK(ImaAdpcm::decode(encoded.data(), encoded.size(), decoded));
+    TEST_CHECK_EQ(decoded.size(), square.size() * 2);
+    //The step adapts within a few samples, the end of every half period sits on the rail
+    const int16_t *samples = (const int16_t*)decoded.data();
+    int worst = 0;
+    for (size_t start = 40; start < square.size(); start += 50)
+        for (size_t i = start; i < start + 10; i++)
+            worst = std::max(worst, abs((int)samples[i] - (int)square[i]));
+    TEST_CHECK(worst < 1024);
+}
+
+//Decoding block by block, as PcmFileSource streams a file, matches the whole file decode
+static void testBlockDecode()
+{
+    const uint16_t channels = 2;
+    const size_t frames = 4 * IMA_ADPCM_BLOCK_FRAMES + 100;
+    std::vector<int16_t> pcm = makeTone(frames, channels, 0.7);
+    std::vector<uint8_t> encoded;
+    std::vector<uint8_t> decoded;
+    ImaAdpcm::encode(pcm.data(), frames, channels, 22050, encoded);
+    TEST_CHECK(ImaAdpcm::decode(encoded.data(), encoded.size(), decoded));
+
+    IMA_ADPCM_HEADER_T header;
+    TEST_CHECK(ImaAdpcm::readHeader(encoded.data(), encoded.size(), header));
+    std::vector<int16_t> streamed(frames * channels);
+    const uint8_t *block = encoded.data() + IMA_ADPCM_HEADER_SIZE;
+    for (size_t start = 0; start < frames; start += header.blockFrames)
+    {
+        size_t count = std::min((size_t)header.blockFrames, frames - start);
+        ImaAdpcm::decodeBlock(header, block, count, streamed.data() + start * channels);
+        block += ImaAdpcm::getBlockSize(header, count);
+    }
+    TEST_CHECK(block == encoded.data() + encoded.size());
+    TEST_CHECK_EQ(decoded.size(), streamed.size() * 2);
+    TEST_CHECK(0 == memcmp(decoded.data(), streamed.data(), std::min(decoded.size(), streamed.size() * 2)));
+
+    //A truncated file decodes its whole blocks, a damaged header is rejected
+    size_t twoBlocks = IMA_ADPCM_HEADER_SIZE + 2 * ImaAdpcm::getBlockSize(header, IMA_ADPCM_BLOCK_FRAMES);
+    std::vector<uint8_t> truncated;
+    TEST_CHECK(ImaAdpcm::decode(encoded.data(), twoBlocks + 10, truncated));
+    TEST_CHECK_EQ(truncated.size(), 2 * IMA_ADPCM_BLOCK_FRAMES * channels * 2);
+    TEST_CHECK(0 == memcmp(truncated.data(), decoded.data(), truncated.size()));
+    std::vector<uint8_t> damaged(encoded);
+    damaged[0] = 'X';
+    TEST_CHECK(!ImaAdpcm::decode(damaged.data(), damaged.size(), truncated));
+    TEST_CHECK(!ImaAdpcm::readHeader(encoded.data(), IMA_ADPCM_HEADER_SIZE - 1, header));
+}
+
+int main()
+{
+    testRoundTrip();
+    testLimits();
+    testBlockDecode();
+    return TEST_RESULT();
+}
@@ -0,0 +1,234 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+
+#include "PcmConverter.h"
+#include "testUtils.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+//The same source is built once with PCM_CONVERTER_SCALAR, so both paths of the platform are checked
+#if defined(PCM_CONVERTER_SCALAR)
+static const char *cConverterPath = "scalar";
+#elif defined(__SSE2__)
+static const char *cConverterPath = "SSE2";
+#elif defined(__ARM_NEON)
+static const char *cConverterPath = "NEON";
+#else
+static const char *cConverterPath = "scalar";
+#endif
+
+static pa_sample_spec makeSpec(pa_sample_format_t format, uint32_t rate, uint8_t channels)
+{
+    pa_sample_spec spec;
+    spec.format = format;
+    spec.rate = rate;
+    spec.channels = channels;
+    return spec;
+}
+
+static std::vector<uint8_t> makeInput(const pa_sample_spec &spec, size_t frames)
+{
+    size_t count = frames * spec.channels;
+    std::vector<uint8_t> input(count * pa_sample_size(&spec));
+    for (size_t i = 0; i < count; i++)
+    {
+        //A sine per channel with some noise, kept inside full scale
+        double value = 0.8 * sin(0.01 * (i / spec.channels) * (1 + i % spec.channels)) + 0.1 * (rand() / (double)RAND_MAX - 0.5);
+        switch (spec.format)
+        {
+            case PA_SAMPLE_S16LE:
+            {
+                int16_t sample = (int16_t)lrint(value * 32767);
+                memcpy(input.data() + i * 2, &sample, 2);
+                break;
+            }
+            case PA_SAMPLE_S24LE:
+            {
+                int32_t sample = (int32_t)lrint(value * 8388607);
+                input[i * 3] = (uint8_t)(sample & 0xff);
+                input[i * 3 + 1] = (uint8_t)((sample >> 8) & 0xff);
+                input[i * 3 + 2] = (uint8_t)((sample >> 16) & 0xff);
+                break;
+            }
+            case PA_SAMPLE_S32LE:
+            {
+                int32_t sample = (int32_t)lrint(value * 2147483647.0);
+                memcpy(input.data() + i * 4, &sample, 4);
+                break;
+            }
+            default:
+            {
+                float sample = (float)value;
+                memcpy(input.data() + i * 4, &sample, 4);
+                break;
+            }
+        }
+    }
+    return input;
+}
+
+//Feeding the input in chunks of random size, split inside frames and samples too,
+//must give the same bytes as converting it at once
+static void testChunkedConversion()
+{
+    const pa_sample_format_t formats[] = {PA_SAMPLE_S16LE, PA_SAMPLE_S24LE, PA_SAMPLE_S32LE, PA_SAMPLE_FLOAT32LE};
+    const uint32_t rates[][2] = {{44100, 44100}, {44100, 48000}, {48000, 44100}, {8000, 48000}, {22050, 16000}};
+    const uint8_t channels[][2] = {{2, 2}, {1, 2}, {2, 1}, {6, 2}};
+    srand(17);
+    for (pa_sample_format_t from : formats)
+    {
+        for (pa_sample_format_t to : formats)
+        {
+            for (const uint32_t *rate : rates)
+            {
+                for (const uint8_t *channel : channels)
+                {
+                    pa_sample_spec fromSpec = makeSpec(from, rate[0], channel[0]);
+                    pa_sample_spec toSpec = makeSpec(to, rate[1], channel[1]);
+                    //More than one internal block, so block boundaries are crossed as well
+                    std::vector<uint8_t> input = makeInput(fromSpec, 9001);
+
+                    PcmConverter whole;
+                    TEST_CHECK(whole.setup(fromSpec, toSpec));
+                    std::vector<uint8_t> expected;
+                    whole.convert(input.data(), input.size(), expected);
+
+                    PcmConverter chunked;
+                    TEST_CHECK(chunked.setup(fromSpec, toSpec));
+                    std::vector<uint8_t> output;
+                    bool bounded = true;
+                    for (size_t offset = 0; offset < input.size();)
+                    {
+                        size_t bytes = std::min(input.size() - offset, (size_t)(1 + rand() % 1500));
+                        size_t before = output.size();
+                        size_t bound = chunked.getMaxOutputSize(bytes);
+                        chunked.convert(input.data() + offset, bytes, output);
+                        bounded = bounded && (output.size() - before <= bound);
+                        offset += bytes;
+                    }
+                    TEST_CHECK(bounded);
+                    TEST_CHECK_EQ(output.size(), expected.size());
+                    if (output != expected)
+                        fprintf(stderr, "%s: format %d -> %d, %u -> %u Hz, %u -> %u channels differ when chunked\n",\
+                            cConverterPath, from, to, rate[0], rate[1], channel[0], channel[1]);
+                    TEST_CHECK(output == expected);
+                }
+            }
+        }
+    }
+}
+
+//S16 to float and back is exact for every sample value, the odd count runs the scalar tails
+static void testS16FloatRoundTrip()
+{
+    std::vector<int16_t> samples;
+    for (int value = -32768; value <= 32767; value++)
+        samples.push_back((int16_t)value);
+    samples.push_back(32767);
+    pa_sample_spec s16 = makeSpec(PA_SAMPLE_S16LE, 48000, 1);
+    pa_sample_spec f32 = makeSpec(PA_SAMPLE_FLOAT32LE, 48000, 1);
+
+    PcmConverter toFloat;
+    PcmConverter toS16;
+    TEST_CHECK(toFloat.setup(s16, f32));
+    TEST_CHECK(toS16.setup(f32, s16));
+    std::vector<uint8_t> floats;
+    std::vector<uint8_t> output;
+    toFloat.convert(samples.data(), samples.size() * 2, floats);
+    TEST_CHECK_EQ(floats.size(), samples.size() * 4);
+    float first;
+    memcpy(&first, floats.data(), sizeof(first));
+    TEST_CHECK(-1.0f == first);
+    toS16.convert(floats.data(), floats.size(), output);
+    TEST_CHECK_EQ(output.size(), samples.size() * 2);
+    TEST_CHECK(0 == memcmp(output.data(), samples.data(), samples.size() * 2));
+
+    //Floats out of range saturate, also beyond the int32 range of the SIMD conversion
+    const float clipped[] = {1.0f, 1.5f, 1e6f, 1e30f, -1.0f, -1.5f, -1e6f, -1e30f, 0.5f, -0.5f, 0.99998f};
+    const int16_t expected[] = {32767, 32767, 32767, 32767, -32768, -32768, -32768, -32768, 16384, -16384, 32767};
+    const size_t count = sizeof(clipped) / sizeof(clipped[0]);
+    //Each value goes once through a SIMD block and once through the tail
+    for (size_t shift = 0; shift < 8; shift++)
+    {
+        std::vector<float> input(8 + count, 0.0f);
+        for (size_t i = 0; i < count; i++)
+            input[(i + shift) % input.size()] = clipped[i];
+        std::vector<uint8_t> converted;
+        toS16.reset();
+        toS16.convert(input.data(), input.size() * sizeof(float), converted);
+        for (size_t i = 0; i < count; i++)
+        {
+            int16_t sample;
+            memcpy(&sample, converted.data() + (i + shift) % input.size() * 2, sizeof(sample));
+            TEST_CHECK_EQ(sample, expected[i]);
+        }
+    }
+}
+
+//The resampler emits an output frame for every output position before the last input frame,
+//however the input is split, and a ramp comes out as the same ramp at the new rate
+static void testResamplerContinuity()
+{
+    const uint32_t rates[][2] = {{44100, 48000}, {48000, 44100}, {8000, 48000}, {48000, 8000}, {44100, 44099}};
+    const size_t chunks[] = {1, 7, 441, 4096, 10000};
+    for (const uint32_t *rate : rates)
+    {
+        for (size_t chunk : chunks)
+        {
+            pa_sample_spec fromSpec = makeSpec(PA_SAMPLE_FLOAT32LE, rate[0], 1);
+            pa_sample_spec toSpec = makeSpec(PA_SAMPLE_FLOAT32LE, rate[1], 1);
+            PcmConverter converter;
+            TEST_CHECK(converter.setup(fromSpec, toSpec));
+            const size_t frames = 20000;
+            std::vector<float> input(frames);
+            for (size_t i = 0; i < frames; i++)
+                input[i] = (float)i / frames;
+            std::vector<uint8_t> output;
+            for (size_t offset = 0; offset < frames; offset += chunk)
+            {
+                size_t count = std::min(chunk, frames - offset);
+                converter.convert(input.data() + offset, count * sizeof(float), output);
+            }
+
+            uint64_t expectedFrames = ((uint64_t)(frames - 1) * rate[1] + rate[0] - 1) / rate[0];
+            TEST_CHECK_EQ(output.size() / sizeof(float), expectedFrames);
+            std::vector<float> resampled(output.size() / sizeof(float));
+            memcpy(resampled.data(), output.data(), output.size());
+            float worst = 0.0f;
+            for (size_t k = 0; k < resampled.size(); k++)
+            {
+                float position = (float)((double)k * rate[0] / rate[1] / frames);
+                worst = std::max(worst, fabsf(resampled[k] - position));
+            }
+            if (worst > 1e-6f)
+                fprintf(stderr, "%u -> %u Hz in chunks of %zu: ramp off by %g\n", rate[0], rate[1], chunk, worst);
+            TEST_CHECK(worst <= 1e-6f);
+        }
+    }
+}
+
+int main()
+{
+    printf("conversion path: %s\n", cConverterPath);
+    testChunkedConversion();
+    testS16FloatRoundTrip();
+    testResamplerContinuity();
+    return TEST_RESULT();
+}
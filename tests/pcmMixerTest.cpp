@@ -0,0 +1,152 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+
+#include "PcmMixer.h"
+#include "testUtils.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+//The same source is built once with PCM_MIXER_SCALAR, so both paths of the platform are checked
+#if defined(PCM_MIXER_SCALAR)
+static const char *cMixerPath = "scalar";
+#elif defined(__SSE2__)
+static const char *cMixerPath = "SSE2";
+#elif defined(__ARM_NEON)
+static const char *cMixerPath = "NEON";
+#else
+static const char *cMixerPath = "scalar";
+#endif
+
+//Guard samples around the mixed range, they must never be written
+static const size_t cGuard = 8;
+static const int16_t cGuardValue = 0x5a5a;
+
+static int16_t referenceMix(int16_t output, int16_t input, uint32_t gain)
+{
+    double scaled = input;
+    if (gain < PCM_MIXER_GAIN_UNITY)
+        scaled = floor((double)input * gain / PCM_MIXER_GAIN_UNITY);
+    return (int16_t)std::min(32767.0, std::max(-32768.0, output + scaled));
+}
+
+//Mixes input into output at offset, which moves the SIMD loads off their natural alignment,
+//and checks every sample against the reference and the guards around them
+static void checkMix(const std::vector<int16_t> &output, const std::vector<int16_t> &input, uint32_t gain, size_t offset)
+{
+    size_t samples = output.size();
+    std::vector<int16_t> mixed(samples + 2 * cGuard + offset, cGuardValue);
+    std::vector<int16_t> source(samples + offset);
+    std::copy(output.begin(), output.end(), mixed.begin() + cGuard + offset);
+    std::copy(input.begin(), input.end(), source.begin() + offset);
+    PcmMixer::mix(mixed.data() + cGuard + offset, source.data() + offset, samples, gain);
+    int mismatches = 0;
+    for (size_t i = 0; i < samples; i++)
+    {
+        int16_t expected = referenceMix(output[i], input[i], gain);
+        if (mixed[cGuard + offset + i] != expected && 0 == mismatches++)
+            fprintf(stderr, "%s: samples:%zu gain:%u offset:%zu sample %zu: %d + %d gave %d, expected %d\n",\
+                cMixerPath, samples, gain, offset, i, output[i], input[i], mixed[cGuard + offset + i], expected);
+    }
+    TEST_CHECK_EQ(mismatches, 0);
+    for (size_t i = 0; i < cGuard + offset; i++)
+        TEST_CHECK_EQ(mixed[i], cGuardValue);
+    for (size_t i = cGuard + offset + samples; i < mixed.size(); i++)
+        TEST_CHECK_EQ(mixed[i], cGuardValue);
+}
+
+static const uint32_t cGains[] = {0, 1, 2, 16383, 16384, 24576, 32766, 32767,\
+    PCM_MIXER_GAIN_UNITY, PCM_MIXER_GAIN_UNITY + 1, 65535};
+
+//Every length up to a few SIMD blocks, so each tail length of the 8 sample loops is hit
+static void testClipLimits()
+{
+    const int16_t limits[] = {-32768, -32767, -16384, -1, 0, 1, 16384, 32766, 32767};
+    const size_t count = sizeof(limits) / sizeof(limits[0]);
+    for (size_t samples = 0; samples <= 35; samples++)
+    {
+        //Every output limit meets every input limit somewhere in the buffer
+        std::vector<int16_t> output(samples);
+        std::vector<int16_t> input(samples);
+        for (size_t i = 0; i < samples; i++)
+        {
+            output[i] = limits[i % count];
+            input[i] = limits[(i / count + i) % count];
+        }
+        for (uint32_t gain : cGains)
+            for (size_t offset = 0; offset < 2; offset++)
+                checkMix(output, input, gain, offset);
+    }
+}
+
+//Every pair of output and input limits, so no combination depends on the buffer layout
+static void testAllLimitPairs()
+{
+    const int16_t limits[] = {-32768, -32767, -1, 0, 1, 32766, 32767};
+    std::vector<int16_t> output;
+    std::vector<int16_t> input;
+    for (int16_t a : limits)
+    {
+        for (int16_t b : limits)
+        {
+            output.push_back(a);
+            input.push_back(b);
+        }
+    }
+    //49 pairs, an odd tail after the 8 sample blocks
+    for (uint32_t gain : cGains)
+        checkMix(output, input, gain, 0);
+}
+
+static void testRandomSamples()
+{
+    srand(20);
+    for (int round = 0; round < 200; round++)
+    {
+        size_t samples = 1 + rand() % 257;
+        std::vector<int16_t> output(samples);
+        std::vector<int16_t> input(samples);
+        for (size_t i = 0; i < samples; i++)
+        {
+            output[i] = (int16_t)(rand() & 0xffff);
+            input[i] = (int16_t)(rand() & 0xffff);
+        }
+        checkMix(output, input, (uint32_t)(rand() % (PCM_MIXER_GAIN_UNITY + 1)), (size_t)(rand() % 2));
+    }
+}
+
+static void testGains()
+{
+    TEST_CHECK_EQ(PcmMixer::volumeToGain(-5), 0);
+    TEST_CHECK_EQ(PcmMixer::volumeToGain(50), PCM_MIXER_GAIN_UNITY / 2);
+    TEST_CHECK_EQ(PcmMixer::volumeToGain(100), PCM_MIXER_GAIN_UNITY);
+    TEST_CHECK_EQ(PcmMixer::volumeToGain(150), PCM_MIXER_GAIN_UNITY);
+    TEST_CHECK_EQ(PcmMixer::linearToGain(-1.0), 0);
+    TEST_CHECK_EQ(PcmMixer::linearToGain(0.5), PCM_MIXER_GAIN_UNITY / 2);
+    TEST_CHECK_EQ(PcmMixer::linearToGain(2.0), PCM_MIXER_GAIN_UNITY);
+}
+
+int main()
+{
+    printf("mix path: %s\n", cMixerPath);
+    testClipLimits();
+    testAllLimitPairs();
+    testRandomSamples();
+    testGains();
+    return TEST_RESULT();
+}
@@ -0,0 +1,194 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "PcmRamp.h"
+#include "testUtils.h"
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+//Gain of the ramp at t, 0 to 1, computed in double precision
+static double referenceGain(const PCM_RAMP_T &ramp, double t)
+{
+    double shape;
+    if (ePcmRampLinear == ramp.curve)
+        shape = t;
+    else if (ramp.to > ramp.from)
+        shape = sin(M_PI / 2 * t);
+    else
+        shape = 1 - cos(M_PI / 2 * t);
+    return ramp.from + ((double)ramp.to - (double)ramp.from) * shape;
+}
+
+//Largest distance in Q15 steps between the ramp gains and the reference
+static double maxGainError(PCM_RAMP_T ramp)
+{
+    double error = 0;
+    const uint32_t frames = ramp.frames;
+    for (; PcmRamp::isActive(ramp); ramp.position++)
+        error = std::max(error, fabs(PcmRamp::getGain(ramp) - referenceGain(ramp, (double)ramp.position / frames)));
+    return error;
+}
+
+static void testLinearEndpointsAndMidpoint()
+{
+    PCM_RAMP_T ramp;
+    PcmRamp::start(ramp, 0, PCM_MIXER_GAIN_UNITY, 256, ePcmRampLinear);
+    TEST_CHECK(PcmRamp::isActive(ramp));
+    TEST_CHECK_EQ(PcmRamp::getGain(ramp), 0);
+    ramp.position = 128;
+    TEST_CHECK_EQ(PcmRamp::getGain(ramp), PCM_MIXER_GAIN_UNITY / 2);
+    ramp.position = 256;
+    TEST_CHECK(!PcmRamp::isActive(ramp));
+    TEST_CHECK_EQ(PcmRamp::getGain(ramp), PCM_MIXER_GAIN_UNITY);
+
+    //Frame counts which do not divide the curve, both directions
+    PcmRamp::start(ramp, 0, PCM_MIXER_GAIN_UNITY, 441, ePcmRampLinear);
+    TEST_CHECK(maxGainError(ramp) <= 2);
+    PcmRamp::start(ramp, PCM_MIXER_GAIN_UNITY, 1000, 4800, ePcmRampLinear);
+    TEST_CHECK(maxGainError(ramp) <= 2);
+    //One second at 48 kHz must not fall short of its target before the last frame
+    PcmRamp::start(ramp, 0, PCM_MIXER_GAIN_UNITY, 48000, ePcmRampLinear);
+    TEST_CHECK(maxGainError(ramp) <= 2);
+}
+
+static void testEqualPowerEndpointsAndMidpoint()
+{
+    PCM_RAMP_T fadeIn, fadeOut;
+    PcmRamp::start(fadeIn, 0, PCM_MIXER_GAIN_UNITY, 480, ePcmRampEqualPower);
+    PcmRamp::start(fadeOut, PCM_MIXER_GAIN_UNITY, 0, 480, ePcmRampEqualPower);
+    TEST_CHECK_EQ(PcmRamp::getGain(fadeIn), 0);
+    TEST_CHECK_EQ(PcmRamp::getGain(fadeOut), PCM_MIXER_GAIN_UNITY);
+    TEST_CHECK(maxGainError(fadeIn) <= 2);
+    TEST_CHECK(maxGainError(fadeOut) <= 2);
+
+    //Half way both are at sin(pi/4), the power of a crossfade stays constant
+    fadeIn.position = fadeOut.position = 240;
+    const double half = PCM_MIXER_GAIN_UNITY * sqrt(0.5);
+    TEST_CHECK(fabs(PcmRamp::getGain(fadeIn) - half) <= 2);
+    TEST_CHECK(fabs(PcmRamp::getGain(fadeOut) - half) <= 2);
+    for (uint32_t i = 0; i < 480; i += 16)
+    {
+        fadeIn.position = fadeOut.position = i;
+        double in = PcmRamp::getGain(fadeIn) / (double)PCM_MIXER_GAIN_UNITY;
+        double out = PcmRamp::getGain(fadeOut) / (double)PCM_MIXER_GAIN_UNITY;
+        TEST_CHECK(fabs(in * in + out * out - 1) < 0.001);
+    }
+    fadeIn.position = fadeOut.position = 480;
+    TEST_CHECK_EQ(PcmRamp::getGain(fadeIn), PCM_MIXER_GAIN_UNITY);
+    TEST_CHECK_EQ(PcmRamp::getGain(fadeOut), 0);
+}
+
+//apply() must scale every sample by the gain of its frame, whatever the SIMD path
+static void testApplyMatchesGains()
+{
+    const uint8_t channels = 2;
+    const size_t frames = 1501;
+    std::vector<int16_t> pcm(frames * channels);
+    std::vector<float> pcmFloat(frames * channels);
+    for (size_t i = 0; i < pcm.size(); i++)
+    {
+        pcm[i] = (int16_t)((rand() % 65536) - 32768);
+        pcmFloat[i] = pcm[i] / 32768.0f;
+    }
+    const std::vector<int16_t> input = pcm;
+    const std::vector<float> inputFloat = pcmFloat;
+
+    PCM_RAMP_T ramp, rampFloat, expected;
+    PcmRamp::start(ramp, 0, PCM_MIXER_GAIN_UNITY, 1000, ePcmRampEqualPower);
+    rampFloat = expected = ramp;
+    //Odd chunks cross the SIMD widths, the ramp ends within the buffer
+    size_t done = 0;
+    for (size_t chunk : {7, 333, 1, 1024, 136})
+    {
+        PcmRamp::apply(ramp, pcm.data() + done * channels, chunk, PA_SAMPLE_S16LE, channels);
+        PcmRamp::apply(rampFloat, pcmFloat.data() + done * channels, chunk, PA_SAMPLE_FLOAT32LE, channels);
+        done += chunk;
+    }
+    TEST_CHECK_EQ(done, frames);
+
+    int mismatches = 0;
+    for (size_t f = 0; f < frames; f++, expected.position++)
+    {
+        int32_t gain = (int32_t)std::min(PcmRamp::getGain(expected), (uint32_t)32767);
+        if (!PcmRamp::isActive(expected))
+            gain = PCM_MIXER_GAIN_UNITY;
+        for (size_t c = 0; c < channels; c++)
+        {
+            size_t i = f * channels + c;
+            int16_t sample = (gain >= PCM_MIXER_GAIN_UNITY) ? input[i] : (int16_t)(((int32_t)input[i] * gain) >> 15);
+            float sampleFloat = (gain >= PCM_MIXER_GAIN_UNITY) ? inputFloat[i] : inputFloat[i] * ((float)gain / PCM_MIXER_GAIN_UNITY);
+            if (pcm[i] != sample || pcmFloat[i] != sampleFloat)
+                mismatches++;
+        }
+    }
+    TEST_CHECK_EQ(mismatches, 0);
+}
+
+static void testSaturation()
+{
+    //Gains above unity are clamped
+    PCM_RAMP_T ramp;
+    PcmRamp::start(ramp, 0, 4 * PCM_MIXER_GAIN_UNITY, 64, ePcmRampLinear);
+    TEST_CHECK_EQ(ramp.to, PCM_MIXER_GAIN_UNITY);
+
+    //Full scale samples never wrap, below unity the gain is at most 32767/32768
+    PcmRamp::start(ramp, PCM_MIXER_GAIN_UNITY - 1, PCM_MIXER_GAIN_UNITY, 64, ePcmRampLinear);
+    std::vector<int16_t> pcm(64);
+    for (size_t i = 0; i < pcm.size(); i++)
+        pcm[i] = (i % 2) ? 32767 : -32768;
+    PcmRamp::apply(ramp, pcm.data(), pcm.size(), PA_SAMPLE_S16LE, 1);
+    for (size_t i = 0; i < pcm.size(); i++)
+        TEST_CHECK((i % 2) ? pcm[i] == 32766 : pcm[i] == -32767);
+
+    std::vector<int32_t> pcm32 = {INT32_MIN, INT32_MAX, INT32_MIN, INT32_MAX};
+    PcmRamp::start(ramp, PCM_MIXER_GAIN_UNITY, PCM_MIXER_GAIN_UNITY - 1, 4, ePcmRampLinear);
+    PcmRamp::apply(ramp, pcm32.data(), 2, PA_SAMPLE_S32LE, 2);
+    TEST_CHECK(pcm32[0] < 0 && pcm32[1] > 0 && pcm32[2] < 0 && pcm32[3] > 0);
+
+    //A finished fade out leaves silence, a finished fade in leaves the data as is
+    std::vector<int16_t> tail = {1000, -1000, 32767};
+    PcmRamp::start(ramp, PCM_MIXER_GAIN_UNITY, 0, 0, ePcmRampLinear);
+    PcmRamp::apply(ramp, tail.data(), tail.size(), PA_SAMPLE_S16LE, 1);
+    TEST_CHECK(tail[0] == 0 && tail[1] == 0 && tail[2] == 0);
+    tail = {1000, -1000, 32767};
+    PcmRamp::start(ramp, 0, PCM_MIXER_GAIN_UNITY, 0, ePcmRampLinear);
+    PcmRamp::apply(ramp, tail.data(), tail.size(), PA_SAMPLE_S16LE, 1);
+    TEST_CHECK(tail[0] == 1000 && tail[1] == -1000 && tail[2] == 32767);
+}
+
+static void testRetargetKeepsGain()
+{
+    PCM_RAMP_T ramp;
+    PcmRamp::start(ramp, 0, PCM_MIXER_GAIN_UNITY, 1000, ePcmRampEqualPower);
+    ramp.position = 300;
+    uint32_t reached = PcmRamp::getGain(ramp);
+    PcmRamp::retarget(ramp, 0, 500);
+    TEST_CHECK_EQ(PcmRamp::getGain(ramp), reached);
+    TEST_CHECK_EQ(ramp.curve, ePcmRampEqualPower);
+    ramp.position = 500;
+    TEST_CHECK_EQ(PcmRamp::getGain(ramp), 0);
+}
+
+int main()
+{
+    testLinearEndpointsAndMidpoint();
+    testEqualPowerEndpointsAndMidpoint();
+    testApplyMatchesGains();
+    testSaturation();
+    testRetargetKeepsGain();
+    return TEST_RESULT();
+}
@@ -0,0 +1,81 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "PulseReplyTracker.h"
+#include "testUtils.h"
+
+static void testInOrderReplies()
+{
+    PulseReplyTracker tracker;
+    uint32_t first = tracker.add(7, 100);
+    uint32_t second = tracker.add(7, 100);
+    uint32_t other = tracker.add(9, 100);
+    TEST_CHECK_EQ(tracker.complete(7), first);
+    TEST_CHECK_EQ(tracker.complete(9), other);
+    TEST_CHECK_EQ(tracker.complete(7), second);
+    TEST_CHECK_EQ(tracker.complete(7), 0);
+    TEST_CHECK(tracker.empty());
+}
+
+static void testLateReplyAfterTimeout()
+{
+    PulseReplyTracker tracker;
+    //reply -> timeout -> late reply -> next reply
+    uint32_t answered = tracker.add(7, 100);
+    TEST_CHECK_EQ(tracker.complete(7), answered);
+    uint32_t expired = tracker.add(7, 200);
+    std::vector<uint32_t> failed = tracker.expire(200);
+    TEST_CHECK_EQ(failed.size(), 1);
+    TEST_CHECK(!failed.empty() && failed[0] == expired);
+    uint32_t next = tracker.add(7, 500);
+    //The late reply belongs to the expired request, not to next
+    TEST_CHECK_EQ(tracker.complete(7), 0);
+    TEST_CHECK_EQ(tracker.getLateReplies(), 1);
+    TEST_CHECK_EQ(tracker.complete(7), next);
+    TEST_CHECK(tracker.empty());
+}
+
+static void testExpiryIsPerReplyID()
+{
+    PulseReplyTracker tracker;
+    tracker.add(7, 100);
+    uint32_t other = tracker.add(9, 300);
+    TEST_CHECK_EQ(tracker.expire(150).size(), 1);
+    TEST_CHECK_EQ(tracker.complete(9), other);
+    TEST_CHECK_EQ(tracker.complete(7), 0);
+    TEST_CHECK_EQ(tracker.getLateReplies(), 1);
+}
+
+static void testClearDropsOwedReplies()
+{
+    PulseReplyTracker tracker;
+    tracker.add(7, 100);
+    tracker.expire(100);
+    tracker.add(7, 500);
+    TEST_CHECK_EQ(tracker.clear().size(), 1);
+    //A new connection owes nothing for the old one
+    uint32_t fresh = tracker.add(7, 900);
+    TEST_CHECK_EQ(tracker.complete(7), fresh);
+}
+
+int main()
+{
+    testInOrderReplies();
+    testLateReplyAfterTimeout();
+    testExpiryIsPerReplyID();
+    testClearDropsOwedReplies();
+    return TEST_RESULT();
+}
@@ -0,0 +1,47 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef AUDIOD_TEST_UTILS_H_
+#define AUDIOD_TEST_UTILS_H_
+
+// Minimal checks for the host tests, a test returns the number of failed checks from main
+
+#include <cstdio>
+
+static int gTestFailures = 0;
+
+#define TEST_CHECK(cond) \
+    do { \
+        if (!(cond)) { \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+            gTestFailures++; \
+        } \
+    } while (0)
+
+#define TEST_CHECK_EQ(a, b) \
+    do { \
+        long long valueA = (long long)(a); \
+        long long valueB = (long long)(b); \
+        if (valueA != valueB) { \
+            fprintf(stderr, "%s:%d: check failed: %s == %s (%lld != %lld)\n", __FILE__, __LINE__, #a, #b, valueA, valueB); \
+            gTestFailures++; \
+        } \
+    } while (0)
+
+#define TEST_RESULT() \
+    (printf("%s: %s\n", __FILE__, gTestFailures ? "FAILED" : "passed"), gTestFailures ? 1 : 0)
+
+#endif /* AUDIOD_TEST_UTILS_H_ */
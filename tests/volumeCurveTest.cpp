@@ -0,0 +1,113 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+
+#include "VolumeCurve.h"
+#include "PcmMixer.h"
+#include "testUtils.h"
+#include <string>
+
+//Gain the playback engine applies for step of the curve of name
+static uint32_t getGain(const std::string &name, int step)
+{
+    return PcmMixer::linearToGain(pa_sw_volume_to_linear(VolumeCurve::getVolume(name, step)));
+}
+
+//Checks a curve the way setCurve loaded it, every step must raise the volume
+static void checkCurve(const std::string &name)
+{
+    TEST_CHECK_EQ(VolumeCurve::getVolume(name, 0), PA_VOLUME_MUTED);
+    TEST_CHECK_EQ(getGain(name, 0), 0);
+    TEST_CHECK(VolumeCurve::getVolume(name, VOLUME_CURVE_MAX_STEP) <= PA_VOLUME_NORM);
+    for (int step = 1; step <= VOLUME_CURVE_MAX_STEP; step++)
+    {
+        if (VolumeCurve::getVolume(name, step) <= VolumeCurve::getVolume(name, step - 1))
+            fprintf(stderr, "%s: step %d does not raise the volume\n", name.c_str(), step);
+        TEST_CHECK(VolumeCurve::getVolume(name, step) > VolumeCurve::getVolume(name, step - 1));
+        TEST_CHECK(getGain(name, step) >= getGain(name, step - 1));
+    }
+    //Out of range steps are clamped
+    TEST_CHECK_EQ(VolumeCurve::getVolume(name, -1), VolumeCurve::getVolume(name, 0));
+    TEST_CHECK_EQ(VolumeCurve::getVolume(name, 101), VolumeCurve::getVolume(name, VOLUME_CURVE_MAX_STEP));
+}
+
+//Loads every volumeCurve of a stream policy config as AudioPolicyManager does
+static int loadConfigCurves(const char *path)
+{
+    pbnjson::JValue config = pbnjson::JDomParser::fromFile(path, pbnjson::JSchema::AllSchema());
+    TEST_CHECK(config["streamDetails"].isArray());
+    int count = 0;
+    for (const pbnjson::JValue &stream : config["streamDetails"].items())
+    {
+        std::string streamType;
+        if (!stream.hasKey("volumeCurve") || stream["streamType"].asString(streamType) != CONV_OK)
+            continue;
+        TEST_CHECK(VolumeCurve::setCurve(streamType, stream["volumeCurve"]));
+        TEST_CHECK(VolumeCurve::hasCurve(streamType));
+        checkCurve(streamType);
+        count++;
+    }
+    return count;
+}
+
+static bool setCurve(const std::string &name, const char *curve)
+{
+    return VolumeCurve::setCurve(name, pbnjson::JDomParser::fromString(curve));
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        fprintf(stderr, "usage: %s <stream policy config>\n", argv[0]);
+        return 1;
+    }
+    TEST_CHECK_EQ(loadConfigCurves(argv[1]), 4);
+
+    //-50 dB to 0 dB, every step of the log curve is a distinct gain
+    TEST_CHECK_EQ(VolumeCurve::getVolume("palerts", 1), VolumeCurve::fromDb(-50.0));
+    TEST_CHECK_EQ(VolumeCurve::getVolume("palerts", VOLUME_CURVE_MAX_STEP), PA_VOLUME_NORM);
+    TEST_CHECK_EQ(getGain("palerts", VOLUME_CURVE_MAX_STEP), PCM_MIXER_GAIN_UNITY);
+    for (int step = 2; step <= VOLUME_CURVE_MAX_STEP; step++)
+        TEST_CHECK(getGain("palerts", step) > getGain("palerts", step - 1));
+    //The piecewise curve goes through its points, -3 dB is about 0.708 in amplitude
+    TEST_CHECK_EQ(VolumeCurve::getVolume("pfeedback", 30), VolumeCurve::fromDb(-40.0));
+    TEST_CHECK_EQ(VolumeCurve::getVolume("pfeedback", 70), VolumeCurve::fromDb(-15.0));
+    TEST_CHECK(getGain("pfeedback", VOLUME_CURVE_MAX_STEP) >= 23190 && getGain("pfeedback", VOLUME_CURVE_MAX_STEP) <= 23200);
+    //A linear curve is the percent of PA_VOLUME_NORM, what Pulse gets for a sink input
+    for (int step = 0; step <= VOLUME_CURVE_MAX_STEP; step++)
+        TEST_CHECK_EQ(VolumeCurve::getVolume("pdefaultapp", step), VolumeCurve::makeLinear().volume[step]);
+
+    //Names without a curve use the linear one, the engine keeps its percent gain for them
+    TEST_CHECK(!VolumeCurve::hasCurve("noCurve"));
+    checkCurve("noCurve");
+    TEST_CHECK_EQ(VolumeCurve::getVolume("noCurve", 50), VolumeCurve::makeLinear().volume[50]);
+
+    //Curves where steps give the same volume are rejected and the previous curve stays
+    TEST_CHECK(!setCurve("palerts", "{\"type\":\"piecewise\", \"points\":[{\"step\":1, \"dB\":-40}, {\"step\":50, \"dB\":-20}, {\"step\":100, \"dB\":-20}]}"));
+    TEST_CHECK(!setCurve("palerts", "{\"type\":\"piecewise\", \"points\":[{\"step\":10, \"dB\":-40}, {\"step\":100, \"dB\":0}]}"));
+    TEST_CHECK(!setCurve("palerts", "{\"type\":\"log\", \"minDb\":-120, \"maxDb\":0}"));
+    TEST_CHECK_EQ(VolumeCurve::getVolume("palerts", 1), VolumeCurve::fromDb(-50.0));
+
+    //Invalid definitions are rejected without adding a curve
+    TEST_CHECK(!setCurve("invalid", "{\"type\":\"log\", \"minDb\":0, \"maxDb\":-10}"));
+    TEST_CHECK(!setCurve("invalid", "{\"type\":\"cubic\"}"));
+    TEST_CHECK(!setCurve("invalid", "{\"type\":\"piecewise\", \"points\":[{\"step\":1, \"dB\":-40}]}"));
+    TEST_CHECK(!setCurve("invalid", "{\"type\":\"piecewise\", \"points\":[{\"step\":50, \"dB\":-10}, {\"step\":20, \"dB\":-5}]}"));
+    TEST_CHECK(!VolumeCurve::hasCurve("invalid"));
+
+    return TEST_RESULT();
+}
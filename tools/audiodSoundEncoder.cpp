@@ -0,0 +1,119 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+// Host tool compressing the raw S16LE system sounds to IMA-ADPCM at build time.
+// usage: audiod-sound-encoder [-r rate] [-c channels] input.pcm output.adpcm
+// It prints the size saved, the quality and the time taken to decode the sound.
+
+#include "ImaAdpcm.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+static bool readFile(const char *path, std::vector<uint8_t> &data)
+{
+    FILE *file = fopen(path, "rb");
+    if (!file)
+        return false;
+    uint8_t buffer[4096];
+    size_t len;
+    while ((len = fread(buffer, 1, sizeof(buffer), file)) > 0)
+        data.insert(data.end(), buffer, buffer + len);
+    bool status = !ferror(file);
+    fclose(file);
+    return status;
+}
+
+static bool writeFile(const char *path, const std::vector<uint8_t> &data)
+{
+    FILE *file = fopen(path, "wb");
+    if (!file)
+        return false;
+    bool status = (fwrite(data.data(), 1, data.size(), file) == data.size());
+    return (0 == fclose(file)) && status;
+}
+
+int main(int argc, char *argv[])
+{
+    uint32_t rate = 44100;
+    uint16_t channels = 1;
+    int arg = 1;
+    for (; arg + 1 < argc && '-' == argv[arg][0]; arg += 2)
+    {
+        if (0 == strcmp(argv[arg], "-r"))
+            rate = (uint32_t)atoi(argv[arg + 1]);
+        else if (0 == strcmp(argv[arg], "-c"))
+            channels = (uint16_t)atoi(argv[arg + 1]);
+        else
+            break;
+    }
+    if (argc - arg != 2 || 0 == rate || 0 == channels || channels > IMA_ADPCM_MAX_CHANNELS)
+    {
+        fprintf(stderr, "usage: %s [-r rate] [-c channels] input.pcm output%s\n", argv[0], IMA_ADPCM_FILE_EXTENSION);
+        return 1;
+    }
+    const char *input = argv[arg];
+    const char *output = argv[arg + 1];
+
+    std::vector<uint8_t> pcm;
+    if (!readFile(input, pcm))
+    {
+        fprintf(stderr, "%s: cannot read %s\n", argv[0], input);
+        return 1;
+    }
+    //Raw PCM has no header, a size that is not whole frames means the format given is wrong
+    size_t frameSize = channels * sizeof(int16_t);
+    if (0 != pcm.size() % frameSize)
+    {
+        fprintf(stderr, "%s: %s is %zu bytes, not whole frames of %u channels\n", argv[0], input, pcm.size(), channels);
+        return 1;
+    }
+    size_t frames = pcm.size() / frameSize;
+    std::vector<int16_t> samples(frames * channels);
+    if (!samples.empty())
+        memcpy(samples.data(), pcm.data(), samples.size() * sizeof(int16_t));
+
+    std::vector<uint8_t> encoded;
+    ImaAdpcm::encode(samples.data(), frames, channels, rate, encoded);
+    if (!writeFile(output, encoded))
+    {
+        fprintf(stderr, "%s: cannot write %s\n", argv[0], output);
+        return 1;
+    }
+
+    std::vector<uint8_t> decoded;
+    auto start = std::chrono::steady_clock::now();
+    ImaAdpcm::decode(encoded.data(), encoded.size(), decoded);
+    double decodeUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+
+    double signal = 0.0, noise = 0.0;
+    const int16_t *result = (const int16_t*)decoded.data();
+    for (size_t i = 0; i < samples.size(); i++)
+    {
+        signal += (double)samples[i] * samples[i];
+        noise += ((double)samples[i] - result[i]) * ((double)samples[i] - result[i]);
+    }
+    double seconds = (double)frames / rate;
+    printf("%s: %zu -> %zu bytes (%.1f%% saved), SNR %.1f dB, decode %.0f us (%.1f us per second of audio)\n",
+        output, pcm.size(), encoded.size(),
+        pcm.empty() ? 0.0 : 100.0 * (1.0 - (double)encoded.size() / pcm.size()),
+        noise > 0.0 ? 10.0 * log10(signal / noise) : INFINITY,
+        decodeUs, seconds > 0.0 ? decodeUs / seconds : 0.0);
+    return 0;
+}
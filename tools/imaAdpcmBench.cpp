@@ -0,0 +1,136 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+// Host benchmark of the IMA-ADPCM codec used for the system sounds.
+// usage: audiod-ima-adpcm-bench [-r runs] [-s rate] [-c channels] [file.pcm]
+// The file is raw S16LE in the given format, 44.1 kHz mono like the system
+// sounds by default. Without a file 10 s of a tone are generated. It prints
+// the size saved, the SNR, and the time to encode and decode per second of
+// audio, which is what preloading and streaming a sound costs on the device.
+
+#include "ImaAdpcm.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+static bool readFile(const char *path, std::vector<uint8_t> &data)
+{
+    FILE *file = fopen(path, "rb");
+    if (!file)
+        return false;
+    uint8_t buffer[4096];
+    size_t len;
+    while ((len = fread(buffer, 1, sizeof(buffer), file)) > 0)
+        data.insert(data.end(), buffer, buffer + len);
+    bool status = !ferror(file);
+    fclose(file);
+    return status;
+}
+
+//Best of runs, in microseconds
+template <typename F>
+static double timeBest(int runs, F function)
+{
+    double best = INFINITY;
+    for (int i = 0; i < runs; i++)
+    {
+        auto start = std::chrono::steady_clock::now();
+        function();
+        best = std::min(best, std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count());
+    }
+    return best;
+}
+
+int main(int argc, char *argv[])
+{
+    int runs = 20;
+    uint32_t rate = 44100;
+    uint16_t channels = 1;
+    int arg = 1;
+    for (; arg + 1 < argc && '-' == argv[arg][0]; arg += 2)
+    {
+        if (0 == strcmp(argv[arg], "-r"))
+            runs = atoi(argv[arg + 1]);
+        else if (0 == strcmp(argv[arg], "-s"))
+            rate = (uint32_t)atoi(argv[arg + 1]);
+        else if (0 == strcmp(argv[arg], "-c"))
+            channels = (uint16_t)atoi(argv[arg + 1]);
+        else
+            break;
+    }
+    if (argc - arg > 1 || runs <= 0 || 0 == rate || 0 == channels || channels > IMA_ADPCM_MAX_CHANNELS)
+    {
+        fprintf(stderr, "usage: %s [-r runs] [-s rate] [-c channels] [file.pcm]\n", argv[0]);
+        return 1;
+    }
+
+    std::vector<int16_t> pcm;
+    if (arg < argc)
+    {
+        std::vector<uint8_t> data;
+        if (!readFile(argv[arg], data))
+        {
+            fprintf(stderr, "%s: cannot read %s\n", argv[0], argv[arg]);
+            return 1;
+        }
+        pcm.resize(data.size() / (channels * sizeof(int16_t)) * channels);
+        if (!pcm.empty())
+            memcpy(pcm.data(), data.data(), pcm.size() * sizeof(int16_t));
+    }
+    else
+    {
+        pcm.resize((size_t)rate * 10 * channels);
+        for (size_t i = 0; i < pcm.size(); i++)
+            pcm[i] = (int16_t)(16000.0 * sin(2.0 * M_PI * 440.0 * (i / channels) / rate * (1 + i % channels)));
+    }
+    size_t frames = pcm.size() / channels;
+    if (0 == frames)
+    {
+        fprintf(stderr, "%s: no audio to encode\n", argv[0]);
+        return 1;
+    }
+
+    std::vector<uint8_t> encoded;
+    double encodeUs = timeBest(runs, [&]() {
+        encoded.clear();
+        ImaAdpcm::encode(pcm.data(), frames, channels, rate, encoded);
+    });
+    std::vector<uint8_t> decoded;
+    double decodeUs = timeBest(runs, [&]() {
+        decoded.clear();
+        ImaAdpcm::decode(encoded.data(), encoded.size(), decoded);
+    });
+
+    double signal = 0.0, noise = 0.0;
+    const int16_t *result = (const int16_t*)decoded.data();
+    for (size_t i = 0; i < pcm.size(); i++)
+    {
+        signal += (double)pcm[i] * pcm[i];
+        noise += ((double)pcm[i] - result[i]) * ((double)pcm[i] - result[i]);
+    }
+    double seconds = (double)frames / rate;
+    size_t rawBytes = pcm.size() * sizeof(int16_t);
+    printf("%zu frames, %u Hz, %u channels, best of %d runs\n", frames, rate, channels, runs);
+    printf("size    %zu -> %zu bytes (%.1f%% saved)\n", rawBytes, encoded.size(), 100.0 * (1.0 - (double)encoded.size() / rawBytes));
+    printf("SNR     %.1f dB\n", noise > 0.0 ? 10.0 * log10(signal / noise) : INFINITY);
+    printf("encode  %9.0f us, %7.1f us per second of audio, %7.1f MB/s\n", encodeUs, encodeUs / seconds, rawBytes / encodeUs);
+    printf("decode  %9.0f us, %7.1f us per second of audio, %7.1f MB/s\n", decodeUs, decodeUs / seconds, rawBytes / decodeUs);
+    return 0;
+}
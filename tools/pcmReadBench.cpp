@@ -0,0 +1,231 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+// Host benchmark of the two ways playback reads a PCM file.
+// usage: audiod-pcm-read-bench [-r runs] [file.pcm]
+// "fread" is the 1 KB stdio loop the playback threads used, "mmap" maps the
+// file like PcmFileSource and copies one mix chunk at a time. Each reader is
+// timed with the file in the page cache (warm) and after it was dropped from
+// it (cold). A mix chunk whose data took longer to read than it lasts would
+// have been an underrun. Without a file 10 s of 48 kHz stereo S16LE is written.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+//Same values as PulsePlaybackEngine and the old playback loop
+#define BENCH_RATE 48000
+#define BENCH_FRAME_SIZE 4
+#define BENCH_CHUNK_BYTES (1024 * BENCH_FRAME_SIZE)
+#define BENCH_FREAD_BYTES 1024
+
+typedef struct readStats
+{
+    double wallMs;
+    double cpuMs;
+    long readCalls;
+    long faults;
+    long lateChunks;
+    double maxChunkUs;
+}READ_STATS_T;
+
+//Read syscalls of the process, -1 if /proc/self/io cannot be read
+static long getReadSyscalls()
+{
+    FILE *file = fopen("/proc/self/io", "r");
+    if (!file)
+        return -1;
+    char line[128];
+    long count = -1;
+    while (fgets(line, sizeof(line), file))
+    {
+        if (1 == sscanf(line, "syscr: %ld", &count))
+            break;
+    }
+    fclose(file);
+    return count;
+}
+
+static double cpuMs(const struct rusage &usage)
+{
+    return (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1e3 + (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e3;
+}
+
+static void dropCache(const char *path)
+{
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return;
+    fdatasync(fd);
+    posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    close(fd);
+}
+
+class ChunkClock
+{
+public:
+    ChunkClock(READ_STATS_T &stats) : mStats(stats), mStart(std::chrono::steady_clock::now()) {}
+    void chunkDone()
+    {
+        auto now = std::chrono::steady_clock::now();
+        double us = std::chrono::duration<double, std::micro>(now - mStart).count();
+        mStats.maxChunkUs = std::max(mStats.maxChunkUs, us);
+        if (us > 1e6 * BENCH_CHUNK_BYTES / BENCH_FRAME_SIZE / BENCH_RATE)
+            mStats.lateChunks++;
+        mStart = now;
+    }
+
+private:
+    READ_STATS_T &mStats;
+    std::chrono::steady_clock::time_point mStart;
+};
+
+static size_t readWithFread(const char *path, uint8_t *chunk, READ_STATS_T &stats)
+{
+    FILE *file = fopen(path, "r");
+    if (!file)
+        return 0;
+    size_t total = 0;
+    size_t filled = 0;
+    size_t len;
+    ChunkClock clock(stats);
+    while ((len = fread(chunk + filled, 1, BENCH_FREAD_BYTES, file)) > 0)
+    {
+        total += len;
+        filled += len;
+        if (filled == BENCH_CHUNK_BYTES)
+        {
+            clock.chunkDone();
+            filled = 0;
+        }
+    }
+    fclose(file);
+    return total;
+}
+
+static size_t readWithMmap(const char *path, uint8_t *chunk, READ_STATS_T &stats)
+{
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return 0;
+    struct stat fileStat;
+    if (0 != fstat(fd, &fileStat) || fileStat.st_size <= 0)
+    {
+        close(fd);
+        return 0;
+    }
+    size_t length = (size_t)fileStat.st_size;
+    void *data = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (MAP_FAILED == data)
+        return 0;
+    madvise(data, length, MADV_SEQUENTIAL);
+    madvise(data, length, MADV_WILLNEED);
+    ChunkClock clock(stats);
+    for (size_t offset = 0; offset < length; offset += BENCH_CHUNK_BYTES)
+    {
+        memcpy(chunk, (const uint8_t*)data + offset, std::min<size_t>(BENCH_CHUNK_BYTES, length - offset));
+        clock.chunkDone();
+    }
+    munmap(data, length);
+    return length;
+}
+
+static READ_STATS_T run(size_t (*reader)(const char*, uint8_t*, READ_STATS_T&), const char *path, bool cold, int runs)
+{
+    READ_STATS_T stats = {};
+    std::vector<uint8_t> chunk(BENCH_CHUNK_BYTES);
+    for (int i = 0; i < runs; i++)
+    {
+        if (cold)
+            dropCache(path);
+        struct rusage before, after;
+        long calls = getReadSyscalls();
+        getrusage(RUSAGE_SELF, &before);
+        auto start = std::chrono::steady_clock::now();
+        reader(path, chunk.data(), stats);
+        stats.wallMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        getrusage(RUSAGE_SELF, &after);
+        stats.cpuMs += cpuMs(after) - cpuMs(before);
+        stats.faults += (after.ru_minflt - before.ru_minflt) + (after.ru_majflt - before.ru_majflt);
+        stats.readCalls += (calls < 0) ? 0 : getReadSyscalls() - calls - 1;
+    }
+    stats.wallMs /= runs;
+    stats.cpuMs /= runs;
+    stats.readCalls /= runs;
+    stats.faults /= runs;
+    return stats;
+}
+
+static void print(const char *name, const READ_STATS_T &stats)
+{
+    printf("%-11s %8.2f %8.2f %10ld %7ld %6ld %9.0f\n", name, stats.wallMs, stats.cpuMs, stats.readCalls, stats.faults,
+        stats.lateChunks, stats.maxChunkUs);
+}
+
+int main(int argc, char *argv[])
+{
+    int runs = 20;
+    int arg = 1;
+    if (arg + 1 < argc && 0 == strcmp(argv[arg], "-r"))
+    {
+        runs = atoi(argv[arg + 1]);
+        arg += 2;
+    }
+    if (arg + 1 < argc || runs <= 0)
+    {
+        fprintf(stderr, "usage: %s [-r runs] [file.pcm]\n", argv[0]);
+        return 1;
+    }
+    char tempFile[] = "/tmp/audiod-read-bench-XXXXXX";
+    const char *path = (arg < argc) ? argv[arg] : nullptr;
+    if (!path)
+    {
+        int fd = mkstemp(tempFile);
+        if (fd < 0)
+            return 1;
+        std::vector<uint8_t> data(10 * BENCH_RATE * BENCH_FRAME_SIZE);
+        for (size_t i = 0; i < data.size(); i++)
+            data[i] = (uint8_t)(i * 7);
+        bool status = (write(fd, data.data(), data.size()) == (ssize_t)data.size());
+        close(fd);
+        if (!status)
+        {
+            unlink(tempFile);
+            return 1;
+        }
+        path = tempFile;
+    }
+
+    printf("%d runs, averages per file read, late chunks summed over all runs\n", runs);
+    printf("reader      wall ms   cpu ms  read calls  faults  late  max chunk us\n");
+    print("fread warm", run(readWithFread, path, false, runs));
+    print("mmap warm", run(readWithMmap, path, false, runs));
+    print("fread cold", run(readWithFread, path, true, runs));
+    print("mmap cold", run(readWithMmap, path, true, runs));
+
+    if (path == tempFile)
+        unlink(tempFile);
+    return 0;
+}
@@ -0,0 +1,292 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+// Stress tool of PulsePlaybackEngine, run against a live pulseaudio server.
+// usage: audiod-playback-stress [-n clips] [-i interval ms] [-l clip ms] [-s sink] [file.pcm]
+// It starts hundreds of short clips which overlap on one sink and reports the
+// cost of play(), the playbacks active at once, the plays rejected when the
+// stream pool is full, errors and the CPU time used. The playbacks of a sink
+// share one pulse stream, so the playbacks active at once are the concurrent
+// streams clients see. It also reports the underruns pulse signalled on that
+// stream, the start latency from play() to the first frame heard and the
+// latency of the stream, both from the timing of getPlaybackStatus(). Without
+// a file a 48 kHz stereo S16LE tone is generated.
+
+#include "PulsePlaybackEngine.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <set>
+#include <sys/resource.h>
+#include <unistd.h>
+
+#define STRESS_RATE 48000
+#define STRESS_CHANNELS 2
+//Period of the timing samples, bounds the resolution of the start latency
+#define STRESS_TIMING_INTERVAL_MS 2
+
+class StressClient : public MixerInterface
+{
+public:
+    StressClient() : mStarted(0), mRejected(0), mFinished(0), mErrors(0), mActive(0), mMaxActive(0),
+                     mPlayNs(0), mMaxPlayNs(0), mHeard(0), mStartMs(0), mMaxStartMs(0),
+                     mLatencySamples(0), mLatencyMs(0), mMaxLatencyMs(0)
+    {
+    }
+
+    void callBackSinkStatus(const std::string& source, const std::string& sink, EVirtualAudioSink audioSink, \
+        utils::ESINK_STATUS sinkStatus, utils::EMIXER_TYPE mixerType, const int& sinkIndex, const std::string& trackId) {}
+    void callBackSourceStatus(const std::string& source, const std::string& sink, EVirtualSource audioSource, \
+        utils::ESINK_STATUS sourceStatus, utils::EMIXER_TYPE mixerType) {}
+    void callBackMixerStatus(const bool& mixerStatus, utils::EMIXER_TYPE mixerType) {}
+    void callBackMasterVolumeStatus() {}
+    void callBackDeviceConnectionStatus(const std::string &deviceName, const std::string &deviceNameDetail, \
+        const std::string &deviceIcon, utils::E_DEVICE_STATUS deviceStatus, utils::EMIXER_TYPE mixerType, const bool& isOutput) {}
+
+    void callBackPlaybackStatusChanged(const std::string &playbackId, const std::string &state, int item)
+    {
+        //Only the state of the whole playback, not of its queued items
+        if (-1 != item)
+            return;
+        if ("stopped" == state || "error" == state)
+        {
+            if ("error" == state)
+                mErrors++;
+            mFinished++;
+            if (mActive > 0)
+                mActive--;
+            mPlaybacks.erase(playbackId);
+            mWaiting.erase(playbackId);
+        }
+    }
+
+    void started(const std::string &playbackId, double playNs, std::chrono::steady_clock::time_point start)
+    {
+        mStarted++;
+        mActive++;
+        mMaxActive = std::max(mMaxActive, mActive);
+        mPlayNs += playNs;
+        mMaxPlayNs = std::max(mMaxPlayNs, playNs);
+        mPlaybacks.insert(playbackId);
+        mWaiting[playbackId] = start;
+    }
+
+    //Samples the timing of the active playbacks, a playback is heard once its position moves
+    void sampleTiming(PulsePlaybackEngine *engine)
+    {
+        auto now = std::chrono::steady_clock::now();
+        bool latencySampled = false;
+        for (const auto &playbackId : mPlaybacks)
+        {
+            PLAYBACK_TIMING_T timing = {};
+            if (engine->getPlaybackStatus(playbackId, &timing).empty())
+                continue;
+            //Every playback of the sink is written to the same stream, one latency sample is enough
+            if (!latencySampled && timing.latency > 0)
+            {
+                double latencyMs = timing.latency / 1000.0;
+                mLatencySamples++;
+                mLatencyMs += latencyMs;
+                mMaxLatencyMs = std::max(mMaxLatencyMs, latencyMs);
+                latencySampled = true;
+            }
+            auto waiting = mWaiting.find(playbackId);
+            if (waiting != mWaiting.end() && timing.positionFrames > 0)
+            {
+                double startMs = std::chrono::duration<double, std::milli>(now - waiting->second).count();
+                mHeard++;
+                mStartMs += startMs;
+                mMaxStartMs = std::max(mMaxStartMs, startMs);
+                mWaiting.erase(waiting);
+            }
+        }
+    }
+
+    int mStarted;
+    int mRejected;
+    int mFinished;
+    int mErrors;
+    int mActive;
+    int mMaxActive;
+    double mPlayNs;
+    double mMaxPlayNs;
+    //Playbacks heard, with their latency from play() to the first frame heard
+    int mHeard;
+    double mStartMs;
+    double mMaxStartMs;
+    int mLatencySamples;
+    double mLatencyMs;
+    double mMaxLatencyMs;
+    std::set<std::string> mPlaybacks;
+    //Playbacks not heard yet, with the time play() was called
+    std::map<std::string, std::chrono::steady_clock::time_point> mWaiting;
+};
+
+typedef struct stressRun
+{
+    PulsePlaybackEngine *engine;
+    StressClient *client;
+    GMainLoop *loop;
+    const char *fileName;
+    const char *sink;
+    int clips;
+    int requested;
+}STRESS_RUN_T;
+
+static bool writeTone(const char *path, int milliseconds)
+{
+    FILE *file = fopen(path, "wb");
+    if (!file)
+        return false;
+    int frames = STRESS_RATE * milliseconds / 1000;
+    bool status = true;
+    for (int i = 0; i < frames && status; i++)
+    {
+        int16_t sample = (int16_t)(8000 * sin(2 * M_PI * 440 * i / STRESS_RATE));
+        int16_t frame[STRESS_CHANNELS] = {sample, sample};
+        status = (fwrite(frame, sizeof(frame), 1, file) == 1);
+    }
+    return (0 == fclose(file)) && status;
+}
+
+static gboolean _startClip(gpointer data)
+{
+    STRESS_RUN_T *run = (STRESS_RUN_T*)data;
+    auto start = std::chrono::steady_clock::now();
+    std::string playbackId = run->engine->play(run->fileName, run->sink, "PA_SAMPLE_S16LE", STRESS_RATE, STRESS_CHANNELS, 50);
+    double playNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    if (playbackId.empty())
+        run->client->mRejected++;
+    else
+        run->client->started(playbackId, playNs, start);
+    return (++run->requested < run->clips) ? TRUE : FALSE;
+}
+
+static gboolean _checkDone(gpointer data)
+{
+    STRESS_RUN_T *run = (STRESS_RUN_T*)data;
+    if (run->requested >= run->clips && run->client->mFinished >= run->client->mStarted)
+    {
+        g_main_loop_quit(run->loop);
+        return FALSE;
+    }
+    return TRUE;
+}
+
+static gboolean _sampleTiming(gpointer data)
+{
+    STRESS_RUN_T *run = (STRESS_RUN_T*)data;
+    run->client->sampleTiming(run->engine);
+    return TRUE;
+}
+
+static gboolean _timeout(gpointer data)
+{
+    STRESS_RUN_T *run = (STRESS_RUN_T*)data;
+    fprintf(stderr, "timed out, %d of %d playbacks finished\n", run->client->mFinished, run->client->mStarted);
+    g_main_loop_quit(run->loop);
+    return FALSE;
+}
+
+static double cpuSeconds(const struct rusage &usage)
+{
+    return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec + (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+}
+
+int main(int argc, char *argv[])
+{
+    int clips = 300;
+    int interval = 5;
+    int clipMs = 300;
+    const char *sink = "@DEFAULT_SINK@";
+    int arg = 1;
+    for (; arg + 1 < argc && '-' == argv[arg][0]; arg += 2)
+    {
+        if (0 == strcmp(argv[arg], "-n"))
+            clips = atoi(argv[arg + 1]);
+        else if (0 == strcmp(argv[arg], "-i"))
+            interval = atoi(argv[arg + 1]);
+        else if (0 == strcmp(argv[arg], "-l"))
+            clipMs = atoi(argv[arg + 1]);
+        else if (0 == strcmp(argv[arg], "-s"))
+            sink = argv[arg + 1];
+        else
+            break;
+    }
+    if (arg + 1 < argc || clips <= 0 || interval <= 0 || clipMs <= 0)
+    {
+        fprintf(stderr, "usage: %s [-n clips] [-i interval ms] [-l clip ms] [-s sink] [file.pcm]\n", argv[0]);
+        return 1;
+    }
+    char toneFile[] = "/tmp/audiod-stress-XXXXXX";
+    const char *fileName = (arg < argc) ? argv[arg] : nullptr;
+    if (!fileName)
+    {
+        int fd = mkstemp(toneFile);
+        if (fd < 0)
+            return 1;
+        close(fd);
+        if (!writeTone(toneFile, clipMs))
+        {
+            fprintf(stderr, "%s: cannot write %s\n", argv[0], toneFile);
+            unlink(toneFile);
+            return 1;
+        }
+        fileName = toneFile;
+    }
+
+    setPmLogContext("audiod-stress");
+    StressClient client;
+    PulsePlaybackEngine *engine = new PulsePlaybackEngine();
+    engine->registerCallback(&client);
+    GMainLoop *loop = g_main_loop_new(nullptr, FALSE);
+    STRESS_RUN_T run = {engine, &client, loop, fileName, sink, clips, 0};
+
+    struct rusage before, after;
+    getrusage(RUSAGE_SELF, &before);
+    auto start = std::chrono::steady_clock::now();
+    g_timeout_add(interval, _startClip, &run);
+    g_timeout_add(20, _checkDone, &run);
+    g_timeout_add(STRESS_TIMING_INTERVAL_MS, _sampleTiming, &run);
+    g_timeout_add_seconds(10 + (clips * interval + clipMs) / 1000, _timeout, &run);
+    g_main_loop_run(loop);
+    double wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    uint32_t underruns = engine->getUnderrunCount();
+    delete engine;
+    getrusage(RUSAGE_SELF, &after);
+
+    printf("clips:%d started:%d rejected:%d finished:%d errors:%d\n", clips, client.mStarted,
+        client.mRejected, client.mFinished, client.mErrors);
+    printf("play() avg:%.0f us max:%.0f us\n", client.mStarted ? client.mPlayNs / client.mStarted / 1000 : 0.0,
+        client.mMaxPlayNs / 1000);
+    printf("concurrent playbacks max:%d underruns:%u\n", client.mMaxActive, underruns);
+    printf("start latency (play() to first frame heard) heard:%d avg:%.1f ms max:%.1f ms\n", client.mHeard,
+        client.mHeard ? client.mStartMs / client.mHeard : 0.0, client.mMaxStartMs);
+    printf("stream latency samples:%d avg:%.1f ms max:%.1f ms\n", client.mLatencySamples,
+        client.mLatencySamples ? client.mLatencyMs / client.mLatencySamples : 0.0, client.mMaxLatencyMs);
+    printf("wall:%.2f s cpu:%.2f s (%.1f%%) voluntary ctx switches:%ld involuntary:%ld\n", wallSeconds,
+        cpuSeconds(after) - cpuSeconds(before), 100 * (cpuSeconds(after) - cpuSeconds(before)) / wallSeconds,
+        after.ru_nvcsw - before.ru_nvcsw, after.ru_nivcsw - before.ru_nivcsw);
+
+    g_main_loop_unref(loop);
+    if (fileName == toneFile)
+        unlink(toneFile);
+    return (client.mErrors || client.mFinished < client.mStarted) ? 1 : 0;
+}
@@ -0,0 +1,109 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+// Host micro-benchmark of the stream policy lookups of AudioPolicyManager.
+// usage: audiod-policy-lookup-bench [audiod_sink_volume_policy_config.json]
+// The config is loaded into the StreamPolicyTable AudioPolicyManager uses, with the
+// position of each policy standing for its virtual sink. It times the stream type
+// lookup against the linear scan the getters did before the table, and one sink
+// open and close of the ducking policy with 1 to all other streams active.
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <pbnjson.hpp>
+#include "streamPolicyTable.h"
+
+static const int cIterations = 20000;
+
+//Stream type lookup as the getters did it before the table
+static const utils::VOLUME_POLICY_INFO_T* findPolicyLinear(const std::vector<utils::VOLUME_POLICY_INFO_T> &policies,\
+    const std::string &streamType)
+{
+    for (const auto &elements : policies)
+    {
+        if (elements.streamType == streamType)
+            return &elements;
+    }
+    return nullptr;
+}
+
+static double elapsedNs(std::chrono::steady_clock::time_point start, int count)
+{
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / count;
+}
+
+int main(int argc, char *argv[])
+{
+    const char *path = argc > 1 ? argv[1] : "files/config/audiod_sink_volume_policy_config.json";
+    pbnjson::JValue config = pbnjson::JDomParser::fromFile(path, pbnjson::JSchema::AllSchema());
+    pbnjson::JValue policyInfo = config["streamDetails"];
+    if (!policyInfo.isArray() || 0 == policyInfo.arraySize())
+    {
+        fprintf(stderr, "%s: cannot load stream policies from %s\n", argv[0], path);
+        return 1;
+    }
+    int streamCount = (int)policyInfo.arraySize();
+    StreamPolicyTable policies(streamCount);
+    std::vector<std::string> streamTypes;
+    for (const pbnjson::JValue &elements : policyInfo.items())
+    {
+        utils::VOLUME_POLICY_INFO_T stPolicyInfo = StreamPolicyTable::parsePolicyInfo(elements);
+        streamTypes.push_back(stPolicyInfo.streamType);
+        policies.addPolicy(stPolicyInfo, (int)streamTypes.size() - 1);
+    }
+
+    volatile int sink = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < cIterations; i++)
+        for (const auto &streamType : streamTypes)
+            sink += findPolicyLinear(policies.getPolicies(), streamType)->priority;
+    double linearNs = elapsedNs(start, cIterations * streamCount);
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < cIterations; i++)
+        for (const auto &streamType : streamTypes)
+            sink += policies.getPolicyInfo(streamType)->priority;
+    double hashNs = elapsedNs(start, cIterations * streamCount);
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < cIterations; i++)
+        for (int stream = 0; stream < streamCount; stream++)
+            sink += policies.getPolicyInfo(stream)->priority;
+    double denseNs = elapsedNs(start, cIterations * streamCount);
+    printf("%d stream policies from %s\n", streamCount, path);
+    printf("ns per lookup: linear scan %.1f, stream type hash %.1f, virtual sink table %.1f\n",\
+        linearNs, hashNs, denseNs);
+
+    //The first stream opens while the streams after it are active, then closes again
+    //so every iteration starts from the same state
+    printf("ns per sink open and close\nactive  ducking\n");
+    std::vector<StreamPolicyTable::POLICY_VOLUME_UPDATE_T> volumeUpdates;
+    const utils::VOLUME_POLICY_INFO_T *incoming = policies.getPolicyInfo(0);
+    for (int active = 1; active < streamCount; active++)
+    {
+        policies.activateStream(active, policies.getPolicyInfo(active)->priority, volumeUpdates);
+        start = std::chrono::steady_clock::now();
+        for (int i = 0; i < cIterations; i++)
+        {
+            volumeUpdates.clear();
+            policies.activateStream(0, incoming->priority, volumeUpdates);
+            policies.deactivateStream(0, incoming->priority, volumeUpdates);
+            sink += (int)volumeUpdates.size();
+        }
+        printf("%6d  %7.0f\n", active, elapsedNs(start, cIterations));
+    }
+    return 0;
+}